@@ -105,6 +105,7 @@ if(USE_OPENCL)
     	if(USE_CLGEMM)
           add_definitions(-DUSE_CLGEMM)
         endif()
+        include(cmake/OpenCL.cmake)
     endif()
 endif()
 
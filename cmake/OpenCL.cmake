@@ -0,0 +1,50 @@
+# Converts the OpenCL kernel sources to standard OpenCL at build time and embeds
+# them into a generated header, so that libcaffe doesn't read them at runtime
+
+# place where to generate the embedded OpenCL sources
+set(opencl_gen_folder "${PROJECT_BINARY_DIR}/include/caffe/util/OpenCL")
+include_directories(SYSTEM "${PROJECT_BINARY_DIR}/include")
+
+################################################################################################
+# Runs cl_embed on the given kernel sources, see tools/cl_embed.cpp
+# Usage:
+#   caffe_opencl_embed_sources(<output_dir> <hdrs_var> <cl_files>)
+# <hdrs_var> receives the stamp file to add to the sources of the library
+function(caffe_opencl_embed_sources output_dir hdrs_var)
+  if(NOT ARGN)
+    message(SEND_ERROR "Error: caffe_opencl_embed_sources() called without any OpenCL files")
+    return()
+  endif()
+
+  set(_embed_args)
+  set(_embed_deps ${PROJECT_SOURCE_DIR}/include/caffe/util/OpenCL/definitions.hpp
+                  ${PROJECT_SOURCE_DIR}/include/caffe/util/OpenCL/philox.hpp
+                  ${PROJECT_SOURCE_DIR}/include/caffe/util/OpenCL/reduction.hpp)
+  foreach(fil ${ARGN})
+    get_filename_component(abs_fil ${fil} ABSOLUTE)
+    file(RELATIVE_PATH rel_fil ${PROJECT_SOURCE_DIR} ${abs_fil})
+    list(APPEND _embed_args ${rel_fil} ${abs_fil})
+    list(APPEND _embed_deps ${abs_fil})
+  endforeach()
+
+  set(_header "${output_dir}/OpenCLSources.hpp")
+  set(_work_dir "${PROJECT_BINARY_DIR}/OpenCL")
+
+  # cl_embed leaves the header alone when its content didn't change, so that
+  # its includers aren't rebuilt. The command is tracked through a stamp file
+  # instead, else the untouched header would stay older than its dependencies
+  # and the command would run on every build.
+  set(_stamp "${_work_dir}/OpenCLSources.stamp")
+
+  add_custom_command(
+    OUTPUT "${_stamp}"
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${output_dir}"
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${_work_dir}"
+    COMMAND cl_embed "${_header}" "${_work_dir}" ${PROJECT_SOURCE_DIR}/include/caffe/util/OpenCL ${_embed_args}
+    COMMAND ${CMAKE_COMMAND} -E touch "${_stamp}"
+    DEPENDS cl_embed ${_embed_deps}
+    COMMENT "Embedding OpenCL kernel sources" VERBATIM )
+
+  set_source_files_properties(${_stamp} PROPERTIES GENERATED TRUE)
+  set(${hdrs_var} ${_stamp} PARENT_SCOPE)
+endfunction()
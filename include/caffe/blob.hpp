@@ -91,6 +91,10 @@ class Blob {
     inline int count() const {
       return count_;
     }
+    /// @brief The number of elements allocated, the largest count so far.
+    inline int capacity() const {
+      return capacity_;
+    }
 
     /**
      * @brief Compute the volume of a slice; i.e., the product of dimensions
@@ -292,6 +296,15 @@ class Blob {
      * shared_ptr calls its destructor when reset with the "=" operator.
      */
     void ShareDiff(const Blob& other);
+    /**
+     * @brief Set the data_ shared_ptr to point to a SyncedMemory that holds
+     *        at least count() elements -- useful to let Blob%s whose data is
+     *        not needed at the same time share their memory.
+     *
+     * The Blob keeps the storage until it is reshaped to a count beyond the
+     * storage or its diff.
+     */
+    void ShareDataStorage(const shared_ptr<SyncedMemory>& storage);
 
     bool ShapeEquals(const BlobProto& other);
 
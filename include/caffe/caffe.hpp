@@ -15,5 +15,6 @@
 #include "caffe/util/benchmark.hpp"
 #include "caffe/util/io.hpp"
 #include "caffe/vision_layers.hpp"
+#include "caffe/workspace_arena.hpp"
 
 #endif  // CAFFE_CAFFE_HPP_
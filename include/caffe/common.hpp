@@ -145,7 +145,22 @@ class Caffe {
     inline static curandGenerator_t curand_generator() {
       return Get().curand_generator_;
     }
-#endif  // Returns the mode: running on CPU or GPU.
+#endif
+#ifdef USE_OPENCL
+    // The key of the Philox generator behind caffe_gpu_rng_*, derived from
+    // the random seed.
+    inline static uint64_t philox_key() {
+      return Get().philox_key_;
+    }
+    // Reserves count consecutive Philox counters and returns the first one,
+    // so every call of caffe_gpu_rng_* draws new numbers.
+    inline static uint64_t philox_counter(const uint64_t count) {
+      uint64_t counter = Get().philox_counter_;
+      Get().philox_counter_ += count;
+      return counter;
+    }
+#endif
+    // Returns the mode: running on CPU or GPU.
     inline static Brew mode() {
       return Get().mode_;
     }
@@ -157,7 +172,7 @@ class Caffe {
     inline static void set_mode(Brew mode) {
       Get().mode_ = mode;
     }
-    // Sets the random seed of both boost and curand
+    // Sets the random seed of boost and of curand or the Philox generator
     static void set_random_seed(const unsigned int seed);
     // Sets the device. Since we have cublas and curand stuff, set device also
     // requires us to reset those values.
@@ -169,6 +184,10 @@ class Caffe {
 #ifdef USE_CUDA
     cublasHandle_t cublas_handle_;
     curandGenerator_t curand_generator_;
+#endif
+#ifdef USE_OPENCL
+    uint64_t philox_key_;
+    uint64_t philox_counter_;
 #endif
     shared_ptr<RNG> random_generator_;
 
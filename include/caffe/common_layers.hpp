@@ -193,6 +193,15 @@ class EltwiseLayer: public Layer<Dtype> {
     virtual inline const char* type() const {
       return "Eltwise";
     }
+
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("eltwise_layer");
+      if (this->layer_param_.fused_relu()) {
+        programs->push_back("relu_layer");
+      }
+    }
+#endif
     virtual inline int MinBottomBlobs() const {
       return 2;
     }
@@ -305,6 +314,15 @@ class InnerProductLayer: public Layer<Dtype> {
     virtual inline const char* type() const {
       return "InnerProduct";
     }
+
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("gemm");
+      if (this->layer_param_.fused_relu()) {
+        programs->push_back("relu_layer");
+      }
+    }
+#endif
     virtual inline int ExactNumBottomBlobs() const {
       return 1;
     }
@@ -332,7 +350,6 @@ class InnerProductLayer: public Layer<Dtype> {
     int K_;
     int N_;
     bool bias_term_;
-    Blob<Dtype> bias_multiplier_;
 };
 
 /**
@@ -354,6 +371,12 @@ class MVNLayer: public Layer<Dtype> {
     virtual inline const char* type() const {
       return "MVN";
     }
+
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("mvn_layer");
+    }
+#endif
     virtual inline int ExactNumBottomBlobs() const {
       return 1;
     }
@@ -377,7 +400,11 @@ class MVNLayer: public Layer<Dtype> {
         const vector<bool>& propagate_down,
         const vector<Blob<Dtype>*>& bottom);
 
-    Blob<Dtype> mean_, variance_, temp_;
+    Blob<Dtype> mean_, variance_;
+    /// temp holds intermediate results, scratch blob 0 of the layer.
+    inline Blob<Dtype>* temp() {
+      return this->workspace(0);
+    }
 
     /// sum_multiplier is used to carry out sum using BLAS
     Blob<Dtype> sum_multiplier_;
@@ -448,6 +475,12 @@ class SoftmaxLayer: public Layer<Dtype> {
     virtual inline const char* type() const {
       return "Softmax";
     }
+
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("softmax_layer");
+    }
+#endif
     virtual inline int ExactNumBottomBlobs() const {
       return 1;
     }
@@ -476,8 +509,11 @@ class SoftmaxLayer: public Layer<Dtype> {
     int softmax_axis_;
     /// sum_multiplier is used to carry out sum using BLAS
     Blob<Dtype> sum_multiplier_;
-    /// scale is an intermediate Blob to hold temporary results.
-    Blob<Dtype> scale_;
+    /// scale is an intermediate Blob to hold temporary results, scratch
+    /// blob 0 of the layer.
+    inline Blob<Dtype>* scale() {
+      return this->workspace(0);
+    }
 };
 
 #ifdef USE_CUDNN
@@ -10,6 +10,7 @@
 #include "caffe/layer_factory.hpp"
 #include "caffe/proto/caffe.pb.h"
 #include "caffe/util/device_alternate.hpp"
+#include "caffe/workspace_arena.hpp"
 
 namespace caffe {
 
@@ -36,6 +37,11 @@ class Layer {
             param) {
       // Set phase and copy blobs (if there are any).
       phase_ = param.phase();
+      workspace_forward_only_ = false;
+#ifdef USE_OPENCL
+      device_loss_ = NULL;
+      device_loss_offset_ = 0;
+#endif
       if (layer_param_.blobs_size() > 0) {
         blobs_.resize(
             layer_param_.blobs_size());
@@ -331,6 +337,59 @@ class Layer {
       param_propagate_down_[param_id] = value;
     }
 
+    /**
+     * @brief Returns scratch blob i of the layer.
+     *
+     * The layer Reshape%s its scratch blobs before it uses them, and their
+     * contents are undefined at the start of every Reshape, Forward and
+     * Backward. They are private blobs, or the slots of a WorkspaceArena
+     * shared with other layers, see set_workspace_arena.
+     */
+    inline Blob<Dtype>* workspace(int i) {
+      if (workspace_arena_) {
+        return workspace_arena_->slot(i);
+      }
+      while (workspace_.size() <= i) {
+        workspace_.push_back(shared_ptr<Blob<Dtype> >(new Blob<Dtype>()));
+      }
+      return workspace_[i].get();
+    }
+    /**
+     * @brief Takes the scratch blobs of the layer from arena from now on.
+     *
+     * @param forward_only
+     *     whether the layer runs no Backward, so that the results its Forward
+     *     keeps for Backward are scratch as well, see backward_workspace.
+     */
+    inline void set_workspace_arena(shared_ptr<WorkspaceArena<Dtype> > arena,
+                                    bool forward_only) {
+      workspace_arena_ = arena;
+      workspace_forward_only_ = forward_only;
+      workspace_.clear();
+    }
+
+#ifdef USE_OPENCL
+    /**
+     * @brief Makes the GPU Forward leave the loss of top i in the device
+     *        memory loss[offset + i] and return 0 instead of reading it back.
+     *        A NULL loss restores the default.
+     */
+    inline void set_device_loss(Dtype* loss, int offset) {
+      device_loss_ = loss;
+      device_loss_offset_ = offset;
+    }
+
+    /**
+     * @brief Adds the base names of the OpenCL programs, which the GPU
+     *        Forward and Backward of the layer run, to programs.
+     *
+     * After SetUp they follow the choices the layer made on its shapes,
+     * like the convolution engine. OpenCLManager::WarmUp() builds them.
+     */
+    virtual void opencl_programs(vector<string>* programs) const {
+    }
+#endif
+
  protected:
     /** The protobuf that stores the layer parameters */
     LayerParameter layer_param_;
@@ -340,6 +399,26 @@ class Layer {
     vector<shared_ptr<Blob<Dtype> > > blobs_;
     /** Vector indicating whether to compute the diff of each param blob. */
     vector<bool> param_propagate_down_;
+    /** The private scratch blobs, unless there is a workspace arena. */
+    vector<shared_ptr<Blob<Dtype> > > workspace_;
+    shared_ptr<WorkspaceArena<Dtype> > workspace_arena_;
+    bool workspace_forward_only_;
+#ifdef USE_OPENCL
+    /** The device loss slots of the tops, see set_device_loss(). */
+    Dtype* device_loss_;
+    int device_loss_offset_;
+#endif
+
+    /**
+     * @brief Returns blob, which keeps results of Forward for Backward, or
+     *        scratch blob i if the layer runs no Backward in its net.
+     */
+    inline Blob<Dtype>* backward_workspace(int i, Blob<Dtype>* blob) {
+      if (workspace_arena_ && workspace_forward_only_) {
+        return workspace(i);
+      }
+      return blob;
+    }
 
     /** The vector that indicates whether each top blob has a non-zero weight in
      *  the objective function. */
@@ -495,6 +574,19 @@ inline Dtype Layer<Dtype>::Forward(
         const int count = top[top_id]->count();
         const Dtype* data = top[top_id]->gpu_data();
         const Dtype* loss_weights = top[top_id]->gpu_diff();
+#ifdef USE_OPENCL
+        if (device_loss_) {
+          caffe_gpu_dot_device<Dtype>(
+              count,
+              data,
+              loss_weights,
+              NULL,
+              Dtype(1),
+              device_loss_,
+              device_loss_offset_ + top_id);
+          continue;
+        }
+#endif
         Dtype blob_loss = 0;
         caffe_gpu_dot(
             count,
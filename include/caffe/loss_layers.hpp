@@ -190,6 +190,12 @@ class ContrastiveLossLayer: public LossLayer<Dtype> {
     virtual inline const char* type() const {
       return "ContrastiveLoss";
     }
+
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("contrastive_loss_layer");
+    }
+#endif
     /**
      * Unlike most loss layers, in the ContrastiveLossLayer we can backpropagate
      * to the first two inputs.
@@ -686,6 +692,12 @@ class SigmoidCrossEntropyLossLayer: public LossLayer<Dtype> {
       return "SigmoidCrossEntropyLoss";
     }
 
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("sigmoid_layer");
+    }
+#endif
+
  protected:
     /// @copydoc SigmoidCrossEntropyLossLayer
     virtual void Forward_cpu(
@@ -800,6 +812,13 @@ class SoftmaxWithLossLayer: public LossLayer<Dtype> {
     virtual inline const char* type() const {
       return "SoftmaxWithLoss";
     }
+
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("softmax_layer");
+      programs->push_back("softmax_loss_layer");
+    }
+#endif
     virtual inline int ExactNumTopBlobs() const {
       return -1;
     }
@@ -12,6 +12,10 @@
 #include "caffe/layer.hpp"
 #include "caffe/proto/caffe.pb.h"
 
+#ifdef USE_OPENCL
+#include "caffe/util/OpenCL/OpenCLScheduler.hpp"
+#endif
+
 namespace caffe {
 
 /**
@@ -49,6 +53,16 @@ class Net {
     Dtype ForwardFromTo(int start, int end);
     Dtype ForwardFrom(int start);
     Dtype ForwardTo(int end);
+#ifdef USE_OPENCL
+    /**
+     * @brief Keeps the losses of the last slots forward passes of the whole
+     *        net on the device, so the GPU forward returns 0 instead of waiting
+     *        for its loss. 0 slots return to reading back the loss per pass.
+     */
+    void set_device_loss_slots(int slots);
+    /// @brief Reads back the mean loss of the forward passes in the slots.
+    Dtype DeviceLoss();
+#endif
     /// @brief Run forward using a set of bottom blobs, and return the result.
     const vector<Blob<Dtype>*>& Forward(
         const vector<Blob<Dtype>*> & bottom,
@@ -203,6 +217,16 @@ class Net {
     static void FilterNet(
         const NetParameter& param,
         NetParameter* param_filtered);
+    /**
+     * @brief Fold the ReLU layers that directly follow a Convolution,
+     *        InnerProduct or Eltwise layer into that layer, see
+     *        LayerParameter.fused_relu, and the max Pooling layers that
+     *        follow a Convolution layer, see LayerParameter.fused_pooling.
+     *        Only for nets without Backward.
+     */
+    static void FuseLayers(
+        const NetParameter& param,
+        NetParameter* param_fused);
     /// @brief return whether NetState state meets NetStateRule rule
     static bool StateMeetsRule(
         const NetState& state,
@@ -242,6 +266,18 @@ class Net {
 
     /// @brief Get misc parameters, e.g. the LR multiplier and weight decay.
     void GetLearningRateAndWeightDecay();
+    /// @brief Let the layers that run one after another take their scratch
+    ///        blobs from one WorkspaceArena.
+    void ShareWorkspaces();
+    /// @brief The WorkspaceArena of each layer, the same for layers that
+    ///        never run concurrently.
+    void WorkspaceArenaIds(vector<int>* arena_ids);
+    /// @brief Find the blobs whose memory may be shared, along with the
+    ///        layers producing and consuming them first and last.
+    void PlanMemory(const NetParameter& param);
+    /// @brief Let the planned blobs with disjoint lifetimes share their
+    ///        memory, for the current blob shapes.
+    void ShareMemory();
 
     /// @brief The network name
     string name_;
@@ -285,10 +321,29 @@ class Net {
     vector<float> params_lr_;
     /// the weight decay multipliers
     vector<float> params_weight_decay_;
+    /// the groups of blobs sharing their data, e.g. the tops of a split
+    /// layer, that may share their memory with other groups.
+    vector<vector<int> > memory_groups_;
+    /// the first and the last layer accessing each memory group.
+    vector<pair<int, int> > memory_group_lifetimes_;
     /// The bytes of memory used by this net
     size_t memory_used_;
+    /// the arena of each layer and the memory of the arenas
+    vector<int> workspace_arena_ids_;
+    size_t workspace_memory_used_;
     /// Whether to compute and display debug info for the net.
     bool debug_info_;
+#ifdef USE_OPENCL
+    /// issues the layers of independent branches on separate command queues
+    OpenCLScheduler scheduler_;
+    /// the losses of the layer tops, a row per forward pass
+    Blob<Dtype> device_loss_;
+    /// the first loss of each layer within a row of device_loss_
+    vector<int> device_loss_offsets_;
+    int device_loss_slots_;
+    int device_loss_slot_;
+    int device_loss_filled_;
+#endif
 
   DISABLE_COPY_AND_ASSIGN(Net);
 };
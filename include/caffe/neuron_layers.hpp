@@ -137,6 +137,12 @@ class BNLLLayer: public NeuronLayer<Dtype> {
       return "BNLL";
     }
 
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("bnll_layer");
+    }
+#endif
+
  protected:
     /// @copydoc BNLLLayer
     virtual void Forward_cpu(
@@ -206,6 +212,12 @@ class DropoutLayer: public NeuronLayer<Dtype> {
       return "Dropout";
     }
 
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("dropout_layer");
+    }
+#endif
+
  protected:
     /**
      * @param bottom input Blob vector (length 1)
@@ -239,13 +251,19 @@ class DropoutLayer: public NeuronLayer<Dtype> {
         const vector<Blob<Dtype>*>& bottom);
 
     /// when divided by UINT_MAX,
-    /// the randomly generated values @f$u\sim U(0, 1)@f$
+    /// the randomly generated values @f$u\sim U(0, 1)@f$, the OpenCL
+    /// kernels regenerate them instead
     Blob<unsigned int> rand_vec_;
     /// the probability @f$ p @f$ of dropping any input
     Dtype threshold_;
     /// the scale for undropped inputs at train time @f$ 1 / (1 - p) @f$
     Dtype scale_;
     unsigned int uint_thres_;
+#ifdef USE_OPENCL
+    /// the Philox key and counter of the mask of the last Forward_gpu
+    uint64_t philox_key_;
+    uint64_t philox_counter_;
+#endif
 };
 
 /**
@@ -429,6 +447,12 @@ class ReLULayer: public NeuronLayer<Dtype> {
       return "ReLU";
     }
 
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("relu_layer");
+    }
+#endif
+
  protected:
     /**
      * @param bottom input Blob vector (length 1)
@@ -534,6 +558,12 @@ class SigmoidLayer: public NeuronLayer<Dtype> {
       return "Sigmoid";
     }
 
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("sigmoid_layer");
+    }
+#endif
+
  protected:
     /**
      * @param bottom input Blob vector (length 1)
@@ -627,6 +657,12 @@ class TanHLayer: public NeuronLayer<Dtype> {
       return "TanH";
     }
 
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("tanh_layer");
+    }
+#endif
+
  protected:
     /**
      * @param bottom input Blob vector (length 1)
@@ -727,6 +763,12 @@ class ThresholdLayer: public NeuronLayer<Dtype> {
       return "Threshold";
     }
 
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("threshold_layer");
+    }
+#endif
+
  protected:
     /**
      * @param bottom input Blob vector (length 1)
@@ -795,6 +837,12 @@ class PReLULayer: public NeuronLayer<Dtype> {
       return "PReLU";
     }
 
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("prelu_layer");
+    }
+#endif
+
  protected:
     /**
      * @param bottom input Blob vector (length 1)
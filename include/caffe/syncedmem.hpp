@@ -55,7 +55,11 @@ class SyncedMemory {
             NULL), size_(
             0), head_(
             UNINITIALIZED), own_cpu_data_(
-            false) {
+            false), cpu_pinned_(
+            false), zero_copy_(
+            false), cpu_mapped_(
+            false), version_(
+            0) {
     }
     explicit SyncedMemory(size_t size)
         : cpu_ptr_(
@@ -63,7 +67,11 @@ class SyncedMemory {
             NULL), size_(
             size), head_(
             UNINITIALIZED), own_cpu_data_(
-            false) {
+            false), cpu_pinned_(
+            false), zero_copy_(
+            false), cpu_mapped_(
+            false), version_(
+            0) {
     }
     ~SyncedMemory();
     const void* cpu_data();
@@ -82,15 +90,31 @@ class SyncedMemory {
     size_t size() {
       return size_;
     }
+    // counts the mutable accesses, so that caches derived from the data can
+    // tell when it may have changed.
+    unsigned int version() {
+      return version_;
+    }
 
  private:
     void to_cpu();
     void to_gpu();
+    void malloc_host();
+    void free_host();
+    bool use_zero_copy();
+    void map_host();
+    void unmap_host();
     void* cpu_ptr_;
     void* gpu_ptr_;
     size_t size_;
     SyncedHead head_;
     bool own_cpu_data_;
+    // the host memory is a mapped OpenCL buffer instead of malloc'd memory.
+    bool cpu_pinned_;
+    // the host memory is the mapped device buffer, no copies are made.
+    bool zero_copy_;
+    bool cpu_mapped_;
+    unsigned int version_;
     int memoryCount;
     std::map<const void*, std::string> memoryTag;
 
@@ -15,17 +15,24 @@ namespace caffe {
 class OpenCLBuffer: public OpenCLMemory {
  public:
   OpenCLBuffer();
-  explicit OpenCLBuffer(size_t size);
+  explicit OpenCLBuffer(size_t size, cl_mem_flags flags = CL_MEM_READ_WRITE);
+  OpenCLBuffer(cl_mem slab, size_t origin, size_t size);
   ~OpenCLBuffer();
 
   bool isAvailable();
   void setAvailable();
   void setUnavailable();
+  size_t getRequestedSize();
+  void setRequestedSize(size_t size);
+  cl_mem getSlab();
 
  protected:
  private:
   OpenCLBuffer(const OpenCLBuffer&);
   bool available_;
+  size_t requested_size_;
+  // the slab of a sub-buffer, NULL for a buffer of its own
+  cl_mem slab_;
 };
 
 class OpenCLBufferException: public std::exception {
@@ -1,8 +1,10 @@
 #ifndef __OPENCL_DEVICE_HPP__
 #define __OPENCL_DEVICE_HPP__
 
+#include <boost/thread/mutex.hpp>
 #include <CL/cl.h>
 #include <CL/cl.hpp>
+#include <stdint.h>
 #include <tr1/memory>
 
 #include <caffe/util/OpenCL/definitions.hpp>
@@ -13,9 +15,23 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace caffe {
 
+// statistics of the caching allocator behind clMalloc()/clFree().
+struct OpenCLMemoryCacheStatistics {
+  OpenCLMemoryCacheStatistics()
+      : hits(0), misses(0), bytes_cached(0), bytes_in_use(0),
+        bytes_requested(0) {
+  }
+  uint64_t hits;
+  uint64_t misses;
+  size_t bytes_cached;
+  size_t bytes_in_use;
+  size_t bytes_requested;
+};
+
 class OpenCLDevice {
  public:
   OpenCLDevice();
@@ -31,6 +47,17 @@ class OpenCLDevice {
   cl_device_id id();
   // bool createContext();
   bool compile(std::string source);
+  bool compile(std::string name, const char* source,
+               const char* const* kernel_names);
+  bool buildProgram(std::string cl_source, bool use_cached_binary,
+                    cl_program* program,
+                    std::vector<std::string>* kernel_names);
+  bool buildProgram(std::string name, const char* source,
+                    bool use_cached_binary, cl_program* program);
+  bool registerProgram(std::string cl_source);
+  bool registerProgram(std::string name, const char* source,
+                       const char* const* kernel_names);
+  bool buildRegisteredProgram(std::string name);
   bool createQueue();
   cl_context getContext();
 
@@ -51,6 +78,33 @@ class OpenCLDevice {
   cl_command_queue* getCurrentOutputQueue();
   void waitForOutputQueues();
 
+  // the number of queues of each kind, defaults to OPENCL_NUM_*_QUEUES
+  // unless overridden by CAFFE_OPENCL_NUM_{INPUT,COMMAND,OUTPUT}_QUEUES.
+  bool setNumInputQueues(unsigned int num);
+  bool setNumCommandQueues(unsigned int num);
+  bool setNumOutputQueues(unsigned int num);
+  unsigned int getNumInputQueues();
+  unsigned int getNumCommandQueues();
+  unsigned int getNumOutputQueues();
+  unsigned int getCommandQueueIDX();
+  cl_command_queue* getCommandQueue(unsigned int idx);
+  // event based ordering between command queues.
+  bool enqueueMarker(unsigned int idx, cl_event* event);
+  bool enqueueWaitForEvents(unsigned int idx,
+                            const std::vector<cl_event>& events);
+  bool enqueueCommandQueueWait(unsigned int idx, unsigned int wait_idx);
+  // command queues with CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE. In that mode
+  // each command on a command queue waits for the events in the command
+  // wait list, which by default holds the event of the previous command.
+  bool setOutOfOrderExecution(bool out_of_order);
+  bool getOutOfOrderExecution();
+  cl_uint getCommandWaitListSize();
+  const cl_event* getCommandWaitList();
+  cl_event* getCommandEvent(cl_event* event = NULL);
+  void addCommandEvent(cl_event event);
+  void setCommandWaitList(const std::vector<cl_event>& events);
+  bool enqueueCommandMarker(cl_event* event);
+
   cl_kernel* getKernel(std::string name);
   bool add(OpenCLMemory& clMem);  // NOLINT(*)
   bool rmMemoryPtr(const void* ptr);
@@ -58,14 +112,67 @@ class OpenCLDevice {
   std::string getMemoryTag(const void* ptr);
   bool get(const void* ptr, OpenCLMemory** clMem);
   std::string getDeviceName();
+  std::string getDriverVersion();
   cl_uint getDeviceMemBaseAddrAlign();
+  size_t getMaxWorkGroupSize();
+  cl_ulong getLocalMemSize();
   size_t getMemoryUsage();
   void Synchronize();
 
   bool getBuffer(std::tr1::shared_ptr<OpenCLBuffer>* ptr, size_t size);
   bool setBufferAvailable(const void* ptr, size_t size);
+  void releaseBuffers();
+  void setMemoryCacheLimit(size_t bytes);
+  size_t getMemoryCacheLimit();
+  const OpenCLMemoryCacheStatistics& getMemoryCacheStatistics();
+  void setAsyncTransfers(bool async);
+  bool getAsyncTransfers();
+  void setPinnedHostMemory(bool pinned);
+  bool getPinnedHostMemory();
+  void setZeroCopy(bool zero_copy);
+  bool getZeroCopy();
+  bool mallocHost(void** ptr, size_t size);
+  bool freeHost(void* ptr);
+  static size_t getBufferSizeClass(size_t size);
 
  private:
+  // a program that is only built once one of its kernels is requested.
+  struct RegisteredProgram {
+    std::string name;
+    const char* source;
+    std::vector<std::string> kernels;
+    bool built;
+  };
+
+  bool addRegisteredProgram(const RegisteredProgram& program);
+  bool buildRegisteredProgramLocked(size_t idx);
+  // the sub-buffers of a slab are only freed together.
+  struct Slab {
+    size_t size_class;
+    size_t in_use;
+  };
+
+  bool createBuffers(size_t size_class);
+  cl_mem_flags bufferFlags();
+  void releaseBuffer(std::tr1::shared_ptr<OpenCLBuffer> buffer);
+  void releaseSlab(cl_mem slab);
+  bool resizeQueues(std::vector<cl_command_queue>* queues, unsigned int num,
+                    const char* kind);
+  void commitCommandEvent();
+  void releaseCommandEvents();
+  std::string buildOptions();
+  bool buildProgramFromSource(const std::string& name,
+                              const std::string& source,
+                              cl_program* program);
+  bool createKernels(const std::string& name, cl_program program,
+                     const std::vector<std::string>& kernel_names);
+  std::string programCacheKey(const std::string& source);
+  std::string programCacheFile(const std::string& key);
+  bool loadProgramBinary(const std::string& key, cl_program* program,
+                         std::vector<std::string>* kernel_names);
+  bool saveProgramBinary(const std::string& key, cl_program program,
+                         const std::vector<std::string>& kernel_names);
+
   cl_device_id deviceID;
   cl_platform_id platformID;
   cl_device_type deviceType;
@@ -87,19 +194,39 @@ class OpenCLDevice {
   cl_ulong deviceLocalMemSize;
   cl_bool deviceHostUnifiedMem;
   cl_uint deviceMemBaseAddrAlign;
+  cl_command_queue_properties deviceQueueProperties;
   std::string deviceName;
+  std::string deviceDriverVersion;
   cl::Context context_;
   std::vector<cl_program> programs;
-  cl_command_queue inputQueues[OPENCL_NUM_INPUT_QUEUES];
-  cl_command_queue commandQueues[OPENCL_NUM_COMMAND_QUEUES];
-  cl_command_queue outputQueues[OPENCL_NUM_OUTPUT_QUEUES];
+  std::vector<cl_command_queue> inputQueues;
+  std::vector<cl_command_queue> commandQueues;
+  std::vector<cl_command_queue> outputQueues;
+  unsigned int numInputQueues;
+  unsigned int numCommandQueues;
+  unsigned int numOutputQueues;
   unsigned int currentInputQueueIdx;
   unsigned int currentCommandQueueIdx;
   unsigned int currentOutputQueueIdx;
+  bool out_of_order_;
+  std::vector<cl_event> command_wait_list_;
+  cl_event command_event_;
 
   std::map<std::string, cl_kernel> kernel_map_;
+  std::vector<RegisteredProgram> registered_programs_;
+  std::map<std::string, size_t> kernel_program_;
+  std::tr1::shared_ptr<boost::mutex> build_mutex_;
   std::map<const void*, caffe::OpenCLMemory> memory;
+  // available buffers by size class and buffers handed out by virtual address
   std::map<size_t, std::vector<std::tr1::shared_ptr<caffe::OpenCLBuffer>>>buffer;  // NOLINT(*)
+  std::map<const void*, std::tr1::shared_ptr<caffe::OpenCLBuffer> > buffers_in_use_;  // NOLINT(*)
+  std::map<cl_mem, Slab> slabs_;
+  size_t memory_cache_limit_;
+  OpenCLMemoryCacheStatistics memory_cache_stats_;
+  bool async_transfers_;
+  int pinned_host_memory_;
+  int zero_copy_;
+  std::map<const void*, cl_mem> host_memory_;
 };
 }  // namespace caffe
 
@@ -0,0 +1,90 @@
+#ifndef __OPENCL_GEMM_TUNER_HPP__
+#define __OPENCL_GEMM_TUNER_HPP__
+
+#include <clBLAS.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace caffe {
+
+// the kernel that runs a GEMM shape. The kernel "default" stands for the
+// kernels clgemm() and clgemm_strided_batched() select by their rules,
+// "mmul_tiled" runs [tile x tile] tiles of C with wpt elements per thread.
+struct OpenCLGemmConfig {
+  OpenCLGemmConfig() : kernel("default"), tile(0), wpt(0), time_us(0) {
+  }
+  bool tiled() const {
+    return kernel == "mmul_tiled";
+  }
+  std::string kernel;
+  int tile;
+  int wpt;
+  float time_us;
+};
+
+// benchmarks the candidate kernels for a GEMM shape of the current device
+// and keeps the fastest one in a tuning database. The database is read from
+// and written to a text file with one shape per line:
+//
+//   device driver dtype transA transB M N K batch kernel tile wpt us
+//
+// separated by tabs. The file defaults to CAFFE_OPENCL_GEMM_TUNING_FILE or to
+// gemm_tuning.txt in the program cache directory. Batches are tuned with A
+// shared across the batch and B and C holding batch consecutive [KxN] and
+// [MxN] matrices.
+class OpenCLGemmTuner {
+ public:
+    // the tuned configuration for the shape on the current device. With
+    // tuning enabled, shapes that are not in the database are tuned first.
+    template <typename T>
+    static bool Lookup(const clblasTranspose TransA,
+                       const clblasTranspose TransB,
+                       const int m, const int n, const int k, const int batch,
+                       OpenCLGemmConfig* config);
+    template <typename T>
+    static bool Tune(const clblasTranspose TransA,
+                     const clblasTranspose TransB,
+                     const int m, const int n, const int k, const int batch,
+                     OpenCLGemmConfig* config);
+    // the mmul_tiled configurations that fit the current device.
+    template <typename T>
+    static std::vector<OpenCLGemmConfig> Candidates();
+    // tune shapes on their first use, defaults to CAFFE_OPENCL_GEMM_TUNING.
+    static void SetTuning(bool tuning);
+    static bool GetTuning();
+    static void SetFile(const std::string& file);
+    static std::string GetFile();
+    static bool Load();
+    static bool Save();
+    static void Clear();
+    static size_t GetNumEntries();
+
+ private:
+    OpenCLGemmTuner();
+    template <typename T>
+    static std::string Key(const clblasTranspose TransA,
+                           const clblasTranspose TransB,
+                           const int m, const int n, const int k,
+                           const int batch);
+    template <typename T>
+    static bool Run(const OpenCLGemmConfig& config,
+                    const clblasTranspose TransA,
+                    const clblasTranspose TransB,
+                    const int m, const int n, const int k, const int batch,
+                    const T* A, const T* B, T* C);
+    // tuned configurations by Key().
+    std::map<std::string, OpenCLGemmConfig> entries_;
+    std::string file_;
+    bool loaded_;
+    bool tuning_;
+    // set while the candidates run, so that they are not looked up.
+    bool benchmarking_;
+    // singleton instance.
+    static OpenCLGemmTuner instance_;
+};
+
+}  // namespace caffe
+
+#endif  // __OPENCL_GEMM_TUNER_HPP__
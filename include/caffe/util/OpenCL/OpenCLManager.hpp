@@ -6,10 +6,13 @@
 
 #include <caffe/util/OpenCL/OpenCLPlatform.hpp>
 
+#include <string>
 #include <vector>
 
 namespace caffe {
 
+template <typename Dtype> class Net;
+
 typedef std::vector<std::tr1::shared_ptr<caffe::OpenCLPlatform> > Platforms;
 typedef Platforms::iterator PlatformIter;
 class OpenCLManager {
@@ -19,6 +22,16 @@ class OpenCLManager {
     static int GetNumPlatforms();
     static std::tr1::shared_ptr<OpenCLPlatform> CurrentPlatform();
     static void SetDeviceId(int device_id);
+    static void SetProgramCacheDir(const std::string& dir);
+    static std::string GetProgramCacheDir();
+    static bool BenchmarkProgramBuild(float* cold_ms, float* warm_ms);
+    // builds the programs needed by the given layer types (or by the layers
+    // of a net, with their convolution engines and fused layers) on the
+    // current device ahead of the first forward pass, see
+    // Layer::opencl_programs().
+    static bool WarmUp(const std::vector<std::string>& layer_types);
+    template <typename Dtype>
+    static bool WarmUp(const Net<Dtype>& net);
  private:
     void Check();
     OpenCLManager();
@@ -29,6 +42,7 @@ class OpenCLManager {
     Platforms platforms_;
     int device_id_;
     bool initialized_;
+    std::string program_cache_dir_;
     // singleton instance.
     static OpenCLManager instance_;
 };
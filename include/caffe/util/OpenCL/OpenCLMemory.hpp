@@ -14,7 +14,8 @@ namespace caffe {
 class OpenCLMemory {
  public:
     OpenCLMemory();
-    explicit OpenCLMemory(size_t size);
+    explicit OpenCLMemory(size_t size, cl_mem_flags flags = CL_MEM_READ_WRITE);
+    OpenCLMemory(cl_mem slab, size_t origin, size_t size);
     ~OpenCLMemory();
 
     void free();
@@ -33,13 +34,11 @@ class OpenCLMemory {
     cl_event getEvent();
     void resetEvent();
 
-    static void logStatistics() {
-      DLOG(INFO) << "OpenCL Memory Statistics [clMalloc|clFree] = ["
-                 << numCallsMalloc << "|" << numCallsFree << "]";
-    }
+    static void logStatistics();
 
  private:
     OpenCLMemory(const OpenCLMemory&);
+    void setDeviceMemory(cl_mem mem, size_t size);
 
     /* the pointer to cl_mem object created by the OpenCL runtime
        this is not a memory address
@@ -31,6 +31,11 @@ class OpenCLPlatform {
     cl_platform_id id();
     bool createContext();
     bool compile(std::string sources);
+    bool compile(std::string name, const char* source,
+                 const char* const* kernel_names);
+    bool registerProgram(std::string sources);
+    bool registerProgram(std::string name, const char* source,
+                         const char* const* kernel_names);
     int getNumDevices(cl_device_type type);
     void DeviceSynchronize();
 
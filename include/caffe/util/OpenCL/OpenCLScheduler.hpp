@@ -0,0 +1,61 @@
+#ifndef __OPENCL_SCHEDULER_HPP__
+#define __OPENCL_SCHEDULER_HPP__
+
+#include <CL/cl.h>
+
+#include <vector>
+
+namespace caffe {
+
+// issues the layers of a net on the command queues of the current device.
+// Init() derives the dependency graph of the layers from their bottom and
+// top blobs: a layer depends on the layers that wrote its bottoms before
+// and on the layers that accessed its tops before. Instead of a clFinish,
+// a layer waits through a cl_event wait list for the events of the layers
+// it depends on.
+//
+// With in-order queues, the layers are assigned to chains along the graph:
+// a layer continues the chain of the first producer of its bottoms that has
+// not been continued yet, otherwise it starts a new chain. Chains map
+// round-robin onto the command queues, so the branches after a split run
+// concurrently. On an out-of-order command queue, each layer only waits for
+// the layers it depends on.
+class OpenCLScheduler {
+ public:
+  OpenCLScheduler();
+  ~OpenCLScheduler();
+
+  void Init(const std::vector<std::vector<int> >& bottom_ids,
+            const std::vector<std::vector<int> >& top_ids, int num_blobs);
+  // true if the current device has more than one command queue or an
+  // out-of-order command queue.
+  bool enabled();
+  unsigned int getQueueIdx(int layer);
+  int getChain(int layer);
+  // the layers with the same index run one after another: those on the same
+  // in-order command queue, or those of a chain on an out-of-order queue.
+  int getSerialIdx(int layer);
+  int getNumChains();
+  const std::vector<int>& getDependencies(int layer);
+  bool BeginLayer(int layer);
+  bool EndLayer(int layer);
+  // makes command queue 0 wait for all layers issued so far.
+  bool Join();
+
+ private:
+  OpenCLScheduler(const OpenCLScheduler&);
+  bool Fork();
+  void releaseEvents();
+
+  std::vector<std::vector<int> > layer_deps_;
+  std::vector<int> layer_chain_;
+  int num_chains_;
+  // per issued layer, the marker enqueued after its commands.
+  std::vector<cl_event> layer_event_;
+  // completes with the commands enqueued before the first issued layer.
+  cl_event fork_event_;
+};
+
+}  // namespace caffe
+
+#endif  // __OPENCL_SCHEDULER_HPP__
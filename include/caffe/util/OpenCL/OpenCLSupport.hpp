@@ -9,6 +9,7 @@
 
 #include <caffe/util/OpenCL/OpenCLBuffer.hpp>
 #include <caffe/util/OpenCL/OpenCLDevice.hpp>
+#include <caffe/util/OpenCL/OpenCLGemmTuner.hpp>
 #include <caffe/util/OpenCL/OpenCLManager.hpp>
 #include <caffe/util/OpenCL/OpenCLMemory.hpp>
 #include <caffe/util/OpenCL/OpenCLPlatform.hpp>
@@ -92,6 +93,16 @@ using kernelMapType = map<pair<string, type_index>, string>;
     ret;\
   })\
 
+// the wait list and event arguments of a command on the current command
+// queue, which chain the commands in out-of-order mode.
+#define CL_COMMAND_WAIT_LIST(device) \
+  (device).getCommandWaitListSize(), (device).getCommandWaitList(), \
+  (device).getCommandEvent()
+
+#define CL_COMMAND_WAIT_LIST_EVENT(device, event) \
+  (device).getCommandWaitListSize(), (device).getCommandWaitList(), \
+  (device).getCommandEvent(event)
+
 #define CL_SET_KERNEL_ARG\
   cl_int err;\
   unsigned int idx = 0;\
@@ -106,6 +117,10 @@ using kernelMapType = map<pair<string, type_index>, string>;
   DLOG(INFO)<<"CL_SET_ARRAY_KERNEL_ARG["<<idx<<"] = "<<*variable;\
   if ( !clSetKernelArrayArg(*variable, idx, sb, bm, kernel) ) return false;
 
+#define CL_SET_LOCAL_KERNEL_ARG(size, kernel) \
+  DLOG(INFO)<<"CL_SET_LOCAL_KERNEL_ARG["<<idx<<"] = "<<size;\
+  if ( !clSetKernelLocalArg(size, idx, kernel) ) return false;
+
 #define CL_SET_KERNEL_ARG_END\
   clReleaseSubBuffers(sb);\
   clReleaseBufferMap(bm);\
@@ -183,11 +198,18 @@ bool clGetBuffer(void** virtualPtr, size_t);
 bool clBufferSetAvailable(void* virtualPtr, size_t size);
 
 bool clFree(void* virtualPtr);
+bool clMallocHost(void** hostPtr, size_t size);
+bool clFreeHost(void* hostPtr);
+bool clIsZeroCopy();
+bool clMapHost(const void* virtualPtr, size_t size, void** hostPtr);
+bool clUnmapHost(const void* virtualPtr, void* hostPtr);
 template<typename T> bool clMemset(
     void* gpuPtr,
     const T alpha,
     const size_t Bytes);
 bool clMemcpy(void* dst, const void* src, size_t Bytes, int type);
+bool clWaitForTransfer(const void* virtualPtr);
+bool clEnqueueWaitForTransfer(const void* virtualPtr);
 bool clIsVirtualMemory(const void* p);
 bool clMakeLogical(const void* ptr_virtual, const void** ptr_logical);
 bool clMakeLogical2(
@@ -201,6 +223,8 @@ bool clSetKernelArrayArg(const void* ptr_virtual, unsigned int& idx, // NOLINT(*
     std::vector<cl_mem>& subBuffers,  // NOLINT(*)
     std::map<const void*, std::pair<void*, size_t> >& bufferMap,  // NOLINT(*)
     cl_kernel* kernel);
+bool clSetKernelLocalArg(size_t size, unsigned int& idx,  // NOLINT(*)
+    cl_kernel* kernel);
 bool clReleaseSubBuffers(std::vector<cl_mem>& subBuffers);  // NOLINT(*)
 bool clReleaseBufferMap(
     std::map<const void*, std::pair<void*, size_t> >& bufferMap);  // NOLINT(*)
@@ -265,6 +289,63 @@ template<typename T> bool clexp(
     const int n,
     const T* array_GPU_x,
     T* array_GPU_y);
+// y[(n * channels + c) * spatial_dim + s] += bias[c] for count elements.
+template<typename T> bool cladd_bias(
+    const int count,
+    const int channels,
+    const int spatial_dim,
+    const T* bias,
+    T* y);
+// y[c] += the sum of x[(n * channels + c) * spatial_dim + s] over n and s.
+template<typename T> bool clchannel_sum(
+    const int num,
+    const int channels,
+    const int spatial_dim,
+    const T* x,
+    T* y);
+// out[out_idx] = scale * dot(x, y), or the sum of |x[i] * y[i]| if absolute,
+// reduced in one or two passes on the device. A NULL y sums x.
+template<typename T> bool clreduce_dot(
+    const int n,
+    const T* x,
+    const T* y,
+    const bool absolute,
+    const T scale,
+    T* out,
+    const int out_idx);
+// the sum of |x[i]| and dot(x, y) reduced by clreduce_dot and read back.
+template<typename T> bool clasum(const int n, const T* x, T* out);
+template<typename T> bool cldot(const int n, const T* x, const T* y, T* out);
+// out[r] = scale * the sum of x * y and the maximum of x over row r of x
+// viewed as [outer x len x inner], r = o * inner + i. A NULL y sums x.
+template<typename T> bool clrows_sum(
+    const int rows,
+    const int len,
+    const int inner,
+    const T* x,
+    const T* y,
+    const T scale,
+    T* out);
+template<typename T> bool clrows_max(
+    const int rows,
+    const int len,
+    const int inner,
+    const T* x,
+    T* out);
+// the NDRange of a row reduction: a work group per row for rows of at least
+// OPENCL_LOCAL_SIZE elements, else a work item per row.
+void clrows_work_items(const int rows, const int len, int* group_per_row,
+                       size_t* global, size_t* local);
+// out[out_idx] = scale * dot(x, y) / sum(d) in a single work group, a NULL y
+// sums x and a NULL d divides by 1.
+template<typename T> bool cldot_device(
+    const int n,
+    const T* x,
+    const T* y,
+    const T* d,
+    const T scale,
+    T* out,
+    const int out_idx);
 template<typename T> bool clgemm(
     const clblasTranspose TransA,
     const clblasTranspose TransB,
@@ -329,6 +410,60 @@ template<typename T> bool cl_group_gemm_3D(
     T* C,
     const size_t idx_offset_C,
     cl_event* event);
+// runs batch GEMMs C_i = alpha*op(A_i)*op(B_i) + beta*C_i, where matrix i of
+// a batch starts at idx_offset_X + i*stride_X. A stride of 0 shares the
+// matrix across the batch. Uses the tuned kernel for the shape if any.
+// Unless NULL, bias_row[m] and bias_col[n] are added to C_i(m, n) as the
+// kernel writes it, followed by a ReLU with negative_slope if relu.
+template<typename T> bool clgemm_strided_batched(
+    const clblasTranspose TransA,
+    const clblasTranspose TransB,
+    const int m,
+    const int n,
+    const int k,
+    const int batch,
+    const T alpha,
+    const T* A,
+    const size_t idx_offset_A,
+    const size_t stride_A,
+    const T* B,
+    const size_t idx_offset_B,
+    const size_t stride_B,
+    const T beta,
+    T* C,
+    const size_t idx_offset_C,
+    const size_t stride_C,
+    const T* bias_row,
+    const T* bias_col,
+    const bool relu,
+    const T negative_slope,
+    cl_event* event);
+// runs batch GEMMs with the mmul_tiled kernel configured by config, matrix i
+// of a batch starts at idx_offset_X + i*stride_X.
+template<typename T> bool clgemm_tiled(
+    const OpenCLGemmConfig& config,
+    const clblasTranspose TransA,
+    const clblasTranspose TransB,
+    const int m,
+    const int n,
+    const int k,
+    const int batch,
+    const T alpha,
+    const T* A,
+    const size_t idx_offset_A,
+    const size_t stride_A,
+    const T* B,
+    const size_t idx_offset_B,
+    const size_t stride_B,
+    const T beta,
+    T* C,
+    const size_t idx_offset_C,
+    const size_t stride_C,
+    const T* bias_row,
+    const T* bias_col,
+    const bool relu,
+    const T negative_slope,
+    cl_event* event);
 template<typename T> bool clgemv(
     const clblasTranspose TransA,
     const int m,
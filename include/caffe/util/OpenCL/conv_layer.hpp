@@ -0,0 +1,53 @@
+#ifndef __OPENCL_CONV_LAYER_HPP__
+#define __OPENCL_CONV_LAYER_HPP__
+
+#include <CL/cl.h>
+#include <glog/logging.h>
+
+#include <caffe/util/OpenCL/OpenCLDevice.hpp>
+#include <caffe/util/OpenCL/OpenCLManager.hpp>
+#include <caffe/util/OpenCL/OpenCLPlatform.hpp>
+#include <caffe/util/OpenCL/OpenCLSupport.hpp>
+
+#include <iostream>   // NOLINT(*)
+#include <sstream>    // NOLINT(*)
+#include <string>
+
+namespace caffe {
+
+namespace OpenCL {
+
+// true if clConvolutionDirect supports the filter shape.
+bool clConvolutionDirectSupported(
+    const int kernel_h,
+    const int kernel_w,
+    const int stride_h,
+    const int stride_w);
+// convolves the num images without the im2col buffer, bias may be NULL.
+template<typename T> bool clConvolutionDirect(
+    const T* bottom_data,
+    const T* weight,
+    const T* bias,
+    const bool relu,
+    const T negative_slope,
+    const int num,
+    const int channels,
+    const int height,
+    const int width,
+    const int num_output,
+    const int group,
+    const int height_out,
+    const int width_out,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_h,
+    const int pad_w,
+    const int stride_h,
+    const int stride_w,
+    T* top_data);
+
+}  // namespace OpenCL
+
+}  // namespace caffe
+
+#endif  // __OPENCL_CONV_LAYER_HPP__
@@ -3,6 +3,7 @@
 
 #define OPENCL_WPT 4
 #define OPENCL_RTS 8
+#define OPENCL_TUNED_MAX_WPT 8
 #define OPENCL_BLOCK_SIZE 16
 #define PS 1
 
@@ -13,6 +14,17 @@
 
 #define OPENCL_LOCAL_SIZE 64
 
+// reductions: the most work groups of a first pass and the fewest elements
+// per work item before another work group is added.
+#define OPENCL_REDUCE_GROUPS 256
+#define OPENCL_REDUCE_ITEMS 4
+
+// direct convolution: output channels per work item and the largest filter
+// whose input tile fits into local memory.
+#define OPENCL_DIRECT_COUT 4
+#define OPENCL_DIRECT_MAX_KERNEL 5
+#define OPENCL_DIRECT_PATCH (OPENCL_BLOCK_SIZE + OPENCL_DIRECT_MAX_KERNEL - 1)
+
 #define OPENCL_NUM_INPUT_QUEUES 1
 #define OPENCL_NUM_COMMAND_QUEUES 1
 #define OPENCL_NUM_OUTPUT_QUEUES 1
@@ -20,14 +20,16 @@ namespace OpenCL {
 template<typename T> bool clDropoutLayerForward(
     const int count,
     const T* bottom_data,
-    const unsigned int* mask,
+    const uint64_t key,
+    const uint64_t counter,
     const unsigned int threshold,
     T scale,
     T* top_data);
 template<typename T> bool clDropoutLayerBackward(
     const int count,
     const T* top_diff,
-    const unsigned int* mask,
+    const uint64_t key,
+    const uint64_t counter,
     const unsigned int threshold,
     T scale,
     T* bottom_diff);
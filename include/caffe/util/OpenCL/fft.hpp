@@ -0,0 +1,75 @@
+#ifndef __OPENCL_FFT_HPP__
+#define __OPENCL_FFT_HPP__
+
+#include <CL/cl.h>
+#include <glog/logging.h>
+
+#include <caffe/util/OpenCL/OpenCLDevice.hpp>
+#include <caffe/util/OpenCL/OpenCLManager.hpp>
+#include <caffe/util/OpenCL/OpenCLPlatform.hpp>
+#include <caffe/util/OpenCL/OpenCLSupport.hpp>
+
+#include <iostream>   // NOLINT(*)
+#include <sstream>    // NOLINT(*)
+#include <string>
+
+namespace caffe {
+
+namespace OpenCL {
+
+template<typename T> bool clfft_pad(
+    const T* data,
+    const int planes,
+    const int height,
+    const int width,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int fft_h,
+    const int fft_w,
+    T* spectrum);
+// radix-2 FFTs of length n, a work item each. Sequence s starts at complex
+// element (s / inner) * outer_stride + (s % inner) * inner_stride and its
+// elements are elem_stride apart.
+template<typename T> bool clfft(
+    T* spectrum,
+    const int sequences,
+    const int n,
+    const int elem_stride,
+    const int inner,
+    const int inner_stride,
+    const int outer_stride,
+    const bool inverse);
+template<typename T> bool clfft_multiply(
+    const T* input,
+    const T* filter,
+    const int num,
+    const int channels,
+    const int num_output,
+    const int group,
+    const int size,
+    const bool transposed,
+    T* output);
+template<typename T> bool clfft_crop(
+    const T* spectrum,
+    const T* bias,
+    const bool relu,
+    const T negative_slope,
+    const int planes,
+    const int num_output,
+    const int fft_h,
+    const int fft_w,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int height,
+    const int width,
+    T* data);
+
+}  // namespace OpenCL
+
+}  // namespace caffe
+
+#endif  // __OPENCL_FFT_HPP__
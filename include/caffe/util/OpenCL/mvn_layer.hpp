@@ -123,6 +123,31 @@ template<typename T> bool clMVNLayerForward_perf(
     const T eps,
     T* data2D_out);
 
+// normalizes rows of width elements with their mean and sq_mean = E(X^2),
+// a NULL sq_mean only subtracts the mean.
+template<typename T> bool clMVNLayerForwardNormalize(
+    const int count,
+    const int width,
+    const T* bottom_data,
+    const T* mean,
+    const T* sq_mean,
+    const T eps,
+    T* top_data);
+
+// the gradient of clMVNLayerForwardNormalize with sq_mean, given the row sums
+// of top_diff and top_data * top_diff.
+template<typename T> bool clMVNLayerBackwardNormalize(
+    const int count,
+    const int width,
+    const T* top_data,
+    const T* top_diff,
+    const T* sum_diff,
+    const T* sum_top_diff,
+    const T* mean,
+    const T* sq_mean,
+    const T eps,
+    T* bottom_diff);
+
 }  // namespace OpenCL
 
 }  // namespace caffe
@@ -0,0 +1,39 @@
+#ifndef CAFFE_UTIL_OPENCL_PHILOX_H_
+#define CAFFE_UTIL_OPENCL_PHILOX_H_
+
+/*
+ * Philox4x32-10 for the OpenCL kernel sources
+ * (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC 2011)
+ *
+ * Maps the 64 bit counter (ctr0, ctr1) + idx and the 64 bit key (k0, k1) to
+ * 4 x 32 random bits in x. The generator has no state, so a kernel can
+ * regenerate the numbers of another kernel from the same key and counter.
+ */
+
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+#define PHILOX_2POW32_INV 2.3283064365386963e-10f
+#define PHILOX_2PI 6.2831853071795865f
+
+void philox4x32_10(const uint ctr0, const uint ctr1, const uint idx, uint k0, uint k1, uint* x) {
+  x[0] = ctr0 + idx;
+  x[1] = ctr1 + (x[0] < ctr0 ? 1 : 0);
+  x[2] = 0;
+  x[3] = 0;
+  for ( int round = 0; round < 10; round++ ) {
+    const uint hi0 = mul_hi(PHILOX_M0, x[0]);
+    const uint lo0 = PHILOX_M0 * x[0];
+    const uint hi1 = mul_hi(PHILOX_M1, x[2]);
+    const uint lo1 = PHILOX_M1 * x[2];
+    x[0] = hi1 ^ x[1] ^ k0;
+    x[1] = lo1;
+    x[2] = hi0 ^ x[3] ^ k1;
+    x[3] = lo0;
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+}
+
+#endif  // CAFFE_UTIL_OPENCL_PHILOX_H_
@@ -0,0 +1,50 @@
+#ifndef CAFFE_UTIL_OPENCL_REDUCTION_H_
+#define CAFFE_UTIL_OPENCL_REDUCTION_H_
+
+/*
+ * Work group reductions for the OpenCL kernel sources
+ *
+ * REDUCE_GROUP(value, partial, OP, SUB_GROUP_OP) combines the value of every
+ * work item of a 1D work group of OPENCL_LOCAL_SIZE items with OP and leaves
+ * the result in partial[0], a local array of OPENCL_LOCAL_SIZE elements, for
+ * all work items. All work items of the group have to reach it.
+ *
+ * Where the device has sub groups, their built-in SUB_GROUP_OP reduces in
+ * registers and only a value per sub group goes through local memory, else
+ * the values are combined by a tree in local memory.
+ */
+
+#define REDUCE_ADD(a, b) ((a) + (b))
+#define REDUCE_MAX(a, b) fmax((a), (b))
+
+#if defined(cl_intel_subgroups) || (defined(cl_khr_subgroups) && __OPENCL_C_VERSION__ >= 200)
+#if defined(cl_khr_subgroups)
+#pragma OPENCL EXTENSION cl_khr_subgroups : enable
+#endif
+#define REDUCE_SUB_GROUPS
+
+#define REDUCE_GROUP(value, partial, OP, SUB_GROUP_OP) \
+  value = SUB_GROUP_OP(value); \
+  if ( get_sub_group_local_id() == 0 ) { \
+    partial[get_sub_group_id()] = value; \
+  } \
+  barrier(CLK_LOCAL_MEM_FENCE); \
+  if ( get_local_id(0) == 0 ) { \
+    for ( uint sub_group = 1; sub_group < get_num_sub_groups(); sub_group++ ) { \
+      partial[0] = OP(partial[0], partial[sub_group]); \
+    } \
+  } \
+  barrier(CLK_LOCAL_MEM_FENCE);
+#else
+#define REDUCE_GROUP(value, partial, OP, SUB_GROUP_OP) \
+  partial[get_local_id(0)] = value; \
+  barrier(CLK_LOCAL_MEM_FENCE); \
+  for ( int stride = OPENCL_LOCAL_SIZE / 2; stride > 0; stride /= 2 ) { \
+    if ( get_local_id(0) < stride ) { \
+      partial[get_local_id(0)] = OP(partial[get_local_id(0)], partial[get_local_id(0) + stride]); \
+    } \
+    barrier(CLK_LOCAL_MEM_FENCE); \
+  }
+#endif
+
+#endif  // CAFFE_UTIL_OPENCL_REDUCTION_H_
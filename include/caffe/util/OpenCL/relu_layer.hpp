@@ -28,6 +28,14 @@ template<typename T> bool clReLULayerBackward(
     const T* bottom_data,
     T* bottom_diff,
     T negative_slope);
+// adds the bias of the channel, unless NULL, and applies the ReLU in place.
+template<typename T> bool clBiasReLUForward(
+    const int count,
+    const int channels,
+    const int spatial_dim,
+    const T* bias,
+    T negative_slope,
+    T* data);
 }  // namespace OpenCL
 
 }  // namespace caffe
@@ -49,6 +49,29 @@ template<typename T> bool clkernel_channel_dot(
     const T* data_1,
     const T* data_2,
     T* channel_dot);
+// the softmax of bottom over the channels in one kernel, see softmax_layer.cl.
+// With a label it also writes the loss and count of each (n, s) as
+// SoftmaxWithLossLayer needs them, else label, loss and counts are NULL.
+template<typename T> bool clSoftmaxForward(
+    const int num,
+    const int channels,
+    const int spatial_dim,
+    const T* bottom,
+    T* top,
+    const T* label,
+    const bool has_ignore_label,
+    const int ignore_label,
+    T* loss,
+    T* counts);
+// bottom_diff = (top_diff - dot(top_diff, top_data) over the channels) *
+// top_data in one kernel, bottom_diff may be top_diff.
+template<typename T> bool clSoftmaxBackward(
+    const int num,
+    const int channels,
+    const int spatial_dim,
+    const T* top_data,
+    const T* top_diff,
+    T* bottom_diff);
 
 }  // namespace OpenCL
 
@@ -0,0 +1,56 @@
+#ifndef __OPENCL_WINOGRAD_HPP__
+#define __OPENCL_WINOGRAD_HPP__
+
+#include <CL/cl.h>
+#include <glog/logging.h>
+
+#include <caffe/util/OpenCL/OpenCLDevice.hpp>
+#include <caffe/util/OpenCL/OpenCLManager.hpp>
+#include <caffe/util/OpenCL/OpenCLPlatform.hpp>
+#include <caffe/util/OpenCL/OpenCLSupport.hpp>
+
+#include <iostream>   // NOLINT(*)
+#include <sstream>    // NOLINT(*)
+#include <string>
+
+namespace caffe {
+
+namespace OpenCL {
+
+template<typename T> bool clwinograd_filter_transform(
+    const int num_output,
+    const T* weight,
+    const int channels,
+    const int tile,
+    T* filter);
+template<typename T> bool clwinograd_input_transform(
+    const int num_tiles,
+    const T* data_im,
+    const int channels,
+    const int height,
+    const int width,
+    const int pad_h,
+    const int pad_w,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    T* input);
+template<typename T> bool clwinograd_output_transform(
+    const int num_tiles,
+    const T* output,
+    const T* bias,
+    const bool relu,
+    const T negative_slope,
+    const int num_output,
+    const int height_out,
+    const int width_out,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    T* data_im);
+
+}  // namespace OpenCL
+
+}  // namespace caffe
+
+#endif  // __OPENCL_WINOGRAD_HPP__
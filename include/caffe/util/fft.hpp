@@ -0,0 +1,139 @@
+#ifndef _CAFFE_UTIL_FFT_HPP_
+#define _CAFFE_UTIL_FFT_HPP_
+
+namespace caffe {
+
+  // FFT convolution: the images and the filters are zero-padded to planes of
+  // [fft_h x fft_w] complex values, stored interleaved as (real, imag), and
+  // transformed by radix-2 FFTs. Per frequency, the spectra of the output
+  // channels are the sums of the products of the input channel spectra and
+  // the filter spectra. The planes are large enough that the circular
+  // convolution does not wrap around into the pixels that are kept.
+  inline int fft_size(const int size) {
+    int fft = 1;
+    while (fft < size) {
+      fft <<= 1;
+    }
+    return fft;
+  }
+
+  // writes the [planes x height x width] data into the real parts of
+  // [planes x fft_h x fft_w] complex planes: pixel (y, x) goes to
+  // (y * stride_h + offset_h, x * stride_w + offset_w), the rest is zero.
+  template<typename Dtype>
+  void fft_pad_cpu(
+      const Dtype* data,
+      const int planes,
+      const int height,
+      const int width,
+      const int stride_h,
+      const int stride_w,
+      const int offset_h,
+      const int offset_w,
+      const int fft_h,
+      const int fft_w,
+      Dtype* spectrum);
+
+  // transforms the complex planes in place, unscaled in both directions.
+  template<typename Dtype>
+  void fft2d_cpu(
+      Dtype* spectrum,
+      const int planes,
+      const int fft_h,
+      const int fft_w,
+      const bool inverse);
+
+  // output[n][o] = sum over the channels c of the group of o of
+  // input[n][c] * conj(filter[o][c]) per frequency, the correlation of
+  // ConvolutionLayer. The transposed filters [channels x num_output / group]
+  // of DeconvolutionLayer are multiplied as filter[c][o], a convolution.
+  template<typename Dtype>
+  void fft_multiply_cpu(
+      const Dtype* input,
+      const Dtype* filter,
+      const int num,
+      const int channels,
+      const int num_output,
+      const int group,
+      const int size,
+      const bool transposed,
+      Dtype* output);
+
+  // reads the real parts of the inverse transformed planes back:
+  // data[plane](y, x) is spectrum[plane](y * stride_h + offset_h,
+  // x * stride_w + offset_w) / (fft_h * fft_w) plus bias[plane % num_output].
+  // The bias may be NULL. With relu, the leaky ReLU of negative_slope is
+  // applied to the data.
+  template<typename Dtype>
+  void fft_crop_cpu(
+      const Dtype* spectrum,
+      const Dtype* bias,
+      const bool relu,
+      const Dtype negative_slope,
+      const int planes,
+      const int num_output,
+      const int fft_h,
+      const int fft_w,
+      const int stride_h,
+      const int stride_w,
+      const int offset_h,
+      const int offset_w,
+      const int height,
+      const int width,
+      Dtype* data);
+
+  template<typename Dtype>
+  void fft_pad_gpu(
+      const Dtype* data,
+      const int planes,
+      const int height,
+      const int width,
+      const int stride_h,
+      const int stride_w,
+      const int offset_h,
+      const int offset_w,
+      const int fft_h,
+      const int fft_w,
+      Dtype* spectrum);
+
+  template<typename Dtype>
+  void fft2d_gpu(
+      Dtype* spectrum,
+      const int planes,
+      const int fft_h,
+      const int fft_w,
+      const bool inverse);
+
+  template<typename Dtype>
+  void fft_multiply_gpu(
+      const Dtype* input,
+      const Dtype* filter,
+      const int num,
+      const int channels,
+      const int num_output,
+      const int group,
+      const int size,
+      const bool transposed,
+      Dtype* output);
+
+  template<typename Dtype>
+  void fft_crop_gpu(
+      const Dtype* spectrum,
+      const Dtype* bias,
+      const bool relu,
+      const Dtype negative_slope,
+      const int planes,
+      const int num_output,
+      const int fft_h,
+      const int fft_w,
+      const int stride_h,
+      const int stride_w,
+      const int offset_h,
+      const int offset_w,
+      const int height,
+      const int width,
+      Dtype* data);
+
+}  // namespace caffe
+
+#endif  // _CAFFE_UTIL_FFT_HPP_
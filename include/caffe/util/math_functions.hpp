@@ -27,6 +27,22 @@ void caffe_cpu_gemm(
     const Dtype beta,
     Dtype* C);
 
+// the same, C(m, n) also gets bias_row[m] and bias_col[n] unless NULL.
+template<typename Dtype>
+void caffe_cpu_gemm(
+    const CBLAS_TRANSPOSE TransA,
+    const CBLAS_TRANSPOSE TransB,
+    const int M,
+    const int N,
+    const int K,
+    const Dtype alpha,
+    const Dtype* A,
+    const Dtype* B,
+    const Dtype beta,
+    Dtype* C,
+    const Dtype* bias_row,
+    const Dtype* bias_col);
+
 template<typename Dtype>
 void caffe_cpu_gemv(
     const CBLAS_TRANSPOSE TransA,
@@ -175,6 +191,22 @@ DEFINE_CAFFE_CPU_UNARY_FUNC(
 template<typename Dtype>
 void caffe_cpu_scale(const int n, const Dtype alpha, const Dtype *x, Dtype* y);
 
+// x = max(x, 0) + negative_slope * min(x, 0) in place, the ReLU of layers
+// with LayerParameter.fused_relu.
+template<typename Dtype>
+void caffe_cpu_relu(const int n, const Dtype negative_slope, Dtype* x);
+
+// y[(n * channels + c) * spatial_dim + s] += bias[c] for the num images.
+template<typename Dtype>
+void caffe_cpu_add_bias(const int num, const int channels,
+    const int spatial_dim, const Dtype* bias, Dtype* y);
+
+// y[c] += the sum of x[(n * channels + c) * spatial_dim + s] over the num
+// images and spatial_dim, the gradient of caffe_cpu_add_bias.
+template<typename Dtype>
+void caffe_cpu_channel_sum(const int num, const int channels,
+    const int spatial_dim, const Dtype* x, Dtype* y);
+
 #ifdef USE_CUDA  // GPU
 
 // Decaf gpu gemm provides an interface that is almost the same as the cpu
@@ -199,6 +231,14 @@ template <typename Dtype>
 void caffe_gpu_axpby(const int N, const Dtype alpha, const Dtype* X,
     const Dtype beta, Dtype* Y);
 
+template <typename Dtype>
+void caffe_gpu_add_bias(const int num, const int channels,
+    const int spatial_dim, const Dtype* bias, Dtype* y);
+
+template <typename Dtype>
+void caffe_gpu_channel_sum(const int num, const int channels,
+    const int spatial_dim, const Dtype* x, Dtype* y);
+
 void caffe_gpu_memcpy(const size_t N, const void *X, void *Y);
 
 template <typename Dtype>
@@ -337,6 +377,12 @@ void caffe_gpu_set(const int n, const Dtype alpha, Dtype *x);
 template<typename T>
 void caffe_gpu_dot(const int n, const T* x, const T* y, T* out);
 
+// out[out_idx] = scale * dot(x, y) / sum(d) where out is device memory, so
+// the result is not read back. A NULL y sums x, a NULL d divides by 1.
+template<typename T>
+void caffe_gpu_dot_device(const int n, const T* x, const T* y, const T* d,
+    const T scale, T* out, const int out_idx);
+
 template<typename T>
 void caffe_gpu_sub(const int n, const T* a, const T* b, T* y);
 
@@ -509,6 +555,54 @@ void caffe_gpu_group_gemm_3D(
     const T beta,
     T* C);
 
+// batch GEMMs, matrix i of a batch starts at X + idx_offset_X + i*stride_X.
+// A stride of 0 shares the matrix across the batch.
+template<typename T>
+void caffe_gpu_gemm_strided_batched(
+    const CBLAS_TRANSPOSE TransA,
+    const CBLAS_TRANSPOSE TransB,
+    const int M,
+    const int N,
+    const int K,
+    const int batch,
+    const T alpha,
+    const T* A,
+    const size_t idx_offset_A,
+    const size_t stride_A,
+    const T* B,
+    const size_t idx_offset_B,
+    const size_t stride_B,
+    const T beta,
+    T* C,
+    const size_t idx_offset_C,
+    const size_t stride_C);
+
+// the same, C_i(m, n) also gets bias_row[m] and bias_col[n] unless NULL, and
+// goes through a ReLU with negative_slope if relu.
+template<typename T>
+void caffe_gpu_gemm_strided_batched(
+    const CBLAS_TRANSPOSE TransA,
+    const CBLAS_TRANSPOSE TransB,
+    const int M,
+    const int N,
+    const int K,
+    const int batch,
+    const T alpha,
+    const T* A,
+    const size_t idx_offset_A,
+    const size_t stride_A,
+    const T* B,
+    const size_t idx_offset_B,
+    const size_t stride_B,
+    const T beta,
+    T* C,
+    const size_t idx_offset_C,
+    const size_t stride_C,
+    const T* bias_row,
+    const T* bias_col,
+    const bool relu,
+    const T negative_slope);
+
 template<typename T>
 void caffe_gpu_axpy(const int N, const T alpha, const T* X, T* Y);
 
@@ -523,6 +617,14 @@ void caffe_gpu_axpby(
 template<typename T>
 void caffe_gpu_scal(const int N, const T alpha, T *X);
 
+template<typename T>
+void caffe_gpu_add_bias(const int num, const int channels,
+    const int spatial_dim, const T* bias, T* y);
+
+template<typename T>
+void caffe_gpu_channel_sum(const int num, const int channels,
+    const int spatial_dim, const T* x, T* y);
+
 void caffe_gpu_rng_uniform(const int n, unsigned int* r);
 
 template<typename T>
@@ -0,0 +1,103 @@
+#ifndef _CAFFE_UTIL_WINOGRAD_HPP_
+#define _CAFFE_UTIL_WINOGRAD_HPP_
+
+namespace caffe {
+
+  // Winograd convolution F(tile x tile, 3x3) with tile 2 or 4: the output is
+  // computed in tiles of [tile x tile] pixels from input tiles of
+  // [(tile + 2) x (tile + 2)] pixels that overlap by 2. Each of the
+  // (tile + 2)^2 positions t of the transformed tiles is a GEMM
+  //
+  //   output[t] (num_output x P) = filter[t] (num_output x channels)
+  //                                * input[t] (channels x P)
+  //
+  // over the P = num * tiles_h * tiles_w tiles of the batch, so filter[t] is
+  // [num_output x channels], input[t] is [channels x P] and output[t] is
+  // [num_output x P]. With groups, each group is a block of rows and columns.
+  inline int winograd_positions(const int tile) {
+    return (tile + 2) * (tile + 2);
+  }
+  inline int winograd_tiles(const int size_out, const int tile) {
+    return (size_out + tile - 1) / tile;
+  }
+
+  // transforms the [num_output x channels x 3 x 3] filters.
+  template<typename Dtype>
+  void winograd_filter_transform_cpu(
+      const Dtype* weight,
+      const int num_output,
+      const int channels,
+      const int tile,
+      Dtype* filter);
+
+  template<typename Dtype>
+  void winograd_input_transform_cpu(
+      const Dtype* data_im,
+      const int num,
+      const int channels,
+      const int height,
+      const int width,
+      const int pad_h,
+      const int pad_w,
+      const int tiles_h,
+      const int tiles_w,
+      const int tile,
+      Dtype* input);
+
+  // bias may be NULL. With relu, the leaky ReLU of negative_slope is applied
+  // to the output.
+  template<typename Dtype>
+  void winograd_output_transform_cpu(
+      const Dtype* output,
+      const Dtype* bias,
+      const bool relu,
+      const Dtype negative_slope,
+      const int num,
+      const int num_output,
+      const int height_out,
+      const int width_out,
+      const int tiles_h,
+      const int tiles_w,
+      const int tile,
+      Dtype* data_im);
+
+  template<typename Dtype>
+  void winograd_filter_transform_gpu(
+      const Dtype* weight,
+      const int num_output,
+      const int channels,
+      const int tile,
+      Dtype* filter);
+
+  template<typename Dtype>
+  void winograd_input_transform_gpu(
+      const Dtype* data_im,
+      const int num,
+      const int channels,
+      const int height,
+      const int width,
+      const int pad_h,
+      const int pad_w,
+      const int tiles_h,
+      const int tiles_w,
+      const int tile,
+      Dtype* input);
+
+  template<typename Dtype>
+  void winograd_output_transform_gpu(
+      const Dtype* output,
+      const Dtype* bias,
+      const bool relu,
+      const Dtype negative_slope,
+      const int num,
+      const int num_output,
+      const int height_out,
+      const int width_out,
+      const int tiles_h,
+      const int tiles_w,
+      const int tile,
+      Dtype* data_im);
+
+}  // namespace caffe
+
+#endif  // _CAFFE_UTIL_WINOGRAD_HPP_
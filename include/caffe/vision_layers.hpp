@@ -26,7 +26,7 @@ class BaseConvolutionLayer: public Layer<Dtype> {
  public:
     explicit BaseConvolutionLayer(const LayerParameter& param)
         : Layer<Dtype>(
-            param) {
+            param), fft_(false), fft_weight_(NULL), fft_version_(0) {
     }
     virtual void LayerSetUp(
         const vector<Blob<Dtype>*>& bottom,
@@ -44,14 +44,19 @@ class BaseConvolutionLayer: public Layer<Dtype> {
     virtual inline bool EqualNumBottomTopBlobs() const {
       return true;
     }
+#ifdef USE_OPENCL
+    virtual void opencl_programs(vector<string>* programs) const;
+#endif
 
  protected:
     // Helper functions that abstract away the column buffer and gemm arguments.
     // The last argument in forward_cpu_gemm is so that we can skip the im2col
-    // if we just called weight_cpu_gemm with the same input.
+    // if we just called weight_cpu_gemm with the same input. The bias of
+    // forward_cpu_gemm may be NULL, otherwise the GEMMs add it.
     void forward_cpu_gemm(
         const Dtype* input,
         const Dtype* weights,
+        const Dtype* bias,
         Dtype* output,
         bool skip_im2col = false);
     void forward_cpu_bias(Dtype* output, const Dtype* bias);
@@ -64,6 +69,9 @@ class BaseConvolutionLayer: public Layer<Dtype> {
         const Dtype* output,
         Dtype* weights);
     void backward_cpu_bias(Dtype* bias, const Dtype* input);
+    // Forward of all num_ images through the FFT engine, see fft.hpp, in
+    // chunks of fft_chunk_ images.
+    void forward_cpu_fft(const Dtype* input, const Dtype* bias, Dtype* output);
 
 #if defined(USE_CUDA) || defined(USE_OPENCL)
     void forward_gpu_gemm(
@@ -122,12 +130,53 @@ class BaseConvolutionLayer: public Layer<Dtype> {
         const size_t bias_offset,
         const Dtype* input,
         const size_t input_offset);
+
+    // the same for all num_ images at once, each group is one strided
+    // batched GEMM over the images of a chunk of col_chunk_ images. The
+    // GEMMs apply the ReLU with negative_slope as well if relu.
+    void forward_gpu_gemm_batched(
+        const Dtype* input,
+        const Dtype* weights,
+        const Dtype* bias,
+        const bool relu,
+        const Dtype negative_slope,
+        Dtype* output);
+
+    void forward_gpu_bias_batched(Dtype* output, const Dtype* bias);
+
+    void backward_gpu_bias_batched(Dtype* bias, const Dtype* input);
+
+    void backward_gpu_gemm_batched(
+        const Dtype* output,
+        const Dtype* weights,
+        Dtype* input);
+
+    void forward_gpu_fft(const Dtype* input, const Dtype* bias, Dtype* output);
+
+    // per image, the groups are one strided batched GEMM.
+    void weight_gpu_gemm_batched(
+        const Dtype* input,
+        const Dtype* output,
+        Dtype* weights);
 #endif  // OpenCL Only
 #endif  // OpenCL or CUDA
 
     // reverse_dimensions should return true iff we are implementing deconv, so
     // that conv helpers know which dimensions are which.
     virtual bool reverse_dimensions() = 0;
+    // true if Forward runs without the im2col buffer.
+    virtual inline bool col_free_forward() {
+      return fft_;
+    }
+    // true if the FFT engine takes fewer multiply-adds per image than the
+    // GEMMs of im2col, with the filter spectra computed beforehand.
+    bool fft_cheaper();
+    // true if the weights changed since the filter spectra were computed,
+    // which the caller then recomputes.
+    bool fft_filter_outdated();
+    // the number of images, at least one, whose scratch blobs of image_bytes
+    // per image fit into workspace_limit bytes.
+    int workspace_chunk(const size_t image_bytes, const char* scratch);
     // Compute height_out_ and width_out_ from other parameters.
     virtual void compute_output_shape() = 0;
 
@@ -151,7 +200,28 @@ class BaseConvolutionLayer: public Layer<Dtype> {
     size_t getImageColLength();
     size_t getChannelColLength();
 
-    Blob<Dtype> col_buffer_;
+    // the im2col buffer is scratch blob 0, it holds the columns of
+    // col_chunk_ images.
+    inline Blob<Dtype>* col_buffer() {
+      return this->workspace(0);
+    }
+    int col_chunk_;
+    // Forward runs through the FFT engine on planes of [fft_h_ x fft_w_].
+    bool fft_;
+    int fft_h_, fft_w_;
+    // the spectra of the images and of the outputs are scratch blobs 1 and 2,
+    // they hold the planes of fft_chunk_ images.
+    int fft_chunk_;
+    inline Blob<Dtype>* fft_input() {
+      return this->workspace(1);
+    }
+    inline Blob<Dtype>* fft_output() {
+      return this->workspace(2);
+    }
+    // the spectra of the filters and the weights they were computed from.
+    Blob<Dtype> fft_filter_;
+    const void* fft_weight_;
+    unsigned int fft_version_;
     Blob<int> index_mask_;
     Blob<int> im2col_mask_;
     Blob<int> col2im_mask_;
@@ -217,6 +287,65 @@ class BaseConvolutionLayer: public Layer<Dtype> {
 #endif
 
 #if defined(USE_OPENCL)
+    // im2col/col2im of the count images from image first on, image first + i
+    // has its columns at i * kernel_dim_ * conv_out_spatial_dim_. Only the
+    // first chunk of a batch runs as one kernel, the im2col kernels of the
+    // batch take no offset into the images.
+    inline void conv_im2col_batched_gpu(const Dtype* data, const int first,
+                                        const int count, Dtype* col_buff) {
+      const size_t data_dim = conv_in_channels_ * conv_in_height_ *
+          conv_in_width_;
+      const size_t col_dim = kernel_dim_ * conv_out_spatial_dim_;
+      if (first > 0) {
+        for (int i = 0; i < count; ++i) {
+          conv_im2col_gpu(data, data_dim * (first + i), col_buff, col_dim * i);
+        }
+        return;
+      }
+      im2col_group_gpu(
+          data,
+          data_dim,
+          count,
+          conv_in_channels_,
+          conv_in_height_,
+          conv_in_width_,
+          kernel_h_,
+          kernel_w_,
+          pad_h_,
+          pad_w_,
+          stride_h_,
+          stride_w_,
+          col_buff,
+          col_dim);
+    }
+    inline void conv_col2im_batched_gpu(const Dtype* col_buff,
+                                        const int first, const int count,
+                                        Dtype* data) {
+      const size_t data_dim = conv_in_channels_ * conv_in_height_ *
+          conv_in_width_;
+      const size_t col_dim = kernel_dim_ * conv_out_spatial_dim_;
+      if (first > 0) {
+        for (int i = 0; i < count; ++i) {
+          conv_col2im_gpu(col_buff, col_dim * i, data, data_dim * (first + i));
+        }
+        return;
+      }
+      col2im_gpu(
+          col_buff,
+          col_dim,
+          count,
+          conv_in_channels_,
+          conv_in_height_,
+          conv_in_width_,
+          kernel_h_,
+          kernel_w_,
+          pad_h_,
+          pad_w_,
+          stride_h_,
+          stride_w_,
+          data,
+          data_dim);
+    }
     inline void conv_im2col_gpu(
         const Dtype* data,
         const size_t data_offset,
@@ -269,8 +398,6 @@ class BaseConvolutionLayer: public Layer<Dtype> {
     }
 #endif
 
-    Blob<Dtype> bias_multiplier_;
-
     int conv_out_channels_;
     int conv_in_channels_;
     int conv_out_spatial_dim_;
@@ -330,17 +457,30 @@ class ConvolutionLayer: public BaseConvolutionLayer<Dtype> {
      *  first group and input channels 3-4 and output channels 5-8 into the
      *  second group.
      *  - bias_term (\b optional, default true). Whether to have a bias.
-     *  - engine: convolution has CAFFE (matrix multiplication) and CUDNN
-     *  (library kernels + stream parallelism) engines.
+     *  - engine: convolution has CAFFE (matrix multiplication), CUDNN
+     *  (library kernels + stream parallelism), DIRECT (OpenCL kernels
+     *  without the im2col buffer, for small filters) and WINOGRAD (minimal
+     *  filtering of 3x3 filters, see winograd_tile) and FFT (frequency
+     *  domain, for large filters) engines.
      */
     explicit ConvolutionLayer(const LayerParameter& param)
         : BaseConvolutionLayer<Dtype>(
-            param) {
+            param), direct_(false), winograd_(false), winograd_tile_(0),
+            winograd_weight_(NULL), winograd_version_(0) {
     }
+    virtual void LayerSetUp(
+        const vector<Blob<Dtype>*>& bottom,
+        const vector<Blob<Dtype>*>& top);
+    virtual void Reshape(
+        const vector<Blob<Dtype>*>& bottom,
+        const vector<Blob<Dtype>*>& top);
 
     virtual inline const char* type() const {
       return "Convolution";
     }
+#ifdef USE_OPENCL
+    virtual void opencl_programs(vector<string>* programs) const;
+#endif
 
  protected:
     virtual void Forward_cpu(
@@ -360,7 +500,57 @@ class ConvolutionLayer: public BaseConvolutionLayer<Dtype> {
     virtual inline bool reverse_dimensions() {
       return false;
     }
+    virtual inline bool col_free_forward() {
+      return (direct_ && Caffe::mode() == Caffe::GPU) || winograd_ ||
+          this->fft_;
+    }
     virtual void compute_output_shape();
+
+    // true if the weights changed since the filters of the WINOGRAD engine
+    // were transformed, which the caller then transforms again.
+    bool winograd_filter_outdated();
+    // Forward of num images, at most winograd_chunk_.
+    void forward_cpu_winograd(const Dtype* input, const Dtype* bias,
+                              const int num, Dtype* output);
+#if defined(USE_OPENCL)
+    void forward_gpu_winograd(const Dtype* input, const Dtype* bias,
+                              const int num, Dtype* output);
+#endif
+
+    // the DIRECT engine supports the filter shape.
+    bool direct_;
+    // the WINOGRAD engine supports the filter shape.
+    bool winograd_;
+    int winograd_tile_;
+    int winograd_tiles_h_, winograd_tiles_w_;
+    // the transformed input and the GEMM results are scratch blobs 1 and 2,
+    // they hold the tiles of winograd_chunk_ images.
+    int winograd_chunk_;
+    inline Blob<Dtype>* winograd_input() {
+      return this->workspace(1);
+    }
+    inline Blob<Dtype>* winograd_output() {
+      return this->workspace(2);
+    }
+    // [T x num_output x channels / group], see winograd.hpp.
+    Blob<Dtype> winograd_filter_;
+    // the weights winograd_filter_ was transformed from.
+    const void* winograd_weight_;
+    unsigned int winograd_version_;
+
+    // the internal PoolingLayer of fused_pooling, which reduces the output
+    // of the convolution in scratch blob 3 into the top.
+    shared_ptr<Layer<Dtype> > pooling_layer_;
+    vector<Blob<Dtype>*> conv_top_vec_;
+    // the blobs the convolution writes, top or the input of pooling_layer_.
+    inline const vector<Blob<Dtype>*>& conv_top(
+        const vector<Blob<Dtype>*>& top) {
+      if (!pooling_layer_) {
+        return top;
+      }
+      conv_top_vec_.assign(1, this->workspace(3));
+      return conv_top_vec_;
+    }
 };
 
 /**
@@ -477,6 +667,12 @@ class Im2colLayer: public Layer<Dtype> {
     virtual inline const char* type() const {
       return "Im2col";
     }
+
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("im2col");
+    }
+#endif
     virtual inline int ExactNumBottomBlobs() const {
       return 1;
     }
@@ -549,6 +745,12 @@ class LRNLayer: public Layer<Dtype> {
     virtual inline const char* type() const {
       return "LRN";
     }
+
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("lrn_layer");
+    }
+#endif
     virtual inline int ExactNumBottomBlobs() const {
       return 1;
     }
@@ -605,8 +807,12 @@ class LRNLayer: public Layer<Dtype> {
     int width_;
 
     // Fields used for normalization ACROSS_CHANNELS
-    // scale_ stores the intermediate summing results
+    // scale_ stores the intermediate summing results for Backward, which are
+    // scratch blob 0 if the layer runs no Backward.
     Blob<Dtype> scale_;
+    inline Blob<Dtype>* scale() {
+      return this->backward_workspace(0, &scale_);
+    }
 
     // Fields used for normalization WITHIN_CHANNEL
     shared_ptr<SplitLayer<Dtype> > split_layer_;
@@ -649,6 +855,16 @@ class PoolingLayer: public Layer<Dtype> {
     virtual inline const char* type() const {
       return "Pooling";
     }
+
+#ifdef USE_OPENCL
+    virtual inline void opencl_programs(vector<string>* programs) const {
+      programs->push_back("pooling_layer");
+      if (this->layer_param_.pooling_param().pool() ==
+          PoolingParameter_PoolMethod_STOCHASTIC) {
+        programs->push_back("random");
+      }
+    }
+#endif
     virtual inline int ExactNumBottomBlobs() const {
       return 1;
     }
@@ -688,6 +904,14 @@ class PoolingLayer: public Layer<Dtype> {
     bool global_pooling_;
     Blob<Dtype> rand_idx_;
     Blob<int> max_idx_;
+    // max pooling writes its mask to top[1] if there is one. Otherwise a layer
+    // that runs no Backward writes it to scratch blob 0 instead of max_idx_.
+    inline Blob<Dtype>* mask_workspace() {
+      return this->backward_workspace(0, NULL);
+    }
+    inline Blob<Dtype>* rand_idx() {
+      return this->backward_workspace(1, &rand_idx_);
+    }
 };
 
 #ifdef USE_CUDNN
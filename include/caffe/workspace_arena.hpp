@@ -0,0 +1,68 @@
+#ifndef CAFFE_WORKSPACE_ARENA_HPP_
+#define CAFFE_WORKSPACE_ARENA_HPP_
+
+#include <vector>
+
+#include "caffe/blob.hpp"
+#include "caffe/common.hpp"
+
+namespace caffe {
+
+/**
+ * @brief Scratch memory shared by Layer%s that never run concurrently.
+ *
+ * The arena holds numbered slots, a layer takes its i-th scratch blob from
+ * slot i. Each layer Reshape%s the slots it uses to its needs, and as a Blob
+ * only reallocates when it grows, every slot ends up with the largest
+ * requirement of a single layer instead of the sum over the layers. The
+ * contents of a slot are undefined whenever another layer ran in between.
+ */
+template<typename Dtype>
+class WorkspaceArena {
+ public:
+    WorkspaceArena() {
+    }
+
+    /// @brief Returns slot i, creating the slots up to i.
+    inline Blob<Dtype>* slot(int i) {
+      CHECK_GE(i, 0);
+      while (slots_.size() <= i) {
+        slots_.push_back(shared_ptr<Blob<Dtype> >(new Blob<Dtype>()));
+      }
+      return slots_[i].get();
+    }
+    inline int num_slots() const {
+      return slots_.size();
+    }
+    /// @brief Empties the shapes of all slots, keeping their memory.
+    inline void Clear() {
+      for (int i = 0; i < slots_.size(); ++i) {
+        slots_[i]->Reshape(vector<int>(1, 0));
+      }
+    }
+    /// @brief The number of elements of all slots in their current shapes.
+    inline size_t count() const {
+      size_t count = 0;
+      for (int i = 0; i < slots_.size(); ++i) {
+        count += slots_[i]->count();
+      }
+      return count;
+    }
+    /// @brief The number of elements allocated for all slots.
+    inline size_t capacity() const {
+      size_t capacity = 0;
+      for (int i = 0; i < slots_.size(); ++i) {
+        capacity += slots_[i]->capacity();
+      }
+      return capacity;
+    }
+
+ protected:
+    vector<shared_ptr<Blob<Dtype> > > slots_;
+
+  DISABLE_COPY_AND_ASSIGN(WorkspaceArena);
+};
+
+}  // namespace caffe
+
+#endif  // CAFFE_WORKSPACE_ARENA_HPP_
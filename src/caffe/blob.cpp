@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <climits>
 #include <vector>
 
@@ -132,6 +133,16 @@ void Blob<Dtype>::ShareDiff(const Blob& other) {
   diff_ = other.diff();
 }
 
+template <typename Dtype>
+void Blob<Dtype>::ShareDataStorage(const shared_ptr<SyncedMemory>& storage) {
+  CHECK(storage);
+  CHECK_GE(storage->size(), count_ * sizeof(Dtype));
+  data_ = storage;
+  // growing within the storage keeps sharing it, as long as the diff fits.
+  size_t bytes = diff_ ? std::min(storage->size(), diff_->size()) : 0;
+  capacity_ = bytes / sizeof(Dtype);
+}
+
 // The "update" method is used for parameter blobs in a Net, which are stored
 // as Blob<float> or Blob<double> -- hence we do not define it for
 // Blob<int> or Blob<unsigned int>.
@@ -286,7 +286,9 @@ const char* curandGetErrorString(curandStatus_t error) {
 
 #ifdef USE_OPENCL  // OpenCL Support
 
-Caffe::Caffe() : random_generator_(), mode_(Caffe::CPU) {
+Caffe::Caffe() :
+    philox_key_(cluster_seedgen()), philox_counter_(0),
+    random_generator_(), mode_(Caffe::CPU) {
   caffe::OpenCLManager::Init();
 }
 
@@ -294,6 +296,9 @@ Caffe::~Caffe() {
 }
 
 void Caffe::set_random_seed(const unsigned int seed) {
+  // Philox seed
+  Get().philox_key_ = seed;
+  Get().philox_counter_ = 0;
   // RNG seed
   Get().random_generator_.reset(new RNG(seed));
 }
@@ -303,7 +308,17 @@ void Caffe::SetDevice(const int device_id) {
 }
 
 void Caffe::DeviceQuery() {
+  OpenCLManager::Init();
   OpenCLManager::CurrentPlatform()->CurrentDevice().print();
+
+  float cold_ms;
+  float warm_ms;
+  if (OpenCLManager::BenchmarkProgramBuild(&cold_ms, &warm_ms)) {
+    LOG(INFO) << "Program cache directory:       "
+              << OpenCLManager::GetProgramCacheDir();
+    LOG(INFO) << "Program build time (cold):     " << cold_ms << " ms";
+    LOG(INFO) << "Program build time (warm):     " << warm_ms << " ms";
+  }
 }
 
 class Caffe::RNG::Generator {
@@ -22,7 +22,10 @@ shared_ptr<Layer<Dtype> > GetConvolutionLayer(
     engine = ConvolutionParameter_Engine_CUDNN;
 #endif
   }
-  if (engine == ConvolutionParameter_Engine_CAFFE) {
+  if (engine == ConvolutionParameter_Engine_CAFFE ||
+      engine == ConvolutionParameter_Engine_DIRECT ||
+      engine == ConvolutionParameter_Engine_WINOGRAD ||
+      engine == ConvolutionParameter_Engine_FFT) {
     return shared_ptr<Layer<Dtype> >(new ConvolutionLayer<Dtype>(param));
 #ifdef USE_CUDNN
   } else if (engine == ConvolutionParameter_Engine_CUDNN) {
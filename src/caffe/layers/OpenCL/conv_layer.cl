@@ -0,0 +1,116 @@
+#if defined(cl_khr_fp64)
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#endif
+
+#if defined(cl_amd_printf)
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+#endif
+
+#if defined(cl_amd_fp64)
+#pragma OPENCL EXTENSION cl_amd_fp64 : enable
+#endif
+
+#include "definitions.hpp"
+
+/*
+ * Direct convolution without the im2col buffer
+ *
+ * Each work group computes a [OPENCL_BLOCK_SIZE x OPENCL_BLOCK_SIZE] tile of
+ * OPENCL_DIRECT_COUT output channels of one image, each thread one output
+ * pixel of the OPENCL_DIRECT_COUT channels. Per input channel, the filters of
+ * the output channels and the input tile the work group reads are loaded into
+ * local memory. Input tiles that do not fit, e.g. of 1x1 filters with a stride
+ * of 2 or more, are read from global memory where each pixel is used once.
+ *
+ * Global Index Space
+ *   global_size[0] := width_out rounded up to OPENCL_BLOCK_SIZE
+ *   global_size[1] := height_out rounded up to OPENCL_BLOCK_SIZE
+ *   global_size[2] := num * group * ceil(num_output / group / OPENCL_DIRECT_COUT)
+ *
+ * Local Index Space
+ *   local_size := [OPENCL_BLOCK_SIZE x OPENCL_BLOCK_SIZE x 1]
+ *
+ * The filters are at most [OPENCL_DIRECT_MAX_KERNEL x OPENCL_DIRECT_MAX_KERNEL].
+ */
+template <class T> __kernel void ConvolutionDirect(global T* bottom, global T* weight, global T* bias, const int relu, const T negative_slope, const int channels, const int height, const int width, const int num_output, const int group, const int height_out, const int width_out, const int kernel_h, const int kernel_w, const int pad_h, const int pad_w, const int stride_h, const int stride_w, global T* top) {
+  __local T patch[OPENCL_DIRECT_PATCH * OPENCL_DIRECT_PATCH];
+  __local T filter[OPENCL_DIRECT_COUT * OPENCL_DIRECT_MAX_KERNEL * OPENCL_DIRECT_MAX_KERNEL];
+
+  const int tx = get_local_id(0);
+  const int ty = get_local_id(1);
+  const int thread = ty * OPENCL_BLOCK_SIZE + tx;
+  const int threads = OPENCL_BLOCK_SIZE * OPENCL_BLOCK_SIZE;
+  const int ow = get_global_id(0);
+  const int oh = get_global_id(1);
+
+  // the image, the group and the first output channel of the work group.
+  const int channels_g = channels / group;
+  const int outputs_g = num_output / group;
+  const int blocks = (outputs_g + OPENCL_DIRECT_COUT - 1) / OPENCL_DIRECT_COUT;
+  const int n = get_global_id(2) / (group * blocks);
+  const int g = (get_global_id(2) / blocks) % group;
+  const int o_bgn = g * outputs_g + (get_global_id(2) % blocks) * OPENCL_DIRECT_COUT;
+  const int o_end = min(o_bgn + OPENCL_DIRECT_COUT, (g + 1) * outputs_g);
+
+  // the input tile read by the work group.
+  const int h_bgn = get_group_id(1) * OPENCL_BLOCK_SIZE * stride_h - pad_h;
+  const int w_bgn = get_group_id(0) * OPENCL_BLOCK_SIZE * stride_w - pad_w;
+  const int patch_h = (OPENCL_BLOCK_SIZE - 1) * stride_h + kernel_h;
+  const int patch_w = (OPENCL_BLOCK_SIZE - 1) * stride_w + kernel_w;
+  const bool local_patch = patch_h <= OPENCL_DIRECT_PATCH && patch_w <= OPENCL_DIRECT_PATCH;
+  const int kernel_size = kernel_h * kernel_w;
+
+  T sum[OPENCL_DIRECT_COUT];
+  for ( int j = 0; j < OPENCL_DIRECT_COUT; j++ ) {
+    sum[j] = 0;
+  }
+
+  for ( int c = 0; c < channels_g; c++ ) {
+    global T* image = bottom + ((n * channels) + g * channels_g + c) * height * width;
+
+    for ( int i = thread; i < OPENCL_DIRECT_COUT * kernel_size; i += threads ) {
+      const int o = o_bgn + i / kernel_size;
+      filter[i] = o < o_end ? weight[(o * channels_g + c) * kernel_size + i % kernel_size] : 0;
+    }
+    if ( local_patch ) {
+      for ( int i = thread; i < patch_h * patch_w; i += threads ) {
+        const int h = h_bgn + i / patch_w;
+        const int w = w_bgn + i % patch_w;
+        patch[i] = (h >= 0 && h < height && w >= 0 && w < width) ? image[h * width + w] : 0;
+      }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for ( int kh = 0; kh < kernel_h; kh++ ) {
+      for ( int kw = 0; kw < kernel_w; kw++ ) {
+        T value;
+        if ( local_patch ) {
+          value = patch[(ty * stride_h + kh) * patch_w + tx * stride_w + kw];
+        } else {
+          const int h = oh * stride_h - pad_h + kh;
+          const int w = ow * stride_w - pad_w + kw;
+          value = (h >= 0 && h < height && w >= 0 && w < width) ? image[h * width + w] : 0;
+        }
+        for ( int j = 0; j < OPENCL_DIRECT_COUT; j++ ) {
+          sum[j] += filter[j * kernel_size + kh * kernel_w + kw] * value;
+        }
+      }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+
+  if ( ow < width_out && oh < height_out ) {
+    for ( int o = o_bgn; o < o_end; o++ ) {
+      T value = sum[o - o_bgn];
+      if ( bias ) {
+        value += bias[o];
+      }
+      if ( relu ) {
+        value = value > 0 ? value : value * negative_slope;
+      }
+      top[((n * num_output + o) * height_out + oh) * width_out + ow] = value;
+    }
+  }
+}
+template __attribute__((mangled_name(ConvolutionDirectFloat))) kernel void ConvolutionDirect(global float* bottom, global float* weight, global float* bias, const int relu, const float negative_slope, const int channels, const int height, const int width, const int num_output, const int group, const int height_out, const int width_out, const int kernel_h, const int kernel_w, const int pad_h, const int pad_w, const int stride_h, const int stride_w, global float* top);
+template __attribute__((mangled_name(ConvolutionDirectDouble))) kernel void ConvolutionDirect(global double* bottom, global double* weight, global double* bias, const int relu, const double negative_slope, const int channels, const int height, const int width, const int num_output, const int group, const int height_out, const int width_out, const int kernel_h, const int kernel_w, const int pad_h, const int pad_w, const int stride_h, const int stride_w, global double* top);
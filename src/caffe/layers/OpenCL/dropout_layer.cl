@@ -10,20 +10,41 @@
 #pragma OPENCL EXTENSION cl_amd_fp64 : enable
 #endif
 
-template <class T> __kernel void DropoutForward(const int n, global T* in, global unsigned int* mask, const unsigned int threshold, const T scale, global T* out) {
-  int idx = get_global_id(0);
-  if ( idx < n ) {
-    out[idx] = in[idx] * mask[idx] * scale;
+#include "philox.hpp"
+
+/*
+ * Dropout without a mask in memory
+ *
+ * Forward and Backward regenerate the same uniform 32 bit numbers from the
+ * Philox key (key0, key1) and counter (ctr0, ctr1) of the iteration, an
+ * input is kept if its number is above threshold. Each work item handles 4
+ * consecutive inputs with one Philox call.
+ *
+ * Global Index Space
+ *   global_size[0] := ceil(n / 4)
+ */
+template <class T> __kernel void DropoutForward(const int n, global T* in, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const unsigned int threshold, const T scale, global T* out) {
+  uint x[4];
+  philox4x32_10(ctr0, ctr1, get_global_id(0), key0, key1, x);
+  for ( int j = 0; j < 4; j++ ) {
+    const int idx = get_global_id(0) * 4 + j;
+    if ( idx < n ) {
+      out[idx] = in[idx] * scale * (x[j] > threshold);
+    }
   }
 }
-template __attribute__((mangled_name(DropoutForwardFloat))) kernel void DropoutForward(const int n, global float* in, global unsigned int* mask, const unsigned int threshold, const float scale, global float* out);
-template __attribute__((mangled_name(DropoutForwardDouble))) kernel void DropoutForward(const int n, global double* in, global unsigned int* mask, const unsigned int threshold, const double scale, global double* out);
+template __attribute__((mangled_name(DropoutForwardFloat))) kernel void DropoutForward(const int n, global float* in, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const unsigned int threshold, const float scale, global float* out);
+template __attribute__((mangled_name(DropoutForwardDouble))) kernel void DropoutForward(const int n, global double* in, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const unsigned int threshold, const double scale, global double* out);
 
-template <class T> __kernel void DropoutBackward(const int n, global T* in_diff, global unsigned int* mask, const unsigned int threshold, const T scale, global T* out_diff) {
-  int idx = get_global_id(0);
-  if ( idx < n ) {
-      out_diff[idx] = in_diff[idx] * scale * mask[idx];
+template <class T> __kernel void DropoutBackward(const int n, global T* in_diff, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const unsigned int threshold, const T scale, global T* out_diff) {
+  uint x[4];
+  philox4x32_10(ctr0, ctr1, get_global_id(0), key0, key1, x);
+  for ( int j = 0; j < 4; j++ ) {
+    const int idx = get_global_id(0) * 4 + j;
+    if ( idx < n ) {
+      out_diff[idx] = in_diff[idx] * scale * (x[j] > threshold);
+    }
   }
 }
-template __attribute__((mangled_name(DropoutBackwardFloat))) kernel void DropoutBackward(const int n, global float* in_diff, global unsigned int* mask, const unsigned int threshold, const float scale, global float* out_diff);
-template __attribute__((mangled_name(DropoutBackwardDouble))) kernel void DropoutBackward(const int n, global double* in_diff, global unsigned int* mask, const unsigned int threshold, const double scale, global double* out_diff);
+template __attribute__((mangled_name(DropoutBackwardFloat))) kernel void DropoutBackward(const int n, global float* in_diff, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const unsigned int threshold, const float scale, global float* out_diff);
+template __attribute__((mangled_name(DropoutBackwardDouble))) kernel void DropoutBackward(const int n, global double* in_diff, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const unsigned int threshold, const double scale, global double* out_diff);
@@ -315,3 +315,39 @@ template <class T> __kernel void MVNLayerBackward_perf(global T* A2D_top, global
 template __attribute__((mangled_name(MVNLayerBackward_perfFloat))) kernel void MVNLayerBackward_perf(global float* A2D_top, global float* A2D_top_diff, const int top_height, const int top_width, global float* A2D_bottom, global float* A2D_bottom_diff, const int bottom_height, const int bottom_width, global float* A1D_sum_multiplier, global float* A1D_buffer, const int sum_multiplier_length, const T eps, global float* A2D_out);
 template __attribute__((mangled_name(MVNLayerBackward_perfDouble))) kernel void MVNLayerBackward_perf(global double* A2D_top, global double* A2D_top_diff, const int top_height, const int top_width, global double* A2D_bottom, global double* A2D_bottom_diff, const int bottom_height, const int bottom_width, global double* A1D_sum_multiplier, global double* A1D_buffer, const int sum_multiplier_length, const T eps, global double* A2D_out);
 
+
+/*
+ * top = (bottom - mean) / (sqrt(sq_mean - mean^2) + eps) for rows of width
+ * elements with the row statistics mean and sq_mean = E(X^2), a NULL sq_mean
+ * only subtracts the mean
+ */
+template <class T> __kernel void MVNLayerForwardNormalize(const int count, const int width, global T* bottom_data, global T* mean, global T* sq_mean, const T eps, global T* top_data) {
+  const int idx = get_global_id(0);
+  if ( idx < count ) {
+    const int r = idx / width;
+    T value = bottom_data[idx] - mean[r];
+    if ( sq_mean ) {
+      value /= sqrt(sq_mean[r] - mean[r] * mean[r]) + eps;
+    }
+    top_data[idx] = value;
+  }
+}
+template __attribute__((mangled_name(MVNLayerForwardNormalizeFloat))) kernel void MVNLayerForwardNormalize(const int count, const int width, global float* bottom_data, global float* mean, global float* sq_mean, const float eps, global float* top_data);
+template __attribute__((mangled_name(MVNLayerForwardNormalizeDouble))) kernel void MVNLayerForwardNormalize(const int count, const int width, global double* bottom_data, global double* mean, global double* sq_mean, const double eps, global double* top_data);
+
+/*
+ * bottom_diff = (top_diff - (sum_diff + sum_top_diff * top) / width)
+ *             / (sqrt(sq_mean - mean^2) + eps)
+ * with the row sums of top_diff and top * top_diff and the row statistics of
+ * the bottom as in MVNLayerForwardNormalize
+ */
+template <class T> __kernel void MVNLayerBackwardNormalize(const int count, const int width, global T* top_data, global T* top_diff, global T* sum_diff, global T* sum_top_diff, global T* mean, global T* sq_mean, const T eps, global T* bottom_diff) {
+  const int idx = get_global_id(0);
+  if ( idx < count ) {
+    const int r = idx / width;
+    T value = top_diff[idx] - (sum_diff[r] + sum_top_diff[r] * top_data[idx]) / width;
+    bottom_diff[idx] = value / (sqrt(sq_mean[r] - mean[r] * mean[r]) + eps);
+  }
+}
+template __attribute__((mangled_name(MVNLayerBackwardNormalizeFloat))) kernel void MVNLayerBackwardNormalize(const int count, const int width, global float* top_data, global float* top_diff, global float* sum_diff, global float* sum_top_diff, global float* mean, global float* sq_mean, const float eps, global float* bottom_diff);
+template __attribute__((mangled_name(MVNLayerBackwardNormalizeDouble))) kernel void MVNLayerBackwardNormalize(const int count, const int width, global double* top_data, global double* top_diff, global double* sum_diff, global double* sum_top_diff, global double* mean, global double* sq_mean, const double eps, global double* bottom_diff);
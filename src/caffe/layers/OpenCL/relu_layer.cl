@@ -19,6 +19,23 @@ template <class T> __kernel void ReLUForward(const int n, global T* in, global T
 template __attribute__((mangled_name(ReLUForwardFloat))) kernel void ReLUForward(const int n, global float* in, global float* out, float negative_slope);
 template __attribute__((mangled_name(ReLUForwardDouble))) kernel void ReLUForward(const int n, global double* in, global double* out, double negative_slope);
 
+/*
+ * the ReLU of layers with a fused ReLU in place, after adding the bias of
+ * channel (idx / spatial_dim) % channels unless bias is NULL.
+ */
+template <class T> __kernel void BiasReLUForward(const int n, const int channels, const int spatial_dim, global T* bias, T negative_slope, global T* data) {
+  int idx = get_global_id(0);
+  if ( idx < n ) {
+    T value = data[idx];
+    if ( bias ) {
+      value += bias[(idx / spatial_dim) % channels];
+    }
+    data[idx] = value > 0 ? value : value * negative_slope;
+  }
+}
+template __attribute__((mangled_name(BiasReLUForwardFloat))) kernel void BiasReLUForward(const int n, const int channels, const int spatial_dim, global float* bias, float negative_slope, global float* data);
+template __attribute__((mangled_name(BiasReLUForwardDouble))) kernel void BiasReLUForward(const int n, const int channels, const int spatial_dim, global double* bias, double negative_slope, global double* data);
+
 template <class T> __kernel void ReLUBackward(const int n, global T* in_diff, global T* in_data, global T* out_diff, T negative_slope) {
   int idx = get_global_id(0);
   if ( idx < n ) {
@@ -10,6 +10,9 @@
 #pragma OPENCL EXTENSION cl_amd_fp64 : enable
 #endif
 
+#include "definitions.hpp"
+#include "reduction.hpp"
+
 template <class T> __kernel void kernel_channel_max(const int num, const int channels, const int spatial_dim, const global T* data, global T* out) {
   int idx = get_global_id(0);
   if ( idx < num*spatial_dim ) {
@@ -90,32 +93,110 @@ template <class T> __kernel void kernel_channel_dot(const int num, const int cha
 template __attribute__((mangled_name(kernel_channel_dotFloat))) kernel void kernel_channel_dot(const int num, const int channels, const int spatial_dim, const global float* data_1, const global float* data_2,  global float* channel_dot);
 template __attribute__((mangled_name(kernel_channel_dotDouble))) kernel void kernel_channel_dot(const int num, const int channels, const int spatial_dim, const global double* data_1, const global double* data_2,  global double* channel_dot);
 
+/*
+ * Fused softmax over the channels of each (n, s) row
+ *
+ * A pass over the row keeps the running maximum m and the sum d of
+ * exp(x - m), rescaling d when m grows, and a second pass writes
+ * top = exp(x - m) / d. With group_per_row the work items of a work group
+ * share a row and combine their m and d in local memory, for many channels,
+ * else a work item handles a row, for few channels and a large spatial_dim.
+ *
+ * With a label, loss[r] = -log(top[label]) and counts[r] = 1 of row r, both 0
+ * for the ignore_label, as SoftmaxLossForwardGPU computes them.
+ *
+ * Global Index Space
+ *   global_size[0] := rows * OPENCL_LOCAL_SIZE with group_per_row, else rows
+ *                     rounded up to OPENCL_LOCAL_SIZE, rows = num * spatial_dim
+ */
+template <class T> __kernel void SoftmaxForward(const int num, const int channels, const int spatial_dim, const int group_per_row, global T* bottom, global T* top, global T* label, const int has_ignore_label, const int ignore_label, global T* loss, global T* counts) {
+  __local T partial_max[OPENCL_LOCAL_SIZE];
+  __local T partial_sum[OPENCL_LOCAL_SIZE];
+  const int r = group_per_row ? get_group_id(0) : get_global_id(0);
+  const int first = group_per_row ? get_local_id(0) : 0;
+  const int step = group_per_row ? OPENCL_LOCAL_SIZE : 1;
+  const bool active = r < num * spatial_dim;
+  const int n = r / spatial_dim;
+  const int s = r % spatial_dim;
+  global T* x = bottom + n * channels * spatial_dim + s;
+  global T* y = top + n * channels * spatial_dim + s;
+
+  T m = -FLT_MAX;
+  T d = 0;
+  if ( active ) {
+    for ( int c = first; c < channels; c += step ) {
+      T value = x[c * spatial_dim];
+      if ( value > m ) {
+        d = (d > 0 ? d * exp(m - value) : 0) + 1;
+        m = value;
+      } else {
+        d += exp(value - m);
+      }
+    }
+  }
+  if ( group_per_row ) {
+    T row_max = m;
+    REDUCE_GROUP(row_max, partial_max, REDUCE_MAX, sub_group_reduce_max);
+    row_max = partial_max[0];
+    d = d > 0 ? d * exp(m - row_max) : 0;
+    m = row_max;
+    REDUCE_GROUP(d, partial_sum, REDUCE_ADD, sub_group_reduce_add);
+    d = partial_sum[0];
+  }
 
+  if ( active ) {
+    for ( int c = first; c < channels; c += step ) {
+      y[c * spatial_dim] = exp(x[c * spatial_dim] - m) / d;
+    }
+    if ( label && first == 0 ) {
+      const int label_value = (int)(label[r]);
+      if ( has_ignore_label && label_value == ignore_label ) {
+        loss[r] = 0;
+        counts[r] = 0;
+      } else {
+        T tiny = FLT_MIN;
+        T prob = exp(x[label_value * spatial_dim] - m) / d;
+        loss[r] = -log(prob > tiny ? prob : tiny);
+        counts[r] = 1;
+      }
+    }
+  }
+}
+template __attribute__((mangled_name(SoftmaxForwardFloat))) kernel void SoftmaxForward(const int num, const int channels, const int spatial_dim, const int group_per_row, global float* bottom, global float* top, global float* label, const int has_ignore_label, const int ignore_label, global float* loss, global float* counts);
+template __attribute__((mangled_name(SoftmaxForwardDouble))) kernel void SoftmaxForward(const int num, const int channels, const int spatial_dim, const int group_per_row, global double* bottom, global double* top, global double* label, const int has_ignore_label, const int ignore_label, global double* loss, global double* counts);
+
+/*
+ * bottom_diff = (top_diff - sum over the channels of top_diff * top) * top
+ * in a pass for the sum and one for bottom_diff, which may be top_diff
+ *
+ * Global Index Space as in SoftmaxForward
+ */
+template <class T> __kernel void SoftmaxBackward(const int num, const int channels, const int spatial_dim, const int group_per_row, global T* top_data, global T* top_diff, global T* bottom_diff) {
+  __local T partial[OPENCL_LOCAL_SIZE];
+  const int r = group_per_row ? get_group_id(0) : get_global_id(0);
+  const int first = group_per_row ? get_local_id(0) : 0;
+  const int step = group_per_row ? OPENCL_LOCAL_SIZE : 1;
+  const bool active = r < num * spatial_dim;
+  const int offset = (r / spatial_dim) * channels * spatial_dim + r % spatial_dim;
+
+  T dot = 0;
+  if ( active ) {
+    for ( int c = first; c < channels; c += step ) {
+      const int idx = offset + c * spatial_dim;
+      dot += top_diff[idx] * top_data[idx];
+    }
+  }
+  if ( group_per_row ) {
+    REDUCE_GROUP(dot, partial, REDUCE_ADD, sub_group_reduce_add);
+    dot = partial[0];
+  }
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+  if ( active ) {
+    for ( int c = first; c < channels; c += step ) {
+      const int idx = offset + c * spatial_dim;
+      bottom_diff[idx] = (top_diff[idx] - dot) * top_data[idx];
+    }
+  }
+}
+template __attribute__((mangled_name(SoftmaxBackwardFloat))) kernel void SoftmaxBackward(const int num, const int channels, const int spatial_dim, const int group_per_row, global float* top_data, global float* top_diff, global float* bottom_diff);
+template __attribute__((mangled_name(SoftmaxBackwardDouble))) kernel void SoftmaxBackward(const int num, const int channels, const int spatial_dim, const int group_per_row, global double* top_data, global double* top_diff, global double* bottom_diff);
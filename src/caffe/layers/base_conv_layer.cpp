@@ -1,9 +1,12 @@
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "assert.h"
 #include "caffe/filler.hpp"
 #include "caffe/layer.hpp"
 #include "caffe/util/benchmark.hpp"
+#include "caffe/util/fft.hpp"
 #include "caffe/util/im2col.hpp"
 #include "caffe/util/math_functions.hpp"
 #include "caffe/vision_layers.hpp"
@@ -206,50 +209,169 @@ void BaseConvolutionLayer<Dtype>::Reshape(
   weight_offset_ = conv_out_channels_ * kernel_dim_ / group_ / group_;
   col_offset_ = kernel_dim_ * conv_out_spatial_dim_ / group_;
   output_offset_ = conv_out_channels_ * conv_out_spatial_dim_ / group_;
-  // The im2col result buffer will only hold one image at a time to avoid
-  // overly large memory usage. In the special case of 1x1 convolution
-  // it goes lazily unused to save memory.
+  // The FFT planes hold the padded images of convolution, or the images
+  // upsampled by the stride and the full convolution of deconvolution.
   if (reverse_dimensions()) {
-    col_buffer_.Reshape(num_, kernel_dim_, height_, width_);
+    fft_h_ = fft_size((height_ - 1) * stride_h_ + kernel_h_);
+    fft_w_ = fft_size((width_ - 1) * stride_w_ + kernel_w_);
   } else {
-    col_buffer_.Reshape(num_, kernel_dim_, height_out_, width_out_);
+    fft_h_ = fft_size(height_ + 2 * pad_h_);
+    fft_w_ = fft_size(width_ + 2 * pad_w_);
   }
-  // Set up the all ones "bias multiplier" for adding biases by BLAS
-  if (bias_term_) {
-    vector<int> bias_multiplier_shape(1, num_* height_out_ * width_out_);
-    bias_multiplier_.Reshape(bias_multiplier_shape);
-    caffe_set(bias_multiplier_.count(), Dtype(1),
-        bias_multiplier_.mutable_cpu_data());
+  const ConvolutionParameter_Engine engine =
+      this->layer_param_.convolution_param().engine();
+  fft_ = engine == ConvolutionParameter_Engine_FFT ||
+      (engine == ConvolutionParameter_Engine_DEFAULT && fft_cheaper());
+  // The im2col result buffer holds the columns of as many images as fit
+  // into workspace_limit bytes, at least one. In the special case of 1x1
+  // convolution it goes lazily unused to save memory.
+  col_chunk_ = workspace_chunk(
+      kernel_dim_ * conv_out_spatial_dim_ * sizeof(Dtype), "im2col buffer");
+  if (col_free_forward() && this->workspace_forward_only_) {
+    // neither Forward nor Backward reads the columns.
+    col_buffer()->Reshape(vector<int>(1, 0));
+  } else if (reverse_dimensions()) {
+    col_buffer()->Reshape(col_chunk_, kernel_dim_, height_, width_);
+  } else {
+    col_buffer()->Reshape(col_chunk_, kernel_dim_, height_out_, width_out_);
+  }
+  if (fft_) {
+    vector<int> shape(4);
+    shape[0] = this->blobs_[0]->num() * this->blobs_[0]->channels();
+    shape[1] = fft_h_;
+    shape[2] = fft_w_;
+    shape[3] = 2;
+    if (fft_filter_.shape() != shape) {
+      fft_filter_.Reshape(shape);
+      fft_weight_ = NULL;
+    }
+    // the spectra are bounded by workspace_limit like the im2col buffer.
+    fft_chunk_ = workspace_chunk(
+        (channels_ + num_output_) * fft_h_ * fft_w_ * 2 * sizeof(Dtype),
+        "FFT spectra");
+    shape[0] = fft_chunk_ * channels_;
+    fft_input()->Reshape(shape);
+    shape[0] = fft_chunk_ * num_output_;
+    fft_output()->Reshape(shape);
   }
-
   // this->setupMaskIM2COL();
   // this->setupMaskCOL2IM();
 }
 
+template<typename Dtype>
+int BaseConvolutionLayer<Dtype>::workspace_chunk(
+    const size_t image_bytes, const char* scratch) {
+  const uint64_t workspace_limit =
+      this->layer_param_.convolution_param().workspace_limit();
+  int chunk = num_;
+  if (workspace_limit > 0 && image_bytes > 0) {
+    chunk = std::max<int>(1,
+        std::min<uint64_t>(num_, workspace_limit / image_bytes));
+  }
+  if (chunk < num_) {
+    DLOG(INFO) << this->layer_param_.name() << " processes " << chunk
+               << " of " << num_ << " images at a time, " << scratch << " "
+               << chunk * image_bytes << " instead of "
+               << num_ * image_bytes << " bytes";
+  }
+  return chunk;
+}
+
+template<typename Dtype>
+bool BaseConvolutionLayer<Dtype>::fft_cheaper() {
+  const double size = fft_h_ * fft_w_;
+  const double gemm = static_cast<double>(conv_out_channels_) * kernel_dim_ *
+      conv_out_spatial_dim_ / group_;
+  // the complex products of the spectra and a radix-2 2D FFT of each input
+  // and output plane.
+  const double fft = 4.0 * num_output_ * channels_ / group_ * size +
+      2.0 * (channels_ + num_output_) * size * std::log(size) / std::log(2.0);
+  return fft < gemm;
+}
+
+template<typename Dtype>
+bool BaseConvolutionLayer<Dtype>::fft_filter_outdated() {
+  SyncedMemory* weight = this->blobs_[0]->data().get();
+  if (weight == fft_weight_ && weight->version() == fft_version_) {
+    return false;
+  }
+  fft_weight_ = weight;
+  fft_version_ = weight->version();
+  return true;
+}
+
+template<typename Dtype>
+void BaseConvolutionLayer<Dtype>::forward_cpu_fft(
+    const Dtype* input,
+    const Dtype* bias,
+    Dtype* output) {
+  const int filter_planes = fft_filter_.shape(0);
+  if (fft_filter_outdated()) {
+    Dtype* filter = fft_filter_.mutable_cpu_data();
+    fft_pad_cpu(this->blobs_[0]->cpu_data(), filter_planes, kernel_h_,
+                kernel_w_, 1, 1, 0, 0, fft_h_, fft_w_, filter);
+    fft2d_cpu(filter, filter_planes, fft_h_, fft_w_, false);
+  }
+  Dtype* spectrum = fft_input()->mutable_cpu_data();
+  Dtype* product = fft_output()->mutable_cpu_data();
+  const bool relu = this->layer_param_.fused_relu();
+  const Dtype negative_slope = this->layer_param_.relu_param().negative_slope();
+  const int input_dim = channels_ * height_ * width_;
+  const int output_dim = num_output_ * height_out_ * width_out_;
+  for (int n = 0; n < num_; n += fft_chunk_) {
+    const int count = std::min(fft_chunk_, num_ - n);
+    if (reverse_dimensions()) {
+      fft_pad_cpu(input + n * input_dim, count * channels_, height_, width_,
+                  stride_h_, stride_w_, 0, 0, fft_h_, fft_w_, spectrum);
+    } else {
+      fft_pad_cpu(input + n * input_dim, count * channels_, height_, width_,
+                  1, 1, pad_h_, pad_w_, fft_h_, fft_w_, spectrum);
+    }
+    fft2d_cpu(spectrum, count * channels_, fft_h_, fft_w_, false);
+    fft_multiply_cpu(spectrum, fft_filter_.cpu_data(), count, channels_,
+                     num_output_, group_, fft_h_ * fft_w_,
+                     reverse_dimensions(), product);
+    fft2d_cpu(product, count * num_output_, fft_h_, fft_w_, true);
+    if (reverse_dimensions()) {
+      fft_crop_cpu(product, bias, relu, negative_slope, count * num_output_,
+                   num_output_, fft_h_, fft_w_, 1, 1, pad_h_, pad_w_,
+                   height_out_, width_out_, output + n * output_dim);
+    } else {
+      fft_crop_cpu(product, bias, relu, negative_slope, count * num_output_,
+                   num_output_, fft_h_, fft_w_, stride_h_, stride_w_, 0, 0,
+                   height_out_, width_out_, output + n * output_dim);
+    }
+  }
+}
+
 template<typename Dtype>
 void BaseConvolutionLayer<Dtype>::forward_cpu_gemm(
     const Dtype* input,
     const Dtype* weights,
+    const Dtype* bias,
     Dtype* output,
     bool skip_im2col) {
   const Dtype* col_buff = input;
   if (!is_1x1_) {
     if (!skip_im2col) {
-      conv_im2col_cpu(input, col_buffer_.mutable_cpu_data());
+      conv_im2col_cpu(input, col_buffer()->mutable_cpu_data());
     }
-    col_buff = col_buffer_.cpu_data();
+    col_buff = col_buffer()->cpu_data();
   }
+  const int outputs_g = conv_out_channels_ / group_;
   for (int g = 0; g < group_; ++g) {
     caffe_cpu_gemm<Dtype>(
         CblasNoTrans, CblasNoTrans,
-        conv_out_channels_ / group_,
+        outputs_g,
         conv_out_spatial_dim_,
         kernel_dim_ / group_,
         (Dtype) 1.,
         weights + weight_offset_ * g,
         col_buff + col_offset_ * g,
         (Dtype) 0.,
-        output + output_offset_ * g);
+        output + output_offset_ * g,
+        bias ? bias + outputs_g * g : NULL,
+        NULL);
   }
 }
 
@@ -257,14 +379,8 @@ template<typename Dtype>
 void BaseConvolutionLayer<Dtype>::forward_cpu_bias(
     Dtype* output,
     const Dtype* bias) {
-  caffe_cpu_gemm<Dtype>(
-      CblasNoTrans, CblasNoTrans,
-      num_output_, height_out_* width_out_, 1,
-      (Dtype) 1.,
-      bias,
-      bias_multiplier_.cpu_data(),
-      (Dtype) 1.,
-      output);
+  caffe_cpu_add_bias<Dtype>(1, num_output_, height_out_ * width_out_, bias,
+                            output);
 }
 
 template<typename Dtype>
@@ -272,7 +388,7 @@ void BaseConvolutionLayer<Dtype>::backward_cpu_gemm(
     const Dtype* output,
     const Dtype* weights,
     Dtype* input) {
-  Dtype* col_buff = col_buffer_.mutable_cpu_data();
+  Dtype* col_buff = col_buffer()->mutable_cpu_data();
   if (is_1x1_) {
     col_buff = input;
   }
@@ -300,8 +416,8 @@ void BaseConvolutionLayer<Dtype>::weight_cpu_gemm(
     Dtype* weights) {
   const Dtype* col_buff = input;
   if (!is_1x1_) {
-    conv_im2col_cpu(input, col_buffer_.mutable_cpu_data());
-    col_buff = col_buffer_.cpu_data();
+    conv_im2col_cpu(input, col_buffer()->mutable_cpu_data());
+    col_buff = col_buffer()->cpu_data();
   }
   for (int g = 0; g < group_; ++g) {
     caffe_cpu_gemm<Dtype>(
@@ -321,10 +437,8 @@ template<typename Dtype>
 void BaseConvolutionLayer<Dtype>::backward_cpu_bias(
     Dtype* bias,
     const Dtype* input) {
-  caffe_cpu_gemv<Dtype>(
-      CblasNoTrans,
-      num_output_, height_out_ * width_out_, 1.,
-      input, bias_multiplier_.cpu_data(), 1., bias);
+  caffe_cpu_channel_sum<Dtype>(1, num_output_, height_out_ * width_out_,
+                               input, bias);
 }
 
 #if defined(USE_CUDA) || defined(USE_OPENCL)
@@ -333,17 +447,9 @@ template<typename Dtype>
 void BaseConvolutionLayer<Dtype>::forward_gpu_bias(
     Dtype* output,
     const Dtype* bias) {
-  TIME("BIAS1 caffe_gpu_gemm()", {
-    caffe_gpu_gemm<Dtype>(
-        CblasNoTrans, CblasNoTrans,
-        num_output_,
-        height_out_ * width_out_,
-        1,
-        (Dtype)1.,
-        bias,
-        bias_multiplier_.gpu_data(),
-        (Dtype)1.,
-        output);
+  TIME("forward_gpu_bias()->caffe_gpu_add_bias()", {
+    caffe_gpu_add_bias<Dtype>(1, num_output_, height_out_ * width_out_, bias,
+                              output);
   });
 }
 
@@ -352,7 +458,7 @@ void BaseConvolutionLayer<Dtype>::backward_gpu_gemm(
     const Dtype* output,
     const Dtype* weights,
     Dtype* input) {
-  Dtype* col_buff = col_buffer_.mutable_gpu_data();
+  Dtype* col_buff = col_buffer()->mutable_gpu_data();
   if (is_1x1_) {
     col_buff = input;
   }
@@ -405,8 +511,8 @@ void BaseConvolutionLayer<Dtype>::weight_gpu_gemm(
     Dtype* weights) {
   const Dtype* col_buff = input;
   if (!is_1x1_) {
-    conv_im2col_gpu(input, col_buffer_.mutable_gpu_data());
-    col_buff = col_buffer_.gpu_data();
+    conv_im2col_gpu(input, col_buffer()->mutable_gpu_data());
+    col_buff = col_buffer()->gpu_data();
   }
   for (int g = 0; g < group_; ++g) {
 #if defined(USE_CUDA)
@@ -459,15 +565,9 @@ template<typename Dtype>
 void BaseConvolutionLayer<Dtype>::backward_gpu_bias(
     Dtype* bias,
     const Dtype* input) {
-  TIME("backward_gpu_bias()->caffe_gpu_gemv()", {
-    caffe_gpu_gemv<Dtype>(
-        CblasNoTrans, num_output_,
-        height_out_ * width_out_,
-        1.,
-        input,
-        bias_multiplier_.gpu_data(),
-        1.,
-        bias);
+  TIME("backward_gpu_bias()->caffe_gpu_channel_sum()", {
+    caffe_gpu_channel_sum<Dtype>(1, num_output_, height_out_ * width_out_,
+                                 input, bias);
   });
 }
 
@@ -483,12 +583,12 @@ void BaseConvolutionLayer<Dtype>::forward_gpu_gemm(const Dtype* input,
     if (!skip_im2col) {
       TIME("forward_gpu_gemm()->conv_im2col_gpu()",
           {
-            conv_im2col_gpu(input, col_buffer_.mutable_gpu_data());
+            conv_im2col_gpu(input, col_buffer()->mutable_gpu_data());
           });
     }
     TIME("forward_gpu_gemm()->col_buffer_.gpu_data()",
         {
-          col_buff = col_buffer_.gpu_data();
+          col_buff = col_buffer()->gpu_data();
         });
   }
 
@@ -514,6 +614,17 @@ void BaseConvolutionLayer<Dtype>::forward_gpu_gemm(const Dtype* input,
 
 #if defined(USE_OPENCL)
 
+template<typename Dtype>
+void BaseConvolutionLayer<Dtype>::opencl_programs(
+    vector<string>* programs) const {
+  // Backward runs im2col and the GEMMs with every engine.
+  programs->push_back("im2col");
+  programs->push_back("gemm");
+  if (fft_) {
+    programs->push_back("fft");
+  }
+}
+
 template<typename Dtype>
 void BaseConvolutionLayer<Dtype>::forward_gpu_gemm(
     const Dtype* input,
@@ -533,7 +644,7 @@ void BaseConvolutionLayer<Dtype>::forward_gpu_gemm(
 
       Dtype* buf;
       TIME("forward_gpu_gemm()->col_buffer_.mutable_gpu_data()", {
-          buf = col_buffer_.mutable_gpu_data();
+          buf = col_buffer()->mutable_gpu_data();
       });
 
       //TIMENOSYNC("forward_gpu_gemm()->conv_im2col_gpu()", {
@@ -564,13 +675,25 @@ void BaseConvolutionLayer<Dtype>::forward_gpu_gemm(
       //});
     }
       TIME("forward_gpu_gemm()->col_buffer_.gpu_data()", {
-      col_buff = col_buffer_.gpu_data();
+      col_buff = col_buffer()->gpu_data();
       });
   }
   // });
 
+  // the groups are independent, spread them over the in-order command queues.
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  const unsigned int queue_idx = device.getCommandQueueIDX();
+  const unsigned int num_queues = device.getOutOfOrderExecution() ? 1 :
+      std::min<unsigned int>(device.getNumCommandQueues(), group_);
+  const unsigned int total_queues = device.getNumCommandQueues();
+  for (unsigned int q = 1; q < num_queues; ++q) {
+    CHECK(device.enqueueCommandQueueWait((queue_idx + q) % total_queues,
+                                         queue_idx));
+  }
+
   //TIME("2nd step()", {
       for (int g = 0; g < group_; ++g) {
+        device.setCommandQueueIDX((queue_idx + g % num_queues) % total_queues);
         TIME("forward_gpu_gemm()->caffe_gpu_gemm("<<g<<")", {
           /* call with offsets
            caffe_gpu_gemm<Dtype>(
@@ -600,6 +723,12 @@ void BaseConvolutionLayer<Dtype>::forward_gpu_gemm(
         });
       }
   //});
+
+  device.setCommandQueueIDX(queue_idx);
+  for (unsigned int q = 1; q < num_queues; ++q) {
+    CHECK(device.enqueueCommandQueueWait(queue_idx,
+                                         (queue_idx + q) % total_queues));
+  }
 }
 
 template<typename Dtype>
@@ -612,11 +741,11 @@ void BaseConvolutionLayer<Dtype>::forward_gpu_gemm(
   if (!is_1x1_) {
     if (!skip_im2col) {
       TIME("forward_gpu_gemm()->conv_im2col_gpu()", {
-        conv_im2col_gpu(input, col_buffer_.mutable_gpu_data());
+        conv_im2col_gpu(input, col_buffer()->mutable_gpu_data());
       });
     }
     TIME("forward_gpu_gemm()->col_buffer_.gpu_data()", {
-      col_buff = col_buffer_.gpu_data();
+      col_buff = col_buffer()->gpu_data();
     });
   }
 
@@ -656,16 +785,10 @@ void BaseConvolutionLayer<Dtype>::forward_gpu_bias(
     Dtype* output,
     const size_t output_offset,
     const Dtype* bias) {
-  // TIME("BIAS2 caffe_gpu_gemm()", {
-    caffe_gpu_gemm<Dtype>(
-        CblasNoTrans, CblasNoTrans,
-        num_output_, height_out_ * width_out_, 1,
-        (Dtype)1.,
-        bias, 0.0,
-        bias_multiplier_.gpu_data(), 0.0,
-        (Dtype)1.,
-        output, output_offset);
-  // });
+  TIME("forward_gpu_bias()->caffe_gpu_add_bias()", {
+    caffe_gpu_add_bias<Dtype>(1, num_output_, height_out_ * width_out_, bias,
+                              output + output_offset);
+  });
 }
 
 template<typename Dtype>
@@ -676,7 +799,7 @@ void BaseConvolutionLayer<Dtype>::backward_gpu_gemm(
     const size_t weights_offset,
     Dtype* input,
     const size_t input_offset) {
-  Dtype* col_buff = col_buffer_.mutable_gpu_data();
+  Dtype* col_buff = col_buffer()->mutable_gpu_data();
   size_t col_buffer_offset = 0;
   if (is_1x1_) {
     col_buff = input;
@@ -728,8 +851,8 @@ void BaseConvolutionLayer<Dtype>::weight_gpu_gemm(
 
   if (!is_1x1_) {
     // conv_im2col_gpu(input + input_offset, col_buffer_.mutable_gpu_data());
-    conv_im2col_gpu(input, input_offset, col_buffer_.mutable_gpu_data(), 0);
-    col_buff = col_buffer_.gpu_data();
+    conv_im2col_gpu(input, input_offset, col_buffer()->mutable_gpu_data(), 0);
+    col_buff = col_buffer()->gpu_data();
     col_buff_offset = 0;
   }
   for (int g = 0; g < group_; ++g) {
@@ -770,17 +893,204 @@ void BaseConvolutionLayer<Dtype>::backward_gpu_bias(
     const size_t bias_offset,
     const Dtype* input,
     const size_t input_offset) {
-  TIME("backward_gpu_bias()->caffe_gpu_gemv()", {
-    caffe_gpu_gemv<Dtype>(
-        CblasNoTrans,
-        num_output_, height_out_ * width_out_, 1.,
-        input, input_offset,
-        bias_multiplier_.gpu_data(), 0,
-        1.,
-        bias, bias_offset);
+  TIME("backward_gpu_bias()->caffe_gpu_channel_sum()", {
+    caffe_gpu_channel_sum<Dtype>(1, num_output_, height_out_ * width_out_,
+                                 input + input_offset, bias + bias_offset);
   });
 }
 
+template<typename Dtype>
+void BaseConvolutionLayer<Dtype>::forward_gpu_gemm_batched(
+    const Dtype* input,
+    const Dtype* weights,
+    const Dtype* bias,
+    const bool relu,
+    const Dtype negative_slope,
+    Dtype* output) {
+  const size_t input_dim = conv_in_channels_ * conv_in_height_ *
+      conv_in_width_;
+  const size_t output_dim = conv_out_channels_ * conv_out_spatial_dim_;
+  const int outputs_g = conv_out_channels_ / group_;
+  for (int n = 0; n < num_; n += col_chunk_) {
+    const int count = std::min(col_chunk_, num_ - n);
+    const Dtype* col_buff = input;
+    size_t col_buff_offset = input_dim * n;
+    size_t col_dim = input_dim;
+    if (!is_1x1_) {
+      TIME("forward_gpu_gemm_batched()->conv_im2col_batched_gpu()", {
+        conv_im2col_batched_gpu(input, n, count,
+                                col_buffer()->mutable_gpu_data());
+      });
+      col_buff = col_buffer()->gpu_data();
+      col_buff_offset = 0;
+      col_dim = kernel_dim_ * conv_out_spatial_dim_;
+    }
+    for (int g = 0; g < group_; ++g) {
+      TIME("forward_gpu_gemm_batched()->caffe_gpu_gemm_strided_batched()", {
+        caffe_gpu_gemm_strided_batched<Dtype>(
+            CblasNoTrans, CblasNoTrans,
+            outputs_g,
+            conv_out_spatial_dim_,
+            kernel_dim_ / group_,
+            count,
+            (Dtype)1.,
+            weights, weight_offset_ * g, 0,
+            col_buff, col_buff_offset + col_offset_ * g, col_dim,
+            (Dtype)0.,
+            output, output_dim * n + output_offset_ * g, output_dim,
+            bias ? bias + outputs_g * g : NULL, NULL, relu, negative_slope);
+      });
+    }
+  }
+}
+
+template<typename Dtype>
+void BaseConvolutionLayer<Dtype>::forward_gpu_bias_batched(
+    Dtype* output,
+    const Dtype* bias) {
+  TIME("forward_gpu_bias_batched()->caffe_gpu_add_bias()", {
+    caffe_gpu_add_bias<Dtype>(num_, num_output_, height_out_ * width_out_,
+                              bias, output);
+  });
+}
+
+template<typename Dtype>
+void BaseConvolutionLayer<Dtype>::backward_gpu_bias_batched(
+    Dtype* bias,
+    const Dtype* input) {
+  TIME("backward_gpu_bias_batched()->caffe_gpu_channel_sum()", {
+    caffe_gpu_channel_sum<Dtype>(num_, num_output_, height_out_ * width_out_,
+                                 input, bias);
+  });
+}
+
+template<typename Dtype>
+void BaseConvolutionLayer<Dtype>::backward_gpu_gemm_batched(
+    const Dtype* output,
+    const Dtype* weights,
+    Dtype* input) {
+  const size_t input_dim = conv_in_channels_ * conv_in_height_ *
+      conv_in_width_;
+  const size_t output_dim = conv_out_channels_ * conv_out_spatial_dim_;
+  for (int n = 0; n < num_; n += col_chunk_) {
+    const int count = std::min(col_chunk_, num_ - n);
+    Dtype* col_buff = input;
+    size_t col_buff_offset = input_dim * n;
+    size_t col_dim = input_dim;
+    if (!is_1x1_) {
+      col_buff = col_buffer()->mutable_gpu_data();
+      col_buff_offset = 0;
+      col_dim = kernel_dim_ * conv_out_spatial_dim_;
+    }
+    for (int g = 0; g < group_; ++g) {
+      TIME("backward_gpu_gemm_batched()->caffe_gpu_gemm_strided_batched()", {
+        caffe_gpu_gemm_strided_batched<Dtype>(
+            CblasTrans, CblasNoTrans,
+            kernel_dim_ / group_,
+            conv_out_spatial_dim_,
+            conv_out_channels_ / group_,
+            count,
+            (Dtype)1.,
+            weights, weight_offset_ * g, 0,
+            output, output_dim * n + output_offset_ * g, output_dim,
+            (Dtype)0.,
+            col_buff, col_buff_offset + col_offset_ * g, col_dim);
+      });
+    }
+    if (!is_1x1_) {
+      TIME("backward_gpu_gemm_batched()->conv_col2im_batched_gpu()", {
+        conv_col2im_batched_gpu(col_buff, n, count, input);
+      });
+    }
+  }
+}
+
+template<typename Dtype>
+void BaseConvolutionLayer<Dtype>::weight_gpu_gemm_batched(
+    const Dtype* input,
+    const Dtype* output,
+    Dtype* weights) {
+  const size_t input_dim = conv_in_channels_ * conv_in_height_ *
+      conv_in_width_;
+  const size_t output_dim = conv_out_channels_ * conv_out_spatial_dim_;
+  for (int n = 0; n < num_; n += col_chunk_) {
+    const int count = std::min(col_chunk_, num_ - n);
+    const Dtype* col_buff = input;
+    size_t col_buff_offset = input_dim * n;
+    size_t col_dim = input_dim;
+    if (!is_1x1_) {
+      TIME("weight_gpu_gemm_batched()->conv_im2col_batched_gpu()", {
+        conv_im2col_batched_gpu(input, n, count,
+                                col_buffer()->mutable_gpu_data());
+      });
+      col_buff = col_buffer()->gpu_data();
+      col_buff_offset = 0;
+      col_dim = kernel_dim_ * conv_out_spatial_dim_;
+    }
+    // the images accumulate into the same weights, so only the groups of an
+    // image form a batch.
+    for (int i = 0; i < count; ++i) {
+      TIME("weight_gpu_gemm_batched()->caffe_gpu_gemm_strided_batched()", {
+        caffe_gpu_gemm_strided_batched<Dtype>(
+            CblasNoTrans, CblasTrans,
+            conv_out_channels_ / group_,
+            kernel_dim_ / group_,
+            conv_out_spatial_dim_,
+            group_,
+            (Dtype)1.,
+            output, output_dim * (n + i), output_offset_,
+            col_buff, col_buff_offset + col_dim * i, col_offset_,
+            (Dtype)1.,
+            weights, 0, weight_offset_);
+      });
+    }
+  }
+}
+
+template<typename Dtype>
+void BaseConvolutionLayer<Dtype>::forward_gpu_fft(
+    const Dtype* input,
+    const Dtype* bias,
+    Dtype* output) {
+  const int filter_planes = fft_filter_.shape(0);
+  if (fft_filter_outdated()) {
+    Dtype* filter = fft_filter_.mutable_gpu_data();
+    fft_pad_gpu(this->blobs_[0]->gpu_data(), filter_planes, kernel_h_,
+                kernel_w_, 1, 1, 0, 0, fft_h_, fft_w_, filter);
+    fft2d_gpu(filter, filter_planes, fft_h_, fft_w_, false);
+  }
+  Dtype* spectrum = fft_input()->mutable_gpu_data();
+  Dtype* product = fft_output()->mutable_gpu_data();
+  const bool relu = this->layer_param_.fused_relu();
+  const Dtype negative_slope = this->layer_param_.relu_param().negative_slope();
+  const int input_dim = channels_ * height_ * width_;
+  const int output_dim = num_output_ * height_out_ * width_out_;
+  for (int n = 0; n < num_; n += fft_chunk_) {
+    const int count = std::min(fft_chunk_, num_ - n);
+    if (reverse_dimensions()) {
+      fft_pad_gpu(input + n * input_dim, count * channels_, height_, width_,
+                  stride_h_, stride_w_, 0, 0, fft_h_, fft_w_, spectrum);
+    } else {
+      fft_pad_gpu(input + n * input_dim, count * channels_, height_, width_,
+                  1, 1, pad_h_, pad_w_, fft_h_, fft_w_, spectrum);
+    }
+    fft2d_gpu(spectrum, count * channels_, fft_h_, fft_w_, false);
+    fft_multiply_gpu(spectrum, fft_filter_.gpu_data(), count, channels_,
+                     num_output_, group_, fft_h_ * fft_w_,
+                     reverse_dimensions(), product);
+    fft2d_gpu(product, count * num_output_, fft_h_, fft_w_, true);
+    if (reverse_dimensions()) {
+      fft_crop_gpu(product, bias, relu, negative_slope, count * num_output_,
+                   num_output_, fft_h_, fft_w_, 1, 1, pad_h_, pad_w_,
+                   height_out_, width_out_, output + n * output_dim);
+    } else {
+      fft_crop_gpu(product, bias, relu, negative_slope, count * num_output_,
+                   num_output_, fft_h_, fft_w_, stride_h_, stride_w_, 0, 0,
+                   height_out_, width_out_, output + n * output_dim);
+    }
+  }
+}
+
 #endif  // USE_OPENCL
 
 INSTANTIATE_CLASS(BaseConvolutionLayer);
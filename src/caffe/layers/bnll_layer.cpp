@@ -91,9 +91,7 @@ bool clBNLLLayerForward(const int count, const T* bottom_data, T* top_data) {
 
   err = clEnqueueNDRangeKernel(
       *queue, *kernel, 1,
-      NULL, &global, &local, 0,
-      NULL,
-      NULL);
+      NULL, &global, &local, CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR)<< "Failed to enqueue kernel '"
     << kernel_name.c_str() << "' on GPU "
@@ -158,9 +156,7 @@ bool clBNLLLayerBackward(
 
   err = clEnqueueNDRangeKernel(
       *queue, *kernel, 1,
-      NULL, &global, &local, 0,
-      NULL,
-      NULL);
+      NULL, &global, &local, CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR)<< "Failed to enqueue kernel '"
     << kernel_name.c_str()
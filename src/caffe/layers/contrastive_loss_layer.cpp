@@ -141,7 +141,7 @@ bool clCLLForward(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -1,14 +1,108 @@
+#if defined(USE_OPENCL)
+#include <caffe/util/OpenCL/conv_layer.hpp>
+#include <caffe/util/OpenCL/definitions.hpp>
+#include <caffe/util/OpenCL/relu_layer.hpp>
+#endif
+
+#include <algorithm>
 #include <vector>
 
 #include "caffe/filler.hpp"
 #include "caffe/layer.hpp"
+#include "caffe/layer_factory.hpp"
 #include "caffe/util/benchmark.hpp"
 #include "caffe/util/im2col.hpp"
 #include "caffe/util/math_functions.hpp"
+#include "caffe/util/winograd.hpp"
 #include "caffe/vision_layers.hpp"
 
 namespace caffe {
 
+template<typename Dtype>
+void ConvolutionLayer<Dtype>::LayerSetUp(
+    const vector<Blob<Dtype>*>& bottom,
+    const vector<Blob<Dtype>*>& top) {
+  pooling_layer_.reset();
+  if (this->layer_param_.fused_pooling()) {
+    CHECK_EQ(1, bottom.size()) << "fused_pooling needs a single bottom.";
+    LayerParameter pooling_param(this->layer_param_);
+    pooling_param.set_type("Pooling");
+    pooling_param.clear_blobs();
+    pooling_layer_ = LayerRegistry<Dtype>::CreateLayer(pooling_param);
+  }
+  BaseConvolutionLayer<Dtype>::LayerSetUp(bottom, conv_top(top));
+  if (pooling_layer_) {
+    // the pooling layer sets up on the shape of the convolution output.
+    BaseConvolutionLayer<Dtype>::Reshape(bottom, conv_top(top));
+    pooling_layer_->SetUp(conv_top_vec_, top);
+  }
+  direct_ = false;
+  winograd_ = false;
+  const ConvolutionParameter& conv_param =
+      this->layer_param_.convolution_param();
+  if (conv_param.engine() == ConvolutionParameter_Engine_WINOGRAD) {
+    winograd_tile_ = conv_param.winograd_tile();
+    CHECK(winograd_tile_ == 2 || winograd_tile_ == 4)
+        << "winograd_tile must be 2 or 4.";
+    winograd_ = this->kernel_h_ == 3 && this->kernel_w_ == 3 &&
+        this->stride_h_ == 1 && this->stride_w_ == 1;
+    if (!winograd_) {
+      LOG(INFO) << this->layer_param_.name() << ": no WINOGRAD convolution "
+                << "for " << this->kernel_h_ << "x" << this->kernel_w_
+                << " filters with " << this->stride_h_ << "x"
+                << this->stride_w_ << " stride, using im2col";
+      return;
+    }
+    vector<int> filter_shape(3);
+    filter_shape[0] = winograd_positions(winograd_tile_);
+    filter_shape[1] = this->num_output_;
+    filter_shape[2] = this->channels_ / this->group_;
+    winograd_filter_.Reshape(filter_shape);
+    winograd_weight_ = NULL;
+    return;
+  }
+  if (conv_param.engine() != ConvolutionParameter_Engine_DIRECT) {
+    return;
+  }
+#if defined(USE_OPENCL)
+  direct_ = caffe::OpenCL::clConvolutionDirectSupported(
+      this->kernel_h_, this->kernel_w_, this->stride_h_, this->stride_w_);
+#endif
+  if (!direct_) {
+    LOG(INFO) << this->layer_param_.name() << ": no DIRECT convolution for "
+              << this->kernel_h_ << "x" << this->kernel_w_ << " filters with "
+              << this->stride_h_ << "x" << this->stride_w_
+              << " stride, using im2col";
+  }
+}
+
+template<typename Dtype>
+void ConvolutionLayer<Dtype>::Reshape(
+    const vector<Blob<Dtype>*>& bottom,
+    const vector<Blob<Dtype>*>& top) {
+  BaseConvolutionLayer<Dtype>::Reshape(bottom, conv_top(top));
+  if (pooling_layer_) {
+    pooling_layer_->Reshape(conv_top_vec_, top);
+  }
+  if (!winograd_) {
+    return;
+  }
+  winograd_tiles_h_ = winograd_tiles(this->height_out_, winograd_tile_);
+  winograd_tiles_w_ = winograd_tiles(this->width_out_, winograd_tile_);
+  vector<int> shape(3);
+  shape[0] = winograd_positions(winograd_tile_);
+  // the transformed tiles are bounded by workspace_limit like the im2col
+  // buffer.
+  winograd_chunk_ = this->workspace_chunk(
+      shape[0] * (this->channels_ + this->num_output_) * winograd_tiles_h_ *
+      winograd_tiles_w_ * sizeof(Dtype), "WINOGRAD tiles");
+  shape[2] = winograd_chunk_ * winograd_tiles_h_ * winograd_tiles_w_;
+  shape[1] = this->channels_;
+  winograd_input()->Reshape(shape);
+  shape[1] = this->num_output_;
+  winograd_output()->Reshape(shape);
+}
+
 template<typename Dtype>
 void ConvolutionLayer<Dtype>::compute_output_shape() {
   this->height_out_ = (this->height_ + 2 * this->pad_h_ - this->kernel_h_)
@@ -17,25 +111,97 @@ void ConvolutionLayer<Dtype>::compute_output_shape() {
       / this->stride_w_ + 1;
 }
 
+template<typename Dtype>
+bool ConvolutionLayer<Dtype>::winograd_filter_outdated() {
+  SyncedMemory* weight = this->blobs_[0]->data().get();
+  if (weight == winograd_weight_ && weight->version() == winograd_version_) {
+    return false;
+  }
+  winograd_weight_ = weight;
+  winograd_version_ = weight->version();
+  return true;
+}
+
+// transforms the input tiles, multiplies them with the transformed filters
+// per tile position and group, and transforms the products back.
+template<typename Dtype>
+void ConvolutionLayer<Dtype>::forward_cpu_winograd(
+    const Dtype* input, const Dtype* bias, const int num, Dtype* output) {
+  const int positions = winograd_positions(winograd_tile_);
+  const int num_tiles = num * winograd_tiles_h_ * winograd_tiles_w_;
+  const int channels_g = this->channels_ / this->group_;
+  const int outputs_g = this->num_output_ / this->group_;
+  if (winograd_filter_outdated()) {
+    winograd_filter_transform_cpu(
+        this->blobs_[0]->cpu_data(), this->num_output_, channels_g,
+        winograd_tile_, winograd_filter_.mutable_cpu_data());
+  }
+  const Dtype* filter = winograd_filter_.cpu_data();
+  Dtype* transformed = winograd_input()->mutable_cpu_data();
+  Dtype* products = winograd_output()->mutable_cpu_data();
+  winograd_input_transform_cpu(
+      input, num, this->channels_, this->height_, this->width_,
+      this->pad_h_, this->pad_w_, winograd_tiles_h_, winograd_tiles_w_,
+      winograd_tile_, transformed);
+  for (int t = 0; t < positions; ++t) {
+    for (int g = 0; g < this->group_; ++g) {
+      caffe_cpu_gemm<Dtype>(
+          CblasNoTrans, CblasNoTrans, outputs_g, num_tiles, channels_g,
+          (Dtype) 1.,
+          filter + (t * this->num_output_ + g * outputs_g) * channels_g,
+          transformed + (t * this->channels_ + g * channels_g) * num_tiles,
+          (Dtype) 0.,
+          products + (t * this->num_output_ + g * outputs_g) * num_tiles);
+    }
+  }
+  winograd_output_transform_cpu(
+      products, bias, this->layer_param_.fused_relu(),
+      (Dtype) this->layer_param_.relu_param().negative_slope(), num,
+      this->num_output_, this->height_out_, this->width_out_,
+      winograd_tiles_h_, winograd_tiles_w_, winograd_tile_, output);
+}
+
 template<typename Dtype>
 void ConvolutionLayer<Dtype>::Forward_cpu(
     const vector<Blob<Dtype>*>& bottom,
     const vector<Blob<Dtype>*>& top) {
   const Dtype* weight = this->blobs_[0]->cpu_data();
+  const vector<Blob<Dtype>*>& output = conv_top(top);
   for (int i = 0; i < bottom.size(); ++i) {
     const Dtype* bottom_data = bottom[i]->cpu_data();
-    Dtype* top_data = top[i]->mutable_cpu_data();
+    Dtype* top_data = output[i]->mutable_cpu_data();
+    if (winograd_) {
+      const Dtype* bias = this->bias_term_ ? this->blobs_[1]->cpu_data() : NULL;
+      for (int n = 0; n < this->num_; n += winograd_chunk_) {
+        forward_cpu_winograd(bottom_data + bottom[i]->offset(n), bias,
+                              std::min(winograd_chunk_, this->num_ - n),
+                              top_data + output[i]->offset(n));
+      }
+      continue;
+    }
+    if (this->fft_) {
+      const Dtype* bias = this->bias_term_ ? this->blobs_[1]->cpu_data() : NULL;
+      this->forward_cpu_fft(bottom_data, bias, top_data);
+      continue;
+    }
+    const Dtype* bias = this->bias_term_ ? this->blobs_[1]->cpu_data() : NULL;
     for (int n = 0; n < this->num_; ++n) {
       this->forward_cpu_gemm(
           bottom_data + bottom[i]->offset(n),
           weight,
-          top_data + top[i]->offset(n));
-      if (this->bias_term_) {
-        const Dtype* bias = this->blobs_[1]->cpu_data();
-        this->forward_cpu_bias(top_data + top[i]->offset(n), bias);
+          bias,
+          top_data + output[i]->offset(n));
+      if (this->layer_param_.fused_relu()) {
+        caffe_cpu_relu(
+            output[i]->count(1),
+            (Dtype) this->layer_param_.relu_param().negative_slope(),
+            top_data + output[i]->offset(n));
       }
     }
   }
+  if (pooling_layer_) {
+    pooling_layer_->Forward(conv_top_vec_, top);
+  }
 }
 
 template<typename Dtype>
@@ -86,7 +252,212 @@ void ConvolutionLayer<Dtype>::Backward_cpu(
 
 #if defined(USE_OPENCL)
 
-/// @brief refer to CPU forward -- the BLAS implementation is the same.
+namespace OpenCL {
+
+bool clConvolutionDirectSupported(
+    const int kernel_h,
+    const int kernel_w,
+    const int stride_h,
+    const int stride_w) {
+  if ( kernel_h == 1 && kernel_w == 1 ) {
+    return true;
+  }
+  return stride_h == 1 && stride_w == 1 &&
+      kernel_h <= OPENCL_DIRECT_MAX_KERNEL &&
+      kernel_w <= OPENCL_DIRECT_MAX_KERNEL;
+}
+
+template<typename T>
+bool clConvolutionDirect(
+    const T* bottom_data,
+    const T* weight,
+    const T* bias,
+    const bool relu,
+    const T negative_slope,
+    const int num,
+    const int channels,
+    const int height,
+    const int width,
+    const int num_output,
+    const int group,
+    const int height_out,
+    const int width_out,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_h,
+    const int pad_w,
+    const int stride_h,
+    const int stride_w,
+    T* top_data) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+  std::string kernel_name = clGetKernelName<T>("ConvolutionDirect");
+
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR)<< device.name() << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  const int relu_flag = relu ? 1 : 0;
+  CL_SET_KERNEL_ARG
+  CL_SET_ARRAY_KERNEL_ARG(&bottom_data, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&weight, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bias, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, relu_flag, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, negative_slope, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, channels, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, height, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, width, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, num_output, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, group, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, height_out, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, width_out, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, kernel_h, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, kernel_w, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, pad_h, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, pad_w, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, stride_h, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, stride_w, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&top_data, kernel)
+
+  // a work group per tile of OPENCL_DIRECT_COUT output channels of an image.
+  const int blocks = (num_output / group + OPENCL_DIRECT_COUT - 1) /
+      OPENCL_DIRECT_COUT;
+  size_t global[3] = {
+      CAFFE_GET_GLOBAL_WORKITEMS(width_out, OPENCL_BLOCK_SIZE),
+      CAFFE_GET_GLOBAL_WORKITEMS(height_out, OPENCL_BLOCK_SIZE),
+      (size_t) num * group * blocks };
+  size_t local[3] = { OPENCL_BLOCK_SIZE, OPENCL_BLOCK_SIZE, 1 };
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 3, NULL,
+                               global, local, CL_COMMAND_WAIT_LIST(device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clConvolutionDirect<float>(
+    const float* bottom_data,
+    const float* weight,
+    const float* bias,
+    const bool relu,
+    const float negative_slope,
+    const int num,
+    const int channels,
+    const int height,
+    const int width,
+    const int num_output,
+    const int group,
+    const int height_out,
+    const int width_out,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_h,
+    const int pad_w,
+    const int stride_h,
+    const int stride_w,
+    float* top_data);
+template bool clConvolutionDirect<double>(
+    const double* bottom_data,
+    const double* weight,
+    const double* bias,
+    const bool relu,
+    const double negative_slope,
+    const int num,
+    const int channels,
+    const int height,
+    const int width,
+    const int num_output,
+    const int group,
+    const int height_out,
+    const int width_out,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_h,
+    const int pad_w,
+    const int stride_h,
+    const int stride_w,
+    double* top_data);
+
+}  // namespace OpenCL
+
+template<typename Dtype>
+void ConvolutionLayer<Dtype>::opencl_programs(
+    vector<string>* programs) const {
+  BaseConvolutionLayer<Dtype>::opencl_programs(programs);
+  if (direct_) {
+    programs->push_back("conv_layer");
+  }
+  if (winograd_) {
+    programs->push_back("winograd");
+  }
+  if (this->layer_param_.fused_relu()) {
+    programs->push_back("relu_layer");
+  }
+  if (pooling_layer_) {
+    pooling_layer_->opencl_programs(programs);
+  }
+}
+
+/// @brief refer to CPU forward -- the GEMMs of the tile positions are one
+/// strided batched GEMM per group.
+template<typename Dtype>
+void ConvolutionLayer<Dtype>::forward_gpu_winograd(
+    const Dtype* input, const Dtype* bias, const int num, Dtype* output) {
+  const int positions = winograd_positions(winograd_tile_);
+  const int num_tiles = num * winograd_tiles_h_ * winograd_tiles_w_;
+  const int channels_g = this->channels_ / this->group_;
+  const int outputs_g = this->num_output_ / this->group_;
+  if (winograd_filter_outdated()) {
+    winograd_filter_transform_gpu(
+        this->blobs_[0]->gpu_data(), this->num_output_, channels_g,
+        winograd_tile_, winograd_filter_.mutable_gpu_data());
+  }
+  const Dtype* filter = winograd_filter_.gpu_data();
+  Dtype* transformed = winograd_input()->mutable_gpu_data();
+  Dtype* products = winograd_output()->mutable_gpu_data();
+  winograd_input_transform_gpu(
+      input, num, this->channels_, this->height_, this->width_,
+      this->pad_h_, this->pad_w_, winograd_tiles_h_, winograd_tiles_w_,
+      winograd_tile_, transformed);
+  for (int g = 0; g < this->group_; ++g) {
+    caffe_gpu_gemm_strided_batched<Dtype>(
+        CblasNoTrans, CblasNoTrans, outputs_g, num_tiles, channels_g,
+        positions, (Dtype) 1.,
+        filter, g * outputs_g * channels_g, this->num_output_ * channels_g,
+        transformed, g * channels_g * num_tiles, this->channels_ * num_tiles,
+        (Dtype) 0.,
+        products, g * outputs_g * num_tiles, this->num_output_ * num_tiles);
+  }
+  winograd_output_transform_gpu(
+      products, bias, this->layer_param_.fused_relu(),
+      (Dtype) this->layer_param_.relu_param().negative_slope(), num,
+      this->num_output_, this->height_out_, this->width_out_,
+      winograd_tiles_h_, winograd_tiles_w_, winograd_tile_, output);
+}
+
+/// @brief refer to CPU forward -- the BLAS implementation is the same, but
+/// all images of the batch run at once as strided batched GEMMs. The DIRECT
+/// engine convolves without the im2col buffer and adds the bias on the way.
 template<typename Dtype>
 void ConvolutionLayer<Dtype>::Forward_gpu(
     const vector<Blob<Dtype>*>& bottom,
@@ -94,170 +465,45 @@ void ConvolutionLayer<Dtype>::Forward_gpu(
   DLOG(INFO)<< "in call ConvolutionLayer<Dtype>::Forward_gpu()";
   TIME("ConvolutionLayer->Forward_gpu()", {
   const Dtype* weight = this->blobs_[0]->gpu_data();
+  const vector<Blob<Dtype>*>& output = conv_top(top);
   for (int i = 0; i < bottom.size(); ++i) {
-    const Dtype* bottom_data;
-    Dtype* top_data;
-
-    bottom_data = bottom[i]->gpu_data();
-    top_data = top[i]->mutable_gpu_data();
-
-    bool use_groups = true;
-    if ( this->group_ == 1 && use_groups ) {
-      const Dtype* cb_ptr = bottom_data;
-
-      if (!this->is_1x1_) {
-        // all images at once using im2col_perf kernel
-
-        TIME("ConvolutionLayer->Forward_gpu()->im2col_group_gpu()", {
-        im2col_group_gpu(
-            bottom_data,
-            this->getImageNumPixels(),
-            this->num_, this->channels_, this->height_, this->width_,
-            this->kernel_h_, this->kernel_w_, this->pad_h_, this->pad_w_,
-            this->stride_h_, this->stride_w_,
-            this->col_buffer_.mutable_gpu_data(),
-            this->getImageColLength());
-        });
-        // all images at once using mask
-        // im2col_group_gpu(bottom_data, this->im2col_mask_.gpu_data(), this->num_, this->channels_, this->height_, this->width_, this->kernel_h_, this->kernel_w_, this->height_out_, this->width_out_, this->col_buffer_.mutable_gpu_data()); // NOLINT(*)
-        cb_ptr = this->col_buffer_.gpu_data();
-      } else {
-        cb_ptr = bottom_data;
+    const Dtype* bottom_data = bottom[i]->gpu_data();
+    Dtype* top_data = output[i]->mutable_gpu_data();
+    if (winograd_) {
+      const Dtype* bias = this->bias_term_ ? this->blobs_[1]->gpu_data() : NULL;
+      for (int n = 0; n < this->num_; n += winograd_chunk_) {
+        forward_gpu_winograd(bottom_data + bottom[i]->offset(n), bias,
+                              std::min(winograd_chunk_, this->num_ - n),
+                              top_data + output[i]->offset(n));
       }
-
-      size_t M = this->conv_out_channels_ /this->group_;
-      size_t N = this->num_*this->conv_out_spatial_dim_;
-      size_t K = this->kernel_dim_ / this->group_;
-
-      DLOG(INFO) << "BIG M x N x K = " << M << " x " << N << " x " << K;
-
-      TIME("ConvolutionLayer->Forward_gpu()->caffe_gpu_group_gemm()", {
-      caffe_gpu_group_gemm<Dtype>(CblasNoTrans, CblasNoTrans,
-          M, N, K,
-          1, this->num_, 1,
-          (Dtype)1.,
-          weight,
-          cb_ptr,
-          (Dtype)0.,
-          top_data);
-      });
-
-      TIME("ConvolutionLayer->Forward_gpu()->bias_term", {
-
-      if (this->bias_term_) {
-        const Dtype* bias = this->blobs_[1]->cpu_data();
-        bias = this->blobs_[1]->gpu_data();
-
-        M = this->num_output_;
-        N = this->height_out_ * this->width_out_ * this->num_;
-        K = 1;
-        caffe_gpu_group_gemm<Dtype>(CblasNoTrans, CblasNoTrans,
-            M, N, K,
-            1, this->num_, 1,
-            (Dtype)1., bias,
-            this->bias_multiplier_.gpu_data(),
-            (Dtype)1., top_data);
-      }
-      });
-
-    } else {
-      //TIMENOSYNC("CONVLAYER::Forward[ALL]", {
-
-      const Dtype* cb_ptr = bottom_data;
-
-      if (!this->is_1x1_) {
-        // all images at once using im2col_perf kernel
-
-        TIME("ConvolutionLayer->Forward_gpu()->im2col_group_gpu()", {
-        im2col_group_gpu(
-            bottom_data,
-            this->getImageNumPixels(),
-            this->num_, this->channels_, this->height_, this->width_,
-            this->kernel_h_, this->kernel_w_, this->pad_h_, this->pad_w_,
-            this->stride_h_, this->stride_w_,
-            this->col_buffer_.mutable_gpu_data(),
-            this->getImageColLength());
-        });
-        // all images at once using mask
-        // im2col_group_gpu(bottom_data, this->im2col_mask_.gpu_data(), this->num_, this->channels_, this->height_, this->width_, this->kernel_h_, this->kernel_w_, this->height_out_, this->width_out_, this->col_buffer_.mutable_gpu_data()); // NOLINT(*)
-        cb_ptr = this->col_buffer_.gpu_data();
-      } else {
-        cb_ptr = bottom_data;
-      }
-
-      size_t M = this->conv_out_channels_ / this->group_;
-      size_t N = this->num_*this->conv_out_spatial_dim_;
-      size_t K = this->kernel_dim_ / this->group_;
-      size_t G = this->group_;
-
-      TIME("ConvolutionLayer->Forward_gpu()->caffe_gpu_group_gemm_3D()", {
-      caffe_gpu_group_gemm_3D<Dtype>(CblasNoTrans, CblasNoTrans,
-          M, N, K, G,
-          1, this->num_, 1,
-          (Dtype)1.,
-          (Dtype*) weight,
-          cb_ptr,
-          (Dtype)0.,
-          top_data);
-      });
-
-      TIME("ConvolutionLayer->Forward_gpu()->bias_term", {
-
-      if (this->bias_term_) {
-        const Dtype* bias = this->blobs_[1]->cpu_data();
-        bias = this->blobs_[1]->gpu_data();
-
-        M = this->num_output_;
-        N = this->height_out_ * this->width_out_ * this->num_;
-        K = 1;
-        caffe_gpu_group_gemm<Dtype>(CblasNoTrans, CblasNoTrans,
-            M, N, K,
-            1, this->num_, 1,
-            (Dtype)1., bias,
-            this->bias_multiplier_.gpu_data(),
-            (Dtype)1., top_data);
-      }
-      });
-      /*
-
-      for (int n = 0; n < this->num_; ++n) {
-        DLOG(INFO) << "bottom["
-                   << i
-                   << "]->offset("
-                   << n
-                   << ") = "
-                   << bottom[i]->offset(n);
-
-        DLOG(INFO) << "top["
-                   << i
-                   << "]->offset("
-                   << n
-                   << ") = "
-                   << top[i]->offset(n);
-
-        // this->forward_gpu_gemm(bottom_data + bottom[i]->offset(n), weight, top_data + top[i]->offset(n)); // NOLINT(*)
-        TIME("CONVLAYER::Forward["<<n<<"]", {
-        this->forward_gpu_gemm(
-            cb_ptr,//bottom_data,
-            n*this->getImageColLength(),//bottom[i]->offset(n),
-            weight,
-            0,
-            top_data,
-            top[i]->offset(n));
-        });
-        if (this->bias_term_) {
-          const Dtype* bias = this->blobs_[1]->gpu_data();
-          // this->forward_gpu_bias(top_data + top[i]->offset(n), bias);
-          this->forward_gpu_bias(top_data, top[i]->offset(n), bias);
-        }
-        OpenCLManager::CurrentPlatform()->CurrentDevice().getNextCommandQueue();
-      }
-
-     // });
-      OpenCLManager::CurrentPlatform()->CurrentDevice().setCommandQueueIDX(0);
-      OpenCLManager::CurrentPlatform()->CurrentDevice().waitForCommandQueues();
-      */
+      continue;
+    }
+    if (this->fft_) {
+      const Dtype* bias = this->bias_term_ ? this->blobs_[1]->gpu_data() : NULL;
+      this->forward_gpu_fft(bottom_data, bias, top_data);
+      continue;
     }
+    if (direct_) {
+      const Dtype* bias = this->bias_term_ ? this->blobs_[1]->gpu_data() : NULL;
+      BOOL_CHECK(
+          caffe::OpenCL::clConvolutionDirect(
+              bottom_data, weight, bias, this->layer_param_.fused_relu(),
+              (Dtype) this->layer_param_.relu_param().negative_slope(),
+              this->num_, this->channels_,
+              this->height_, this->width_, this->num_output_, this->group_,
+              this->height_out_, this->width_out_, this->kernel_h_,
+              this->kernel_w_, this->pad_h_, this->pad_w_, this->stride_h_,
+              this->stride_w_, top_data));
+      continue;
+    }
+    // the GEMMs add the bias and apply the ReLU when they write the output.
+    const Dtype* bias = this->bias_term_ ? this->blobs_[1]->gpu_data() : NULL;
+    this->forward_gpu_gemm_batched(
+        bottom_data, weight, bias, this->layer_param_.fused_relu(),
+        (Dtype) this->layer_param_.relu_param().negative_slope(), top_data);
+  }
+  if (pooling_layer_) {
+    pooling_layer_->Forward(conv_top_vec_, top);
   }
   });
 }
@@ -287,40 +533,17 @@ void ConvolutionLayer<Dtype>::Backward_gpu(
       // Bias gradient, if necessary.
       if (this->bias_term_ && this->param_propagate_down_[1]) {
         Dtype* bias_diff = this->blobs_[1]->mutable_gpu_diff();
-
-        for (int n = 0; n < this->num_; ++n) {
-          // this->backward_gpu_bias(bias_diff, top_diff + top[i]->offset(n));
-          this->backward_gpu_bias(bias_diff, 0, top_diff, top[i]->offset(n));
-        }
+        this->backward_gpu_bias_batched(bias_diff, top_diff);
       }
-      if (this->param_propagate_down_[0] || propagate_down[i]) {
+      // gradient w.r.t. weight. Note that we will accumulate diffs.
+      if (this->param_propagate_down_[0]) {
         const Dtype* bottom_data = bottom[i]->gpu_data();
+        this->weight_gpu_gemm_batched(bottom_data, top_diff, weight_diff);
+      }
+      // gradient w.r.t. bottom data, if necessary.
+      if (propagate_down[i]) {
         Dtype* bottom_diff = bottom[i]->mutable_gpu_diff();
-
-        for (int n = 0; n < this->num_; ++n) {
-          // gradient w.r.t. weight. Note that we will accumulate diffs.
-          if (this->param_propagate_down_[0]) {
-            // this->weight_gpu_gemm(bottom_data + bottom[i]->offset(n), top_diff + top[i]->offset(n), weight_diff);  // NOLINT(*)
-            this->weight_gpu_gemm(
-                bottom_data,
-                bottom[i]->offset(n),
-                top_diff,
-                top[i]->offset(n),
-                weight_diff,
-                0.0);
-          }
-          // gradient w.r.t. bottom data, if necessary.
-          if (propagate_down[i]) {
-            // this->backward_gpu_gemm(top_diff + top[i]->offset(n), weight, bottom_diff + bottom[i]->offset(n)); //NOLINT(*)
-            this->backward_gpu_gemm(
-                top_diff,
-                top[i]->offset(n),
-                weight,
-                0,
-                bottom_diff,
-                bottom[i]->offset(n));
-          }
-        }
+        this->backward_gpu_gemm_batched(top_diff, weight, bottom_diff);
       }
     }
   });
@@ -12,6 +12,9 @@ namespace caffe {
 template <typename Dtype>
 void ConvolutionLayer<Dtype>::Forward_gpu(const vector<Blob<Dtype>*>& bottom,
       const vector<Blob<Dtype>*>& top) {
+  CHECK(!this->layer_param_.fused_relu() &&
+        !this->layer_param_.fused_pooling())
+      << "The CUDA ConvolutionLayer does not support fused layers.";
   TIME("ConvolutionLayer->Forward_gpu()", {
   const Dtype* weight = this->blobs_[0]->gpu_data();
   for (int i = 0; i < bottom.size(); ++i) {
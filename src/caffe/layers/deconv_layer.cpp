@@ -24,6 +24,11 @@ void DeconvolutionLayer<Dtype>::Forward_cpu(
   for (int i = 0; i < bottom.size(); ++i) {
     const Dtype* bottom_data = bottom[i]->cpu_data();
     Dtype* top_data = top[i]->mutable_cpu_data();
+    if (this->fft_) {
+      const Dtype* bias = this->bias_term_ ? this->blobs_[1]->cpu_data() : NULL;
+      this->forward_cpu_fft(bottom_data, bias, top_data);
+      continue;
+    }
     for (int n = 0; n < this->num_; ++n) {
       this->backward_cpu_gemm(
           bottom_data + bottom[i]->offset(n),
@@ -77,6 +82,7 @@ void DeconvolutionLayer<Dtype>::Backward_cpu(
           this->forward_cpu_gemm(
               top_diff + top[i]->offset(n),
               weight,
+              (const Dtype*) NULL,
               bottom_diff + bottom[i]->offset(n),
               this->param_propagate_down_[0]);
         }
@@ -95,15 +101,15 @@ void DeconvolutionLayer<Dtype>::Forward_gpu(
   for (int i = 0; i < bottom.size(); ++i) {
     const Dtype* bottom_data = bottom[i]->gpu_data();
     Dtype* top_data = top[i]->mutable_gpu_data();
-    for (int n = 0; n < this->num_; ++n) {
-      this->backward_gpu_gemm(
-          bottom_data + bottom[i]->offset(n),
-          weight,
-          top_data + top[i]->offset(n));
-      if (this->bias_term_) {
-        const Dtype* bias = this->blobs_[1]->gpu_data();
-        this->forward_gpu_bias(top_data + top[i]->offset(n), bias);
-      }
+    if (this->fft_) {
+      const Dtype* bias = this->bias_term_ ? this->blobs_[1]->gpu_data() : NULL;
+      this->forward_gpu_fft(bottom_data, bias, top_data);
+      continue;
+    }
+    this->backward_gpu_gemm_batched(bottom_data, weight, top_data);
+    if (this->bias_term_) {
+      const Dtype* bias = this->blobs_[1]->gpu_data();
+      this->forward_gpu_bias_batched(top_data, bias);
     }
   }
 }
@@ -131,25 +137,16 @@ void DeconvolutionLayer<Dtype>::Backward_gpu(
     // Bias gradient, if necessary.
     if (this->bias_term_ && this->param_propagate_down_[1]) {
       Dtype* bias_diff = this->blobs_[1]->mutable_gpu_diff();
-      for (int n = 0; n < this->num_; ++n) {
-        this->backward_gpu_bias(bias_diff, top_diff + top[i]->offset(n));
-      }
+      this->backward_gpu_bias_batched(bias_diff, top_diff);
     }
-    if (this->param_propagate_down_[0] || propagate_down[i]) {
-      for (int n = 0; n < this->num_; ++n) {
-        // gradient w.r.t. weight. Note that we will accumulate diffs.
-        if (this->param_propagate_down_[0]) {
-          this->weight_gpu_gemm(top_diff + top[i]->offset(n), bottom_data
-              + bottom[i]->offset(n), weight_diff);
-        }
-        // gradient w.r.t. bottom data, if necessary.
-        if (propagate_down[i]) {
-          this->forward_gpu_gemm(
-              top_diff + top[i]->offset(n),
-              weight,
-              bottom_diff + bottom[i]->offset(n));
-        }
-      }
+    // gradient w.r.t. weight. Note that we will accumulate diffs.
+    if (this->param_propagate_down_[0]) {
+      this->weight_gpu_gemm_batched(top_diff, bottom_data, weight_diff);
+    }
+    // gradient w.r.t. bottom data, if necessary.
+    if (propagate_down[i]) {
+      this->forward_gpu_gemm_batched(top_diff, weight, (const Dtype*) NULL,
+                                     false, (Dtype) 0, bottom_diff);
     }
   }
 }
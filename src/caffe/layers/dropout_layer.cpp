@@ -89,7 +89,8 @@ template<typename T>
 bool clDropoutLayerForward(
     const int count,
     const T* bottom_data,
-    const unsigned int* mask,
+    const uint64_t key,
+    const uint64_t counter,
     const unsigned int threshold,
     const T scale,
     T* top_data) {
@@ -108,19 +109,29 @@ bool clDropoutLayerForward(
     return false;
   }
 
+  const cl_uint key0 = static_cast<cl_uint>(key);
+  const cl_uint key1 = static_cast<cl_uint>(key >> 32);
+  const cl_uint ctr0 = static_cast<cl_uint>(counter);
+  const cl_uint ctr1 = static_cast<cl_uint>(counter >> 32);
+  // 4 inputs per work item.
+  const int calls = (count + 3) / 4;
+
   CL_SET_KERNEL_ARG
   CL_SET_TYPE_KERNEL_ARG(int, count, kernel)
   CL_SET_ARRAY_KERNEL_ARG(&bottom_data, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&mask, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, key0, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, key1, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, ctr0, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, ctr1, kernel)
   CL_SET_TYPE_KERNEL_ARG(const unsigned int, threshold, kernel)
   CL_SET_TYPE_KERNEL_ARG(T, scale, kernel)
   CL_SET_ARRAY_KERNEL_ARG(&top_data, kernel)
 
-  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
-  size_t local = CAFFE_GET_LOCAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(calls, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(calls, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -142,14 +153,16 @@ bool clDropoutLayerForward(
 template bool clDropoutLayerForward<float>(
     const int count,
     const float* bottom_data,
-    const unsigned int* mask,
+    const uint64_t key,
+    const uint64_t counter,
     const unsigned int threshold,
     const float scale,
     float* top_data);
 template bool clDropoutLayerForward<double>(
     const int count,
     const double* bottom_data,
-    const unsigned int* mask,
+    const uint64_t key,
+    const uint64_t counter,
     const unsigned int threshold,
     const double scale,
     double* top_data);
@@ -158,7 +171,8 @@ template<typename T>
 bool clDropoutLayerBackward(
     const int count,
     const T* top_diff,
-    const unsigned int* mask,
+    const uint64_t key,
+    const uint64_t counter,
     const unsigned int threshold,
     const T scale,
     T* bottom_diff) {
@@ -177,19 +191,29 @@ bool clDropoutLayerBackward(
     return false;
   }
 
+  const cl_uint key0 = static_cast<cl_uint>(key);
+  const cl_uint key1 = static_cast<cl_uint>(key >> 32);
+  const cl_uint ctr0 = static_cast<cl_uint>(counter);
+  const cl_uint ctr1 = static_cast<cl_uint>(counter >> 32);
+  // 4 inputs per work item.
+  const int calls = (count + 3) / 4;
+
   CL_SET_KERNEL_ARG
   CL_SET_TYPE_KERNEL_ARG(int, count, kernel)
   CL_SET_ARRAY_KERNEL_ARG(&top_diff, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&mask, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, key0, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, key1, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, ctr0, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, ctr1, kernel)
   CL_SET_TYPE_KERNEL_ARG(unsigned int, threshold, kernel)
   CL_SET_TYPE_KERNEL_ARG(T, scale, kernel)
   CL_SET_ARRAY_KERNEL_ARG(&bottom_diff, kernel)
 
-  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
-  size_t local = CAFFE_GET_LOCAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(calls, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(calls, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -211,14 +235,16 @@ bool clDropoutLayerBackward(
 template bool clDropoutLayerBackward<float>(
     const int count,
     const float* top_diff,
-    const unsigned int* mask,
+    const uint64_t key,
+    const uint64_t counter,
     const unsigned int threshold,
     const float scale,
     float* bottom_diff);
 template bool clDropoutLayerBackward<double>(
     const int count,
     const double* top_diff,
-    const unsigned int* mask,
+    const uint64_t key,
+    const uint64_t counter,
     const unsigned int threshold,
     const double scale,
     double* bottom_diff);
@@ -233,22 +259,13 @@ void DropoutLayer<Dtype>::Forward_gpu(
   Dtype* top_data = top[0]->mutable_gpu_data();
   const int count = bottom[0]->count();
   if (this->phase_ == TRAIN) {
-    unsigned int* mask =
-        static_cast<unsigned int*>(rand_vec_.mutable_gpu_data());
-    caffe_gpu_rng_bernoulli(count, 1. - threshold_, mask);
-
-    // caffe_gpu_rng_uniform(count, mask);
-
-    /*
-     // set thresholds
-     // NOLINT_NEXT_LINE(whitespace/operators)
-     DropoutForward<Dtype> << <CAFFE_GET_BLOCKS(count), CAFFE_CUDA_NUM_THREADS>>>(
-     count, bottom_data, mask, uint_thres_, scale_, top_data);
-     CUDA_POST_KERNEL_CHECK;
-     */
+    // the kernels regenerate the mask from the key and the counters, which
+    // Backward_gpu reuses.
+    philox_key_ = Caffe::philox_key();
+    philox_counter_ = Caffe::philox_counter((count + 3) / 4);
     BOOL_CHECK(
-        caffe::OpenCL::clDropoutLayerForward(count, bottom_data, mask,
-            uint_thres_, scale_, top_data));
+        caffe::OpenCL::clDropoutLayerForward(count, bottom_data, philox_key_,
+            philox_counter_, uint_thres_, scale_, top_data));
   } else {
     caffe_copy(count, bottom_data, top_data);
   }
@@ -263,19 +280,10 @@ void DropoutLayer<Dtype>::Backward_gpu(
     const Dtype* top_diff = top[0]->gpu_diff();
     Dtype* bottom_diff = bottom[0]->mutable_gpu_diff();
     if (this->phase_ == TRAIN) {
-      const unsigned int* mask =
-          static_cast<const unsigned int*>(rand_vec_.gpu_data());
       const int count = bottom[0]->count();
-      /*
-       // NOLINT_NEXT_LINE(whitespace/operators)
-       DropoutBackward<Dtype> << <CAFFE_GET_BLOCKS(count),
-       CAFFE_CUDA_NUM_THREADS>>>(
-       count, top_diff, mask, uint_thres_, scale_, bottom_diff);
-       CUDA_POST_KERNEL_CHECK;
-       */
       BOOL_CHECK(
-          caffe::OpenCL::clDropoutLayerBackward(count, top_diff, mask,
-              uint_thres_, scale_, bottom_diff));
+          caffe::OpenCL::clDropoutLayerBackward(count, top_diff, philox_key_,
+              philox_counter_, uint_thres_, scale_, bottom_diff));
     } else {
       caffe_copy(top[0]->count(), top_diff, bottom_diff);
     }
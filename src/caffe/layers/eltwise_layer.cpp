@@ -2,6 +2,7 @@
 #include <caffe/util/OpenCL/definitions.hpp>
 #include <caffe/util/OpenCL/eltwise_layer.hpp>
 #include <caffe/util/OpenCL/OpenCLDevice.hpp>
+#include <caffe/util/OpenCL/relu_layer.hpp>
 #endif
 
 #include <cfloat>
@@ -105,6 +106,11 @@ void EltwiseLayer<Dtype>::Forward_cpu(
     default:
       LOG(FATAL)<< "Unknown elementwise operation.";
     }
+    if (this->layer_param_.fused_relu()) {
+      caffe_cpu_relu(
+          count, (Dtype) this->layer_param_.relu_param().negative_slope(),
+          top_data);
+    }
   }
 
 template<typename Dtype>
@@ -210,7 +216,7 @@ bool clMaxForward(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(nthreads, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -276,7 +282,7 @@ bool clMaxBackward(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(nthreads, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -367,6 +373,13 @@ void EltwiseLayer<Dtype>::Forward_gpu(
     default:
       LOG(FATAL)<< "Unknown elementwise operation.";
     }
+    if (this->layer_param_.fused_relu()) {
+      BOOL_CHECK(
+          caffe::OpenCL::clBiasReLUForward<Dtype>(
+              count, 1, count, NULL,
+              (Dtype) this->layer_param_.relu_param().negative_slope(),
+              top_data));
+    }
   }
 
 template<typename Dtype>
@@ -34,6 +34,8 @@ __global__ void MaxForward(const int nthreads, const Dtype* bottom_data_a,
 template <typename Dtype>
 void EltwiseLayer<Dtype>::Forward_gpu(const vector<Blob<Dtype>*>& bottom,
     const vector<Blob<Dtype>*>& top) {
+  CHECK(!this->layer_param_.fused_relu())
+      << "The CUDA EltwiseLayer does not support fused layers.";
   int* mask = NULL;
   const int count = top[0]->count();
   Dtype* top_data = top[0]->mutable_gpu_data();
@@ -1,3 +1,7 @@
+#if defined(USE_OPENCL)
+#include <caffe/util/OpenCL/relu_layer.hpp>
+#endif
+
 #include <vector>
 
 #include "caffe/blob.hpp"
@@ -71,12 +75,6 @@ void InnerProductLayer<Dtype>::Reshape(
   top_shape.resize(axis + 1);
   top_shape[axis] = N_;
   top[0]->Reshape(top_shape);
-  // Set up the bias multiplier
-  if (bias_term_) {
-    vector<int> bias_shape(1, M_);
-    bias_multiplier_.Reshape(bias_shape);
-    caffe_set(M_, Dtype(1), bias_multiplier_.mutable_cpu_data());
-  }
 }
 
 template<typename Dtype>
@@ -86,22 +84,18 @@ void InnerProductLayer<Dtype>::Forward_cpu(
   const Dtype* bottom_data = bottom[0]->cpu_data();
   Dtype* top_data = top[0]->mutable_cpu_data();
   const Dtype* weight = this->blobs_[0]->cpu_data();
+  const Dtype* bias = bias_term_ ? this->blobs_[1]->cpu_data() : NULL;
   caffe_cpu_gemm<Dtype>(
       CblasNoTrans, CblasTrans,
       M_, N_, K_,
       (Dtype) 1.,
       bottom_data, weight,
       (Dtype) 0.,
-      top_data);
-
-  if (bias_term_) {
-    caffe_cpu_gemm<Dtype>(
-        CblasNoTrans, CblasNoTrans,
-        M_, N_, 1,
-        (Dtype) 1.,
-        bias_multiplier_.cpu_data(),
-        this->blobs_[1]->cpu_data(),
-        (Dtype) 1.,
+      top_data,
+      NULL, bias);
+  if (this->layer_param_.fused_relu()) {
+    caffe_cpu_relu(
+        M_ * N_, (Dtype) this->layer_param_.relu_param().negative_slope(),
         top_data);
   }
 }
@@ -126,15 +120,10 @@ void InnerProductLayer<Dtype>::Backward_cpu(
   }
   if (bias_term_ && this->param_propagate_down_[1]) {
     const Dtype* top_diff = top[0]->cpu_diff();
+    Dtype* bias_diff = this->blobs_[1]->mutable_cpu_diff();
     // Gradient with respect to bias
-    caffe_cpu_gemv<Dtype>(
-        CblasTrans,
-        M_, N_,
-        (Dtype) 1.,
-        top_diff,
-        bias_multiplier_.cpu_data(),
-        (Dtype) 0.,
-        this->blobs_[1]->mutable_cpu_diff());
+    caffe_set(N_, Dtype(0), bias_diff);
+    caffe_cpu_channel_sum<Dtype>(M_, N_, 1, top_diff, bias_diff);
   }
   if (propagate_down[0]) {
     const Dtype* top_diff = top[0]->cpu_diff();
@@ -159,6 +148,27 @@ void InnerProductLayer<Dtype>::Forward_gpu(
   const Dtype* bottom_data = bottom[0]->gpu_data();
   Dtype* top_data = top[0]->mutable_gpu_data();
   const Dtype* weight = this->blobs_[0]->gpu_data();
+  const Dtype* bias = bias_term_ ? this->blobs_[1]->gpu_data() : NULL;
+  const bool relu = this->layer_param_.fused_relu();
+  const Dtype negative_slope = this->layer_param_.relu_param().negative_slope();
+  OpenCLGemmConfig config;
+  if (OpenCLGemmTuner::Lookup<Dtype>(clblasNoTrans, clblasTrans, M_, N_, K_,
+                                     1, &config) && config.tiled()) {
+    // the tuned tiled GEMM adds the bias and applies the ReLU when it writes
+    // the output.
+    caffe_gpu_gemm_strided_batched<Dtype>(
+        CblasNoTrans, CblasTrans,
+        M_, N_, K_,
+        1,
+        (Dtype) 1.,
+        bottom_data, 0, 0,
+        weight, 0, 0,
+        (Dtype) 0.,
+        top_data, 0, 0,
+        NULL, bias, relu, negative_slope);
+    return;
+  }
+  // otherwise clBLAS, followed by a single pass for the bias and the ReLU.
   caffe_gpu_gemm<Dtype>(
       CblasNoTrans, CblasTrans,
       M_, N_, K_,
@@ -167,15 +177,12 @@ void InnerProductLayer<Dtype>::Forward_gpu(
       weight,
       (Dtype) 0.,
       top_data);
-  if (bias_term_) {
-    caffe_gpu_gemm<Dtype>(
-        CblasNoTrans, CblasNoTrans,
-        M_, N_, 1,
-        (Dtype) 1.,
-        bias_multiplier_.gpu_data(),
-        this->blobs_[1]->gpu_data(),
-        (Dtype) 1.,
-        top_data);
+  if (relu) {
+    BOOL_CHECK(
+        caffe::OpenCL::clBiasReLUForward(
+            M_ * N_, N_, 1, bias, negative_slope, top_data));
+  } else if (bias) {
+    caffe_gpu_add_bias<Dtype>(M_, N_, 1, bias, top_data);
   }
 }
 
@@ -199,15 +206,10 @@ void InnerProductLayer<Dtype>::Backward_gpu(
   }
   if (bias_term_ && this->param_propagate_down_[1]) {
     const Dtype* top_diff = top[0]->gpu_diff();
+    Dtype* bias_diff = this->blobs_[1]->mutable_gpu_diff();
     // Gradient with respect to bias
-    caffe_gpu_gemv<Dtype>(
-        CblasTrans,
-        M_, N_,
-        (Dtype) 1.,
-        top_diff,
-        bias_multiplier_.gpu_data(),
-        (Dtype) 0.,
-        this->blobs_[1]->mutable_gpu_diff());
+    caffe_gpu_set(N_, Dtype(0), bias_diff);
+    caffe_gpu_channel_sum<Dtype>(M_, N_, 1, top_diff, bias_diff);
   }
   if (propagate_down[0]) {
     const Dtype* top_diff = top[0]->gpu_diff();
@@ -12,15 +12,16 @@ namespace caffe {
 template <typename Dtype>
 void InnerProductLayer<Dtype>::Forward_gpu(const vector<Blob<Dtype>*>& bottom,
     const vector<Blob<Dtype>*>& top) {
+  CHECK(!this->layer_param_.fused_relu())
+      << "The CUDA InnerProductLayer does not support fused layers.";
   const Dtype* bottom_data = bottom[0]->gpu_data();
   Dtype* top_data = top[0]->mutable_gpu_data();
   const Dtype* weight = this->blobs_[0]->gpu_data();
   caffe_gpu_gemm<Dtype>(CblasNoTrans, CblasTrans, M_, N_, K_, (Dtype)1.,
       bottom_data, weight, (Dtype)0., top_data);
   if (bias_term_) {
-    caffe_gpu_gemm<Dtype>(CblasNoTrans, CblasNoTrans, M_, N_, 1, (Dtype)1.,
-        bias_multiplier_.gpu_data(),
-        this->blobs_[1]->gpu_data(), (Dtype)1., top_data);
+    caffe_gpu_add_bias<Dtype>(M_, N_, 1, this->blobs_[1]->gpu_data(),
+        top_data);
   }
 }
 
@@ -37,10 +38,10 @@ void InnerProductLayer<Dtype>::Backward_gpu(const vector<Blob<Dtype>*>& top,
   }
   if (bias_term_ && this->param_propagate_down_[1]) {
     const Dtype* top_diff = top[0]->gpu_diff();
+    Dtype* bias_diff = this->blobs_[1]->mutable_gpu_diff();
     // Gradient with respect to bias
-    caffe_gpu_gemv<Dtype>(CblasTrans, M_, N_, (Dtype)1., top_diff,
-        bias_multiplier_.gpu_data(), (Dtype)0.,
-        this->blobs_[1]->mutable_gpu_diff());
+    caffe_gpu_set(N_, Dtype(0), bias_diff);
+    caffe_gpu_channel_sum<Dtype>(M_, N_, 1, top_diff, bias_diff);
   }
   if (propagate_down[0]) {
     const Dtype* top_diff = top[0]->gpu_diff();
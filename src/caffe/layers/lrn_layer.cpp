@@ -86,7 +86,7 @@ void LRNLayer<Dtype>::Reshape(
   switch (this->layer_param_.lrn_param().norm_region()) {
     case LRNParameter_NormRegion_ACROSS_CHANNELS:
     top[0]->Reshape(num_, channels_, height_, width_);
-    scale_.Reshape(num_, channels_, height_, width_);
+    scale()->Reshape(num_, channels_, height_, width_);
     break;
     case LRNParameter_NormRegion_WITHIN_CHANNEL:
     split_layer_->Reshape(bottom, split_top_vec_);
@@ -120,9 +120,9 @@ void LRNLayer<Dtype>::CrossChannelForward_cpu(
     const vector<Blob<Dtype>*>& top) {
   const Dtype* bottom_data = bottom[0]->cpu_data();
   Dtype* top_data = top[0]->mutable_cpu_data();
-  Dtype* scale_data = scale_.mutable_cpu_data();
+  Dtype* scale_data = scale()->mutable_cpu_data();
   // start with the constant value
-  for (int i = 0; i < scale_.count(); ++i) {
+  for (int i = 0; i < scale()->count(); ++i) {
     scale_data[i] = k_;
   }
   Blob<Dtype> padded_square(1, channels_ + size_ - 1, height_, width_);
@@ -142,32 +142,32 @@ void LRNLayer<Dtype>::CrossChannelForward_cpu(
           height_ * width_,
           alpha_over_size,
           padded_square_data + padded_square.offset(0, c),
-          scale_data + scale_.offset(n, 0));
+          scale_data + scale()->offset(n, 0));
     }
     for (int c = 1; c < channels_; ++c) {
       // copy previous scale
       caffe_copy<Dtype>(
           height_ * width_,
-          scale_data + scale_.offset(n, c - 1),
-          scale_data + scale_.offset(n, c));
+          scale_data + scale()->offset(n, c - 1),
+          scale_data + scale()->offset(n, c));
       // add head
       caffe_axpy<Dtype>(
           height_ * width_,
           alpha_over_size,
           padded_square_data + padded_square.offset(0, c + size_ - 1),
-          scale_data + scale_.offset(n, c));
+          scale_data + scale()->offset(n, c));
       // subtract tail
       caffe_axpy<Dtype>(
           height_ * width_,
           -alpha_over_size,
           padded_square_data + padded_square.offset(0, c - 1),
-          scale_data + scale_.offset(n, c));
+          scale_data + scale()->offset(n, c));
     }
   }
 
   // In the end, compute output
-  caffe_powx<Dtype>(scale_.count(), scale_data, -beta_, top_data);
-  caffe_mul<Dtype>(scale_.count(), top_data, bottom_data, top_data);
+  caffe_powx<Dtype>(scale()->count(), scale_data, -beta_, top_data);
+  caffe_mul<Dtype>(scale()->count(), top_data, bottom_data, top_data);
 }
 
 template<typename Dtype>
@@ -328,7 +328,8 @@ bool clLRNFillScale(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(nthreads, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &
-                               global, &local, 0, NULL, NULL);
+                               global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -403,7 +404,8 @@ bool clLRNComputeOutput(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(nthreads, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name
@@ -484,7 +486,8 @@ bool clLRNComputeDiff(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(nthreads, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name
@@ -566,7 +569,7 @@ void LRNLayer<Dtype>::CrossChannelForward_gpu(
   });
   Dtype* scale_data;
   TIME("LRNLayer->CrossChannelForward_gpu()->scale_->mutable_gpu_data()", {
-  scale_data = scale_.mutable_gpu_data();
+  scale_data = scale()->mutable_gpu_data();
   });
 
   // We will launch one kernel for each pixel location, and have the kernel
@@ -22,7 +22,7 @@ void MVNLayer<Dtype>::Reshape(
                   bottom[0]->height(), bottom[0]->width());
   mean_.Reshape(bottom[0]->num(), bottom[0]->channels(), 1, 1);
   variance_.Reshape(bottom[0]->num(), bottom[0]->channels(), 1, 1);
-  temp_.Reshape(bottom[0]->num(), bottom[0]->channels(),
+  temp()->Reshape(bottom[0]->num(), bottom[0]->channels(),
                 bottom[0]->height(), bottom[0]->width());
   sum_multiplier_.Reshape(1, 1, bottom[0]->height(), bottom[0]->width());
   Dtype* multiplier_data = sum_multiplier_.mutable_cpu_data();
@@ -47,7 +47,7 @@ void MVNLayer<Dtype>::Forward_cpu(
   if (this->layer_param_.mvn_param().normalize_variance()) {
     // put the squares of bottom into temp_
     caffe_powx(bottom[0]->count(), bottom_data,
-               Dtype(2), temp_.mutable_cpu_data());
+               Dtype(2), temp()->mutable_cpu_data());
 
     // computes variance using var(X) = E(X^2) - (EX)^2
     caffe_cpu_gemv<Dtype>(
@@ -61,14 +61,14 @@ void MVNLayer<Dtype>::Forward_cpu(
     caffe_cpu_gemv<Dtype>(
         CblasNoTrans,
         num, dim, 1. / dim,
-        temp_.cpu_data(),
+        temp()->cpu_data(),
         sum_multiplier_.cpu_data(),
         0.,
         variance_.mutable_cpu_data());  // E(X^2)
 
     caffe_powx(mean_.count(), mean_.cpu_data(), Dtype(2),
-               temp_.mutable_cpu_data());  // (EX)^2
-    caffe_sub(mean_.count(), variance_.cpu_data(), temp_.cpu_data(),
+               temp()->mutable_cpu_data());  // (EX)^2
+    caffe_sub(mean_.count(), variance_.cpu_data(), temp()->cpu_data(),
               variance_.mutable_cpu_data());  // variance
 
     // do mean and variance normalization
@@ -80,9 +80,9 @@ void MVNLayer<Dtype>::Forward_cpu(
         mean_.cpu_data(),
         sum_multiplier_.cpu_data(),
         0.,
-        temp_.mutable_cpu_data());
+        temp()->mutable_cpu_data());
 
-    caffe_add(temp_.count(), bottom_data, temp_.cpu_data(), top_data);
+    caffe_add(bottom[0]->count(), bottom_data, temp()->cpu_data(), top_data);
 
     // normalize variance
     caffe_powx(variance_.count(), variance_.cpu_data(),
@@ -97,9 +97,9 @@ void MVNLayer<Dtype>::Forward_cpu(
         variance_.cpu_data(),
         sum_multiplier_.cpu_data(),
         0.,
-        temp_.mutable_cpu_data());
+        temp()->mutable_cpu_data());
 
-    caffe_div(temp_.count(), top_data, temp_.cpu_data(), top_data);
+    caffe_div(bottom[0]->count(), top_data, temp()->cpu_data(), top_data);
   } else {
     caffe_cpu_gemv<Dtype>(
         CblasNoTrans,
@@ -116,9 +116,9 @@ void MVNLayer<Dtype>::Forward_cpu(
         mean_.cpu_data(),
         sum_multiplier_.cpu_data(),
         0.,
-        temp_.mutable_cpu_data());
+        temp()->mutable_cpu_data());
 
-    caffe_add(temp_.count(), bottom_data, temp_.cpu_data(), top_data);
+    caffe_add(bottom[0]->count(), bottom_data, temp()->cpu_data(), top_data);
   }
 }
 
@@ -142,7 +142,7 @@ void MVNLayer<Dtype>::Backward_cpu(
   Dtype eps = 1e-10;
 
   if (this->layer_param_.mvn_param().normalize_variance()) {
-    caffe_mul(temp_.count(), top_data, top_diff, bottom_diff);
+    caffe_mul(bottom[0]->count(), top_data, top_diff, bottom_diff);
     caffe_cpu_gemv<Dtype>(
         CblasNoTrans,
         num, dim, 1.,
@@ -159,7 +159,7 @@ void MVNLayer<Dtype>::Backward_cpu(
         sum_multiplier_.cpu_data(),
         0.,
         bottom_diff);
-    caffe_mul(temp_.count(), top_data, bottom_diff, bottom_diff);
+    caffe_mul(bottom[0]->count(), top_data, bottom_diff, bottom_diff);
 
     caffe_cpu_gemv<Dtype>(
         CblasNoTrans,
@@ -178,11 +178,11 @@ void MVNLayer<Dtype>::Backward_cpu(
         1.,
         bottom_diff);
 
-    caffe_cpu_axpby(temp_.count(), Dtype(1), top_diff,
+    caffe_cpu_axpby(bottom[0]->count(), Dtype(1), top_diff,
                     Dtype(-1. / dim), bottom_diff);
 
     // put the squares of bottom into temp_
-    caffe_powx(temp_.count(), bottom_data, Dtype(2), temp_.mutable_cpu_data());
+    caffe_powx(bottom[0]->count(), bottom_data, Dtype(2), temp()->mutable_cpu_data());
 
     // computes variance using var(X) = E(X^2) - (EX)^2
     caffe_cpu_gemv<Dtype>(
@@ -194,14 +194,14 @@ void MVNLayer<Dtype>::Backward_cpu(
 
     caffe_cpu_gemv<Dtype>(
         CblasNoTrans, num, dim, 1. / dim,
-        temp_.cpu_data(),
+        temp()->cpu_data(),
         sum_multiplier_.cpu_data(),
         0.,
         variance_.mutable_cpu_data());  // E(X^2)
 
     caffe_powx(mean_.count(), mean_.cpu_data(),
-               Dtype(2), temp_.mutable_cpu_data());  // (EX)^2
-    caffe_sub(mean_.count(), variance_.cpu_data(), temp_.cpu_data(),
+               Dtype(2), temp()->mutable_cpu_data());  // (EX)^2
+    caffe_sub(mean_.count(), variance_.cpu_data(), temp()->cpu_data(),
               variance_.mutable_cpu_data());  // variance
 
     // normalize variance
@@ -216,11 +216,11 @@ void MVNLayer<Dtype>::Backward_cpu(
         variance_.cpu_data(),
         sum_multiplier_.cpu_data(),
         0.,
-        temp_.mutable_cpu_data());
+        temp()->mutable_cpu_data());
 
-    caffe_div(temp_.count(), bottom_diff, temp_.cpu_data(), bottom_diff);
+    caffe_div(bottom[0]->count(), bottom_diff, temp()->cpu_data(), bottom_diff);
   } else {
-    caffe_copy(temp_.count(), top_diff, bottom_diff);
+    caffe_copy(bottom[0]->count(), top_diff, bottom_diff);
   }
 }
 
@@ -287,7 +287,8 @@ template<typename T> bool clMVNLayerForwardResidual(
   // LOG(ERROR) << "local  = " << local[0] << " x " << local[1];
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, dim, NULL,
-                               global, local, 0, NULL, NULL);
+                               global, local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name
@@ -370,7 +371,8 @@ template<typename T> bool clMVNLayerForwardMV2(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(data2D_height, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name
@@ -451,7 +453,8 @@ template<typename T> bool clMVNLayerForward(
   OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name
@@ -530,7 +533,8 @@ template<typename T> bool clMVNLayerForwardS2(
   OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name
@@ -609,7 +613,8 @@ template<typename T> bool clMVNLayerBackward(
   OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name
@@ -690,7 +695,8 @@ template<typename T> bool clMVNLayerBackwardMV2(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(data2D_height, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name
@@ -773,7 +779,8 @@ template<typename T> bool clMVNLayerBackwardS1(
   OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name
@@ -867,7 +874,8 @@ template<typename T> bool clMVNLayerForward_perf(
 
   std::string function = __func__;
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name
@@ -964,7 +972,8 @@ template<typename T> bool clMVNLayerBackward_perf(
   OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name
@@ -1011,6 +1020,162 @@ template bool clMVNLayerBackward_perf<double>(
     const double eps,
     double* data2D_out);
 
+template<typename T> bool clMVNLayerForwardNormalize(
+    const int count,
+    const int width,
+    const T* bottom_data,
+    const T* mean,
+    const T* sq_mean,
+    const T eps,
+    T* top_data) {
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+  std::string kernel_name = clGetKernelName<T>("MVNLayerForwardNormalize");
+  cl_command_queue* queue = current_device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR)<< current_device.name()
+    << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = current_device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, count, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, width, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bottom_data, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&mean, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&sq_mean, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, eps, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&top_data, kernel)
+
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name
+               << "' on GPU " << current_device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << current_device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clMVNLayerForwardNormalize<float>(
+    const int count,
+    const int width,
+    const float* bottom_data,
+    const float* mean,
+    const float* sq_mean,
+    const float eps,
+    float* top_data);
+template bool clMVNLayerForwardNormalize<double>(
+    const int count,
+    const int width,
+    const double* bottom_data,
+    const double* mean,
+    const double* sq_mean,
+    const double eps,
+    double* top_data);
+
+template<typename T> bool clMVNLayerBackwardNormalize(
+    const int count,
+    const int width,
+    const T* top_data,
+    const T* top_diff,
+    const T* sum_diff,
+    const T* sum_top_diff,
+    const T* mean,
+    const T* sq_mean,
+    const T eps,
+    T* bottom_diff) {
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+  std::string kernel_name = clGetKernelName<T>("MVNLayerBackwardNormalize");
+  cl_command_queue* queue = current_device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR)<< current_device.name()
+    << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = current_device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, count, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, width, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&top_data, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&top_diff, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&sum_diff, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&sum_top_diff, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&mean, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&sq_mean, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, eps, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bottom_diff, kernel)
+
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name
+               << "' on GPU " << current_device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << current_device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clMVNLayerBackwardNormalize<float>(
+    const int count,
+    const int width,
+    const float* top_data,
+    const float* top_diff,
+    const float* sum_diff,
+    const float* sum_top_diff,
+    const float* mean,
+    const float* sq_mean,
+    const float eps,
+    float* bottom_diff);
+template bool clMVNLayerBackwardNormalize<double>(
+    const int count,
+    const int width,
+    const double* top_data,
+    const double* top_diff,
+    const double* sum_diff,
+    const double* sum_top_diff,
+    const double* mean,
+    const double* sq_mean,
+    const double eps,
+    double* bottom_diff);
+
 }  // namespace OpenCL
 
 template<typename Dtype>
@@ -1045,45 +1210,21 @@ void MVNLayer<Dtype>::Forward_gpu(
   if (this->layer_param_.mvn_param().normalize_variance()) {
     Dtype eps = 1e-10;
 
-    // 1D array [num_pixels]
-    // this step computes the square of all pixel values in bottom layer
-    caffe_gpu_powx(num_pixels, bottom_data, Dtype(2), temp_.mutable_gpu_data());
-    // SNAPSHOT2D("bottom", bottom[0]->cpu_data(), num_ppp, num_parts);
-    // SNAPSHOT2D("squared", temp_.cpu_data(), num_ppp, num_parts);
-
-    // 2D array [num_parts x num_ppp]
-    // this step computes the dot product between each part of bottom layer
-    // and sum_multiplier and normalizes by number of pixels per part
-    caffe_gpu_gemv<Dtype>(
-        CblasNoTrans, num_parts, num_ppp, 1. / num_ppp,
-        bottom_data,
-        sum_multiplier_.gpu_data(),
-        0.,
-        mean_.mutable_gpu_data());
-
-    // SNAPSHOT2D("mean", mean_.cpu_data(), 1, num_parts);
-
-    // 2D array [num_parts x num_ppp]
-    // this step computes the dot product between each part of bottom layer
-    // (squared) and sum_multiplier and normalizes by number of pixels per part
-    caffe_gpu_gemv<Dtype>(
-        CblasNoTrans,
-        num_parts, num_ppp, 1. / num_ppp,
-        temp_.gpu_data(),
-        sum_multiplier_.gpu_data(),
-        0.,
-        variance_.mutable_gpu_data());  // E(X^2)
-    // SNAPSHOT2D("variance", variance_.cpu_data(), 1, num_parts);
+    // the row statistics EX and E(X^2) of the parts in mean_ and variance_
+    BOOL_CHECK(caffe::OpenCL::clrows_sum(num_parts, num_ppp, 1, bottom_data,
+        (const Dtype*) NULL, Dtype(1. / num_ppp), mean_.mutable_gpu_data()));
+    BOOL_CHECK(caffe::OpenCL::clrows_sum(num_parts, num_ppp, 1, bottom_data,
+        bottom_data, Dtype(1. / num_ppp), variance_.mutable_gpu_data()));
 
     /*
      // 1D array [num_parts]
      // this step computes the squre of the mean
      caffe_gpu_powx(mean_.count(), mean_.gpu_data(),
-                    Dtype(2), temp_.mutable_gpu_data());
+                    Dtype(2), temp()->mutable_gpu_data());
 
      // 1D array [num_parts]
      // this step computes the difference between variance and quare of mean vector
-     caffe_gpu_sub(mean_.count(), variance_.gpu_data(), temp_.gpu_data(),
+     caffe_gpu_sub(mean_.count(), variance_.gpu_data(), temp()->gpu_data(),
                    variance_.mutable_gpu_data());
 
      // [num_parts x num_ppp] = [num_parts x 1] * [1 x num_ppp]
@@ -1093,10 +1234,10 @@ void MVNLayer<Dtype>::Forward_gpu(
        mean_.gpu_data(),
        sum_multiplier_.gpu_data(),
        0.,
-       temp_.mutable_gpu_data());
+       temp()->mutable_gpu_data());
 
      // 1D array [num_pixels]
-     caffe_gpu_add(temp_.count(), bottom_data, temp_.gpu_data(), top_data);
+     caffe_gpu_add(bottom[0]->count(), bottom_data, temp()->gpu_data(), top_data);
 
      // 1D array [num_parts]
      // square root of variance
@@ -1114,16 +1255,14 @@ void MVNLayer<Dtype>::Forward_gpu(
        variance_.gpu_data(),
        sum_multiplier_.gpu_data(),
        0.,
-       temp_.mutable_gpu_data());
+       temp()->mutable_gpu_data());
 
      // [num_pixels]
-     caffe_gpu_div(temp_.count(), top_data, temp_.gpu_data(), top_data);
+     caffe_gpu_div(bottom[0]->count(), top_data, temp()->gpu_data(), top_data);
      */
 
-    caffe::OpenCL::clMVNLayerForwardResidual(
-        bottom_data, num_parts, num_ppp, sum_multiplier_.gpu_data(), num_ppp,
-        mean_.gpu_data(), num_parts, variance_.gpu_data(), num_parts, eps,
-        top_data, num_parts, num_ppp);
+    BOOL_CHECK(caffe::OpenCL::clMVNLayerForwardNormalize(num_pixels, num_ppp,
+        bottom_data, mean_.gpu_data(), variance_.gpu_data(), eps, top_data));
 
     /*
     caffe::OpenCL::clMVNLayerForwardMV2(bottom_data, num_parts, num_ppp,
@@ -1145,7 +1284,7 @@ void MVNLayer<Dtype>::Forward_gpu(
                                           num_ppp, bottom_data, bottom_diff,
                                           num_parts, num_ppp,
                                           sum_multiplier_.gpu_data(),
-                                          (Dtype*) temp_.mutable_gpu_data(),
+                                          (Dtype*) temp()->mutable_gpu_data(),
                                           num_ppp, eps, top_data);
                                           */
   } else {
@@ -1162,12 +1301,14 @@ void MVNLayer<Dtype>::Forward_gpu(
          mean_.gpu_data(),
          sum_multiplier_.gpu_data(),
          0.,
-         temp_.mutable_gpu_data());
-     caffe_gpu_add(temp_.count(), bottom_data, temp_.gpu_data(), top_data);
+         temp()->mutable_gpu_data());
+     caffe_gpu_add(bottom[0]->count(), bottom_data, temp()->gpu_data(), top_data);
      */
-    caffe::OpenCL::clMVNLayerForwardS2(bottom_data, num_parts, num_ppp,
-                                       sum_multiplier_.gpu_data(), num_ppp,
-                                       top_data);
+    BOOL_CHECK(caffe::OpenCL::clrows_sum(num_parts, num_ppp, 1, bottom_data,
+        (const Dtype*) NULL, Dtype(1. / num_ppp), mean_.mutable_gpu_data()));
+    BOOL_CHECK(caffe::OpenCL::clMVNLayerForwardNormalize(num_pixels, num_ppp,
+        bottom_data, mean_.gpu_data(), (const Dtype*) NULL, Dtype(0),
+        top_data));
   }
 }
 
@@ -1193,7 +1334,7 @@ void MVNLayer<Dtype>::Backward_gpu(
 
   if (this->layer_param_.mvn_param().normalize_variance()) {
     /*
-     caffe_gpu_mul(temp_.count(), top_data, top_diff, bottom_diff);
+     caffe_gpu_mul(bottom[0]->count(), top_data, top_diff, bottom_diff);
 
      caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1., bottom_diff,
                            sum_multiplier_.gpu_data(), 0.,
@@ -1203,7 +1344,7 @@ void MVNLayer<Dtype>::Backward_gpu(
                            mean_.gpu_data(), sum_multiplier_.gpu_data(), 0.,
                            bottom_diff);
 
-     caffe_gpu_mul(temp_.count(), top_data, bottom_diff, bottom_diff);
+     caffe_gpu_mul(bottom[0]->count(), top_data, bottom_diff, bottom_diff);
 
      caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1., top_diff,
                            sum_multiplier_.gpu_data(), 0.,
@@ -1213,25 +1354,25 @@ void MVNLayer<Dtype>::Backward_gpu(
                            mean_.gpu_data(), sum_multiplier_.gpu_data(), 1.,
                            bottom_diff);
 
-     caffe_gpu_axpby(temp_.count(), Dtype(1), top_diff, Dtype(-1. / dim),
+     caffe_gpu_axpby(bottom[0]->count(), Dtype(1), top_diff, Dtype(-1. / dim),
                      bottom_diff);
 
-     caffe_gpu_powx(temp_.count(), bottom_data, Dtype(2),
-                    temp_.mutable_gpu_data());
+     caffe_gpu_powx(bottom[0]->count(), bottom_data, Dtype(2),
+                    temp()->mutable_gpu_data());
 
      caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1. / dim, bottom_data,
                            sum_multiplier_.gpu_data(), 0.,
                            mean_.mutable_gpu_data());  // EX
 
-     caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1. / dim, temp_.gpu_data(),
+     caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1. / dim, temp()->gpu_data(),
                            sum_multiplier_.gpu_data(), 0.,
                            variance_.mutable_gpu_data());  // E(X^2)
 
      caffe_gpu_powx(mean_.count(), mean_.gpu_data(), Dtype(2),
-                    temp_.mutable_gpu_data());  // (EX)^2
+                    temp()->mutable_gpu_data());  // (EX)^2
 
      caffe_gpu_sub(mean_.count(), variance_.gpu_data(),
-                   temp_.gpu_data(), variance_.mutable_gpu_data());  // variance
+                   temp()->gpu_data(), variance_.mutable_gpu_data());  // variance
 
      caffe_gpu_powx(variance_.count(), variance_.gpu_data(), Dtype(0.5),
                     variance_.mutable_gpu_data());
@@ -1240,9 +1381,9 @@ void MVNLayer<Dtype>::Backward_gpu(
 
      caffe_gpu_gemm<Dtype>(CblasNoTrans, CblasNoTrans, num, dim, 1, 1.,
                            variance_.gpu_data(), sum_multiplier_.gpu_data(),
-                           0., temp_.mutable_gpu_data());
+                           0., temp()->mutable_gpu_data());
 
-     caffe_gpu_div(temp_.count(), bottom_diff, temp_.gpu_data(), bottom_diff);
+     caffe_gpu_div(bottom[0]->count(), bottom_diff, temp()->gpu_data(), bottom_diff);
      */
 
     /*
@@ -1271,13 +1412,23 @@ void MVNLayer<Dtype>::Backward_gpu(
                                        num, eps, bottom_diff);
      */
 
-    caffe::OpenCL::clMVNLayerBackward_perf(top_data, top_diff, num, dim,
-                                           bottom_data, bottom_diff, num, dim,
-                                           sum_multiplier_.gpu_data(),
-                                           reinterpret_cast<Dtype*>(temp_.mutable_gpu_data()),  // NOLINT(*)
-                                           dim, eps, bottom_diff);
+    // the row sums of top_diff and top_data * top_diff in temp, the row
+    // statistics of the bottom in mean_ and variance_ as in Forward_gpu.
+    Dtype* sum_diff = temp()->mutable_gpu_data();
+    Dtype* sum_top_diff = temp()->mutable_gpu_diff();
+    BOOL_CHECK(caffe::OpenCL::clrows_sum(num, dim, 1, top_diff,
+        (const Dtype*) NULL, Dtype(1), sum_diff));
+    BOOL_CHECK(caffe::OpenCL::clrows_sum(num, dim, 1, top_data, top_diff,
+        Dtype(1), sum_top_diff));
+    BOOL_CHECK(caffe::OpenCL::clrows_sum(num, dim, 1, bottom_data,
+        (const Dtype*) NULL, Dtype(1. / dim), mean_.mutable_gpu_data()));
+    BOOL_CHECK(caffe::OpenCL::clrows_sum(num, dim, 1, bottom_data,
+        bottom_data, Dtype(1. / dim), variance_.mutable_gpu_data()));
+    BOOL_CHECK(caffe::OpenCL::clMVNLayerBackwardNormalize(
+        bottom[0]->count(), dim, top_data, top_diff, sum_diff, sum_top_diff,
+        mean_.gpu_data(), variance_.gpu_data(), eps, bottom_diff));
   } else {
-    caffe_copy(temp_.count(), top_diff, bottom_diff);
+    caffe_copy(bottom[0]->count(), top_diff, bottom_diff);
   }
 }
 
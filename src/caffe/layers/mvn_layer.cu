@@ -23,17 +23,17 @@ void MVNLayer<Dtype>::Forward_gpu(const vector<Blob<Dtype>*>& bottom,
   if (this->layer_param_.mvn_param().normalize_variance()) {
     // put the squares of bottom into temp_
     caffe_gpu_powx(bottom[0]->count(), bottom_data, Dtype(2),
-        temp_.mutable_gpu_data());
+        temp()->mutable_gpu_data());
 
     // computes variance using var(X) = E(X^2) - (EX)^2
     caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1. / dim, bottom_data,
         sum_multiplier_.gpu_data(), 0., mean_.mutable_gpu_data());  // EX
-    caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1. / dim, temp_.gpu_data(),
+    caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1. / dim, temp()->gpu_data(),
         sum_multiplier_.gpu_data(), 0.,
         variance_.mutable_gpu_data());  // E(X^2)
     caffe_gpu_powx(mean_.count(), mean_.gpu_data(), Dtype(2),
-        temp_.mutable_gpu_data());  // (EX)^2
-    caffe_gpu_sub(mean_.count(), variance_.gpu_data(), temp_.gpu_data(),
+        temp()->mutable_gpu_data());  // (EX)^2
+    caffe_gpu_sub(mean_.count(), variance_.gpu_data(), temp()->gpu_data(),
         variance_.mutable_gpu_data());  // variance
 
     Dtype eps = 1e-10;
@@ -42,9 +42,9 @@ void MVNLayer<Dtype>::Forward_gpu(const vector<Blob<Dtype>*>& bottom,
     // subtract mean
     caffe_gpu_gemm<Dtype>(CblasNoTrans, CblasNoTrans, num, dim, 1, -1.,
             mean_.gpu_data(), sum_multiplier_.gpu_data(), 0.,
-            temp_.mutable_gpu_data());
+            temp()->mutable_gpu_data());
 
-    caffe_gpu_add(temp_.count(), bottom_data, temp_.gpu_data(), top_data);
+    caffe_gpu_add(bottom[0]->count(), bottom_data, temp()->gpu_data(), top_data);
 
     // normalize variance
     caffe_gpu_powx(variance_.count(), variance_.gpu_data(), Dtype(0.5),
@@ -54,9 +54,9 @@ void MVNLayer<Dtype>::Forward_gpu(const vector<Blob<Dtype>*>& bottom,
 
     caffe_gpu_gemm<Dtype>(CblasNoTrans, CblasNoTrans, num, dim, 1, 1.,
           variance_.gpu_data(), sum_multiplier_.gpu_data(), 0.,
-          temp_.mutable_gpu_data());
+          temp()->mutable_gpu_data());
 
-    caffe_gpu_div(temp_.count(), top_data, temp_.gpu_data(), top_data);
+    caffe_gpu_div(bottom[0]->count(), top_data, temp()->gpu_data(), top_data);
   } else {
     caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1. / dim, bottom_data,
             sum_multiplier_.gpu_data(), 0., mean_.mutable_gpu_data());  // EX
@@ -64,9 +64,9 @@ void MVNLayer<Dtype>::Forward_gpu(const vector<Blob<Dtype>*>& bottom,
     // subtract mean
     caffe_gpu_gemm<Dtype>(CblasNoTrans, CblasNoTrans, num, dim, 1, -1.,
             mean_.gpu_data(), sum_multiplier_.gpu_data(), 0.,
-            temp_.mutable_gpu_data());
+            temp()->mutable_gpu_data());
 
-    caffe_gpu_add(temp_.count(), bottom_data, temp_.gpu_data(), top_data);
+    caffe_gpu_add(bottom[0]->count(), bottom_data, temp()->gpu_data(), top_data);
   }
 }
 
@@ -90,13 +90,13 @@ void MVNLayer<Dtype>::Backward_gpu(const vector<Blob<Dtype>*>& top,
   Dtype eps = 1e-10;
 
   if (this->layer_param_.mvn_param().normalize_variance()) {
-    caffe_gpu_mul(temp_.count(), top_data, top_diff, bottom_diff);
+    caffe_gpu_mul(bottom[0]->count(), top_data, top_diff, bottom_diff);
     caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1., bottom_diff,
           sum_multiplier_.gpu_data(), 0., mean_.mutable_gpu_data());
     caffe_gpu_gemm<Dtype>(CblasNoTrans, CblasNoTrans, num, dim, 1, 1.,
           mean_.gpu_data(), sum_multiplier_.gpu_data(), 0.,
           bottom_diff);
-    caffe_gpu_mul(temp_.count(), top_data, bottom_diff, bottom_diff);
+    caffe_gpu_mul(bottom[0]->count(), top_data, bottom_diff, bottom_diff);
 
     caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1., top_diff,
             sum_multiplier_.gpu_data(), 0., mean_.mutable_gpu_data());
@@ -104,22 +104,22 @@ void MVNLayer<Dtype>::Backward_gpu(const vector<Blob<Dtype>*>& top,
             mean_.gpu_data(), sum_multiplier_.gpu_data(), 1.,
             bottom_diff);
 
-    caffe_gpu_axpby(temp_.count(), Dtype(1), top_diff, Dtype(-1. / dim),
+    caffe_gpu_axpby(bottom[0]->count(), Dtype(1), top_diff, Dtype(-1. / dim),
         bottom_diff);
 
     // put the squares of bottom into temp_
-    caffe_gpu_powx(temp_.count(), bottom_data, Dtype(2),
-        temp_.mutable_gpu_data());
+    caffe_gpu_powx(bottom[0]->count(), bottom_data, Dtype(2),
+        temp()->mutable_gpu_data());
 
     // computes variance using var(X) = E(X^2) - (EX)^2
     caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1. / dim, bottom_data,
         sum_multiplier_.gpu_data(), 0., mean_.mutable_gpu_data());  // EX
-    caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1. / dim, temp_.gpu_data(),
+    caffe_gpu_gemv<Dtype>(CblasNoTrans, num, dim, 1. / dim, temp()->gpu_data(),
         sum_multiplier_.gpu_data(), 0.,
         variance_.mutable_gpu_data());  // E(X^2)
     caffe_gpu_powx(mean_.count(), mean_.gpu_data(), Dtype(2),
-        temp_.mutable_gpu_data());  // (EX)^2
-    caffe_gpu_sub(mean_.count(), variance_.gpu_data(), temp_.gpu_data(),
+        temp()->mutable_gpu_data());  // (EX)^2
+    caffe_gpu_sub(mean_.count(), variance_.gpu_data(), temp()->gpu_data(),
         variance_.mutable_gpu_data());  // variance
 
     // normalize variance
@@ -130,11 +130,11 @@ void MVNLayer<Dtype>::Backward_gpu(const vector<Blob<Dtype>*>& top,
 
     caffe_gpu_gemm<Dtype>(CblasNoTrans, CblasNoTrans, num, dim, 1, 1.,
         variance_.gpu_data(), sum_multiplier_.gpu_data(), 0.,
-        temp_.mutable_gpu_data());
+        temp()->mutable_gpu_data());
 
-    caffe_gpu_div(temp_.count(), bottom_diff, temp_.gpu_data(), bottom_diff);
+    caffe_gpu_div(bottom[0]->count(), bottom_diff, temp()->gpu_data(), bottom_diff);
   } else {
-    caffe_copy(temp_.count(), top_diff, bottom_diff);
+    caffe_copy(bottom[0]->count(), top_diff, bottom_diff);
   }
 }
 
@@ -139,13 +139,17 @@ void PoolingLayer<Dtype>::Reshape(
   // If max pooling, we will initialize the vector index part.
   if (this->layer_param_.pooling_param().pool() ==
       PoolingParameter_PoolMethod_MAX && top.size() == 1) {
-    max_idx_.Reshape(bottom[0]->num(), channels_, pooled_height_,
-        pooled_width_);
+    if (mask_workspace()) {
+      mask_workspace()->ReshapeLike(*top[0]);
+    } else {
+      max_idx_.Reshape(bottom[0]->num(), channels_, pooled_height_,
+          pooled_width_);
+    }
   }
   // If stochastic pooling, we will initialize the random index part.
   if (this->layer_param_.pooling_param().pool() ==
       PoolingParameter_PoolMethod_STOCHASTIC) {
-    rand_idx_.Reshape(bottom[0]->num(), channels_, pooled_height_,
+    rand_idx()->Reshape(bottom[0]->num(), channels_, pooled_height_,
         pooled_width_);
   }
 }
@@ -159,8 +163,10 @@ void PoolingLayer<Dtype>::Forward_cpu(
   const Dtype* bottom_data = bottom[0]->cpu_data();
   Dtype* top_data = top[0]->mutable_cpu_data();
   const int top_count = top[0]->count();
-  // We'll output the mask to top[1] if it's of size >1.
-  const bool use_top_mask = top.size() > 1;
+  // We'll output the mask to top[1] if it's of size >1, or to a scratch blob
+  // if the layer runs no Backward.
+  Blob<Dtype>* top_mask_blob = top.size() > 1 ? top[1] : mask_workspace();
+  const bool use_top_mask = top_mask_blob != NULL;
   int* mask = NULL;  // suppress warnings about uninitalized variables
   Dtype* top_mask = NULL;
   // Different pooling methods. We explicitly do the switch outside the for
@@ -169,7 +175,7 @@ void PoolingLayer<Dtype>::Forward_cpu(
     case PoolingParameter_PoolMethod_MAX:
       // Initialize
       if (use_top_mask) {
-        top_mask = top[1]->mutable_cpu_data();
+        top_mask = top_mask_blob->mutable_cpu_data();
         caffe_set(top_count, Dtype(-1), top_mask);
       } else {
         mask = max_idx_.mutable_cpu_data();
@@ -398,7 +404,7 @@ bool clMaxPoolBackward(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(nthreads, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -507,7 +513,7 @@ bool clAvePoolBackward(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(nthreads, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -610,7 +616,7 @@ bool clStoPoolBackward(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(nthreads, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -741,7 +747,7 @@ bool clMaxPoolForward(
 
   std::string function = __func__;
   err = clEnqueueNDRangeKernel(*queue, *kernel, dim, NULL,
-                               global, local, 0, NULL, NULL);
+                               global, local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -871,7 +877,7 @@ bool clAvePoolForward(
   }
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, dim, NULL,
-                               global, local, 0, NULL, NULL);
+                               global, local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -974,7 +980,7 @@ bool clStoPoolForwardTrain(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(nthreads, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -1073,7 +1079,7 @@ bool clStoPoolForwardTest(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(nthreads, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -1128,14 +1134,16 @@ void PoolingLayer<Dtype>::Forward_gpu(
   const Dtype* bottom_data = bottom[0]->gpu_data();
   Dtype* top_data = top[0]->mutable_gpu_data();
   int count = top[0]->count();
-  // We'll output the mask to top[1] if it's of size >1.
-  const bool use_top_mask = top.size() > 1;
+  // We'll output the mask to top[1] if it's of size >1, or to a scratch blob
+  // if the layer runs no Backward.
+  Blob<Dtype>* top_mask_blob = top.size() > 1 ? top[1] : mask_workspace();
+  const bool use_top_mask = top_mask_blob != NULL;
   int* mask = NULL;
   Dtype* top_mask = NULL;
   switch (this->layer_param_.pooling_param().pool()) {
     case PoolingParameter_PoolMethod_MAX:
       if (use_top_mask) {
-        top_mask = top[1]->mutable_gpu_data();
+        top_mask = top_mask_blob->mutable_gpu_data();
       } else {
         mask = max_idx_.mutable_gpu_data();
       }
@@ -1176,7 +1184,7 @@ void PoolingLayer<Dtype>::Forward_gpu(
     case PoolingParameter_PoolMethod_STOCHASTIC:
       if (this->phase_ == TRAIN) {
         // We need to create the random index as well.
-        caffe_gpu_rng_uniform(count, Dtype(0), Dtype(1), rand_idx_.mutable_gpu_data());  // NOLINT(*)
+        caffe_gpu_rng_uniform(count, Dtype(0), Dtype(1), rand_idx()->mutable_gpu_data());  // NOLINT(*)
         /*
          // NOLINT_NEXT_LINE(whitespace/operators)
          StoPoolForwardTrain<Dtype> << <CAFFE_GET_BLOCKS(count),
@@ -1184,14 +1192,14 @@ void PoolingLayer<Dtype>::Forward_gpu(
          count, bottom_data, bottom[0]->num(), channels_,
          height_, width_, pooled_height_, pooled_width_, kernel_h_,
          kernel_w_, stride_h_, stride_w_,
-         rand_idx_.mutable_gpu_data(), top_data);
+         rand_idx()->mutable_gpu_data(), top_data);
          */
         BOOL_CHECK(
             caffe::OpenCL::clStoPoolForwardTrain(
                 count, bottom_data, bottom[0]->num(),
                 channels_, height_, width_, pooled_height_, pooled_width_,
                 kernel_h_, kernel_w_, stride_h_, stride_w_,
-                rand_idx_.mutable_gpu_data(), top_data));
+                rand_idx()->mutable_gpu_data(), top_data));
       } else {
         /*
          // NOLINT_NEXT_LINE(whitespace/operators)
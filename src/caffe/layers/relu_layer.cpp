@@ -82,7 +82,7 @@ bool clReLULayerForward(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -113,6 +113,76 @@ template bool clReLULayerForward<double>(
     double* top_data,
     double negative_slope);
 
+template<typename T>
+bool clBiasReLUForward(
+    const int count,
+    const int channels,
+    const int spatial_dim,
+    const T* bias,
+    T negative_slope,
+    T* data) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+
+  std::string kernel_name = clGetKernelName<T>("BiasReLUForward");
+
+  if (!queue) {
+    LOG(ERROR)<< device.name() << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, count, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, channels, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, spatial_dim, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bias, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, negative_slope, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&data, kernel)
+
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clBiasReLUForward<float>(
+    const int count,
+    const int channels,
+    const int spatial_dim,
+    const float* bias,
+    float negative_slope,
+    float* data);
+template bool clBiasReLUForward<double>(
+    const int count,
+    const int channels,
+    const int spatial_dim,
+    const double* bias,
+    double negative_slope,
+    double* data);
+
 template<typename T>
 bool clReLULayerBackward(
     const int count,
@@ -146,7 +216,7 @@ bool clReLULayerBackward(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local, CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
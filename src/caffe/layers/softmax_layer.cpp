@@ -30,7 +30,7 @@ void SoftmaxLayer<Dtype>::Reshape(
   inner_num_ = bottom[0]->count(softmax_axis_ + 1);
   vector<int> scale_dims = bottom[0]->shape();
   scale_dims[softmax_axis_] = 1;
-  scale_.Reshape(scale_dims);
+  scale()->Reshape(scale_dims);
 }
 
 template<typename Dtype>
@@ -39,7 +39,7 @@ void SoftmaxLayer<Dtype>::Forward_cpu(
     const vector<Blob<Dtype>*>& top) {
   const Dtype* bottom_data = bottom[0]->cpu_data();
   Dtype* top_data = top[0]->mutable_cpu_data();
-  Dtype* scale_data = scale_.mutable_cpu_data();
+  Dtype* scale_data = scale()->mutable_cpu_data();
   int channels = bottom[0]->shape(softmax_axis_);
   int dim = bottom[0]->count() / outer_num_;
   caffe_copy(bottom[0]->count(), bottom_data, top_data);
@@ -92,7 +92,7 @@ void SoftmaxLayer<Dtype>::Backward_cpu(
   const Dtype* top_diff = top[0]->cpu_diff();
   const Dtype* top_data = top[0]->cpu_data();
   Dtype* bottom_diff = bottom[0]->mutable_cpu_diff();
-  Dtype* scale_data = scale_.mutable_cpu_data();
+  Dtype* scale_data = scale()->mutable_cpu_data();
   int channels = top[0]->shape(softmax_axis_);
   int dim = top[0]->count() / outer_num_;
   caffe_copy(top[0]->count(), top_diff, bottom_diff);
@@ -156,7 +156,8 @@ bool clkernel_channel_max(
       CAFFE_GET_LOCAL_WORKITEMS(num * spatial_dim, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -224,7 +225,8 @@ bool clkernel_channel_subtract(
       CAFFE_GET_LOCAL_WORKITEMS(num * spatial_dim, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -283,7 +285,8 @@ bool clkernel_exp(const int count, const T* data, T* out) {
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -347,7 +350,8 @@ bool clkernel_channel_sum(
       CAFFE_GET_LOCAL_WORKITEMS(num * spatial_dim, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -415,7 +419,8 @@ bool clkernel_channel_div(
   OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -485,7 +490,8 @@ bool clkernel_channel_dot(
   OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -519,6 +525,175 @@ template bool clkernel_channel_dot<double>(
     const double* data_1,
     const double* data_2,
     double* channel_dot);
+template<typename T>
+bool clSoftmaxForward(
+    const int num,
+    const int channels,
+    const int spatial_dim,
+    const T* bottom,
+    T* top,
+    const T* label,
+    const bool has_ignore_label,
+    const int ignore_label,
+    T* loss,
+    T* counts) {
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+  std::string kernel_name = clGetKernelName<T>("SoftmaxForward");
+
+  cl_command_queue* queue = current_device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << current_device.name()
+               << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = current_device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  int group_per_row;
+  size_t global;
+  size_t local;
+  clrows_work_items(num * spatial_dim, channels, &group_per_row, &global,
+                    &local);
+  const int ignore = has_ignore_label ? 1 : 0;
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, num, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, channels, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, spatial_dim, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, group_per_row, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bottom, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&top, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&label, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, ignore, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, ignore_label, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&loss, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&counts, kernel)
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << current_device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << current_device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clSoftmaxForward<float>(
+    const int num,
+    const int channels,
+    const int spatial_dim,
+    const float* bottom,
+    float* top,
+    const float* label,
+    const bool has_ignore_label,
+    const int ignore_label,
+    float* loss,
+    float* counts);
+template bool clSoftmaxForward<double>(
+    const int num,
+    const int channels,
+    const int spatial_dim,
+    const double* bottom,
+    double* top,
+    const double* label,
+    const bool has_ignore_label,
+    const int ignore_label,
+    double* loss,
+    double* counts);
+
+template<typename T>
+bool clSoftmaxBackward(
+    const int num,
+    const int channels,
+    const int spatial_dim,
+    const T* top_data,
+    const T* top_diff,
+    T* bottom_diff) {
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+  std::string kernel_name = clGetKernelName<T>("SoftmaxBackward");
+
+  cl_command_queue* queue = current_device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << current_device.name()
+               << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = current_device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  int group_per_row;
+  size_t global;
+  size_t local;
+  clrows_work_items(num * spatial_dim, channels, &group_per_row, &global,
+                    &local);
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, num, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, channels, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, spatial_dim, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, group_per_row, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&top_data, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&top_diff, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bottom_diff, kernel)
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << current_device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << current_device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clSoftmaxBackward<float>(
+    const int num,
+    const int channels,
+    const int spatial_dim,
+    const float* top_data,
+    const float* top_diff,
+    float* bottom_diff);
+template bool clSoftmaxBackward<double>(
+    const int num,
+    const int channels,
+    const int spatial_dim,
+    const double* top_data,
+    const double* top_diff,
+    double* bottom_diff);
+
 }  // namespace OpenCL
 
 template<typename Dtype>
@@ -527,11 +702,9 @@ void SoftmaxLayer<Dtype>::Forward_gpu(
     const vector<Blob<Dtype>*>& top) {
   const Dtype* bottom_data = bottom[0]->gpu_data();
   Dtype* top_data = (top)[0]->mutable_gpu_data();
-  Dtype* scale_data = scale_.mutable_gpu_data();
   int num = bottom[0]->num();
   int channels = bottom[0]->channels();
   int spatial_dim = bottom[0]->height() * bottom[0]->width();
-  caffe_copy(bottom[0]->count(), bottom_data, top_data);
 
   // We need to subtract the max to avoid numerical issues, compute the exp,
   // and then normalize.
@@ -564,26 +737,14 @@ void SoftmaxLayer<Dtype>::Forward_gpu(
    scale_data);
    */
 
+  // a single kernel finds the max and the sum of exp of each row of channels
+  // elements, spatial_dim apart, and normalizes it, see softmax_layer.cl.
   TIME("SoftmaxLayer<Dtype>::Forward_gpu", {
       BOOL_CHECK(
-          caffe::OpenCL::clkernel_channel_max(num, channels, spatial_dim,
-                                              top_data, scale_data) );
-      // subtract
-      BOOL_CHECK(
-          caffe::OpenCL::clkernel_channel_subtract(num, channels, spatial_dim,
-                                                   top_data, scale_data) );
-      // exponentiate
-      BOOL_CHECK(
-          caffe::OpenCL::clkernel_exp(num * channels * spatial_dim,
-                                      top_data, top_data) );
-      // sum after exp
-      BOOL_CHECK(
-          caffe::OpenCL::clkernel_channel_sum(num, channels, spatial_dim,
-                                              top_data, scale_data) );
-      // divide
-      BOOL_CHECK(
-          caffe::OpenCL::clkernel_channel_div(num, channels, spatial_dim,
-                                              top_data, scale_data) );
+          caffe::OpenCL::clSoftmaxForward(num, channels, spatial_dim,
+                                          bottom_data, top_data,
+                                          (const Dtype*) NULL, false, -1,
+                                          (Dtype*) NULL, (Dtype*) NULL) );
   });
 }
 
@@ -595,11 +756,9 @@ void SoftmaxLayer<Dtype>::Backward_gpu(
   const Dtype* top_diff = top[0]->gpu_diff();
   const Dtype* top_data = top[0]->gpu_data();
   Dtype* bottom_diff = (bottom)[0]->mutable_gpu_diff();
-  Dtype* scale_data = scale_.mutable_gpu_data();
   int num = top[0]->num();
   int channels = top[0]->channels();
   int spatial_dim = top[0]->height() * top[0]->width();
-  caffe_copy(top[0]->count(), top_diff, bottom_diff);
   // Compute inner1d(top_diff, top_data) and subtract them from the bottom diff.
   // NOLINT_NEXT_LINE(whitespace/operators)
   /*
@@ -616,12 +775,8 @@ void SoftmaxLayer<Dtype>::Backward_gpu(
 
   TIME("SoftmaxLayer<Dtype>::Backward_gpu", {
       BOOL_CHECK(
-          caffe::OpenCL::clkernel_channel_dot(num, channels, spatial_dim,
-                                              top_diff, top_data, scale_data) );
-      BOOL_CHECK(
-          caffe::OpenCL::clkernel_channel_subtract(num, channels, spatial_dim,
-                                                   bottom_diff, scale_data) );
-      caffe_gpu_mul<Dtype>(top[0]->count(), bottom_diff, top_data, bottom_diff);
+          caffe::OpenCL::clSoftmaxBackward(num, channels, spatial_dim,
+                                           top_data, top_diff, bottom_diff) );
   });
 }
 
@@ -1,6 +1,7 @@
 #if defined(USE_OPENCL)
 #include <caffe/util/OpenCL/definitions.hpp>
 #include <caffe/util/OpenCL/OpenCLDevice.hpp>
+#include <caffe/util/OpenCL/softmax_layer.hpp>
 #include <caffe/util/OpenCL/softmax_loss_layer.hpp>
 #endif
 
@@ -181,7 +182,8 @@ bool clSoftmaxLossForwardGPU(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(nthreads, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR)<< "Failed to enqueue kernel '" << kernel_name
     << "' on GPU " << current_device.name()
@@ -264,7 +266,8 @@ bool clSoftmaxLossBackwardGPU(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(nthreads, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR)<< "Failed to enqueue kernel '" << kernel_name
     << "' on GPU " << current_device.name()
@@ -308,8 +311,6 @@ template<typename Dtype>
 void SoftmaxWithLossLayer<Dtype>::Forward_gpu(
     const vector<Blob<Dtype>*>& bottom,
     const vector<Blob<Dtype>*>& top) {
-  softmax_layer_->Forward(softmax_bottom_vec_, softmax_top_vec_);
-  const Dtype* prob_data = prob_.gpu_data();
   const Dtype* label = bottom[1]->gpu_data();
   const int dim = prob_.count() / outer_num_;
   const int nthreads = outer_num_ * inner_num_;
@@ -327,21 +328,18 @@ void SoftmaxWithLossLayer<Dtype>::Forward_gpu(
    CAFFE_CUDA_NUM_THREADS>>>(nthreads, prob_data, label, loss_data,
    outer_num_, dim, inner_num_, has_ignore_label_, ignore_label_, counts);
    */
+  // the softmax of every row and its loss come out of a single kernel,
+  // instead of the softmax layer followed by SoftmaxLossForwardGPU.
   BOOL_CHECK(
-      caffe::OpenCL::clSoftmaxLossForwardGPU(nthreads, prob_data, label,
-          loss_data, outer_num_, dim, inner_num_, has_ignore_label_,
-          ignore_label_, counts));
-
-  Dtype loss;
-  caffe_gpu_asum(nthreads, loss_data, &loss);
-  if (normalize_) {
-    Dtype count;
-    caffe_gpu_asum(nthreads, counts, &count);
-    loss /= count;
-  } else {
-    loss /= outer_num_;
-  }
-  top[0]->mutable_cpu_data()[0] = loss;
+      caffe::OpenCL::clSoftmaxForward(outer_num_, dim / inner_num_,
+          inner_num_, bottom[0]->gpu_data(), prob_.mutable_gpu_data(), label,
+          has_ignore_label_, ignore_label_, loss_data, counts));
+
+  // the normalized loss is reduced into top[0] on the device, without
+  // waiting for the sums of loss_data and counts.
+  caffe_gpu_dot_device<Dtype>(nthreads, loss_data, NULL,
+      normalize_ ? counts : NULL, normalize_ ? Dtype(1) : Dtype(1) / outer_num_,
+      top[0]->mutable_gpu_data(), 0);
   if (top.size() == 2) {
     top[1]->ShareData(prob_);
   }
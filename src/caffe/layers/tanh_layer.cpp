@@ -96,9 +96,7 @@ bool clTanHLayerForward(const int count, const T* bottom_data, T* top_data) {
       NULL,
       &global,
       &local,
-      0,
-      NULL,
-      NULL);
+      CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -179,9 +177,7 @@ bool clTanHLayerBackward(
       NULL,
       &global,
       &local,
-      0,
-      NULL,
-      NULL);
+      CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -39,6 +39,13 @@ void Net<Dtype>::Init(const NetParameter& in_param) {
   FilterNet(in_param, &filtered_param);
   LOG(INFO) << "Initializing net from parameters: " << std::endl
             << filtered_param.DebugString();
+  // Fold the activations of a TEST net into the layers computing their
+  // inputs.
+  if (phase_ == TEST && filtered_param.fuse_layers()) {
+    NetParameter fused_param;
+    FuseLayers(filtered_param, &fused_param);
+    filtered_param.Swap(&fused_param);
+  }
   // Create a copy of filtered_param with splits added where necessary.
   NetParameter param;
   InsertSplits(filtered_param, &param);
@@ -213,10 +220,240 @@ void Net<Dtype>::Init(const NetParameter& in_param) {
   }
   GetLearningRateAndWeightDecay();
   debug_info_ = param.debug_info();
+#ifdef USE_OPENCL
+  scheduler_.Init(bottom_id_vecs_, top_id_vecs_, blobs_.size());
+  device_loss_slots_ = 0;
+  device_loss_slot_ = 0;
+  device_loss_filled_ = 0;
+  device_loss_offsets_.clear();
+  for (int i = 0, offset = 0; i < layers_.size(); ++i) {
+    device_loss_offsets_.push_back(offset);
+    offset += top_vecs_[i].size();
+  }
+#endif
+  // the scheduler tracks the shared memory after PlanMemory, which may
+  // change the queues the layers run on.
+  PlanMemory(param);
+  workspace_memory_used_ = 0;
+  ShareWorkspaces();
   LOG(INFO) << "Network initialization done.";
   LOG(INFO) << "Memory required for data: " << memory_used_ * sizeof(Dtype);
 }
 
+template <typename Dtype>
+void Net<Dtype>::ShareWorkspaces() {
+  vector<int> arena_ids;
+  WorkspaceArenaIds(&arena_ids);
+  map<int, shared_ptr<WorkspaceArena<Dtype> > > arenas;
+  size_t workspace_used = 0;
+  size_t arena_used = 0;
+  for (int layer_id = 0; layer_id < layers_.size(); ++layer_id) {
+    shared_ptr<WorkspaceArena<Dtype> >& arena = arenas[arena_ids[layer_id]];
+    if (!arena) {
+      arena.reset(new WorkspaceArena<Dtype>());
+    }
+    // the layer takes its scratch blobs from the arena in Reshape.
+    arena_used -= arena->capacity();
+    arena->Clear();
+    layers_[layer_id]->set_workspace_arena(arena,
+                                           !layer_need_backward_[layer_id]);
+    layers_[layer_id]->Reshape(bottom_vecs_[layer_id], top_vecs_[layer_id]);
+    workspace_used += arena->count();
+    arena_used += arena->capacity();
+  }
+  if (workspace_used > 0) {
+    LOG(INFO) << "Memory required for workspace arenas: "
+              << arena_used * sizeof(Dtype) << " in " << arenas.size()
+              << " arenas, instead of " << workspace_used * sizeof(Dtype);
+  }
+  memory_used_ += arena_used - workspace_memory_used_;
+  workspace_memory_used_ = arena_used;
+  workspace_arena_ids_.swap(arena_ids);
+}
+
+template <typename Dtype>
+void Net<Dtype>::WorkspaceArenaIds(vector<int>* arena_ids) {
+  // Without the scheduler all layers run one after another.
+  arena_ids->assign(layers_.size(), 0);
+#ifdef USE_OPENCL
+  if (Caffe::mode() == Caffe::GPU && scheduler_.enabled()) {
+    for (int layer_id = 0; layer_id < layers_.size(); ++layer_id) {
+      (*arena_ids)[layer_id] = scheduler_.getSerialIdx(layer_id);
+    }
+  }
+#endif
+}
+
+template <typename Dtype>
+void Net<Dtype>::PlanMemory(const NetParameter& param) {
+  memory_groups_.clear();
+  memory_group_lifetimes_.clear();
+  if (!param.optimize_memory()) {
+    return;
+  }
+  // Backward reads the data of the blobs after the forward pass.
+  if (phase_ != TEST || std::find(layer_need_backward_.begin(),
+      layer_need_backward_.end(), true) != layer_need_backward_.end()) {
+    LOG(INFO) << "Not optimizing memory of a net that runs Backward.";
+    return;
+  }
+  const int num_layers = layers_.size();
+  vector<bool> keep(blobs_.size(), false);
+  for (int i = 0; i < net_input_blob_indices_.size(); ++i) {
+    keep[net_input_blob_indices_[i]] = true;
+  }
+  for (int i = 0; i < net_output_blob_indices_.size(); ++i) {
+    keep[net_output_blob_indices_[i]] = true;
+  }
+  for (int i = 0; i < param.keep_blob_size(); ++i) {
+    CHECK(has_blob(param.keep_blob(i))) << "Unknown blob "
+        << param.keep_blob(i) << " to keep";
+    keep[blob_names_index_[param.keep_blob(i)]] = true;
+  }
+  // data layers may point their tops to memory of their own.
+  for (int layer_id = 0; layer_id < num_layers; ++layer_id) {
+    if (bottom_id_vecs_[layer_id].empty()) {
+      for (int i = 0; i < top_id_vecs_[layer_id].size(); ++i) {
+        keep[top_id_vecs_[layer_id][i]] = true;
+      }
+    }
+  }
+  // blobs that share their data after SetUp, e.g. the tops of a split layer
+  // and its bottom, are alive together.
+  map<SyncedMemory*, int> group_index;
+  vector<int> blob_group(blobs_.size());
+  vector<bool> group_keep;
+  for (int blob_id = 0; blob_id < blobs_.size(); ++blob_id) {
+    SyncedMemory* data = blobs_[blob_id]->data().get();
+    if (group_index.find(data) == group_index.end()) {
+      group_index[data] = memory_groups_.size();
+      memory_groups_.push_back(vector<int>());
+      memory_group_lifetimes_.push_back(make_pair(num_layers, -1));
+      group_keep.push_back(false);
+    }
+    const int group = group_index[data];
+    blob_group[blob_id] = group;
+    memory_groups_[group].push_back(blob_id);
+    group_keep[group] = group_keep[group] || keep[blob_id];
+  }
+  for (int layer_id = 0; layer_id < num_layers; ++layer_id) {
+    for (int i = 0; i < top_id_vecs_[layer_id].size(); ++i) {
+      pair<int, int>& lifetime =
+          memory_group_lifetimes_[blob_group[top_id_vecs_[layer_id][i]]];
+      lifetime.first = std::min(lifetime.first, layer_id);
+      lifetime.second = std::max(lifetime.second, layer_id);
+    }
+    for (int i = 0; i < bottom_id_vecs_[layer_id].size(); ++i) {
+      pair<int, int>& lifetime =
+          memory_group_lifetimes_[blob_group[bottom_id_vecs_[layer_id][i]]];
+      lifetime.second = std::max(lifetime.second, layer_id);
+    }
+  }
+  // drop the groups that keep their memory.
+  int num_groups = 0;
+  for (int group = 0; group < memory_groups_.size(); ++group) {
+    if (!group_keep[group]) {
+      memory_groups_[num_groups] = memory_groups_[group];
+      memory_group_lifetimes_[num_groups] = memory_group_lifetimes_[group];
+      ++num_groups;
+    }
+  }
+  memory_groups_.resize(num_groups);
+  memory_group_lifetimes_.resize(num_groups);
+  ShareMemory();
+}
+
+template <typename Dtype>
+void Net<Dtype>::ShareMemory() {
+  if (memory_groups_.empty()) {
+    return;
+  }
+  // Greedy interval coloring: in the order of their first layer, the groups
+  // take the storage of a group that is dead by then, preferring the
+  // smallest storage that is large enough and growing the largest one
+  // otherwise.
+  const int num_groups = memory_groups_.size();
+  vector<pair<int, int> > order(num_groups);
+  vector<size_t> group_count(num_groups, 0);
+  for (int group = 0; group < num_groups; ++group) {
+    for (int i = 0; i < memory_groups_[group].size(); ++i) {
+      group_count[group] = std::max(group_count[group],
+          static_cast<size_t>(blobs_[memory_groups_[group][i]]->count()));
+    }
+    order[group] = make_pair(memory_group_lifetimes_[group].first, group);
+  }
+  std::sort(order.begin(), order.end());
+  vector<size_t> storage_count;
+  vector<int> storage_end;
+  vector<int> group_storage(num_groups);
+  size_t unshared_count = 0;
+  for (int i = 0; i < num_groups; ++i) {
+    const int group = order[i].second;
+    const size_t count = group_count[group];
+    unshared_count += count;
+    int best = -1;
+    for (int j = 0; j < storage_count.size(); ++j) {
+      if (storage_end[j] >= memory_group_lifetimes_[group].first) {
+        continue;
+      }
+      if (best < 0) {
+        best = j;
+      } else if (storage_count[best] >= count) {
+        if (storage_count[j] >= count &&
+            storage_count[j] < storage_count[best]) {
+          best = j;
+        }
+      } else if (storage_count[j] > storage_count[best]) {
+        best = j;
+      }
+    }
+    if (best < 0) {
+      best = storage_count.size();
+      storage_count.push_back(0);
+      storage_end.push_back(-1);
+    }
+    storage_count[best] = std::max(storage_count[best], count);
+    storage_end[best] = memory_group_lifetimes_[group].second;
+    group_storage[group] = best;
+  }
+  size_t shared_count = 0;
+  vector<shared_ptr<SyncedMemory> > storage(storage_count.size());
+  for (int i = 0; i < storage.size(); ++i) {
+    storage[i].reset(new SyncedMemory(storage_count[i] * sizeof(Dtype)));
+    shared_count += storage_count[i];
+  }
+  vector<int> blob_storage(blobs_.size(), -1);
+  for (int group = 0; group < num_groups; ++group) {
+    for (int i = 0; i < memory_groups_[group].size(); ++i) {
+      const int blob_id = memory_groups_[group][i];
+      blobs_[blob_id]->ShareDataStorage(storage[group_storage[group]]);
+      blob_storage[blob_id] = group_storage[group];
+    }
+  }
+  LOG(INFO) << "Memory required for shared blobs: "
+            << shared_count * sizeof(Dtype) << " in " << storage.size()
+            << " buffers, instead of " << unshared_count * sizeof(Dtype);
+#ifdef USE_OPENCL
+  // the layers must also wait for the last layer reading the memory they
+  // overwrite, so the scheduler tracks the storage instead of the blobs.
+  const int num_storage = storage.size();
+  vector<vector<int> > bottom_storage_ids(bottom_id_vecs_);
+  vector<vector<int> > top_storage_ids(top_id_vecs_);
+  for (int layer_id = 0; layer_id < layers_.size(); ++layer_id) {
+    for (int i = 0; i < bottom_storage_ids[layer_id].size(); ++i) {
+      int& id = bottom_storage_ids[layer_id][i];
+      id = blob_storage[id] >= 0 ? blob_storage[id] : num_storage + id;
+    }
+    for (int i = 0; i < top_storage_ids[layer_id].size(); ++i) {
+      int& id = top_storage_ids[layer_id][i];
+      id = blob_storage[id] >= 0 ? blob_storage[id] : num_storage + id;
+    }
+  }
+  scheduler_.Init(bottom_storage_ids, top_storage_ids,
+                  num_storage + blobs_.size());
+#endif
+}
+
 template <typename Dtype>
 void Net<Dtype>::FilterNet(const NetParameter& param,
     NetParameter* param_filtered) {
@@ -247,6 +484,105 @@ void Net<Dtype>::FilterNet(const NetParameter& param,
   }
 }
 
+template <typename Dtype>
+void Net<Dtype>::FuseLayers(const NetParameter& param,
+    NetParameter* param_fused) {
+  param_fused->CopyFrom(param);
+#if defined(USE_CUDA) && !defined(USE_OPENCL)
+  // the CUDA Forward_gpu of the layers applies neither fused_relu nor
+  // fused_pooling.
+  LOG(WARNING) << "Not fusing the layers of " << param.name()
+               << ", the CUDA layers do not support it.";
+  return;
+#endif
+  param_fused->clear_layer();
+  // per blob name, the index into param_fused of the layer that wrote it
+  // last and whether a layer read it since.
+  map<string, int> writer;
+  map<string, bool> read;
+  for (int i = 0; i < param.layer_size(); ++i) {
+    const LayerParameter& layer_param = param.layer(i);
+    const bool relu = layer_param.type() == "ReLU";
+    // only max pooling without a mask top folds into a Convolution layer.
+    const bool pooling = layer_param.type() == "Pooling" &&
+        layer_param.pooling_param().pool() == PoolingParameter_PoolMethod_MAX;
+    int producer = -1;
+    if ((relu || pooling) && layer_param.bottom_size() == 1 &&
+        layer_param.top_size() == 1 && layer_param.loss_weight_size() == 0 &&
+        writer.count(layer_param.bottom(0)) &&
+        !read[layer_param.bottom(0)]) {
+      producer = writer[layer_param.bottom(0)];
+    }
+    bool fuse = false;
+    if (producer >= 0) {
+      const LayerParameter& producer_param = param_fused->layer(producer);
+      const string& type = producer_param.type();
+      fuse = producer_param.top_size() == 1 &&
+          producer_param.loss_weight_size() == 0 &&
+          !producer_param.fused_pooling();
+      if (relu) {
+        fuse = fuse && (type == "Convolution" || type == "InnerProduct" ||
+            type == "Eltwise") && !producer_param.fused_relu();
+      } else {
+        fuse = fuse && type == "Convolution";
+      }
+#ifdef USE_CUDNN
+      // the cuDNN layers do not apply the activation.
+      const ConvolutionParameter_Engine engine =
+          producer_param.convolution_param().engine();
+      if (type == "Convolution" &&
+          (engine == ConvolutionParameter_Engine_DEFAULT ||
+           engine == ConvolutionParameter_Engine_CUDNN)) {
+        fuse = false;
+      }
+#endif
+    }
+    // without the ReLU in place, nothing else may read its input.
+    const string bottom = fuse ? layer_param.bottom(0) : "";
+    for (int j = i + 1; fuse && bottom != layer_param.top(0) &&
+         j < param.layer_size(); ++j) {
+      const LayerParameter& next_param = param.layer(j);
+      for (int k = 0; k < next_param.bottom_size(); ++k) {
+        fuse = fuse && next_param.bottom(k) != bottom;
+      }
+      bool rewritten = false;
+      for (int k = 0; k < next_param.top_size(); ++k) {
+        rewritten = rewritten || next_param.top(k) == bottom;
+      }
+      if (rewritten) {
+        break;
+      }
+    }
+    if (fuse) {
+      LayerParameter* producer_param = param_fused->mutable_layer(producer);
+      LOG(INFO) << "Fusing " << layer_param.name() << " into "
+                << producer_param->name();
+      if (relu) {
+        producer_param->set_fused_relu(true);
+        producer_param->mutable_relu_param()->CopyFrom(
+            layer_param.relu_param());
+      } else {
+        producer_param->set_fused_pooling(true);
+        producer_param->mutable_pooling_param()->CopyFrom(
+            layer_param.pooling_param());
+      }
+      producer_param->set_top(0, layer_param.top(0));
+      writer.erase(bottom);
+      writer[layer_param.top(0)] = producer;
+      read[layer_param.top(0)] = false;
+      continue;
+    }
+    for (int j = 0; j < layer_param.bottom_size(); ++j) {
+      read[layer_param.bottom(j)] = true;
+    }
+    for (int j = 0; j < layer_param.top_size(); ++j) {
+      writer[layer_param.top(j)] = param_fused->layer_size();
+      read[layer_param.top(j)] = false;
+    }
+    param_fused->add_layer()->CopyFrom(layer_param);
+  }
+}
+
 template <typename Dtype>
 bool Net<Dtype>::StateMeetsRule(const NetState& state,
     const NetStateRule& rule, const string& layer_name) {
@@ -467,16 +803,85 @@ Dtype Net<Dtype>::ForwardFromTo(int start, int end) {
       InputDebugInfo(i);
     }
   }
+#ifdef USE_OPENCL
+  // independent layers run on separate command queues, which are joined
+  // into the default queue again before returning.
+  const bool schedule = Caffe::mode() == Caffe::GPU && scheduler_.enabled();
+  // a forward of the whole net leaves its layer losses in the next row of
+  // device_loss_, see set_device_loss_slots().
+  const bool device_loss = device_loss_slots_ > 0
+      && Caffe::mode() == Caffe::GPU && start == 0 && end == layers_.size() - 1;
+  Dtype* device_loss_row = NULL;
+  if (device_loss) {
+    device_loss_row = device_loss_.mutable_gpu_data()
+        + device_loss_slot_ * device_loss_.count(1);
+  }
+  // the command queues of the device may have changed since the layers got
+  // their workspace arenas.
+  vector<int> arena_ids;
+  WorkspaceArenaIds(&arena_ids);
+  if (arena_ids != workspace_arena_ids_) {
+    ShareWorkspaces();
+  }
+#endif
   for (int i = start; i <= end; ++i) {
     // LOG(ERROR) << "Forwarding " << layer_names_[i];
+#ifdef USE_OPENCL
+    if (schedule) { CHECK(scheduler_.BeginLayer(i)); }
+    layers_[i]->set_device_loss(device_loss_row, device_loss_offsets_[i]);
+#endif
     layers_[i]->Reshape(bottom_vecs_[i], top_vecs_[i]);
     Dtype layer_loss = layers_[i]->Forward(bottom_vecs_[i], top_vecs_[i]);
     loss += layer_loss;
+#ifdef USE_OPENCL
+    if (schedule) { CHECK(scheduler_.EndLayer(i)); }
+#endif
     if (debug_info_) { ForwardDebugInfo(i); }
   }
+#ifdef USE_OPENCL
+  if (schedule) { CHECK(scheduler_.Join()); }
+  if (device_loss) {
+    device_loss_slot_ = (device_loss_slot_ + 1) % device_loss_slots_;
+    device_loss_filled_ = std::min(device_loss_filled_ + 1, device_loss_slots_);
+  }
+#endif
   return loss;
 }
 
+#ifdef USE_OPENCL
+template <typename Dtype>
+void Net<Dtype>::set_device_loss_slots(int slots) {
+  CHECK_GE(slots, 0);
+  device_loss_slots_ = slots;
+  device_loss_slot_ = 0;
+  device_loss_filled_ = 0;
+  if (slots == 0) {
+    return;
+  }
+  int tops = 0;
+  for (int i = 0; i < top_vecs_.size(); ++i) {
+    tops += top_vecs_[i].size();
+  }
+  device_loss_.Reshape(slots, std::max(tops, 1), 1, 1);
+  caffe_gpu_set(device_loss_.count(), Dtype(0),
+                device_loss_.mutable_gpu_data());
+}
+
+template <typename Dtype>
+Dtype Net<Dtype>::DeviceLoss() {
+  if (device_loss_filled_ == 0) {
+    return 0;
+  }
+  // the rows not filled yet are 0.
+  const Dtype* data = device_loss_.cpu_data();
+  Dtype loss = 0;
+  for (int i = 0; i < device_loss_.count(); ++i) {
+    loss += data[i];
+  }
+  return loss / device_loss_filled_;
+}
+#endif
+
 template <typename Dtype>
 Dtype Net<Dtype>::ForwardFrom(int start) {
   return ForwardFromTo(start, layers_.size() - 1);
@@ -681,6 +1086,7 @@ void Net<Dtype>::Reshape() {
   for (int i = 0; i < layers_.size(); ++i) {
     layers_[i]->Reshape(bottom_vecs_[i], top_vecs_[i]);
   }
+  ShareMemory();
 }
 
 template <typename Dtype>
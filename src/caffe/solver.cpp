@@ -168,6 +168,15 @@ void Solver<Dtype>::Step(int iters) {
   int average_loss = this->param_.average_loss();
   vector<Dtype> losses;
   Dtype smoothed_loss = 0;
+  bool device_loss = false;
+#ifdef USE_OPENCL
+  // on the GPU the losses of the last average_loss iterations stay on the
+  // device, they are only read back to be displayed.
+  device_loss = Caffe::mode() == Caffe::GPU;
+  if (device_loss) {
+    net_->set_device_loss_slots(average_loss);
+  }
+#endif
 
   for (; iter_ < stop_iter; ++iter_) {
     DLOG(INFO) << "current iteration = " << iter_;
@@ -182,7 +191,9 @@ void Solver<Dtype>::Step(int iters) {
     TIME("ForwardBackward()", {
         loss = net_->ForwardBackward(bottom_vec);
     });
-    if (losses.size() < average_loss) {
+    if (device_loss) {
+      // read back below, if displayed.
+    } else if (losses.size() < average_loss) {
       losses.push_back(loss);
       int size = losses.size();
       smoothed_loss = (smoothed_loss * (size - 1) + loss) / size;
@@ -192,6 +203,11 @@ void Solver<Dtype>::Step(int iters) {
       losses[idx] = loss;
     }
     if (display) {
+#ifdef USE_OPENCL
+      if (device_loss) {
+        smoothed_loss = net_->DeviceLoss();
+      }
+#endif
       LOG(INFO) << "Iteration "
                << iter_ << ", loss = " << smoothed_loss;
       const vector<Blob<Dtype>*>& result = net_->output_blobs();
@@ -226,6 +242,11 @@ void Solver<Dtype>::Step(int iters) {
       Snapshot();
     }
   }
+#ifdef USE_OPENCL
+  if (device_loss) {
+    net_->set_device_loss_slots(0);
+  }
+#endif
 }
 
 template <typename Dtype>
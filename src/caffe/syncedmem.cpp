@@ -13,8 +13,15 @@
 namespace caffe {
 
 SyncedMemory::~SyncedMemory() {
+#ifdef USE_OPENCL
+  // an asynchronous upload might still read from the host memory.
+  if (gpu_ptr_) {
+    BOOL_CHECK(caffe::OpenCL::clWaitForTransfer(gpu_ptr_));
+  }
+#endif
+
   if (cpu_ptr_ && own_cpu_data_) {
-    CaffeFreeHost(cpu_ptr_);
+    free_host();
   }
 
 #ifdef USE_CUDA
@@ -32,13 +39,77 @@ SyncedMemory::~SyncedMemory() {
 #endif
 }
 
+void SyncedMemory::malloc_host() {
+#ifdef USE_OPENCL
+  // page-locked memory lets the device transfer from and to the host
+  // memory directly, the OpenCL device decides whether it's used.
+  if (Caffe::mode() == Caffe::GPU
+      && caffe::OpenCL::clMallocHost(&cpu_ptr_, size_)) {
+    cpu_pinned_ = true;
+    return;
+  }
+#endif
+  CaffeMallocHost(&cpu_ptr_, size_);
+  cpu_pinned_ = false;
+}
+
+void SyncedMemory::free_host() {
+#ifdef USE_OPENCL
+  if (zero_copy_) {
+    unmap_host();
+    return;
+  }
+  if (cpu_pinned_) {
+    BOOL_CHECK(caffe::OpenCL::clFreeHost(cpu_ptr_));
+    cpu_pinned_ = false;
+    return;
+  }
+#endif
+  CaffeFreeHost(cpu_ptr_);
+}
+
+bool SyncedMemory::use_zero_copy() {
+#ifdef USE_OPENCL
+  zero_copy_ = Caffe::mode() == Caffe::GPU && caffe::OpenCL::clIsZeroCopy();
+#endif
+  return zero_copy_;
+}
+
+void SyncedMemory::map_host() {
+#ifdef USE_OPENCL
+  if (!cpu_mapped_) {
+    BOOL_CHECK(caffe::OpenCL::clMapHost(gpu_ptr_, size_, &cpu_ptr_));
+    cpu_mapped_ = true;
+  }
+#endif
+}
+
+void SyncedMemory::unmap_host() {
+#ifdef USE_OPENCL
+  if (cpu_mapped_) {
+    BOOL_CHECK(caffe::OpenCL::clUnmapHost(gpu_ptr_, cpu_ptr_));
+    cpu_mapped_ = false;
+  }
+#endif
+}
+
 inline void SyncedMemory::to_cpu() {
   std::string function = __func__;
   std::ostringstream oss;
 
   switch (head_) {
   case UNINITIALIZED:
-    CaffeMallocHost(&cpu_ptr_, size_);
+#ifdef USE_OPENCL
+    if (use_zero_copy()) {
+      BOOL_CHECK(caffe::OpenCL::clMalloc(&gpu_ptr_, size_));
+      map_host();
+      caffe_memset(size_, 0, cpu_ptr_);
+      head_ = HEAD_AT_CPU;
+      own_cpu_data_ = true;
+      break;
+    }
+#endif
+    malloc_host();
     if ( cpu_ptr_ == NULL ) {
       LOG(ERROR) << "failed to allocate " << size_ << " Byte in main memory";
       return;
@@ -63,8 +134,14 @@ inline void SyncedMemory::to_cpu() {
     caffe_gpu_memcpy(size_, gpu_ptr_, cpu_ptr_);
     head_ = SYNCED;
 #elif defined(USE_OPENCL)
+    if (zero_copy_) {
+      map_host();
+      own_cpu_data_ = true;
+      head_ = SYNCED;
+      break;
+    }
     if (cpu_ptr_ == NULL) {
-      CaffeMallocHost(&cpu_ptr_, size_);
+      malloc_host();
       if ( cpu_ptr_ == NULL ) {
         LOG(ERROR) << "failed to allocate " << size_ << " Byte in main memory";
         return;
@@ -87,6 +164,15 @@ inline void SyncedMemory::to_cpu() {
 
   case HEAD_AT_CPU:
   case SYNCED:
+#ifdef USE_OPENCL
+    if (zero_copy_) {
+      map_host();
+      break;
+    }
+    if (gpu_ptr_) {
+      BOOL_CHECK(caffe::OpenCL::clWaitForTransfer(gpu_ptr_));
+    }
+#endif
     break;
   }
 }
@@ -115,6 +201,7 @@ inline void SyncedMemory::to_gpu() {
 #elif defined(USE_OPENCL)
   switch (head_) {
   case UNINITIALIZED:
+    use_zero_copy();
     TIMENOSYNC("clMalloc", {
     BOOL_CHECK(caffe::OpenCL::clMalloc(&gpu_ptr_, size_));
     });
@@ -125,6 +212,11 @@ inline void SyncedMemory::to_gpu() {
     break;
 
   case HEAD_AT_CPU:
+    if (zero_copy_) {
+      unmap_host();
+      head_ = SYNCED;
+      break;
+    }
     if (gpu_ptr_ == NULL) {
       BOOL_CHECK(caffe::OpenCL::clMalloc(&gpu_ptr_, size_));
     }
@@ -134,6 +226,8 @@ inline void SyncedMemory::to_gpu() {
   case HEAD_AT_GPU:
     break;
   case SYNCED:
+    // the device must not use the buffer while it's mapped.
+    unmap_host();
     break;
   }
 #else
@@ -148,12 +242,20 @@ const void* SyncedMemory::cpu_data() {
 
 void SyncedMemory::set_cpu_data(void* data) {
   CHECK(data);
+#ifdef USE_OPENCL
+  if (gpu_ptr_) {
+    BOOL_CHECK(caffe::OpenCL::clWaitForTransfer(gpu_ptr_));
+  }
+#endif
   if (own_cpu_data_) {
-    CaffeFreeHost(cpu_ptr_);
+    free_host();
   }
+  // external host memory has to be copied to the device again.
+  zero_copy_ = false;
   cpu_ptr_ = data;
   head_ = HEAD_AT_CPU;
   own_cpu_data_ = false;
+  ++version_;
 }
 
 const void* SyncedMemory::gpu_data() {
@@ -168,6 +270,7 @@ const void* SyncedMemory::gpu_data() {
 void* SyncedMemory::mutable_cpu_data() {
   to_cpu();
   head_ = HEAD_AT_CPU;
+  ++version_;
   return cpu_ptr_;
 }
 
@@ -175,6 +278,7 @@ void* SyncedMemory::mutable_gpu_data() {
 #if defined(USE_CUDA) || defined(USE_OPENCL)
   to_gpu();
   head_ = HEAD_AT_GPU;
+  ++version_;
   return gpu_ptr_;
 #else
   NO_GPU;
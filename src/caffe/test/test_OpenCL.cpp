@@ -1,12 +1,16 @@
 #ifdef USE_OPENCL
 
 #include <caffe/util/OpenCL/OpenCLSupport.hpp>
+#include <caffe/util/OpenCL/softmax_layer.hpp>
 
+#include <algorithm>
 #include <cstring>
 
 #include "caffe/blob.hpp"
 #include "caffe/common.hpp"
 #include "caffe/filler.hpp"
+#include "caffe/util/benchmark.hpp"
+#include "caffe/util/math_functions.hpp"
 #include "gtest/gtest.h"
 #include "stdlib.h"
 #include "time.h"
@@ -103,6 +107,78 @@ TYPED_TEST(OpenCLSimpleTest, TestMaxBufferPerformance) {
   printf("OpenCL successfully allocated one buffer of %ld MB\n", megabytes);
 }
 
+TYPED_TEST(OpenCLSimpleTest, TestPointerResolutionPerformance) {
+  size_t bytes     = 4096;
+  int num_buffers  = 4096;
+  int num_lookups  = 1000000;
+
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  std::vector<void*> vPtrArr(num_buffers, NULL);
+  for (int i = 0; i < num_buffers; i++) {
+    EXPECT_TRUE(caffe::OpenCL::clMalloc(&vPtrArr[i], bytes));
+  }
+
+  // resolve offset pointers spread over all buffers, as done for the
+  // per-image offsets in conv and im2col.
+  OpenCLMemory* clMem = NULL;
+  int found = 0;
+  CPUTimer timer;
+  timer.Start();
+  for (int i = 0; i < num_lookups; i++) {
+    const char* ptr = reinterpret_cast<const char*>(
+        vPtrArr[(i * 7919) % num_buffers]) + (i % bytes);
+    found += device.get(ptr, &clMem);
+  }
+  float ms = timer.MilliSeconds();
+  printf("OpenCL resolved %d pointers in %d buffers in %f ms (%f ns each)\n",
+         num_lookups, num_buffers, ms, 1e6 * ms / num_lookups);
+  EXPECT_EQ(num_lookups, found);
+
+  const char* last = reinterpret_cast<const char*>(
+      vPtrArr[num_buffers - 1]);
+  EXPECT_TRUE(device.get(last + bytes - 1, &clMem));
+  EXPECT_EQ(vPtrArr[num_buffers - 1], clMem->getVirtualPointer());
+
+  for (int i = num_buffers - 1; i >= 0; i--) {
+    EXPECT_TRUE(caffe::OpenCL::clFree(vPtrArr[i]));
+  }
+}
+
+TYPED_TEST(OpenCLSimpleTest, TestMemoryCache) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  size_t limit = device.getMemoryCacheLimit();
+  size_t bytes = 1000 * sizeof(TypeParam);
+
+  void* vPtr = NULL;
+  EXPECT_TRUE(caffe::OpenCL::clMalloc(&vPtr, bytes));
+  EXPECT_TRUE(caffe::OpenCL::clFree(vPtr));
+
+  // the freed buffer is handed out again for a request of the same class.
+  uint64_t hits = device.getMemoryCacheStatistics().hits;
+  void* vPtrCached = NULL;
+  EXPECT_TRUE(caffe::OpenCL::clMalloc(&vPtrCached, bytes - 8));
+  EXPECT_EQ(vPtr, vPtrCached);
+  EXPECT_EQ(hits + 1, device.getMemoryCacheStatistics().hits);
+  EXPECT_GE(device.getMemoryCacheStatistics().bytes_in_use,
+            device.getMemoryCacheStatistics().bytes_requested);
+  EXPECT_TRUE(caffe::OpenCL::clMemset(vPtrCached, (TypeParam) 0,
+                                      bytes - 8));
+
+  // without a cache the buffer is released, the other buffers of its
+  // slab are released with it.
+  device.setMemoryCacheLimit(0);
+  EXPECT_TRUE(caffe::OpenCL::clFree(vPtrCached));
+  EXPECT_EQ(0U, device.getMemoryCacheStatistics().bytes_cached);
+
+  // no slab is created beyond the limit.
+  void* vPtrUncached = NULL;
+  EXPECT_TRUE(caffe::OpenCL::clMalloc(&vPtrUncached, bytes));
+  EXPECT_EQ(0U, device.getMemoryCacheStatistics().bytes_cached);
+  EXPECT_TRUE(caffe::OpenCL::clFree(vPtrUncached));
+  EXPECT_EQ(0U, device.getMemoryCacheStatistics().bytes_cached);
+  device.setMemoryCacheLimit(limit);
+}
+
 TYPED_TEST(OpenCLSimpleTest, TestMemcpy) {
   int    count  = 10;
   size_t bytes   = count*sizeof(TypeParam);
@@ -141,6 +217,117 @@ TYPED_TEST(OpenCLSimpleTest, TestMemcpy) {
   free(cpuPtrB);
 }
 
+TYPED_TEST(OpenCLSimpleTest, TestMemcpyAsync) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  bool async = device.getAsyncTransfers();
+  device.setAsyncTransfers(true);
+
+  int    count  = 1024;
+  size_t bytes   = count*sizeof(TypeParam);
+
+  TypeParam* cpuPtrA = reinterpret_cast<TypeParam*>(malloc(bytes));
+  EXPECT_TRUE(cpuPtrA != NULL);
+
+  TypeParam* cpuPtrB = reinterpret_cast<TypeParam*>(malloc(bytes));
+  EXPECT_TRUE(cpuPtrB != NULL);
+
+  for (int i = 0; i < count; i++) {
+    cpuPtrA[i] = rand() % count;  // NOLINT(*)
+    cpuPtrB[i] = 0;
+  }
+
+  void* gpuPtrA     = NULL;
+  EXPECT_TRUE(caffe::OpenCL::clMalloc(&gpuPtrA, bytes));
+
+  void* gpuPtrB     = NULL;
+  EXPECT_TRUE(caffe::OpenCL::clMalloc(&gpuPtrB, bytes));
+
+  // the copy on the command queue has to wait for the upload.
+  EXPECT_TRUE(caffe::OpenCL::clMemcpy(
+      gpuPtrA, cpuPtrA, bytes, caffe::OpenCL::COPY_CPU_TO_GPU));
+  EXPECT_TRUE(caffe::OpenCL::clMemcpy(
+      gpuPtrB, gpuPtrA, bytes, caffe::OpenCL::COPY_GPU_TO_GPU));
+  EXPECT_TRUE(caffe::OpenCL::clWaitForTransfer(gpuPtrA));
+  EXPECT_TRUE(caffe::OpenCL::clMemcpy(
+      cpuPtrB, gpuPtrB, bytes, caffe::OpenCL::COPY_GPU_TO_CPU));
+
+  for (int i = 0; i < count; i++) {
+    EXPECT_EQ(cpuPtrA[i], cpuPtrB[i]);
+  }
+
+  // host writes after cpu_data() don't race with the upload.
+  SyncedMemory mem(bytes);
+  TypeParam* cpuPtr = reinterpret_cast<TypeParam*>(mem.mutable_cpu_data());
+  for (int i = 0; i < count; i++) {
+    cpuPtr[i] = i;
+  }
+  mem.gpu_data();
+  cpuPtr = reinterpret_cast<TypeParam*>(mem.mutable_cpu_data());
+  for (int i = 0; i < count; i++) {
+    cpuPtr[i] = 0;
+  }
+  EXPECT_TRUE(caffe::OpenCL::clMemcpy(
+      cpuPtrB, mem.gpu_data(), bytes, caffe::OpenCL::COPY_GPU_TO_CPU));
+  for (int i = 0; i < count; i++) {
+    EXPECT_EQ(0, cpuPtrB[i]);
+  }
+
+  EXPECT_TRUE(caffe::OpenCL::clFree(gpuPtrA));
+  EXPECT_TRUE(caffe::OpenCL::clFree(gpuPtrB));
+  free(cpuPtrA);
+  free(cpuPtrB);
+  device.setAsyncTransfers(async);
+}
+
+TYPED_TEST(OpenCLSimpleTest, TestPinnedHostMemoryBandwidth) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  bool pinned = device.getPinnedHostMemory();
+  device.setPinnedHostMemory(true);
+
+  size_t MB       = 1024*1024;
+  size_t bytes    = 64 * MB;
+  int iterations  = 10;
+
+  void* gpuPtr = NULL;
+  EXPECT_TRUE(caffe::OpenCL::clMalloc(&gpuPtr, bytes));
+
+  void* hostPtr[2];
+  hostPtr[0] = malloc(bytes);
+  EXPECT_TRUE(hostPtr[0] != NULL);
+  EXPECT_TRUE(caffe::OpenCL::clMallocHost(&hostPtr[1], bytes));
+  const char* names[2] = { "malloc", "pinned" };
+
+  for (int k = 0; k < 2; k++) {
+    memset(hostPtr[k], 0, bytes);
+    CPUTimer timer;
+
+    timer.Start();
+    for (int i = 0; i < iterations; i++) {
+      EXPECT_TRUE(caffe::OpenCL::clMemcpy(
+          gpuPtr, hostPtr[k], bytes, caffe::OpenCL::COPY_CPU_TO_GPU));
+    }
+    device.Synchronize();
+    float upload_ms = timer.MilliSeconds();
+
+    timer.Start();
+    for (int i = 0; i < iterations; i++) {
+      EXPECT_TRUE(caffe::OpenCL::clMemcpy(
+          hostPtr[k], gpuPtr, bytes, caffe::OpenCL::COPY_GPU_TO_CPU));
+    }
+    float download_ms = timer.MilliSeconds();
+
+    printf("OpenCL %s host memory: upload %f GB/s, download %f GB/s\n",
+           names[k],
+           iterations * bytes / (upload_ms * 1e6),
+           iterations * bytes / (download_ms * 1e6));
+  }
+
+  EXPECT_TRUE(caffe::OpenCL::clFreeHost(hostPtr[1]));
+  free(hostPtr[0]);
+  EXPECT_TRUE(caffe::OpenCL::clFree(gpuPtr));
+  device.setPinnedHostMemory(pinned);
+}
+
 TYPED_TEST(OpenCLSimpleTest, TestMemcpyOffset) {
   int    count      = 10;
   int    offset      = 5;
@@ -523,6 +710,447 @@ TYPED_TEST(OpenCLSimpleTest, Test_clpowx) {
   }
 }
 
+TYPED_TEST(OpenCLSimpleTest, TestWarmUp) {
+  std::vector<std::string> layer_types;
+  layer_types.push_back("Pooling");
+  EXPECT_TRUE(caffe::OpenCLManager::WarmUp(layer_types));
+
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  EXPECT_TRUE(device.buildRegisteredProgram("pooling_layer"));
+  EXPECT_FALSE(device.buildRegisteredProgram("no_such_layer"));
+
+  cl_kernel* kernel = device.getKernel("MaxPoolForwardFloat");
+  EXPECT_TRUE(kernel != NULL);
+  EXPECT_TRUE(*kernel != NULL);
+}
+
+TYPED_TEST(OpenCLSimpleTest, TestGemmTiled) {
+  const int m = 19;
+  const int n = 23;
+  const int k = 37;
+  const int batch = 3;
+  Blob<TypeParam> A(1, 1, m, k);
+  Blob<TypeParam> B(batch, 1, k, n);
+  Blob<TypeParam> C(batch, 1, m, n);
+  Blob<TypeParam> C_ref(batch, 1, m, n);
+  FillerParameter filler_param;
+  UniformFiller<TypeParam> filler(filler_param);
+  filler.Fill(&A);
+  filler.Fill(&B);
+  filler.Fill(&C);
+
+  std::vector<OpenCLGemmConfig> candidates =
+      OpenCLGemmTuner::Candidates<TypeParam>();
+  EXPECT_GT(candidates.size(), 0U);
+  CBLAS_TRANSPOSE cblas_trans[] = { CblasNoTrans, CblasTrans };
+  clblasTranspose cl_trans[] = { clblasNoTrans, clblasTrans };
+  for ( size_t c = 0; c < candidates.size(); c++ ) {
+    for ( int ta = 0; ta < 2; ta++ ) {
+      for ( int tb = 0; tb < 2; tb++ ) {
+        caffe_copy(C.count(), C.cpu_data(), C_ref.mutable_cpu_data());
+        for ( int i = 0; i < batch; i++ ) {
+          caffe_cpu_gemm<TypeParam>(cblas_trans[ta], cblas_trans[tb], m, n, k,
+                                    1.5, A.cpu_data(), B.cpu_data() + i*k*n,
+                                    0.5, C_ref.mutable_cpu_data() + i*m*n);
+        }
+        Blob<TypeParam> C_gpu(batch, 1, m, n);
+        caffe_copy(C.count(), C.cpu_data(), C_gpu.mutable_cpu_data());
+        EXPECT_TRUE(caffe::OpenCL::clgemm_tiled<TypeParam>(
+            candidates[c], cl_trans[ta], cl_trans[tb], m, n, k, batch, 1.5,
+            A.gpu_data(), 0, 0, B.gpu_data(), 0, k*n, 0.5,
+            C_gpu.mutable_gpu_data(), 0, m*n, NULL, NULL, false, 0, NULL));
+        for ( int i = 0; i < C.count(); i++ ) {
+          EXPECT_NEAR(C_ref.cpu_data()[i], C_gpu.cpu_data()[i], 1e-4)
+              << "tile = " << candidates[c].tile
+              << " wpt = " << candidates[c].wpt;
+        }
+      }
+    }
+  }
+}
+
+TYPED_TEST(OpenCLSimpleTest, TestGemmStridedBatched) {
+  const int m = 21;
+  const int n = 17;
+  const int k = 33;
+  const int batch = 4;
+  // every matrix of a batch has its own A, B and C behind an offset.
+  const int offset = 5;
+  Blob<TypeParam> A(1, 1, 1, offset + batch*m*k);
+  Blob<TypeParam> B(1, 1, 1, offset + batch*k*n);
+  Blob<TypeParam> C(1, 1, 1, offset + batch*m*n);
+  FillerParameter filler_param;
+  UniformFiller<TypeParam> filler(filler_param);
+  filler.Fill(&A);
+  filler.Fill(&B);
+  filler.Fill(&C);
+
+  CBLAS_TRANSPOSE trans[] = { CblasNoTrans, CblasTrans };
+  for ( int ta = 0; ta < 2; ta++ ) {
+    for ( int tb = 0; tb < 2; tb++ ) {
+      Blob<TypeParam> C_ref(1, 1, 1, C.count());
+      caffe_copy(C.count(), C.cpu_data(), C_ref.mutable_cpu_data());
+      for ( int i = 0; i < batch; i++ ) {
+        caffe_cpu_gemm<TypeParam>(trans[ta], trans[tb], m, n, k, 1.5,
+            A.cpu_data() + offset + i*m*k, B.cpu_data() + offset + i*k*n,
+            0.5, C_ref.mutable_cpu_data() + offset + i*m*n);
+      }
+      Blob<TypeParam> C_gpu(1, 1, 1, C.count());
+      caffe_copy(C.count(), C.cpu_data(), C_gpu.mutable_cpu_data());
+      caffe_gpu_gemm_strided_batched<TypeParam>(trans[ta], trans[tb],
+          m, n, k, batch, 1.5, A.gpu_data(), offset, m*k,
+          B.gpu_data(), offset, k*n, 0.5,
+          C_gpu.mutable_gpu_data(), offset, m*n);
+      for ( int i = 0; i < C.count(); i++ ) {
+        EXPECT_NEAR(C_ref.cpu_data()[i], C_gpu.cpu_data()[i], 1e-4)
+            << "TransA = " << ta << " TransB = " << tb;
+      }
+    }
+  }
+}
+
+TYPED_TEST(OpenCLSimpleTest, TestGemmStridedBatchedBias) {
+  const int m = 21;
+  const int n = 17;
+  const int k = 33;
+  const int batch = 3;
+  Blob<TypeParam> A(1, 1, 1, batch*m*k);
+  Blob<TypeParam> B(1, 1, 1, k*n);
+  Blob<TypeParam> C(1, 1, 1, batch*m*n);
+  Blob<TypeParam> bias_row(1, 1, 1, m);
+  Blob<TypeParam> bias_col(1, 1, 1, n);
+  FillerParameter filler_param;
+  UniformFiller<TypeParam> filler(filler_param);
+  filler.Fill(&A);
+  filler.Fill(&B);
+  filler.Fill(&C);
+  filler.Fill(&bias_row);
+  filler.Fill(&bias_col);
+
+  Blob<TypeParam> C_ref(1, 1, 1, C.count());
+  caffe_copy(C.count(), C.cpu_data(), C_ref.mutable_cpu_data());
+  for ( int i = 0; i < batch; i++ ) {
+    caffe_cpu_gemm<TypeParam>(CblasNoTrans, CblasNoTrans, m, n, k, 1.5,
+        A.cpu_data() + i*m*k, B.cpu_data(), 0.5,
+        C_ref.mutable_cpu_data() + i*m*n, bias_row.cpu_data(),
+        bias_col.cpu_data());
+  }
+  Blob<TypeParam> C_gpu(1, 1, 1, C.count());
+  caffe_copy(C.count(), C.cpu_data(), C_gpu.mutable_cpu_data());
+  caffe_gpu_gemm_strided_batched<TypeParam>(CblasNoTrans, CblasNoTrans,
+      m, n, k, batch, 1.5, A.gpu_data(), 0, m*k, B.gpu_data(), 0, 0, 0.5,
+      C_gpu.mutable_gpu_data(), 0, m*n, bias_row.gpu_data(),
+      bias_col.gpu_data(), false, 0);
+  for ( int i = 0; i < C.count(); i++ ) {
+    EXPECT_NEAR(C_ref.cpu_data()[i], C_gpu.cpu_data()[i], 1e-4);
+  }
+
+  // a negative bias moves part of C below zero for the leaky ReLU.
+  const TypeParam negative_slope = 0.25;
+  caffe_add_scalar<TypeParam>(n, -static_cast<TypeParam>(k) / 4,
+      bias_col.mutable_cpu_data());
+  for ( int i = 0; i < batch; i++ ) {
+    caffe_cpu_gemm<TypeParam>(CblasNoTrans, CblasNoTrans, m, n, k, 1.5,
+        A.cpu_data() + i*m*k, B.cpu_data(), 0,
+        C_ref.mutable_cpu_data() + i*m*n, bias_row.cpu_data(),
+        bias_col.cpu_data());
+  }
+  for ( int i = 0; i < C.count(); i++ ) {
+    const TypeParam value = C_ref.cpu_data()[i];
+    C_ref.mutable_cpu_data()[i] = value > 0 ? value : value * negative_slope;
+  }
+  caffe_gpu_gemm_strided_batched<TypeParam>(CblasNoTrans, CblasNoTrans,
+      m, n, k, batch, 1.5, A.gpu_data(), 0, m*k, B.gpu_data(), 0, 0, 0,
+      C_gpu.mutable_gpu_data(), 0, m*n, bias_row.gpu_data(),
+      bias_col.gpu_data(), true, negative_slope);
+  for ( int i = 0; i < C.count(); i++ ) {
+    EXPECT_NEAR(C_ref.cpu_data()[i], C_gpu.cpu_data()[i], 1e-4);
+  }
+}
+
+TYPED_TEST(OpenCLSimpleTest, TestAddBiasChannelSum) {
+  const int num = 3;
+  const int channels = 5;
+  const int spatial_dim = 77;
+  Blob<TypeParam> x(num, channels, 1, spatial_dim);
+  Blob<TypeParam> bias(1, 1, 1, channels);
+  FillerParameter filler_param;
+  UniformFiller<TypeParam> filler(filler_param);
+  filler.Fill(&x);
+  filler.Fill(&bias);
+
+  Blob<TypeParam> y_ref(num, channels, 1, spatial_dim);
+  caffe_copy(x.count(), x.cpu_data(), y_ref.mutable_cpu_data());
+  caffe_cpu_add_bias<TypeParam>(num, channels, spatial_dim, bias.cpu_data(),
+      y_ref.mutable_cpu_data());
+  Blob<TypeParam> y_gpu(num, channels, 1, spatial_dim);
+  caffe_copy(x.count(), x.cpu_data(), y_gpu.mutable_cpu_data());
+  caffe_gpu_add_bias<TypeParam>(num, channels, spatial_dim, bias.gpu_data(),
+      y_gpu.mutable_gpu_data());
+  for ( int i = 0; i < x.count(); i++ ) {
+    EXPECT_NEAR(y_ref.cpu_data()[i], y_gpu.cpu_data()[i], 1e-5);
+  }
+
+  // the sums accumulate into the bias.
+  Blob<TypeParam> sum_ref(1, 1, 1, channels);
+  caffe_copy(channels, bias.cpu_data(), sum_ref.mutable_cpu_data());
+  caffe_cpu_channel_sum<TypeParam>(num, channels, spatial_dim, x.cpu_data(),
+      sum_ref.mutable_cpu_data());
+  Blob<TypeParam> sum_gpu(1, 1, 1, channels);
+  caffe_copy(channels, bias.cpu_data(), sum_gpu.mutable_cpu_data());
+  caffe_gpu_channel_sum<TypeParam>(num, channels, spatial_dim, x.gpu_data(),
+      sum_gpu.mutable_gpu_data());
+  for ( int c = 0; c < channels; c++ ) {
+    EXPECT_NEAR(sum_ref.cpu_data()[c], sum_gpu.cpu_data()[c], 1e-4);
+  }
+}
+
+TYPED_TEST(OpenCLSimpleTest, TestRNGReproducible) {
+  const int n = 1001;
+  Blob<TypeParam> first(1, 1, 1, n);
+  Blob<TypeParam> second(1, 1, 1, n);
+  Blob<TypeParam> repeated(1, 1, 1, n);
+
+  Caffe::set_random_seed(1701);
+  caffe_gpu_rng_gaussian<TypeParam>(n, 0, 1, first.mutable_gpu_data());
+  caffe_gpu_rng_gaussian<TypeParam>(n, 0, 1, second.mutable_gpu_data());
+  Caffe::set_random_seed(1701);
+  caffe_gpu_rng_gaussian<TypeParam>(n, 0, 1, repeated.mutable_gpu_data());
+
+  // the seed determines the numbers, consecutive calls draw new ones.
+  int equal = 0;
+  for ( int i = 0; i < n; i++ ) {
+    EXPECT_EQ(first.cpu_data()[i], repeated.cpu_data()[i]);
+    equal += first.cpu_data()[i] == second.cpu_data()[i];
+  }
+  EXPECT_LT(equal, 10);
+}
+
+TYPED_TEST(OpenCLSimpleTest, TestRNGPerformance) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  const int n = 16 * 1024 * 1024;
+  const int iterations = 10;
+  Blob<TypeParam> r(1, 1, 1, n);
+  Blob<int> mask(1, 1, 1, n);
+  TypeParam* r_gpu = r.mutable_gpu_data();
+  int* mask_gpu = mask.mutable_gpu_data();
+  CPUTimer timer;
+
+  // warm up, the first call builds the kernel.
+  caffe_gpu_rng_uniform<TypeParam>(n, 0, 1, r_gpu);
+  device.Synchronize();
+
+  timer.Start();
+  for ( int i = 0; i < iterations; i++ ) {
+    caffe_gpu_rng_uniform<TypeParam>(n, 0, 1, r_gpu);
+  }
+  device.Synchronize();
+  float uniform_ms = timer.MilliSeconds();
+
+  timer.Start();
+  for ( int i = 0; i < iterations; i++ ) {
+    caffe_gpu_rng_gaussian<TypeParam>(n, 0, 1, r_gpu);
+  }
+  device.Synchronize();
+  float gaussian_ms = timer.MilliSeconds();
+
+  timer.Start();
+  for ( int i = 0; i < iterations; i++ ) {
+    caffe_gpu_rng_bernoulli<TypeParam, int>(n, 0.5, mask_gpu);
+  }
+  device.Synchronize();
+  float bernoulli_ms = timer.MilliSeconds();
+
+  // the former path: generate on the host and upload.
+  timer.Start();
+  for ( int i = 0; i < iterations; i++ ) {
+    caffe_rng_uniform<TypeParam>(n, 0, 1, r.mutable_cpu_data());
+    r.gpu_data();
+  }
+  device.Synchronize();
+  float host_ms = timer.MilliSeconds();
+
+  printf("OpenCL RNG: uniform %f, gaussian %f, bernoulli %f, "
+         "host uniform + upload %f Gnumbers/s\n",
+         iterations * n / (uniform_ms * 1e6),
+         iterations * n / (gaussian_ms * 1e6),
+         iterations * n / (bernoulli_ms * 1e6),
+         iterations * n / (host_ms * 1e6));
+}
+
+TYPED_TEST(OpenCLSimpleTest, TestReduction) {
+  // one and two passes.
+  const int sizes[] = { 37, 1000003 };
+  for ( int t = 0; t < 2; t++ ) {
+    const int n = sizes[t];
+    Blob<TypeParam> x(1, 1, 1, n);
+    Blob<TypeParam> y(1, 1, 1, n);
+    FillerParameter filler_param;
+    filler_param.set_min(-1);
+    filler_param.set_max(1);
+    UniformFiller<TypeParam> filler(filler_param);
+    filler.Fill(&x);
+    filler.Fill(&y);
+    const TypeParam asum_ref = caffe_cpu_asum<TypeParam>(n, x.cpu_data());
+    const TypeParam dot_ref = caffe_cpu_dot<TypeParam>(n, x.cpu_data(),
+        y.cpu_data());
+    TypeParam asum;
+    TypeParam dot;
+    caffe_gpu_asum<TypeParam>(n, x.gpu_data(), &asum);
+    caffe_gpu_dot<TypeParam>(n, x.gpu_data(), y.gpu_data(), &dot);
+    EXPECT_NEAR(asum_ref, asum, 1e-4 * asum_ref);
+    EXPECT_NEAR(dot_ref, dot, 1e-4 * asum_ref);
+  }
+
+  // rows of channels elements spatial_dim apart, a work group per row and a
+  // work item per row.
+  const int num = 4;
+  const int channels[] = { 1000, 21 };
+  const int spatial_dims[] = { 1, 50 };
+  for ( int t = 0; t < 2; t++ ) {
+    const int rows = num * spatial_dims[t];
+    Blob<TypeParam> x(num, channels[t], 1, spatial_dims[t]);
+    FillerParameter filler_param;
+    GaussianFiller<TypeParam> filler(filler_param);
+    filler.Fill(&x);
+    Blob<TypeParam> sum(1, 1, 1, rows);
+    Blob<TypeParam> dot(1, 1, 1, rows);
+    Blob<TypeParam> max(1, 1, 1, rows);
+    EXPECT_TRUE(caffe::OpenCL::clrows_sum<TypeParam>(rows, channels[t],
+        spatial_dims[t], x.gpu_data(), NULL, 2, sum.mutable_gpu_data()));
+    EXPECT_TRUE(caffe::OpenCL::clrows_sum<TypeParam>(rows, channels[t],
+        spatial_dims[t], x.gpu_data(), x.gpu_data(), 1,
+        dot.mutable_gpu_data()));
+    EXPECT_TRUE(caffe::OpenCL::clrows_max<TypeParam>(rows, channels[t],
+        spatial_dims[t], x.gpu_data(), max.mutable_gpu_data()));
+    for ( int r = 0; r < rows; r++ ) {
+      const int n = r / spatial_dims[t];
+      const int s = r % spatial_dims[t];
+      TypeParam sum_ref = 0;
+      TypeParam dot_ref = 0;
+      TypeParam max_ref = x.data_at(n, 0, 0, s);
+      for ( int c = 0; c < channels[t]; c++ ) {
+        const TypeParam value = x.data_at(n, c, 0, s);
+        sum_ref += 2 * value;
+        dot_ref += value * value;
+        max_ref = std::max(max_ref, value);
+      }
+      EXPECT_NEAR(sum_ref, sum.cpu_data()[r], 1e-3);
+      EXPECT_NEAR(dot_ref, dot.cpu_data()[r], 1e-4 * dot_ref);
+      EXPECT_EQ(max_ref, max.cpu_data()[r]);
+    }
+  }
+}
+
+TYPED_TEST(OpenCLSimpleTest, TestReductionPerformance) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  const int n = 16 * 1024 * 1024;
+  const int iterations = 10;
+  Blob<TypeParam> x(1, 1, 1, n);
+  Blob<TypeParam> y(1, 1, 1, n);
+  caffe_gpu_set<TypeParam>(n, TypeParam(1), x.mutable_gpu_data());
+  caffe_gpu_set<TypeParam>(n, TypeParam(1), y.mutable_gpu_data());
+  const TypeParam* x_gpu = x.gpu_data();
+  const TypeParam* y_gpu = y.gpu_data();
+  TypeParam result;
+  CPUTimer timer;
+
+  // warm up, the first calls build the kernels.
+  caffe_gpu_asum<TypeParam>(n, x_gpu, &result);
+  caffe_gpu_dot<TypeParam>(n, x_gpu, y_gpu, &result);
+  caffe::OpenCL::clBLASasum<TypeParam>(n, x_gpu, &result);
+  caffe::OpenCL::clBLASdot<TypeParam>(n, x_gpu, 1, y_gpu, 1, &result);
+
+  timer.Start();
+  for ( int i = 0; i < iterations; i++ ) {
+    caffe_gpu_asum<TypeParam>(n, x_gpu, &result);
+  }
+  float asum_ms = timer.MilliSeconds();
+  EXPECT_EQ(n, result);
+
+  timer.Start();
+  for ( int i = 0; i < iterations; i++ ) {
+    caffe::OpenCL::clBLASasum<TypeParam>(n, x_gpu, &result);
+  }
+  float blas_asum_ms = timer.MilliSeconds();
+
+  timer.Start();
+  for ( int i = 0; i < iterations; i++ ) {
+    caffe_gpu_dot<TypeParam>(n, x_gpu, y_gpu, &result);
+  }
+  float dot_ms = timer.MilliSeconds();
+  EXPECT_EQ(n, result);
+
+  timer.Start();
+  for ( int i = 0; i < iterations; i++ ) {
+    caffe::OpenCL::clBLASdot<TypeParam>(n, x_gpu, 1, y_gpu, 1, &result);
+  }
+  float blas_dot_ms = timer.MilliSeconds();
+
+  printf("OpenCL reduction of %d: asum %.3fms, clBLAS asum %.3fms, "
+         "dot %.3fms, clBLAS dot %.3fms\n", n,
+         asum_ms / iterations, blas_asum_ms / iterations,
+         dot_ms / iterations, blas_dot_ms / iterations);
+
+  // the softmax channel max of a classifier, 1000 channels per image.
+  const int num = 256;
+  const int channels = 1000;
+  Blob<TypeParam> max(1, 1, 1, num);
+  TypeParam* max_gpu = max.mutable_gpu_data();
+  caffe::OpenCL::clrows_max<TypeParam>(num, channels, 1, x_gpu, max_gpu);
+  caffe::OpenCL::clkernel_channel_max<TypeParam>(num, channels, 1, x_gpu,
+                                                 max_gpu);
+  device.Synchronize();
+
+  timer.Start();
+  for ( int i = 0; i < iterations; i++ ) {
+    caffe::OpenCL::clrows_max<TypeParam>(num, channels, 1, x_gpu, max_gpu);
+  }
+  device.Synchronize();
+  float rows_ms = timer.MilliSeconds();
+
+  timer.Start();
+  for ( int i = 0; i < iterations; i++ ) {
+    caffe::OpenCL::clkernel_channel_max<TypeParam>(num, channels, 1, x_gpu,
+                                                   max_gpu);
+  }
+  device.Synchronize();
+  float channel_ms = timer.MilliSeconds();
+
+  printf("OpenCL channel max of %d x %d: rows %.3fms, per row thread %.3fms\n",
+         num, channels, rows_ms / iterations, channel_ms / iterations);
+}
+
+TYPED_TEST(OpenCLSimpleTest, TestGemmTuner) {
+  std::string file = OpenCLGemmTuner::GetFile();
+  bool tuning = OpenCLGemmTuner::GetTuning();
+  OpenCLGemmTuner::SetFile("/tmp/caffe_test_gemm_tuning.txt");
+  OpenCLGemmTuner::Clear();
+
+  OpenCLGemmConfig config;
+  EXPECT_FALSE(OpenCLGemmTuner::Lookup<TypeParam>(
+      clblasNoTrans, clblasTrans, 64, 48, 32, 1, &config));
+  OpenCLGemmTuner::SetTuning(true);
+  EXPECT_TRUE(OpenCLGemmTuner::Lookup<TypeParam>(
+      clblasNoTrans, clblasTrans, 64, 48, 32, 1, &config));
+  EXPECT_GT(config.time_us, 0);
+  OpenCLGemmTuner::SetTuning(false);
+
+  // the winner is read back from the tuning file.
+  OpenCLGemmConfig loaded;
+  EXPECT_TRUE(OpenCLGemmTuner::Save());
+  EXPECT_TRUE(OpenCLGemmTuner::Load());
+  EXPECT_EQ(1U, OpenCLGemmTuner::GetNumEntries());
+  EXPECT_TRUE(OpenCLGemmTuner::Lookup<TypeParam>(
+      clblasNoTrans, clblasTrans, 64, 48, 32, 1, &loaded));
+  EXPECT_EQ(config.kernel, loaded.kernel);
+  EXPECT_EQ(config.tile, loaded.tile);
+  EXPECT_EQ(config.wpt, loaded.wpt);
+
+  remove("/tmp/caffe_test_gemm_tuning.txt");
+  OpenCLGemmTuner::SetFile(file);
+  OpenCLGemmTuner::SetTuning(tuning);
+}
 
 }  // namespace caffe
 
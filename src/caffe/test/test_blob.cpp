@@ -54,6 +54,22 @@ TYPED_TEST(BlobSimpleTest, TestReshape) {
   EXPECT_EQ(this->blob_->count(), 120);
 }
 
+TYPED_TEST(BlobSimpleTest, TestShareDataStorage) {
+  this->blob_->Reshape(2, 3, 4, 5);
+  this->blob_->Reshape(1, 3, 4, 5);
+  shared_ptr<SyncedMemory> storage(new SyncedMemory(120 * sizeof(TypeParam)));
+  this->blob_->ShareDataStorage(storage);
+  EXPECT_EQ(storage, this->blob_->data());
+
+  // growing within the storage keeps sharing it.
+  this->blob_->Reshape(2, 3, 4, 5);
+  EXPECT_EQ(storage, this->blob_->data());
+
+  this->blob_->Reshape(3, 3, 4, 5);
+  EXPECT_NE(storage, this->blob_->data());
+  EXPECT_GE(this->blob_->data()->size(), 180 * sizeof(TypeParam));
+}
+
 TYPED_TEST(BlobSimpleTest, TestLegacyBlobProtoShapeEquals) {
   BlobProto blob_proto;
 
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -7,6 +8,7 @@
 #include "caffe/blob.hpp"
 #include "caffe/common.hpp"
 #include "caffe/filler.hpp"
+#include "caffe/util/math_functions.hpp"
 #include "caffe/vision_layers.hpp"
 
 #include "caffe/test/test_caffe_main.hpp"
@@ -196,6 +198,49 @@ class ConvolutionLayerTest : public MultiDeviceTest<TypeParam> {
         layer->Forward(this->blob_bottom_vec_, this->blob_top_vec_);
     });
   }
+
+  // the forward time of the engine for 3x3, 5x5 or 1x1 filters.
+  float ConvolutionLayerTestEnginePerformance(int kernel_size, int stride,
+      ConvolutionParameter_Engine engine) {
+    typedef typename TypeParam::Dtype Dtype;
+
+    blob_bottom_->Reshape(16, 32, 32, 32);
+    FillerParameter filler_param;
+    GaussianFiller<Dtype> filler(filler_param);
+    filler.Fill(this->blob_bottom_);
+    blob_bottom_vec_.clear();
+    blob_bottom_vec_.push_back(blob_bottom_);
+    blob_top_vec_.clear();
+    blob_top_vec_.push_back(blob_top_);
+
+    LayerParameter layer_param;
+    ConvolutionParameter* convolution_param =
+        layer_param.mutable_convolution_param();
+    convolution_param->set_kernel_size(kernel_size);
+    convolution_param->set_stride(stride);
+    convolution_param->set_pad(kernel_size / 2);
+    convolution_param->set_num_output(32);
+    convolution_param->set_engine(engine);
+    convolution_param->mutable_weight_filler()->set_type("gaussian");
+    shared_ptr<Layer<Dtype> > layer(new ConvolutionLayer<Dtype>(layer_param));
+    layer->SetUp(this->blob_bottom_vec_, this->blob_top_vec_);
+    // the first run builds the kernels.
+    layer->Forward(this->blob_bottom_vec_, this->blob_top_vec_);
+
+    record r;
+    r.type         = std::string(typeid(Dtype).name());
+    r.num_images   = blob_bottom_->num();
+    r.num_channels = blob_bottom_->channels();
+    r.img_width    = blob_bottom_->width();
+    r.img_height   = blob_bottom_->height();
+
+    BENCH(r, {
+      for (int i = 0; i < 10; i++) {
+        layer->Forward(this->blob_bottom_vec_, this->blob_top_vec_);
+      }
+    });
+    return r.time;
+  }
 };
 
 TYPED_TEST_CASE(ConvolutionLayerTest, TestDtypesAndDevices);
@@ -338,6 +383,238 @@ TYPED_TEST(ConvolutionLayerTest, TestSimpleConvolutionGroup) {
   }
 }
 
+TYPED_TEST(ConvolutionLayerTest, TestSimpleConvolutionWorkspaceLimit) {
+  typedef typename TypeParam::Dtype Dtype;
+  this->blob_bottom_->Reshape(5, 3, 6, 4);
+  FillerParameter filler_param;
+  filler_param.set_value(1.);
+  GaussianFiller<Dtype> filler(filler_param);
+  filler.Fill(this->blob_bottom_);
+  LayerParameter layer_param;
+  ConvolutionParameter* convolution_param =
+      layer_param.mutable_convolution_param();
+  convolution_param->set_kernel_size(3);
+  convolution_param->set_stride(2);
+  convolution_param->set_num_output(3);
+  convolution_param->set_group(3);
+  // the columns of two images, so that the batch runs in chunks of 2, 2, 1.
+  convolution_param->set_workspace_limit(2 * 3 * 3 * 3 * 2 * sizeof(Dtype));
+  convolution_param->mutable_weight_filler()->set_type("gaussian");
+  convolution_param->mutable_bias_filler()->set_type("constant");
+  convolution_param->mutable_bias_filler()->set_value(0.1);
+  shared_ptr<Layer<Dtype> > layer(
+      new ConvolutionLayer<Dtype>(layer_param));
+  layer->SetUp(this->blob_bottom_vec_, this->blob_top_vec_);
+  EXPECT_EQ(layer->workspace(0)->num(), 2);
+  layer->Forward(this->blob_bottom_vec_, this->blob_top_vec_);
+  // Check against reference convolution.
+  const Dtype* top_data;
+  const Dtype* ref_top_data;
+  caffe_conv(this->blob_bottom_, convolution_param, layer->blobs(),
+      this->MakeReferenceTop(this->blob_top_));
+  top_data = this->blob_top_->cpu_data();
+  ref_top_data = this->ref_blob_top_->cpu_data();
+  for (int i = 0; i < this->blob_top_->count(); ++i) {
+    EXPECT_NEAR(top_data[i], ref_top_data[i], 1e-4);
+  }
+}
+
+TYPED_TEST(ConvolutionLayerTest, TestSimpleConvolutionDirect) {
+  typedef typename TypeParam::Dtype Dtype;
+  // filter size, stride, pad and group of the shapes the engine supports.
+  const int shapes[][4] = {
+      {3, 1, 1, 1}, {5, 1, 2, 1}, {1, 1, 0, 1}, {1, 2, 0, 1}, {3, 1, 1, 3} };
+  const int num_shapes = sizeof(shapes) / sizeof(shapes[0]);
+  for (int s = 0; s < num_shapes; ++s) {
+    LayerParameter layer_param;
+    ConvolutionParameter* convolution_param =
+        layer_param.mutable_convolution_param();
+    convolution_param->set_kernel_size(shapes[s][0]);
+    convolution_param->set_stride(shapes[s][1]);
+    convolution_param->set_pad(shapes[s][2]);
+    convolution_param->set_group(shapes[s][3]);
+    convolution_param->set_num_output(6);
+    convolution_param->set_engine(ConvolutionParameter_Engine_DIRECT);
+    convolution_param->mutable_weight_filler()->set_type("gaussian");
+    convolution_param->mutable_bias_filler()->set_type("constant");
+    convolution_param->mutable_bias_filler()->set_value(0.1);
+    shared_ptr<Layer<Dtype> > layer(
+        new ConvolutionLayer<Dtype>(layer_param));
+    layer->SetUp(this->blob_bottom_vec_, this->blob_top_vec_);
+    layer->Forward(this->blob_bottom_vec_, this->blob_top_vec_);
+    // Check against reference convolution.
+    caffe_conv(this->blob_bottom_, convolution_param, layer->blobs(),
+        this->MakeReferenceTop(this->blob_top_));
+    const Dtype* top_data = this->blob_top_->cpu_data();
+    const Dtype* ref_top_data = this->ref_blob_top_->cpu_data();
+    for (int i = 0; i < this->blob_top_->count(); ++i) {
+      EXPECT_NEAR(top_data[i], ref_top_data[i], 1e-4);
+    }
+  }
+}
+
+TYPED_TEST(ConvolutionLayerTest, TestSimpleConvolutionWinograd) {
+  typedef typename TypeParam::Dtype Dtype;
+  // output tile, pad and group.
+  const int shapes[][3] = {
+      {2, 0, 1}, {2, 1, 1}, {2, 1, 3}, {4, 0, 1}, {4, 1, 1}, {4, 1, 3} };
+  const int num_shapes = sizeof(shapes) / sizeof(shapes[0]);
+  for (int s = 0; s < num_shapes; ++s) {
+    LayerParameter layer_param;
+    ConvolutionParameter* convolution_param =
+        layer_param.mutable_convolution_param();
+    convolution_param->set_kernel_size(3);
+    convolution_param->set_winograd_tile(shapes[s][0]);
+    convolution_param->set_pad(shapes[s][1]);
+    convolution_param->set_group(shapes[s][2]);
+    convolution_param->set_num_output(6);
+    convolution_param->set_engine(ConvolutionParameter_Engine_WINOGRAD);
+    convolution_param->mutable_weight_filler()->set_type("gaussian");
+    convolution_param->mutable_bias_filler()->set_type("constant");
+    convolution_param->mutable_bias_filler()->set_value(0.1);
+    shared_ptr<Layer<Dtype> > layer(
+        new ConvolutionLayer<Dtype>(layer_param));
+    layer->SetUp(this->blob_bottom_vec_, this->blob_top_vec_);
+    layer->Forward(this->blob_bottom_vec_, this->blob_top_vec_);
+    // Check against reference convolution.
+    caffe_conv(this->blob_bottom_, convolution_param, layer->blobs(),
+        this->MakeReferenceTop(this->blob_top_));
+    const Dtype* top_data = this->blob_top_->cpu_data();
+    const Dtype* ref_top_data = this->ref_blob_top_->cpu_data();
+    for (int i = 0; i < this->blob_top_->count(); ++i) {
+      EXPECT_NEAR(top_data[i], ref_top_data[i], 1e-3);
+    }
+  }
+}
+
+TYPED_TEST(ConvolutionLayerTest, TestWinogradWeightUpdate) {
+  typedef typename TypeParam::Dtype Dtype;
+  LayerParameter layer_param;
+  ConvolutionParameter* convolution_param =
+      layer_param.mutable_convolution_param();
+  convolution_param->set_kernel_size(3);
+  convolution_param->set_pad(1);
+  convolution_param->set_num_output(4);
+  convolution_param->set_engine(ConvolutionParameter_Engine_WINOGRAD);
+  convolution_param->mutable_weight_filler()->set_type("gaussian");
+  convolution_param->mutable_bias_filler()->set_type("constant");
+  convolution_param->mutable_bias_filler()->set_value(0.1);
+  shared_ptr<Layer<Dtype> > layer(
+      new ConvolutionLayer<Dtype>(layer_param));
+  layer->SetUp(this->blob_bottom_vec_, this->blob_top_vec_);
+  layer->Forward(this->blob_bottom_vec_, this->blob_top_vec_);
+  // the transformed filters are cached, changing the weights must not use
+  // the stale ones.
+  caffe_scal(layer->blobs()[0]->count(), Dtype(-2),
+             layer->blobs()[0]->mutable_cpu_data());
+  layer->Forward(this->blob_bottom_vec_, this->blob_top_vec_);
+  caffe_conv(this->blob_bottom_, convolution_param, layer->blobs(),
+      this->MakeReferenceTop(this->blob_top_));
+  const Dtype* top_data = this->blob_top_->cpu_data();
+  const Dtype* ref_top_data = this->ref_blob_top_->cpu_data();
+  for (int i = 0; i < this->blob_top_->count(); ++i) {
+    EXPECT_NEAR(top_data[i], ref_top_data[i], 1e-3);
+  }
+}
+
+TYPED_TEST(ConvolutionLayerTest, TestSimpleConvolutionFFT) {
+  typedef typename TypeParam::Dtype Dtype;
+  // filter size, stride, pad and group.
+  const int shapes[][4] = {
+      {3, 1, 1, 1}, {5, 1, 2, 1}, {3, 2, 0, 1}, {4, 1, 2, 3}, {6, 1, 3, 1} };
+  const int num_shapes = sizeof(shapes) / sizeof(shapes[0]);
+  for (int s = 0; s < num_shapes; ++s) {
+    LayerParameter layer_param;
+    ConvolutionParameter* convolution_param =
+        layer_param.mutable_convolution_param();
+    convolution_param->set_kernel_size(shapes[s][0]);
+    convolution_param->set_stride(shapes[s][1]);
+    convolution_param->set_pad(shapes[s][2]);
+    convolution_param->set_group(shapes[s][3]);
+    convolution_param->set_num_output(6);
+    convolution_param->set_engine(ConvolutionParameter_Engine_FFT);
+    convolution_param->mutable_weight_filler()->set_type("gaussian");
+    convolution_param->mutable_bias_filler()->set_type("constant");
+    convolution_param->mutable_bias_filler()->set_value(0.1);
+    shared_ptr<Layer<Dtype> > layer(
+        new ConvolutionLayer<Dtype>(layer_param));
+    layer->SetUp(this->blob_bottom_vec_, this->blob_top_vec_);
+    layer->Forward(this->blob_bottom_vec_, this->blob_top_vec_);
+    // Check against reference convolution.
+    caffe_conv(this->blob_bottom_, convolution_param, layer->blobs(),
+        this->MakeReferenceTop(this->blob_top_));
+    const Dtype* top_data = this->blob_top_->cpu_data();
+    const Dtype* ref_top_data = this->ref_blob_top_->cpu_data();
+    for (int i = 0; i < this->blob_top_->count(); ++i) {
+      EXPECT_NEAR(top_data[i], ref_top_data[i], 1e-4);
+    }
+  }
+}
+
+TYPED_TEST(ConvolutionLayerTest, TestWorkspaceLimitWinogradFFT) {
+  typedef typename TypeParam::Dtype Dtype;
+  this->blob_bottom_->Reshape(5, 3, 6, 4);
+  FillerParameter filler_param;
+  GaussianFiller<Dtype> filler(filler_param);
+  filler.Fill(this->blob_bottom_);
+  const ConvolutionParameter_Engine engines[] = {
+      ConvolutionParameter_Engine_WINOGRAD, ConvolutionParameter_Engine_FFT };
+  for (int e = 0; e < 2; ++e) {
+    LayerParameter layer_param;
+    ConvolutionParameter* convolution_param =
+        layer_param.mutable_convolution_param();
+    convolution_param->set_kernel_size(3);
+    convolution_param->set_pad(1);
+    convolution_param->set_num_output(4);
+    convolution_param->set_engine(engines[e]);
+    convolution_param->mutable_weight_filler()->set_type("gaussian");
+    convolution_param->mutable_bias_filler()->set_type("constant");
+    convolution_param->mutable_bias_filler()->set_value(0.1);
+    ConvolutionLayer<Dtype> unlimited(layer_param);
+    unlimited.SetUp(this->blob_bottom_vec_, this->blob_top_vec_);
+    // the scratch blobs of the engine hold one image at a time.
+    convolution_param->set_workspace_limit(1);
+    ConvolutionLayer<Dtype> layer(layer_param);
+    layer.SetUp(this->blob_bottom_vec_, this->blob_top_vec_);
+    EXPECT_EQ(unlimited.workspace(1)->count(), 5 * layer.workspace(1)->count());
+    EXPECT_EQ(unlimited.workspace(2)->count(), 5 * layer.workspace(2)->count());
+    layer.Forward(this->blob_bottom_vec_, this->blob_top_vec_);
+    caffe_conv(this->blob_bottom_, convolution_param, layer.blobs(),
+        this->MakeReferenceTop(this->blob_top_));
+    const Dtype* top_data = this->blob_top_->cpu_data();
+    const Dtype* ref_top_data = this->ref_blob_top_->cpu_data();
+    for (int i = 0; i < this->blob_top_->count(); ++i) {
+      EXPECT_NEAR(top_data[i], ref_top_data[i], 1e-3);
+    }
+  }
+}
+
+TYPED_TEST(ConvolutionLayerTest, TestFFTCostModel) {
+  typedef typename TypeParam::Dtype Dtype;
+  this->blob_bottom_->Reshape(1, 16, 32, 32);
+  // by default, 11x11 filters run in the frequency domain and 3x3 filters
+  // through im2col, which leaves the spectra empty.
+  const int kernel_sizes[] = { 3, 11 };
+  for (int k = 0; k < 2; ++k) {
+    LayerParameter layer_param;
+    ConvolutionParameter* convolution_param =
+        layer_param.mutable_convolution_param();
+    convolution_param->set_kernel_size(kernel_sizes[k]);
+    convolution_param->set_pad(kernel_sizes[k] / 2);
+    convolution_param->set_num_output(16);
+    ConvolutionLayer<Dtype> layer(layer_param);
+    layer.SetUp(this->blob_bottom_vec_, this->blob_top_vec_);
+    EXPECT_EQ(layer.workspace(1)->count() > 0, kernel_sizes[k] == 11);
+#ifdef USE_OPENCL
+    // the warm up of the net builds the programs of the chosen engine.
+    vector<string> programs;
+    layer.opencl_programs(&programs);
+    EXPECT_EQ(std::count(programs.begin(), programs.end(), "fft") > 0,
+              kernel_sizes[k] == 11);
+#endif
+  }
+}
+
 TYPED_TEST(ConvolutionLayerTest, TestSobelConvolution) {
   // Test separable convolution by computing the Sobel operator
   // as a single filter then comparing the result
@@ -487,12 +764,50 @@ TYPED_TEST(ConvolutionLayerTest, TestGradientGroup) {
       this->blob_top_vec_);
 }
 
+TYPED_TEST(ConvolutionLayerTest, TestGradientWorkspaceLimit) {
+  typedef typename TypeParam::Dtype Dtype;
+  this->blob_bottom_->Reshape(3, 3, 6, 4);
+  FillerParameter filler_param;
+  filler_param.set_value(1.);
+  GaussianFiller<Dtype> filler(filler_param);
+  filler.Fill(this->blob_bottom_);
+  LayerParameter layer_param;
+  ConvolutionParameter* convolution_param =
+      layer_param.mutable_convolution_param();
+  convolution_param->set_kernel_size(3);
+  convolution_param->set_stride(2);
+  convolution_param->set_num_output(3);
+  convolution_param->set_group(3);
+  // less than the columns of one image, the batch runs image by image.
+  convolution_param->set_workspace_limit(1);
+  convolution_param->mutable_weight_filler()->set_type("gaussian");
+  convolution_param->mutable_bias_filler()->set_type("gaussian");
+  ConvolutionLayer<Dtype> layer(layer_param);
+  GradientChecker<Dtype> checker(1e-2, 1e-3);
+  checker.CheckGradientExhaustive(&layer, this->blob_bottom_vec_,
+      this->blob_top_vec_);
+}
+
 TYPED_TEST(ConvolutionLayerTest, TestForwardPerformance) {
   for (int i = 0; i < 10; i++) {
     this->ConvolutionLayerTestForwardPerformance(100, 3, 32, 32);
   }
 }
 
+TYPED_TEST(ConvolutionLayerTest, TestForwardPerformanceDirect) {
+  const int shapes[][2] = { {3, 1}, {5, 1}, {1, 1}, {1, 2} };
+  const int num_shapes = sizeof(shapes) / sizeof(shapes[0]);
+  for (int s = 0; s < num_shapes; ++s) {
+    const float im2col_time = this->ConvolutionLayerTestEnginePerformance(
+        shapes[s][0], shapes[s][1], ConvolutionParameter_Engine_CAFFE);
+    const float direct_time = this->ConvolutionLayerTestEnginePerformance(
+        shapes[s][0], shapes[s][1], ConvolutionParameter_Engine_DIRECT);
+    LOG(INFO) << shapes[s][0] << "x" << shapes[s][0] << " filters, stride "
+              << shapes[s][1] << ": im2col " << im2col_time << "ms, direct "
+              << direct_time << "ms";
+  }
+}
+
 #ifdef USE_CUDNN
 
 template <typename Dtype>
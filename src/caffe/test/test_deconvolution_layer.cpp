@@ -137,6 +137,50 @@ TYPED_TEST(DeconvolutionLayerTest, TestSimpleDeconvolution) {
   }
 }
 
+TYPED_TEST(DeconvolutionLayerTest, TestSimpleDeconvolutionFFT) {
+  typedef typename TypeParam::Dtype Dtype;
+  // filter size, stride, pad and group.
+  const int shapes[][4] = {
+      {3, 2, 0, 1}, {4, 2, 1, 1}, {5, 1, 2, 1}, {4, 2, 1, 3} };
+  const int num_shapes = sizeof(shapes) / sizeof(shapes[0]);
+  FillerParameter filler_param;
+  filler_param.set_value(1.);
+  GaussianFiller<Dtype> filler(filler_param);
+  filler.Fill(this->blob_bottom_);
+  vector<Blob<Dtype>*> ref_top_vec(1, this->blob_top_2_);
+  for (int s = 0; s < num_shapes; ++s) {
+    LayerParameter layer_param;
+    ConvolutionParameter* convolution_param =
+        layer_param.mutable_convolution_param();
+    convolution_param->set_kernel_size(shapes[s][0]);
+    convolution_param->set_stride(shapes[s][1]);
+    convolution_param->set_pad(shapes[s][2]);
+    convolution_param->set_group(shapes[s][3]);
+    convolution_param->set_num_output(6);
+    convolution_param->mutable_weight_filler()->set_type("gaussian");
+    convolution_param->mutable_bias_filler()->set_type("constant");
+    convolution_param->mutable_bias_filler()->set_value(0.1);
+    // the im2col deconvolution as the reference.
+    convolution_param->set_engine(ConvolutionParameter_Engine_CAFFE);
+    DeconvolutionLayer<Dtype> ref_layer(layer_param);
+    ref_layer.SetUp(this->blob_bottom_vec_, ref_top_vec);
+    ref_layer.Forward(this->blob_bottom_vec_, ref_top_vec);
+    convolution_param->set_engine(ConvolutionParameter_Engine_FFT);
+    DeconvolutionLayer<Dtype> layer(layer_param);
+    layer.SetUp(this->blob_bottom_vec_, this->blob_top_vec_);
+    for (int i = 0; i < layer.blobs().size(); ++i) {
+      layer.blobs()[i]->CopyFrom(*ref_layer.blobs()[i]);
+    }
+    layer.Forward(this->blob_bottom_vec_, this->blob_top_vec_);
+    ASSERT_EQ(this->blob_top_->count(), this->blob_top_2_->count());
+    const Dtype* top_data = this->blob_top_->cpu_data();
+    const Dtype* ref_top_data = this->blob_top_2_->cpu_data();
+    for (int i = 0; i < this->blob_top_->count(); ++i) {
+      EXPECT_NEAR(top_data[i], ref_top_data[i], 1e-4);
+    }
+  }
+}
+
 TYPED_TEST(DeconvolutionLayerTest, TestGradient) {
   typedef typename TypeParam::Dtype Dtype;
   LayerParameter layer_param;
@@ -9,6 +9,7 @@
 #include "caffe/common.hpp"
 #include "caffe/filler.hpp"
 #include "caffe/net.hpp"
+#include "caffe/util/benchmark.hpp"
 #include "caffe/util/math_functions.hpp"
 
 #include "caffe/test/test_caffe_main.hpp"
@@ -613,6 +614,89 @@ class NetTest : public MultiDeviceTest<TypeParam> {
     InitNetFromProtoString(proto);
   }
 
+  virtual void InitBranchedNet() {
+    // an inception module: parallel branches between a split and a concat.
+    const string& proto =
+        "name: 'BranchedNetwork' "
+        "input: 'data' "
+        "input_dim: 8 "
+        "input_dim: 32 "
+        "input_dim: 28 "
+        "input_dim: 28 "
+        "layer { "
+        "  name: 'conv1x1' "
+        "  type: 'Convolution' "
+        "  bottom: 'data' "
+        "  top: 'conv1x1' "
+        "  convolution_param { "
+        "    num_output: 16 "
+        "    kernel_size: 1 "
+        "    weight_filler { "
+        "      type: 'gaussian' "
+        "      std: 0.01 "
+        "    } "
+        "  } "
+        "} "
+        "layer { "
+        "  name: 'conv3x3' "
+        "  type: 'Convolution' "
+        "  bottom: 'data' "
+        "  top: 'conv3x3' "
+        "  convolution_param { "
+        "    num_output: 32 "
+        "    kernel_size: 3 "
+        "    pad: 1 "
+        "    weight_filler { "
+        "      type: 'gaussian' "
+        "      std: 0.01 "
+        "    } "
+        "  } "
+        "} "
+        "layer { "
+        "  name: 'relu3x3' "
+        "  type: 'ReLU' "
+        "  bottom: 'conv3x3' "
+        "  top: 'conv3x3' "
+        "} "
+        "layer { "
+        "  name: 'conv5x5' "
+        "  type: 'Convolution' "
+        "  bottom: 'data' "
+        "  top: 'conv5x5' "
+        "  convolution_param { "
+        "    num_output: 8 "
+        "    kernel_size: 5 "
+        "    pad: 2 "
+        "    weight_filler { "
+        "      type: 'gaussian' "
+        "      std: 0.01 "
+        "    } "
+        "  } "
+        "} "
+        "layer { "
+        "  name: 'pool' "
+        "  type: 'Pooling' "
+        "  bottom: 'data' "
+        "  top: 'pool' "
+        "  pooling_param { "
+        "    pool: MAX "
+        "    kernel_size: 3 "
+        "    stride: 1 "
+        "    pad: 1 "
+        "  } "
+        "} "
+        "layer { "
+        "  name: 'concat' "
+        "  type: 'Concat' "
+        "  bottom: 'conv1x1' "
+        "  bottom: 'conv3x3' "
+        "  bottom: 'conv5x5' "
+        "  bottom: 'pool' "
+        "  top: 'concat' "
+        "} ";
+    InitNetFromProtoString(proto);
+  }
+
   int seed_;
   shared_ptr<Net<Dtype> > net_;
 };
@@ -1249,6 +1333,495 @@ TYPED_TEST(NetTest, TestFromTo) {
   }
 }
 
+TYPED_TEST(NetTest, TestSharedWorkspace) {
+  typedef typename TypeParam::Dtype Dtype;
+  const string& proto =
+      "name: 'StackedNetwork' "
+      "input: 'data' "
+      "input_dim: 4 "
+      "input_dim: 3 "
+      "input_dim: 16 "
+      "input_dim: 16 "
+      "layer { "
+      "  name: 'conv1' "
+      "  type: 'Convolution' "
+      "  bottom: 'data' "
+      "  top: 'conv1' "
+      "  convolution_param { "
+      "    num_output: 8 "
+      "    kernel_size: 3 "
+      "    weight_filler { "
+      "      type: 'gaussian' "
+      "      std: 0.01 "
+      "    } "
+      "  } "
+      "} "
+      "layer { "
+      "  name: 'relu1' "
+      "  type: 'ReLU' "
+      "  bottom: 'conv1' "
+      "  top: 'conv1' "
+      "} "
+      "layer { "
+      "  name: 'conv2' "
+      "  type: 'Convolution' "
+      "  bottom: 'conv1' "
+      "  top: 'conv2' "
+      "  convolution_param { "
+      "    num_output: 8 "
+      "    kernel_size: 5 "
+      "    workspace_limit: 1 "
+      "    weight_filler { "
+      "      type: 'gaussian' "
+      "      std: 0.01 "
+      "    } "
+      "  } "
+      "} ";
+  this->InitNetFromProtoString(proto);
+  const vector<shared_ptr<Layer<Dtype> > >& layers = this->net_->layers();
+  ASSERT_EQ(3, layers.size());
+  EXPECT_EQ(layers[0]->workspace(0), layers[2]->workspace(0));
+  // conv2 holds the columns of one image only.
+  EXPECT_EQ(1, layers[2]->workspace(0)->num());
+  // the arena holds the columns of conv1, the larger of the two.
+  const int conv1_count = 4 * 3 * 3 * 3 * 14 * 14;
+  EXPECT_EQ(conv1_count, layers[0]->workspace(0)->capacity());
+  FillerParameter filler_param;
+  GaussianFiller<Dtype> filler(filler_param);
+  filler.Fill(this->net_->input_blobs()[0]);
+  this->net_->ForwardPrefilled();
+  // conv1 runs on the whole batch again.
+  layers[0]->Reshape(this->net_->bottom_vecs()[0], this->net_->top_vecs()[0]);
+  EXPECT_EQ(4, layers[0]->workspace(0)->num());
+  EXPECT_EQ(conv1_count, layers[0]->workspace(0)->capacity());
+}
+
+TYPED_TEST(NetTest, TestWorkspaceArenaForwardOnly) {
+  typedef typename TypeParam::Dtype Dtype;
+  // without a loss, the layers of the net run no Backward, and pool1 and
+  // norm1 keep the results for Backward in the arena as well.
+  Caffe::set_random_seed(this->seed_);
+  this->InitReshapableNet();
+  FillerParameter filler_param;
+  filler_param.set_std(1);
+  GaussianFiller<Dtype> filler(filler_param);
+  Blob<Dtype> input;
+  input.ReshapeLike(*this->net_->input_blobs()[0]);
+  filler.Fill(&input);
+  this->net_->input_blobs()[0]->CopyFrom(input);
+  this->net_->ForwardPrefilled();
+  Blob<Dtype> expected;
+  expected.CopyFrom(*this->net_->output_blobs()[0], false, true);
+
+  // the same net with private blobs for Backward.
+  NetParameter param;
+  this->net_->ToProto(&param);
+  param.set_force_backward(true);
+  Caffe::set_random_seed(this->seed_);
+  this->net_.reset(new Net<Dtype>(param));
+  this->net_->input_blobs()[0]->CopyFrom(input);
+  this->net_->ForwardPrefilled();
+  const Blob<Dtype>& output = *this->net_->output_blobs()[0];
+  ASSERT_EQ(expected.count(), output.count());
+  for (int i = 0; i < output.count(); ++i) {
+    EXPECT_EQ(expected.cpu_data()[i], output.cpu_data()[i]);
+  }
+}
+
+TYPED_TEST(NetTest, TestWorkspaceArenaPerQueue) {
+  typedef typename TypeParam::Dtype Dtype;
+#ifdef USE_OPENCL
+  unsigned int num_queues = 0;
+  bool out_of_order = false;
+  if (Caffe::mode() == Caffe::GPU) {
+    OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+    num_queues = device.getNumCommandQueues();
+    out_of_order = device.getOutOfOrderExecution();
+    ASSERT_TRUE(device.setOutOfOrderExecution(false));
+    ASSERT_TRUE(device.setNumCommandQueues(1));
+  }
+#endif
+  // on a single command queue the branches run one after another and share
+  // one arena.
+  this->InitBranchedNet();
+  shared_ptr<Layer<Dtype> > conv3x3 = this->net_->layer_by_name("conv3x3");
+  shared_ptr<Layer<Dtype> > conv5x5 = this->net_->layer_by_name("conv5x5");
+  EXPECT_EQ(conv3x3->workspace(0), conv5x5->workspace(0));
+#ifdef USE_OPENCL
+  if (Caffe::mode() == Caffe::GPU) {
+    // the branches on separate queues get arenas of their own.
+    OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+    ASSERT_TRUE(device.setNumCommandQueues(4));
+    FillerParameter filler_param;
+    GaussianFiller<Dtype> filler(filler_param);
+    filler.Fill(this->net_->input_blobs()[0]);
+    this->net_->ForwardPrefilled();
+    EXPECT_NE(conv3x3->workspace(0), conv5x5->workspace(0));
+    EXPECT_TRUE(device.setNumCommandQueues(num_queues));
+    EXPECT_TRUE(device.setOutOfOrderExecution(out_of_order));
+  }
+#endif
+}
+
+TYPED_TEST(NetTest, TestOptimizeMemory) {
+  typedef typename TypeParam::Dtype Dtype;
+  string proto =
+      "name: 'ChainNetwork' "
+      "input: 'data' "
+      "input_dim: 2 "
+      "input_dim: 3 "
+      "input_dim: 4 "
+      "input_dim: 4 ";
+  for (int i = 1; i <= 4; ++i) {
+    ostringstream bottom;
+    if (i == 1) {
+      bottom << "data";
+    } else {
+      bottom << "ip" << i - 1;
+    }
+    ostringstream layer;
+    layer << "layer { "
+          << "  name: 'ip" << i << "' "
+          << "  type: 'InnerProduct' "
+          << "  bottom: '" << bottom.str() << "' "
+          << "  top: 'ip" << i << "' "
+          << "  inner_product_param { "
+          << "    num_output: " << 10 - i << " "
+          << "    weight_filler { "
+          << "      type: 'gaussian' "
+          << "      std: 0.1 "
+          << "    } "
+          << "  } "
+          << "} ";
+    proto += layer.str();
+  }
+  Caffe::set_random_seed(this->seed_);
+  this->InitNetFromProtoString(proto);
+  FillerParameter filler_param;
+  GaussianFiller<Dtype> filler(filler_param);
+  Blob<Dtype> input;
+  input.ReshapeLike(*this->net_->input_blobs()[0]);
+  filler.Fill(&input);
+  this->net_->input_blobs()[0]->CopyFrom(input);
+  this->net_->ForwardPrefilled();
+  Blob<Dtype> expected;
+  expected.CopyFrom(*this->net_->output_blobs()[0], false, true);
+
+  Caffe::set_random_seed(this->seed_);
+  this->InitNetFromProtoString(proto + "optimize_memory: true ");
+  // ip1 is dead once ip2 has run, ip3 takes its memory.
+  EXPECT_EQ(this->net_->blob_by_name("ip1")->data(),
+            this->net_->blob_by_name("ip3")->data());
+  EXPECT_NE(this->net_->blob_by_name("ip1")->data(),
+            this->net_->blob_by_name("ip2")->data());
+  EXPECT_NE(this->net_->blob_by_name("ip2")->data(),
+            this->net_->blob_by_name("ip4")->data());
+  EXPECT_NE(this->net_->blob_by_name("data")->data(),
+            this->net_->blob_by_name("ip2")->data());
+  this->net_->input_blobs()[0]->CopyFrom(input);
+  this->net_->ForwardPrefilled();
+  const Blob<Dtype>& output = *this->net_->output_blobs()[0];
+  ASSERT_EQ(expected.count(), output.count());
+  for (int i = 0; i < output.count(); ++i) {
+    EXPECT_EQ(expected.cpu_data()[i], output.cpu_data()[i]);
+  }
+  // a larger batch reallocates the shared memory.
+  this->net_->input_blobs()[0]->Reshape(4, 3, 4, 4);
+  this->net_->Reshape();
+  EXPECT_EQ(this->net_->blob_by_name("ip1")->data(),
+            this->net_->blob_by_name("ip3")->data());
+  EXPECT_GE(this->net_->blob_by_name("ip3")->data()->size(),
+            4 * 9 * sizeof(Dtype));
+
+  this->InitNetFromProtoString(proto + "optimize_memory: true "
+                               "keep_blob: 'ip1' ");
+  EXPECT_NE(this->net_->blob_by_name("ip1")->data(),
+            this->net_->blob_by_name("ip3")->data());
+}
+
+TYPED_TEST(NetTest, TestFuseLayers) {
+  typedef typename TypeParam::Dtype Dtype;
+  const string proto =
+      "name: 'FusedNetwork' "
+      "input: 'data' "
+      "input_dim: 2 "
+      "input_dim: 3 "
+      "input_dim: 6 "
+      "input_dim: 6 "
+      "layer { "
+      "  name: 'conv1' "
+      "  type: 'Convolution' "
+      "  bottom: 'data' "
+      "  top: 'conv1' "
+      "  convolution_param { "
+      "    num_output: 4 "
+      "    kernel_size: 3 "
+      "    pad: 1 "
+      "    weight_filler { "
+      "      type: 'gaussian' "
+      "      std: 0.1 "
+      "    } "
+      "    bias_filler { "
+      "      type: 'gaussian' "
+      "      std: 0.1 "
+      "    } "
+      "  } "
+      "} "
+      "layer { "
+      "  name: 'relu1' "
+      "  type: 'ReLU' "
+      "  bottom: 'conv1' "
+      "  top: 'conv1' "
+      "} "
+      "layer { "
+      "  name: 'pool1' "
+      "  type: 'Pooling' "
+      "  bottom: 'conv1' "
+      "  top: 'pool1' "
+      "  pooling_param { "
+      "    pool: MAX "
+      "    kernel_size: 2 "
+      "    stride: 2 "
+      "  } "
+      "} "
+      "layer { "
+      "  name: 'ip1' "
+      "  type: 'InnerProduct' "
+      "  bottom: 'pool1' "
+      "  top: 'ip1' "
+      "  inner_product_param { "
+      "    num_output: 5 "
+      "    weight_filler { "
+      "      type: 'gaussian' "
+      "      std: 0.1 "
+      "    } "
+      "    bias_filler { "
+      "      type: 'gaussian' "
+      "      std: 0.1 "
+      "    } "
+      "  } "
+      "} "
+      "layer { "
+      "  name: 'relu2' "
+      "  type: 'ReLU' "
+      "  bottom: 'ip1' "
+      "  top: 'relu2' "
+      "} "
+      "layer { "
+      "  name: 'ip2' "
+      "  type: 'InnerProduct' "
+      "  bottom: 'relu2' "
+      "  top: 'ip2' "
+      "  inner_product_param { "
+      "    num_output: 5 "
+      "    weight_filler { "
+      "      type: 'gaussian' "
+      "      std: 0.1 "
+      "    } "
+      "  } "
+      "} "
+      "layer { "
+      "  name: 'sum' "
+      "  type: 'Eltwise' "
+      "  bottom: 'relu2' "
+      "  bottom: 'ip2' "
+      "  top: 'sum' "
+      "} "
+      "layer { "
+      "  name: 'relu3' "
+      "  type: 'ReLU' "
+      "  bottom: 'sum' "
+      "  top: 'sum' "
+      "  relu_param { "
+      "    negative_slope: 0.1 "
+      "  } "
+      "} ";
+  Caffe::set_random_seed(this->seed_);
+  this->InitNetFromProtoString(proto);
+  EXPECT_EQ(8, this->net_->layers().size());
+  FillerParameter filler_param;
+  GaussianFiller<Dtype> filler(filler_param);
+  Blob<Dtype> input;
+  input.ReshapeLike(*this->net_->input_blobs()[0]);
+  filler.Fill(&input);
+  this->net_->input_blobs()[0]->CopyFrom(input);
+  this->net_->ForwardPrefilled();
+  Blob<Dtype> expected;
+  expected.CopyFrom(*this->net_->output_blobs()[0], false, true);
+
+  Caffe::set_random_seed(this->seed_);
+  this->InitNetFromProtoString(proto + "fuse_layers: true ");
+#if defined(USE_CUDA) && !defined(USE_OPENCL)
+  // the CUDA layers do not fuse, see Net::FuseLayers.
+  EXPECT_EQ(8, this->net_->layers().size());
+  return;
+#endif
+  // the ReLUs are folded into conv1, ip1 and sum, which write their tops,
+  // and pool1 into conv1.
+  EXPECT_EQ(4, this->net_->layers().size());
+  EXPECT_FALSE(this->net_->has_layer("relu1"));
+  EXPECT_FALSE(this->net_->has_layer("pool1"));
+  EXPECT_FALSE(this->net_->has_blob("conv1"));
+  EXPECT_TRUE(this->net_->layer_by_name("conv1")->layer_param()
+              .fused_pooling());
+  EXPECT_EQ(2, this->net_->layer_by_name("conv1")->layer_param()
+            .pooling_param().kernel_size());
+  EXPECT_FALSE(this->net_->has_blob("ip1"));
+  EXPECT_TRUE(this->net_->layer_by_name("ip1")->layer_param().fused_relu());
+  EXPECT_FLOAT_EQ(0.1, this->net_->layer_by_name("sum")->layer_param()
+                  .relu_param().negative_slope());
+  this->net_->input_blobs()[0]->CopyFrom(input);
+  this->net_->ForwardPrefilled();
+  const Blob<Dtype>& output = *this->net_->output_blobs()[0];
+  ASSERT_EQ(expected.count(), output.count());
+  for (int i = 0; i < output.count(); ++i) {
+    EXPECT_NEAR(expected.cpu_data()[i], output.cpu_data()[i], 1e-5);
+  }
+}
+
+#ifdef USE_OPENCL
+TYPED_TEST(NetTest, TestScheduledForward) {
+  typedef typename TypeParam::Dtype Dtype;
+  if (Caffe::mode() != Caffe::GPU) {
+    return;
+  }
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  const unsigned int num_queues = device.getNumCommandQueues();
+  this->InitBranchedNet();
+  FillerParameter filler_param;
+  GaussianFiller<Dtype> filler(filler_param);
+  filler.Fill(this->net_->input_blobs()[0]);
+
+  const int kIterations = 20;
+  Blob<Dtype> expected;
+  ASSERT_TRUE(device.setNumCommandQueues(1));
+  this->net_->ForwardPrefilled();
+  expected.CopyFrom(*this->net_->output_blobs()[0], false, true);
+  CPUTimer timer;
+  timer.Start();
+  for (int i = 0; i < kIterations; ++i) {
+    this->net_->ForwardPrefilled();
+  }
+  Caffe::DeviceSync();
+  timer.Stop();
+  const float serial_ms = timer.MilliSeconds() / kIterations;
+
+  // the four branches of the module run on separate command queues.
+  ASSERT_TRUE(device.setNumCommandQueues(4));
+  this->net_->ForwardPrefilled();
+  timer.Start();
+  for (int i = 0; i < kIterations; ++i) {
+    this->net_->ForwardPrefilled();
+  }
+  Caffe::DeviceSync();
+  timer.Stop();
+  const float scheduled_ms = timer.MilliSeconds() / kIterations;
+  printf("branched forward: 1 queue %.3fms, 4 queues %.3fms, speedup %.2fx\n",
+         serial_ms, scheduled_ms, serial_ms / scheduled_ms);
+
+  const Blob<Dtype>& output = *this->net_->output_blobs()[0];
+  ASSERT_EQ(expected.count(), output.count());
+  for (int i = 0; i < output.count(); ++i) {
+    EXPECT_EQ(expected.cpu_data()[i], output.cpu_data()[i]);
+  }
+  EXPECT_TRUE(device.setNumCommandQueues(num_queues));
+}
+
+TYPED_TEST(NetTest, TestOutOfOrderForward) {
+  typedef typename TypeParam::Dtype Dtype;
+  if (Caffe::mode() != Caffe::GPU) {
+    return;
+  }
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  const bool out_of_order = device.getOutOfOrderExecution();
+  this->InitBranchedNet();
+  FillerParameter filler_param;
+  GaussianFiller<Dtype> filler(filler_param);
+  filler.Fill(this->net_->input_blobs()[0]);
+
+  const int kIterations = 20;
+  Blob<Dtype> expected;
+  ASSERT_TRUE(device.setOutOfOrderExecution(false));
+  this->net_->ForwardPrefilled();
+  expected.CopyFrom(*this->net_->output_blobs()[0], false, true);
+  CPUTimer timer;
+  timer.Start();
+  for (int i = 0; i < kIterations; ++i) {
+    this->net_->ForwardPrefilled();
+  }
+  Caffe::DeviceSync();
+  timer.Stop();
+  const float in_order_ms = timer.MilliSeconds() / kIterations;
+
+  if (!device.setOutOfOrderExecution(true)) {
+    LOG(INFO) << "skip, no out-of-order command queue on " << device.name();
+    return;
+  }
+  // the host only waits when it reads the output.
+  this->net_->ForwardPrefilled();
+  timer.Start();
+  for (int i = 0; i < kIterations; ++i) {
+    this->net_->ForwardPrefilled();
+  }
+  Caffe::DeviceSync();
+  timer.Stop();
+  const float out_of_order_ms = timer.MilliSeconds() / kIterations;
+  printf("branched forward: in-order %.3fms, out-of-order %.3fms\n",
+         in_order_ms, out_of_order_ms);
+
+  const Blob<Dtype>& output = *this->net_->output_blobs()[0];
+  ASSERT_EQ(expected.count(), output.count());
+  for (int i = 0; i < output.count(); ++i) {
+    EXPECT_EQ(expected.cpu_data()[i], output.cpu_data()[i]);
+  }
+  EXPECT_TRUE(device.setOutOfOrderExecution(out_of_order));
+}
+
+TYPED_TEST(NetTest, TestDeviceLoss) {
+  typedef typename TypeParam::Dtype Dtype;
+  if (Caffe::mode() != Caffe::GPU) {
+    return;
+  }
+  const int kIterations = 5;
+  const int kSlots = 3;
+  Caffe::set_random_seed(this->seed_);
+  this->InitUnsharedWeightsNet();
+  vector<Dtype> losses;
+  for (int i = 0; i < kIterations; ++i) {
+    Dtype loss;
+    this->net_->ForwardPrefilled(&loss);
+    losses.push_back(loss);
+  }
+  ASSERT_GE(fabs(losses.back()), 1e-2);
+
+  // the same forward passes, with the losses of the last kSlots on the device.
+  Caffe::set_random_seed(this->seed_);
+  this->InitUnsharedWeightsNet();
+  this->net_->set_device_loss_slots(kSlots);
+  EXPECT_EQ(0, this->net_->DeviceLoss());
+  Dtype expected = 0;
+  for (int i = 0; i < kIterations; ++i) {
+    Dtype loss;
+    this->net_->ForwardPrefilled(&loss);
+    EXPECT_EQ(0, loss);
+    expected = 0;
+    const int filled = std::min(i + 1, kSlots);
+    for (int j = i + 1 - filled; j <= i; ++j) {
+      expected += losses[j] / filled;
+    }
+    EXPECT_NEAR(expected, this->net_->DeviceLoss(), 1e-4 * fabs(expected));
+  }
+
+  // a forward of a part of the net still returns its loss.
+  Dtype loss = this->net_->ForwardFrom(1);
+  EXPECT_NE(0, loss);
+  EXPECT_NEAR(expected, this->net_->DeviceLoss(), 1e-4 * fabs(expected));
+  this->net_->set_device_loss_slots(0);
+  this->net_->ForwardPrefilled(&loss);
+  EXPECT_NE(0, loss);
+}
+#endif  // USE_OPENCL
+
 class FilterNetTest : public ::testing::Test {
  protected:
   void RunFilterNetTest(
@@ -478,6 +478,25 @@ TYPED_TEST(NeuronLayerTest, TestDropoutGradient) {
       this->blob_top_vec_);
 }
 
+TYPED_TEST(NeuronLayerTest, TestDropoutBackwardMask) {
+  typedef typename TypeParam::Dtype Dtype;
+  LayerParameter layer_param;
+  layer_param.set_phase(TRAIN);
+  DropoutLayer<Dtype> layer(layer_param);
+  layer.SetUp(this->blob_bottom_vec_, this->blob_top_vec_);
+  layer.Forward(this->blob_bottom_vec_, this->blob_top_vec_);
+  caffe_set(this->blob_top_->count(), Dtype(1),
+      this->blob_top_->mutable_cpu_diff());
+  vector<bool> propagate_down(1, true);
+  layer.Backward(this->blob_top_vec_, propagate_down, this->blob_bottom_vec_);
+  // Backward drops the inputs Forward dropped.
+  const Dtype* top_data = this->blob_top_->cpu_data();
+  const Dtype* bottom_diff = this->blob_bottom_->cpu_diff();
+  for (int i = 0; i < this->blob_bottom_->count(); ++i) {
+    EXPECT_EQ(top_data[i] != 0, bottom_diff[i] != 0);
+  }
+}
+
 TYPED_TEST(NeuronLayerTest, TestDropoutGradientTest) {
   typedef typename TypeParam::Dtype Dtype;
   LayerParameter layer_param;
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <vector>
@@ -71,6 +72,40 @@ TYPED_TEST(SoftmaxLayerTest, TestForward) {
   }
 }
 
+TYPED_TEST(SoftmaxLayerTest, TestForwardManyChannels) {
+  typedef typename TypeParam::Dtype Dtype;
+  // enough channels for the OpenCL kernels to reduce a row per work group
+  this->blob_bottom_->Reshape(2, 1000, 1, 2);
+  FillerParameter filler_param;
+  filler_param.set_std(4);
+  GaussianFiller<Dtype> filler(filler_param);
+  filler.Fill(this->blob_bottom_);
+  LayerParameter layer_param;
+  SoftmaxLayer<Dtype> layer(layer_param);
+  layer.SetUp(this->blob_bottom_vec_, this->blob_top_vec_);
+  layer.Forward(this->blob_bottom_vec_, this->blob_top_vec_);
+  for (int i = 0; i < this->blob_bottom_->num(); ++i) {
+    for (int l = 0; l < this->blob_bottom_->width(); ++l) {
+      Dtype max = this->blob_bottom_->data_at(i, 0, 0, l);
+      for (int j = 1; j < this->blob_bottom_->channels(); ++j) {
+        max = std::max(max, this->blob_bottom_->data_at(i, j, 0, l));
+      }
+      Dtype sum = 0;
+      Dtype scale = 0;
+      for (int j = 0; j < this->blob_bottom_->channels(); ++j) {
+        sum += this->blob_top_->data_at(i, j, 0, l);
+        scale += exp(this->blob_bottom_->data_at(i, j, 0, l) - max);
+      }
+      EXPECT_NEAR(sum, 1, 1e-3);
+      for (int j = 0; j < this->blob_bottom_->channels(); ++j) {
+        EXPECT_NEAR(this->blob_top_->data_at(i, j, 0, l),
+            exp(this->blob_bottom_->data_at(i, j, 0, l) - max) / scale, 1e-4)
+            << "debug: " << i << " " << j << " " << l;
+      }
+    }
+  }
+}
+
 TYPED_TEST(SoftmaxLayerTest, TestGradient) {
   typedef typename TypeParam::Dtype Dtype;
   LayerParameter layer_param;
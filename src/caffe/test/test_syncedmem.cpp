@@ -7,6 +7,9 @@
 #include "caffe/syncedmem.hpp"
 #include "caffe/util/device_alternate.hpp"
 #include "caffe/util/math_functions.hpp"
+#ifdef USE_OPENCL
+#include "caffe/util/OpenCL/OpenCLSupport.hpp"
+#endif
 
 #include "caffe/test/test_caffe_main.hpp"
 
@@ -41,6 +44,15 @@ TEST_F(SyncedMemoryTest, TestAllocationCPU) {
   EXPECT_TRUE(mem.mutable_cpu_data());
 }
 
+TEST_F(SyncedMemoryTest, TestVersion) {
+  SyncedMemory mem(10);
+  const unsigned int version = mem.version();
+  mem.cpu_data();
+  EXPECT_EQ(mem.version(), version);
+  mem.mutable_cpu_data();
+  EXPECT_NE(mem.version(), version);
+}
+
 #if defined(USE_CUDA) || defined(USE_OPENCL)  // GPU test
 
 TEST_F(SyncedMemoryTest, TestAllocationGPU) {
@@ -123,6 +135,42 @@ TEST_F(SyncedMemoryTest, TestGPUWrite) {
   EXPECT_EQ(mem.head(), SyncedMemory::SYNCED);
 }
 
+#ifdef USE_OPENCL
+
+TEST_F(SyncedMemoryTest, TestZeroCopy) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  bool zero_copy = device.getZeroCopy();
+  device.setZeroCopy(true);
+  Caffe::Brew mode = Caffe::mode();
+  Caffe::set_mode(Caffe::GPU);
+
+  SyncedMemory mem(10);
+  void* cpu_data = mem.mutable_cpu_data();
+  caffe_memset(mem.size(), 1, cpu_data);
+  const void* gpu_data = mem.gpu_data();
+  EXPECT_EQ(mem.head(), SyncedMemory::SYNCED);
+  char* recovered_value = new char[10];
+  caffe_gpu_memcpy(10, gpu_data, recovered_value);
+  for (int i = 0; i < mem.size(); ++i) {
+    EXPECT_EQ(recovered_value[i], 1);
+  }
+
+  void* gpu_mutable = mem.mutable_gpu_data();
+  EXPECT_EQ(gpu_data, gpu_mutable);
+  caffe_gpu_memset(mem.size(), static_cast<char>(2), gpu_mutable);
+  const void* cpu_const = mem.cpu_data();
+  EXPECT_EQ(mem.head(), SyncedMemory::SYNCED);
+  for (int i = 0; i < mem.size(); ++i) {
+    EXPECT_EQ((static_cast<const char*>(cpu_const))[i], 2);
+  }
+  delete[] recovered_value;
+
+  Caffe::set_mode(mode);
+  device.setZeroCopy(zero_copy);
+}
+
+#endif  // USE_OPENCL
+
 #endif
 
 }  // namespace caffe
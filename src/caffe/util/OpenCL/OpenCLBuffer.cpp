@@ -15,11 +15,22 @@ namespace caffe {
 
   OpenCLBuffer::OpenCLBuffer() {
     available_ = true;
+    requested_size_ = 0;
+    slab_ = NULL;
   }
 
-  OpenCLBuffer::OpenCLBuffer(size_t size)
-      : OpenCLMemory::OpenCLMemory(size) {
+  OpenCLBuffer::OpenCLBuffer(size_t size, cl_mem_flags flags)
+      : OpenCLMemory::OpenCLMemory(size, flags) {
     available_ = true;
+    requested_size_ = 0;
+    slab_ = NULL;
+  }
+
+  OpenCLBuffer::OpenCLBuffer(cl_mem slab, size_t origin, size_t size)
+      : OpenCLMemory::OpenCLMemory(slab, origin, size) {
+    available_ = true;
+    requested_size_ = 0;
+    slab_ = slab;
   }
 
   OpenCLBuffer::~OpenCLBuffer() {
@@ -37,6 +48,18 @@ namespace caffe {
     available_ = false;
   }
 
+  size_t OpenCLBuffer::getRequestedSize() {
+    return requested_size_;
+  }
+
+  void OpenCLBuffer::setRequestedSize(size_t size) {
+    requested_size_ = size;
+  }
+
+  cl_mem OpenCLBuffer::getSlab() {
+    return slab_;
+  }
+
 }  // namespace caffe
 
 #endif  // USE_OPENCL
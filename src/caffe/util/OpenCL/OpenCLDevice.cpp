@@ -1,18 +1,24 @@
 #ifdef USE_OPENCL
 
 #include <CL/cl.h>
+#include <errno.h>
 #include <glog/logging.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <tr1/memory>
+#include <unistd.h>
 
 #include <caffe/util/OpenCL/OpenCLDevice.hpp>
+#include <caffe/util/OpenCL/OpenCLManager.hpp>
 #include <caffe/util/OpenCL/OpenCLMemory.hpp>
 #include <caffe/util/OpenCL/OpenCLParser.hpp>
 #include <caffe/util/OpenCL/OpenCLSupport.hpp>
 
 #include <cstdlib>
 #include <fstream>   // NOLINT(*)
+#include <iomanip>
 #include <iostream>  // NOLINT(*)
 #include <map>
 #include <sstream>   // NOLINT(*)
@@ -21,6 +27,94 @@
 
 namespace caffe {
 
+  // buffers are handed out in size classes of at least this many bytes.
+  static const size_t kMinBufferSize = 256;
+  // small size classes are carved out of slabs of this size.
+  static const size_t kSlabSize = 4 * 1024 * 1024;
+  static const size_t kMinBuffersPerSlab = 4;
+
+  static bool GetDefaultAsyncTransfers() {
+    const char* async = getenv("CAFFE_OPENCL_ASYNC_TRANSFERS");
+    return async != NULL && atoi(async) != 0;
+  }
+
+  // -1 selects pinned host memory depending on the device type.
+  static int GetDefaultPinnedHostMemory() {
+    const char* pinned = getenv("CAFFE_OPENCL_PINNED_HOST_MEMORY");
+    if ( pinned == NULL ) {
+      return -1;
+    }
+    return atoi(pinned) != 0;
+  }
+
+  // -1 selects zero-copy depending on CL_DEVICE_HOST_UNIFIED_MEMORY.
+  static int GetDefaultZeroCopy() {
+    const char* zero_copy = getenv("CAFFE_OPENCL_ZERO_COPY");
+    if ( zero_copy == NULL ) {
+      return -1;
+    }
+    return atoi(zero_copy) != 0;
+  }
+
+  static bool GetDefaultOutOfOrderExecution() {
+    const char* out_of_order = getenv("CAFFE_OPENCL_OUT_OF_ORDER");
+    return out_of_order != NULL && atoi(out_of_order) != 0;
+  }
+
+  static unsigned int GetDefaultNumQueues(const char* name,
+                                          unsigned int num) {
+    const char* value = getenv(name);
+    if ( value == NULL || atoi(value) < 1 ) {
+      return num;
+    }
+    return atoi(value);
+  }
+
+  static size_t GetDefaultMemoryCacheLimit() {
+    const char* limit = getenv("CAFFE_OPENCL_MEMORY_CACHE_MB");
+    if ( limit == NULL ) {
+      return static_cast<size_t>(-1);
+    }
+    return static_cast<size_t>(atol(limit)) * 1024 * 1024;
+  }
+
+  // Reads file_name and replaces its '#include "file"' lines by the content
+  // of the file in include_dir, recursively, the way the OpenCL compiler
+  // resolves them through the -I option of buildOptions().
+  static bool ReadExpandedSource(const std::string& file_name,
+                                 const std::string& include_dir,
+                                 int depth, std::string* result) {
+    if ( depth > 16 ) {
+      LOG(ERROR) << "too many nested includes in file '" << file_name << "'";
+      return false;
+    }
+    std::ifstream file(file_name.c_str());
+    if ( !file.is_open() ) {
+      LOG(ERROR) << "failed to open file '" << file_name << "'";
+      return false;
+    }
+    std::string line;
+    while ( std::getline(file, line) ) {
+      size_t pos = line.find_first_not_of(" \t");
+      if ( pos != std::string::npos && line.compare(pos, 8, "#include") == 0 ) {
+        size_t bgn = line.find('"', pos);
+        size_t end = bgn == std::string::npos
+            ? std::string::npos : line.find('"', bgn + 1);
+        if ( end != std::string::npos ) {
+          std::string included = include_dir + "/"
+              + line.substr(bgn + 1, end - bgn - 1);
+          if ( !ReadExpandedSource(included, include_dir, depth + 1,
+                                   result) ) {
+            return false;
+          }
+          continue;
+        }
+      }
+      *result += line + "\n";
+    }
+    return true;
+  }
+
   OpenCLDevice::OpenCLDevice() {
     deviceID = NULL;
     platformID = NULL;
@@ -41,21 +135,27 @@ namespace caffe {
     deviceLocalMemSize = 0;
     deviceHostUnifiedMem = 0;
     deviceMemBaseAddrAlign = 0;
+    deviceQueueProperties = 0;
 
-    for (int i = 0; i < OPENCL_NUM_INPUT_QUEUES; i++) {
-      inputQueues[i] = NULL;
-    }
+    numInputQueues = GetDefaultNumQueues("CAFFE_OPENCL_NUM_INPUT_QUEUES",
+                                         OPENCL_NUM_INPUT_QUEUES);
     currentInputQueueIdx = 0;
 
-    for (int i = 0; i < OPENCL_NUM_COMMAND_QUEUES; i++) {
-      commandQueues[i] = NULL;
-    }
+    numCommandQueues = GetDefaultNumQueues("CAFFE_OPENCL_NUM_COMMAND_QUEUES",
+                                           OPENCL_NUM_COMMAND_QUEUES);
     currentCommandQueueIdx = 0;
 
-    for (int i = 0; i < OPENCL_NUM_OUTPUT_QUEUES; i++) {
-      outputQueues[i] = NULL;
-    }
+    numOutputQueues = GetDefaultNumQueues("CAFFE_OPENCL_NUM_OUTPUT_QUEUES",
+                                          OPENCL_NUM_OUTPUT_QUEUES);
     currentOutputQueueIdx = 0;
+    out_of_order_ = GetDefaultOutOfOrderExecution();
+    command_event_ = NULL;
+
+    build_mutex_.reset(new boost::mutex());
+    memory_cache_limit_ = GetDefaultMemoryCacheLimit();
+    async_transfers_ = GetDefaultAsyncTransfers();
+    pinned_host_memory_ = GetDefaultPinnedHostMemory();
+    zero_copy_ = GetDefaultZeroCopy();
   }
 
   OpenCLDevice::OpenCLDevice(cl_platform_id pid, cl_device_id did) {
@@ -78,21 +178,27 @@ namespace caffe {
     deviceLocalMemSize = 0;
     deviceHostUnifiedMem = 0;
     deviceMemBaseAddrAlign = 0;
+    deviceQueueProperties = 0;
 
-    for (int i = 0; i < OPENCL_NUM_INPUT_QUEUES; i++) {
-      inputQueues[i] = NULL;
-    }
+    numInputQueues = GetDefaultNumQueues("CAFFE_OPENCL_NUM_INPUT_QUEUES",
+                                         OPENCL_NUM_INPUT_QUEUES);
     currentInputQueueIdx = 0;
 
-    for (int i = 0; i < OPENCL_NUM_COMMAND_QUEUES; i++) {
-      commandQueues[i] = NULL;
-    }
+    numCommandQueues = GetDefaultNumQueues("CAFFE_OPENCL_NUM_COMMAND_QUEUES",
+                                           OPENCL_NUM_COMMAND_QUEUES);
     currentCommandQueueIdx = 0;
 
-    for (int i = 0; i < OPENCL_NUM_OUTPUT_QUEUES; i++) {
-      outputQueues[i] = NULL;
-    }
+    numOutputQueues = GetDefaultNumQueues("CAFFE_OPENCL_NUM_OUTPUT_QUEUES",
+                                          OPENCL_NUM_OUTPUT_QUEUES);
     currentOutputQueueIdx = 0;
+    out_of_order_ = GetDefaultOutOfOrderExecution();
+    command_event_ = NULL;
+
+    build_mutex_.reset(new boost::mutex());
+    memory_cache_limit_ = GetDefaultMemoryCacheLimit();
+    async_transfers_ = GetDefaultAsyncTransfers();
+    pinned_host_memory_ = GetDefaultPinnedHostMemory();
+    zero_copy_ = GetDefaultZeroCopy();
   }
 
   OpenCLDevice::OpenCLDevice(const OpenCLDevice& dev) {
@@ -116,28 +222,47 @@ namespace caffe {
     deviceLocalMemSize = dev.deviceLocalMemSize;
     deviceHostUnifiedMem = dev.deviceHostUnifiedMem;
     deviceMemBaseAddrAlign = dev.deviceMemBaseAddrAlign;
+    deviceQueueProperties = dev.deviceQueueProperties;
     deviceName = dev.deviceName;
+    deviceDriverVersion = dev.deviceDriverVersion;
     context_ = dev.context_;
     programs = dev.programs;
-
-    for (int i = 0; i < OPENCL_NUM_INPUT_QUEUES; i++) {
-      inputQueues[i] = dev.inputQueues[i];
-    }
+    build_mutex_ = dev.build_mutex_;
+    memory_cache_limit_ = dev.memory_cache_limit_;
+    async_transfers_ = dev.async_transfers_;
+    pinned_host_memory_ = dev.pinned_host_memory_;
+    zero_copy_ = dev.zero_copy_;
+
+    // the copy shares the queues, each copy releases its reference.
+    inputQueues = dev.inputQueues;
+    numInputQueues = dev.numInputQueues;
     currentInputQueueIdx = dev.currentInputQueueIdx;
 
-    for (int i = 0; i < OPENCL_NUM_COMMAND_QUEUES; i++) {
-      commandQueues[i] = dev.commandQueues[i];
-    }
+    commandQueues = dev.commandQueues;
+    numCommandQueues = dev.numCommandQueues;
     currentCommandQueueIdx = dev.currentCommandQueueIdx;
 
-    for (int i = 0; i < OPENCL_NUM_OUTPUT_QUEUES; i++) {
-      outputQueues[i] = dev.commandQueues[i];
-    }
+    outputQueues = dev.outputQueues;
+    numOutputQueues = dev.numOutputQueues;
     currentOutputQueueIdx = dev.currentOutputQueueIdx;
+    out_of_order_ = dev.out_of_order_;
+    command_event_ = NULL;
+
+    for ( size_t i = 0; i < inputQueues.size(); i++ ) {
+      clRetainCommandQueue(inputQueues[i]);
+    }
+    for ( size_t i = 0; i < commandQueues.size(); i++ ) {
+      clRetainCommandQueue(commandQueues[i]);
+    }
+    for ( size_t i = 0; i < outputQueues.size(); i++ ) {
+      clRetainCommandQueue(outputQueues[i]);
+    }
   }
 
   OpenCLDevice::~OpenCLDevice() {
-    for (int i = 0; i < OPENCL_NUM_INPUT_QUEUES; i++) {
+    releaseCommandEvents();
+
+    for ( size_t i = 0; i < inputQueues.size(); i++ ) {
       if (inputQueues[i] != NULL) {
         clReleaseCommandQueue(inputQueues[i]);
         LOG(INFO) << "release OpenCL input queue["
@@ -145,7 +270,7 @@ namespace caffe {
       }
     }
 
-    for ( int i = 0; i < OPENCL_NUM_COMMAND_QUEUES; i++ ) {
+    for ( size_t i = 0; i < commandQueues.size(); i++ ) {
       if (commandQueues[i] != NULL) {
         clReleaseCommandQueue(commandQueues[i]);
         LOG(INFO) << "release OpenCL command queue["
@@ -153,7 +278,7 @@ namespace caffe {
       }
     }
 
-    for ( int i = 0; i < OPENCL_NUM_OUTPUT_QUEUES; i++ ) {
+    for ( size_t i = 0; i < outputQueues.size(); i++ ) {
       if (outputQueues[i] != NULL) {
         clReleaseCommandQueue(outputQueues[i]);
         LOG(INFO) << "release OpenCL output queue["
@@ -270,6 +395,12 @@ namespace caffe {
             sizeof(cl_uint), &(this->deviceMemBaseAddrAlign), &size))) {
       return false;
     }
+    if (!CL_CHECK(
+        clGetDeviceInfo(this->deviceID, CL_DEVICE_QUEUE_PROPERTIES,
+            sizeof(cl_command_queue_properties),
+            &(this->deviceQueueProperties), &size))) {
+      return false;
+    }
     size = 1024;
     char* name = reinterpret_cast<char*>(malloc(size * sizeof(char)));
     if (!CL_CHECK(
@@ -278,6 +409,13 @@ namespace caffe {
     }
     deviceName = std::string(name);
 
+    if (!CL_CHECK(
+        clGetDeviceInfo(this->deviceID, CL_DRIVER_VERSION, size, name, NULL))) {
+      return false;
+    }
+    deviceDriverVersion = std::string(name);
+    free(name);
+
     switch (this->deviceType) {
       case CL_DEVICE_TYPE_CPU:
         deviceTypeStr = "CPU";
@@ -346,6 +484,8 @@ namespace caffe {
         << this->deviceHostUnifiedMem << std::endl;
     std::cout << "    deviceMemBaseAddrAlign        = "
         << this->deviceMemBaseAddrAlign << std::endl;
+    std::cout << "    deviceDriverVersion           = "
+        << this->deviceDriverVersion << std::endl;
   }
 
   cl_device_type OpenCLDevice::type() {
@@ -361,6 +501,179 @@ namespace caffe {
   }
 
   bool OpenCLDevice::compile(std::string cl_source) {
+    boost::mutex::scoped_lock lock(*build_mutex_);
+    cl_program program;
+    std::vector<std::string> kernel_names;
+    if ( !buildProgram(cl_source, true, &program, &kernel_names) ) {
+      return false;
+    }
+    return createKernels(cl_source, program, kernel_names);
+  }
+
+  bool OpenCLDevice::compile(std::string name, const char* source,
+                             const char* const* kernel_names) {
+    boost::mutex::scoped_lock lock(*build_mutex_);
+    cl_program program;
+    if ( !buildProgram(name, source, true, &program) ) {
+      return false;
+    }
+
+    std::vector<std::string> names;
+    for ( int i = 0; kernel_names[i] != NULL; i++ ) {
+      names.push_back(kernel_names[i]);
+    }
+    return createKernels(name, program, names);
+  }
+
+  bool OpenCLDevice::createKernels(
+      const std::string& name,
+      cl_program program,
+      const std::vector<std::string>& kernel_names) {
+    programs.push_back(program);
+
+    cl_int err;
+    std::vector<std::string>::const_iterator it;
+
+    for ( it = kernel_names.begin(); it != kernel_names.end(); it++ ) {
+      cl_kernel kern = clCreateKernel(program, (*it).c_str(), &err);
+      if ( err != CL_SUCCESS ) {
+        LOG(ERROR) << "failed to create kernel '" << (*it).c_str()
+                   << "' from program '" << name.c_str()
+                   << "' : error = " << caffe::OpenCL::what(err);
+        return false;
+      }
+
+      // registered programs reserve their kernels with a NULL entry.
+      if ( kernel_map_.find((*it)) != kernel_map_.end()
+          && kernel_map_[(*it)] != NULL ) {
+        LOG(ERROR) << "kernel '" << *it << "' already present in map.";
+        return false;
+      }
+
+      kernel_map_[(*it)] = kern;
+      DLOG(INFO) << "create kernel '" << (*it).c_str() << "' from program '"
+                 << name.c_str() << "' for device " << this->name()
+                 << " @ " << kernel_map_[(*it)];
+    }
+
+    return true;
+  }
+
+  bool OpenCLDevice::registerProgram(std::string cl_source) {
+    caffe::OpenCLParser parser;
+
+    // only the kernel names are scanned here, the conversion to standard
+    // OpenCL is left to the build on first use, see buildProgram().
+    RegisteredProgram program;
+    program.name = cl_source;
+    program.source = NULL;
+    program.built = false;
+    if ( !parser.getKernelNames(cl_source, program.kernels) ) {
+      LOG(ERROR) << "failed to parse kernel names from file '"
+                 << cl_source.c_str() << "'";
+      return false;
+    }
+    return addRegisteredProgram(program);
+  }
+
+  bool OpenCLDevice::registerProgram(std::string name, const char* source,
+                                     const char* const* kernel_names) {
+    RegisteredProgram program;
+    program.name = name;
+    program.source = source;
+    program.built = false;
+    for ( int i = 0; kernel_names[i] != NULL; i++ ) {
+      program.kernels.push_back(kernel_names[i]);
+    }
+    return addRegisteredProgram(program);
+  }
+
+  bool OpenCLDevice::addRegisteredProgram(const RegisteredProgram& program) {
+    boost::mutex::scoped_lock lock(*build_mutex_);
+
+    std::vector<std::string>::const_iterator it;
+    for ( it = program.kernels.begin(); it != program.kernels.end(); it++ ) {
+      if ( kernel_map_.find((*it)) != kernel_map_.end() ) {
+        LOG(ERROR) << "kernel '" << *it << "' already present in map.";
+        return false;
+      }
+    }
+
+    // reserve the kernel names so that the map doesn't change its structure
+    // when the program is built later on.
+    for ( it = program.kernels.begin(); it != program.kernels.end(); it++ ) {
+      kernel_map_[(*it)] = NULL;
+      kernel_program_[(*it)] = registered_programs_.size();
+    }
+    registered_programs_.push_back(program);
+    DLOG(INFO) << "register program '" << program.name.c_str() << "' with "
+               << program.kernels.size() << " kernels for device "
+               << this->name();
+    return true;
+  }
+
+  bool OpenCLDevice::buildRegisteredProgram(std::string name) {
+    boost::mutex::scoped_lock lock(*build_mutex_);
+
+    // accept the full name as well as the base name, e.g. 'pooling_layer'
+    // for 'src/caffe/layers/OpenCL/pooling_layer.cl'.
+    std::string suffix = "/" + name + ".cl";
+    for ( size_t i = 0; i < registered_programs_.size(); i++ ) {
+      const std::string& program = registered_programs_[i].name;
+      if ( program == name || (program.size() >= suffix.size() &&
+          program.compare(program.size() - suffix.size(),
+                          suffix.size(), suffix) == 0) ) {
+        return buildRegisteredProgramLocked(i);
+      }
+    }
+    LOG(ERROR) << "program '" << name << "' is not registered";
+    return false;
+  }
+
+  bool OpenCLDevice::buildRegisteredProgramLocked(size_t idx) {
+    RegisteredProgram& registered = registered_programs_[idx];
+    if ( registered.built ) {
+      return true;
+    }
+
+    cl_program program;
+    if ( registered.source == NULL ) {
+      std::vector<std::string> kernel_names;
+      if ( !buildProgram(registered.name, true, &program, &kernel_names) ) {
+        return false;
+      }
+    } else {
+      if ( !buildProgram(registered.name, registered.source, true,
+                         &program) ) {
+        return false;
+      }
+    }
+
+    if ( !createKernels(registered.name, program, registered.kernels) ) {
+      return false;
+    }
+    registered.built = true;
+    DLOG(INFO) << "built program '" << registered.name.c_str()
+               << "' on first use for device " << this->name();
+    return true;
+  }
+
+  std::string OpenCLDevice::buildOptions() {
+    // -x clc++ -O5 -cl-std=CL2.0
+    return "-cl-unsafe-math-optimizations "
+        "-cl-finite-math-only "
+        "-cl-fast-relaxed-math "
+        "-cl-single-precision-constant "
+        "-cl-denorms-are-zero "
+        "-cl-mad-enable "
+        "-cl-no-signed-zeros "
+        "-I ../../CL/include/ -I include/caffe/util/OpenCL/";
+  }
+
+  bool OpenCLDevice::buildProgram(std::string cl_source,
+                                  bool use_cached_binary,
+                                  cl_program* program,
+                                  std::vector<std::string>* kernel_names) {
     if (context_() == NULL) {
       LOG(ERROR) << "cannot create OpenCL program without OpenCL context";
       return false;
@@ -378,6 +691,32 @@ namespace caffe {
       return false;
     }
 
+    // the cache key is computed from the unconverted source, so a cache hit
+    // skips the conversion to standard OpenCL as well as the compiler. The
+    // headers pulled in through the include path, e.g. definitions.hpp or
+    // reduction.hpp, are part of the program, so the key covers the source
+    // with its includes expanded. Without them the binary isn't cached.
+    std::string key;
+    if ( OpenCLManager::GetProgramCacheDir().size() > 0 ) {
+      std::string expanded;
+      if ( ReadExpandedSource(cl_source, "include/caffe/util/OpenCL", 0,
+                              &expanded) ) {
+        key = programCacheKey(expanded);
+      } else {
+        LOG(WARNING) << "failed to expand the includes of file = '"
+                     << cl_source.c_str() << "', not caching its binary";
+      }
+    }
+
+    if ( use_cached_binary && key.size() > 0 ) {
+      kernel_names->clear();
+      if ( loadProgramBinary(key, program, kernel_names) ) {
+        DLOG(INFO) << "create program from cached binary for file = '"
+                   << cl_source.c_str() << "' for device " << this->name();
+        return true;
+      }
+    }
+
     caffe::OpenCLParser parser;
 
     boost::regex re("\\.cl", boost::regex::perl);
@@ -389,8 +728,8 @@ namespace caffe {
       return false;
     }
 
-    std::vector<std::string> kernel_names;
-    if ( !parser.getKernelNames(cl_standard, kernel_names) ) {
+    kernel_names->clear();
+    if ( !parser.getKernelNames(cl_standard, *kernel_names) ) {
       LOG(ERROR) << "failed to parse kernel names from file '"
                  << cl_standard.c_str() << "'";
       return false;
@@ -406,38 +745,82 @@ namespace caffe {
       return false;
     }
 
+    if ( !buildProgramFromSource(cl_standard, str, program) ) {
+      return false;
+    }
+
+    if ( key.size() > 0 && !saveProgramBinary(key, *program, *kernel_names) ) {
+      LOG(WARNING) << "failed to cache program binary for file = '"
+                   << cl_source.c_str() << "'";
+    }
+
+    return true;
+  }
+
+  bool OpenCLDevice::buildProgram(std::string name,
+                                  const char* source,
+                                  bool use_cached_binary,
+                                  cl_program* program) {
+    if (context_() == NULL) {
+      LOG(ERROR) << "cannot create OpenCL program without OpenCL context";
+      return false;
+    }
+
+    // embedded sources are already converted to standard OpenCL and have
+    // their includes resolved, the kernel names are known at build time.
+    std::string key;
+    if ( OpenCLManager::GetProgramCacheDir().size() > 0 ) {
+      key = programCacheKey(source);
+    }
+
+    std::vector<std::string> kernel_names;
+    if ( use_cached_binary && key.size() > 0 ) {
+      if ( loadProgramBinary(key, program, &kernel_names) ) {
+        DLOG(INFO) << "create program from cached binary for '"
+                   << name.c_str() << "' for device " << this->name();
+        return true;
+      }
+    }
+
+    if ( !buildProgramFromSource(name, source, program) ) {
+      return false;
+    }
+
+    if ( key.size() > 0 && !saveProgramBinary(key, *program, kernel_names) ) {
+      LOG(WARNING) << "failed to cache program binary for '"
+                   << name.c_str() << "'";
+    }
+
+    return true;
+  }
+
+  bool OpenCLDevice::buildProgramFromSource(const std::string& name,
+                                            const std::string& source,
+                                            cl_program* program) {
     cl_int err;
-    const char *list = str.c_str();
-    size_t sourceSize[] = {strlen(str.c_str())};
-    cl_program program =
+    const char *list = source.c_str();
+    size_t sourceSize[] = {source.size()};
+    *program =
         clCreateProgramWithSource(context_(), 1, &list, sourceSize, &err);
     if ( err != CL_SUCCESS ) {
       LOG(ERROR) << "failed to create program from file = '"
-                 << cl_standard.c_str() << "'";
+                 << name.c_str() << "'";
       return false;
     }
     DLOG(INFO) << "create program with source from file = '"
-               << cl_standard.c_str() << "' for device " << this->name();
+               << name.c_str() << "' for device " << this->name();
 
-    // -x clc++ -O5 -cl-std=CL2.0
-    std::string clIncludes = "-cl-unsafe-math-optimizations "
-        "-cl-finite-math-only "
-        "-cl-fast-relaxed-math "
-        "-cl-single-precision-constant "
-        "-cl-denorms-are-zero "
-        "-cl-mad-enable "
-        "-cl-no-signed-zeros "
-        "-I ../../CL/include/ -I include/caffe/util/OpenCL/";
-
-    err = clBuildProgram(program, 1, &deviceID, clIncludes.c_str(), NULL, NULL);
+    std::string clIncludes = buildOptions();
+    err = clBuildProgram(*program, 1, &deviceID, clIncludes.c_str(),
+                         NULL, NULL);
     if ( err != CL_SUCCESS ) {
       LOG(ERROR) << "failed to build OpenCL program from file '"
-                 << cl_standard.c_str() << "' : error = " << err;
+                 << name.c_str() << "' : error = " << err;
 
       char* logBuffer = reinterpret_cast<char*>(malloc(1024 * 1024));
       size_t tempSize;
 
-      err = clGetProgramBuildInfo(program,
+      err = clGetProgramBuildInfo(*program,
           deviceID, CL_PROGRAM_BUILD_LOG, 1000000, logBuffer, &tempSize);
       if ( err != CL_SUCCESS ) {
         LOG(ERROR) << "clGetProgramBuildInfo() failed.";
@@ -462,97 +845,308 @@ namespace caffe {
 
       return false;
     }
-    DLOG(INFO) << "create program from file = '" << cl_standard.c_str()
+    DLOG(INFO) << "create program from file = '" << name.c_str()
                << "' for device " << this->name();
-    programs.push_back(program);
+    return true;
+  }
 
-    std::vector<std::string>::iterator it;
+  std::string OpenCLDevice::programCacheKey(const std::string& source) {
+    std::vector<std::string> parts;
+    parts.push_back(source);
+    parts.push_back(buildOptions());
+    parts.push_back(deviceName);
+    parts.push_back(deviceDriverVersion);
 
-    for ( it = kernel_names.begin(); it != kernel_names.end(); it++ ) {
-      cl_kernel kern = clCreateKernel(program, (*it).c_str(), &err);
-      if ( err != CL_SUCCESS ) {
-        LOG(ERROR) << "failed to create kernel '" << (*it).c_str()
-                   << "' from file '" << cl_standard.c_str()
-                   << "' : error = " << caffe::OpenCL::what(err);
-        return false;
+    // 64 bit FNV-1a, parts are separated by a zero byte.
+    uint64_t hash = 14695981039346656037ULL;
+    std::vector<std::string>::iterator it;
+    for ( it = parts.begin(); it != parts.end(); it++ ) {
+      for ( size_t i = 0; i <= (*it).size(); i++ ) {
+        hash ^= static_cast<unsigned char>((*it).c_str()[i]);
+        hash *= 1099511628211ULL;
       }
+    }
 
-      if ( kernel_map_.find((*it)) != kernel_map_.end() ) {
-        LOG(ERROR) << "kernel '" << *it << "' already present in map.";
-        return false;
+    std::ostringstream os;
+    os << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return os.str();
+  }
+
+  std::string OpenCLDevice::programCacheFile(const std::string& key) {
+    return OpenCLManager::GetProgramCacheDir() + "/" + key + ".clbin";
+  }
+
+  bool OpenCLDevice::loadProgramBinary(
+      const std::string& key,
+      cl_program* program,
+      std::vector<std::string>* kernel_names) {
+    std::string file_name = programCacheFile(key);
+    std::ifstream file(file_name.c_str(), std::ios::in | std::ios::binary);
+    if ( !file.is_open() ) {
+      DLOG(INFO) << "no cached program binary '" << file_name.c_str() << "'";
+      return false;
+    }
+
+    // header: magic, key, number of kernels, binary size; then one kernel
+    // name per line followed by the raw program binary.
+    std::string magic;
+    std::string file_key;
+    size_t num_kernels = 0;
+    size_t binary_size = 0;
+    file >> magic >> file_key >> num_kernels >> binary_size;
+    if ( !file.good() || magic != "CAFFE_CL_PROGRAM" || file_key != key ) {
+      LOG(WARNING) << "ignoring invalid program binary '"
+                   << file_name.c_str() << "'";
+      return false;
+    }
+    file.ignore(1);
+
+    std::vector<std::string> names(num_kernels);
+    for ( size_t i = 0; i < num_kernels; i++ ) {
+      std::getline(file, names[i]);
+    }
+
+    std::vector<unsigned char> binary(binary_size + 1);
+    file.read(reinterpret_cast<char*>(&binary[0]), binary_size);
+    if ( binary_size == 0 ||
+         static_cast<size_t>(file.gcount()) != binary_size ) {
+      LOG(WARNING) << "ignoring truncated program binary '"
+                   << file_name.c_str() << "'";
+      return false;
+    }
+
+    cl_int err;
+    cl_int status;
+    const unsigned char* binary_ptr = &binary[0];
+    *program = clCreateProgramWithBinary(context_(), 1, &deviceID,
+                                         &binary_size, &binary_ptr,
+                                         &status, &err);
+    if ( err != CL_SUCCESS || status != CL_SUCCESS ) {
+      LOG(WARNING) << "failed to create program from binary '"
+                   << file_name.c_str() << "' : error = "
+                   << caffe::OpenCL::what(err) << ", falling back to source";
+      if ( *program != NULL ) {
+        clReleaseProgram(*program);
       }
+      return false;
+    }
 
-      kernel_map_[(*it)] = kern;
-      DLOG(INFO) << "create kernel '" << (*it).c_str() << "' from file '"
-                 << cl_standard.c_str() << "' for device " << this->name()
-                 << " @ " << kernel_map_[(*it)];
+    err = clBuildProgram(*program, 1, &deviceID, buildOptions().c_str(),
+                         NULL, NULL);
+    if ( err != CL_SUCCESS ) {
+      LOG(WARNING) << "failed to build program from binary '"
+                   << file_name.c_str() << "' : error = "
+                   << caffe::OpenCL::what(err) << ", falling back to source";
+      clReleaseProgram(*program);
+      return false;
     }
 
+    *kernel_names = names;
     return true;
   }
 
-  bool OpenCLDevice::createQueue() {
-    if (!context_()) {
-      LOG(ERROR) << "cannot create command queue without context.";
+  bool OpenCLDevice::saveProgramBinary(
+      const std::string& key,
+      cl_program program,
+      const std::vector<std::string>& kernel_names) {
+    std::string dir = OpenCLManager::GetProgramCacheDir();
+    if ( mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST ) {
+      LOG(WARNING) << "failed to create program cache directory '"
+                   << dir.c_str() << "'";
+      return false;
+    }
+
+    // the program may be associated with all devices of the context, so
+    // look up the binary that belongs to this device.
+    cl_uint num_devices;
+    if ( !CL_CHECK(clGetProgramInfo(program, CL_PROGRAM_NUM_DEVICES,
+                                    sizeof(cl_uint), &num_devices, NULL)) ) {
+      return false;
+    }
+    std::vector<cl_device_id> devices(num_devices);
+    if ( !CL_CHECK(clGetProgramInfo(program, CL_PROGRAM_DEVICES,
+                                    sizeof(cl_device_id) * num_devices,
+                                    &devices[0], NULL)) ) {
+      return false;
+    }
+    std::vector<size_t> sizes(num_devices);
+    if ( !CL_CHECK(clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES,
+                                    sizeof(size_t) * num_devices,
+                                    &sizes[0], NULL)) ) {
+      return false;
+    }
+
+    std::vector<std::vector<unsigned char> > binaries(num_devices);
+    std::vector<unsigned char*> binary_ptrs(num_devices);
+    for ( cl_uint i = 0; i < num_devices; i++ ) {
+      binaries[i].resize(sizes[i] + 1);
+      binary_ptrs[i] = &binaries[i][0];
+    }
+    if ( !CL_CHECK(clGetProgramInfo(program, CL_PROGRAM_BINARIES,
+                                    sizeof(unsigned char*) * num_devices,
+                                    &binary_ptrs[0], NULL)) ) {
+      return false;
+    }
+
+    cl_uint idx = 0;
+    while ( idx < num_devices && devices[idx] != deviceID ) {
+      idx++;
+    }
+    if ( idx == num_devices || sizes[idx] == 0 ) {
+      LOG(WARNING) << "no program binary available for device "
+                   << this->name();
+      return false;
+    }
+
+    // write to a temporary file first so that concurrently starting
+    // processes never read a partially written binary.
+    std::string file_name = programCacheFile(key);
+    std::ostringstream tmp_name;
+    tmp_name << file_name << "." << getpid();
+
+    std::ofstream file(tmp_name.str().c_str(),
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+    if ( !file.is_open() ) {
+      LOG(WARNING) << "failed to open file '" << tmp_name.str().c_str()
+                   << "' for writing";
+      return false;
+    }
+    file << "CAFFE_CL_PROGRAM " << key << " " << kernel_names.size() << " "
+         << sizes[idx] << "\n";
+    std::vector<std::string>::const_iterator it;
+    for ( it = kernel_names.begin(); it != kernel_names.end(); it++ ) {
+      file << *it << "\n";
+    }
+    file.write(reinterpret_cast<char*>(binary_ptrs[idx]), sizes[idx]);
+    file.close();
+    if ( !file.good() ) {
+      LOG(WARNING) << "failed to write file '" << tmp_name.str().c_str()
+                   << "'";
+      unlink(tmp_name.str().c_str());
+      return false;
+    }
+
+    if ( rename(tmp_name.str().c_str(), file_name.c_str()) != 0 ) {
+      LOG(WARNING) << "failed to move '" << tmp_name.str().c_str()
+                   << "' to '" << file_name.c_str() << "'";
+      unlink(tmp_name.str().c_str());
       return false;
     }
+    DLOG(INFO) << "cached program binary '" << file_name.c_str() << "' for "
+               << "device " << this->name();
+    return true;
+  }
+
+  bool OpenCLDevice::resizeQueues(std::vector<cl_command_queue>* queues,
+                                  unsigned int num, const char* kind) {
+    while ( queues->size() > num ) {
+      CL_CHECK(clFinish(queues->back()));
+      clReleaseCommandQueue(queues->back());
+      LOG(INFO) << "release OpenCL " << kind << " queue["
+                << queues->size() - 1 << "] on device " << name();
+      queues->pop_back();
+    }
 
     cl_command_queue_properties props = 0;
 #ifdef OPENCL_PROFILING
     props |= CL_QUEUE_PROFILING_ENABLE;
 #endif
+    if ( queues == &commandQueues && getOutOfOrderExecution() ) {
+      props |= CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+    }
     cl_int err;
-    for ( int i = 0; i < OPENCL_NUM_INPUT_QUEUES; i++ ) {
-      inputQueues[i] = clCreateCommandQueue(context_(), deviceID, props, &err);
+    while ( queues->size() < num ) {
+      cl_command_queue queue =
+        clCreateCommandQueue(context_(), deviceID, props, &err);
       if ( err != CL_SUCCESS ) {
-        LOG(ERROR) << "failed to create OpenCL input queue["
-                   << i << "] for device " << this->name();
+        LOG(ERROR) << "failed to create OpenCL " << kind << " queue["
+                   << queues->size() << "] for device " << this->name();
         return false;
       }
-      LOG(INFO) << "create OpenCL input queue[" << i << "] for device "
-                << this->name() << " @ queues = " << inputQueues[i]
+      LOG(INFO) << "create OpenCL " << kind << " queue[" << queues->size()
+                << "] for device " << this->name() << " @ queues = " << queue
                 << " and deviceID = " << deviceID;
+      queues->push_back(queue);
     }
+    return true;
+  }
 
-    for ( int i = 0; i < OPENCL_NUM_COMMAND_QUEUES; i++ ) {
-      commandQueues[i] =
-        clCreateCommandQueue(context_(), deviceID, props, &err);
-      if ( err != CL_SUCCESS ) {
-        LOG(ERROR) << "failed to create OpenCL command queue["
-                   << i << "] for device " << this->name();
-        return false;
-      }
-      LOG(INFO) << "create OpenCL command queue[" << i << "] for device "
-                << this->name() << " @ queues = " << commandQueues[i]
-                << " and deviceID = " << deviceID;
+  bool OpenCLDevice::createQueue() {
+    if (!context_()) {
+      LOG(ERROR) << "cannot create command queue without context.";
+      return false;
     }
 
-    for ( int i = 0; i < OPENCL_NUM_OUTPUT_QUEUES; i++ ) {
-      outputQueues[i] = clCreateCommandQueue(context_(), deviceID, props, &err);
-      if ( err != CL_SUCCESS ) {
-        LOG(ERROR) << "failed to create OpenCL output queue["
-                   << i << "] for device " << this->name();
-        return false;
-      }
-      LOG(INFO) << "create OpenCL output queue[" << i << "] for device "
-                << this->name() << " @ queues = " << outputQueues[i]
-                << " and deviceID = " << deviceID;
+    return resizeQueues(&inputQueues, numInputQueues, "input") &&
+           resizeQueues(&commandQueues, numCommandQueues, "command") &&
+           resizeQueues(&outputQueues, numOutputQueues, "output");
+  }
+
+  bool OpenCLDevice::setNumInputQueues(unsigned int num) {
+    if ( num < 1 ) {
+      LOG(ERROR) << "number of OpenCL input queues must be at least 1.";
+      return false;
+    }
+    numInputQueues = num;
+    currentInputQueueIdx = 0;
+    if ( !context_() || inputQueues.empty() ) {
+      return true;
     }
+    return resizeQueues(&inputQueues, num, "input");
+  }
 
-    return true;
+  bool OpenCLDevice::setNumCommandQueues(unsigned int num) {
+    if ( num < 1 ) {
+      LOG(ERROR) << "number of OpenCL command queues must be at least 1.";
+      return false;
+    }
+    numCommandQueues = num;
+    currentCommandQueueIdx = 0;
+    if ( !context_() || commandQueues.empty() ) {
+      return true;
+    }
+    return resizeQueues(&commandQueues, num, "command");
+  }
+
+  bool OpenCLDevice::setNumOutputQueues(unsigned int num) {
+    if ( num < 1 ) {
+      LOG(ERROR) << "number of OpenCL output queues must be at least 1.";
+      return false;
+    }
+    numOutputQueues = num;
+    currentOutputQueueIdx = 0;
+    if ( !context_() || outputQueues.empty() ) {
+      return true;
+    }
+    return resizeQueues(&outputQueues, num, "output");
+  }
+
+  unsigned int OpenCLDevice::getNumInputQueues() {
+    return numInputQueues;
+  }
+
+  unsigned int OpenCLDevice::getNumCommandQueues() {
+    return numCommandQueues;
+  }
+
+  unsigned int OpenCLDevice::getNumOutputQueues() {
+    return numOutputQueues;
   }
 
   cl_context OpenCLDevice::getContext() {
     return context_();
   }
 
+  // copies and kernels that a layer enqueues through the default queue
+  // must stay ordered with its kernels on the current command queue.
   cl_command_queue* OpenCLDevice::getQueue() {
-    DLOG(INFO) << "using OpenCL default command queue = 0";
-    return &commandQueues[0];
+    DLOG(INFO) << "using OpenCL default command queue = "
+               << currentCommandQueueIdx;
+    return &commandQueues[currentCommandQueueIdx];
   }
 
   cl_command_queue* OpenCLDevice::getNextInputQueue() {
-    if (currentInputQueueIdx < OPENCL_NUM_INPUT_QUEUES - 1) {
+    if (currentInputQueueIdx < inputQueues.size() - 1) {
       currentInputQueueIdx++;
     } else {
       currentInputQueueIdx = 0;
@@ -562,7 +1156,7 @@ namespace caffe {
   }
 
   cl_command_queue* OpenCLDevice::getNextCommandQueue() {
-    if (currentCommandQueueIdx < OPENCL_NUM_COMMAND_QUEUES - 1) {
+    if (currentCommandQueueIdx < commandQueues.size() - 1) {
       currentCommandQueueIdx++;
     } else {
       currentCommandQueueIdx = 0;
@@ -573,7 +1167,7 @@ namespace caffe {
   }
 
   cl_command_queue* OpenCLDevice::getNextOutputQueue() {
-    if (currentOutputQueueIdx < OPENCL_NUM_OUTPUT_QUEUES - 1) {
+    if (currentOutputQueueIdx < outputQueues.size() - 1) {
       currentOutputQueueIdx++;
     } else {
       currentOutputQueueIdx = 0;
@@ -597,8 +1191,20 @@ namespace caffe {
     return &outputQueues[currentOutputQueueIdx];
   }
 
+  unsigned int OpenCLDevice::getCommandQueueIDX() {
+    return currentCommandQueueIdx;
+  }
+
+  cl_command_queue* OpenCLDevice::getCommandQueue(unsigned int idx) {
+    if ( idx >= commandQueues.size() ) {
+      LOG(ERROR) << "OpenCL command queue idx = " << idx << " out of range.";
+      return NULL;
+    }
+    return &commandQueues[idx];
+  }
+
   bool OpenCLDevice::setInputQueueIDX(unsigned int idx) {
-    if (idx >= OPENCL_NUM_INPUT_QUEUES) {
+    if (idx >= inputQueues.size()) {
       LOG(ERROR) << "OpenCL input queue idx = " << idx << " out of range.";
       return false;
     }
@@ -608,7 +1214,7 @@ namespace caffe {
   }
 
   bool OpenCLDevice::setCommandQueueIDX(unsigned int idx) {
-    if (idx >= OPENCL_NUM_COMMAND_QUEUES) {
+    if (idx >= commandQueues.size()) {
       LOG(ERROR) << "OpenCL command queue idx = " << idx << " out of range.";
       return false;
     }
@@ -618,7 +1224,7 @@ namespace caffe {
   }
 
   bool OpenCLDevice::setOutputQueueIDX(unsigned int idx) {
-    if (idx >= OPENCL_NUM_OUTPUT_QUEUES) {
+    if (idx >= outputQueues.size()) {
       LOG(ERROR) << "OpenCL output queue idx = " << idx << " out of range.";
       return false;
     }
@@ -627,17 +1233,179 @@ namespace caffe {
     return true;
   }
 
+  // the marker completes once all commands enqueued before on the queue
+  // have completed. The caller releases the event.
+  bool OpenCLDevice::enqueueMarker(unsigned int idx, cl_event* event) {
+    cl_command_queue* queue = getCommandQueue(idx);
+    if ( queue == NULL ) {
+      return false;
+    }
+    if ( !CL_CHECK(clEnqueueMarkerWithWaitList(*queue, 0, NULL, event)) ) {
+      return false;
+    }
+    // commands another queue waits for have to be submitted to the device.
+    return CL_CHECK(clFlush(*queue));
+  }
+
+  bool OpenCLDevice::enqueueWaitForEvents(unsigned int idx,
+                                          const std::vector<cl_event>& events) {
+    if ( events.empty() ) {
+      return true;
+    }
+    cl_command_queue* queue = getCommandQueue(idx);
+    if ( queue == NULL ) {
+      return false;
+    }
+    DLOG(INFO) << "command queue[" << idx << "] waits for " << events.size()
+               << " events";
+    return CL_CHECK(clEnqueueBarrierWithWaitList(*queue, events.size(),
+                                                 &events[0], NULL));
+  }
+
+  bool OpenCLDevice::enqueueCommandQueueWait(unsigned int idx,
+                                             unsigned int wait_idx) {
+    if ( idx == wait_idx ) {
+      return true;
+    }
+    cl_event event;
+    if ( !enqueueMarker(wait_idx, &event) ) {
+      return false;
+    }
+    bool success = enqueueWaitForEvents(idx, std::vector<cl_event>(1, event));
+    clReleaseEvent(event);
+    return success;
+  }
+
+  bool OpenCLDevice::setOutOfOrderExecution(bool out_of_order) {
+    if ( out_of_order &&
+        !(deviceQueueProperties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) ) {
+      LOG(WARNING) << this->name() << "> does not support out-of-order "
+                   << "command queues.";
+      return false;
+    }
+    if ( out_of_order == out_of_order_ ) {
+      return true;
+    }
+    out_of_order_ = out_of_order;
+    releaseCommandEvents();
+    if ( !context_() || commandQueues.empty() ) {
+      return true;
+    }
+    // the queue properties are fixed, so the command queues are recreated.
+    return resizeQueues(&commandQueues, 0, "command") &&
+           resizeQueues(&commandQueues, numCommandQueues, "command");
+  }
+
+  bool OpenCLDevice::getOutOfOrderExecution() {
+    return out_of_order_ &&
+        (deviceQueueProperties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+  }
+
+  // the event of a command is only taken over by the next command, as the
+  // arguments of the enqueue call are evaluated in any order.
+  void OpenCLDevice::commitCommandEvent() {
+    if ( command_event_ == NULL ) {
+      return;
+    }
+    for ( size_t i = 0; i < command_wait_list_.size(); i++ ) {
+      clReleaseEvent(command_wait_list_[i]);
+    }
+    command_wait_list_.assign(1, command_event_);
+    command_event_ = NULL;
+  }
+
+  void OpenCLDevice::releaseCommandEvents() {
+    commitCommandEvent();
+    for ( size_t i = 0; i < command_wait_list_.size(); i++ ) {
+      clReleaseEvent(command_wait_list_[i]);
+    }
+    command_wait_list_.clear();
+  }
+
+  cl_uint OpenCLDevice::getCommandWaitListSize() {
+    if ( !getOutOfOrderExecution() ) {
+      return 0;
+    }
+    commitCommandEvent();
+    return command_wait_list_.size();
+  }
+
+  const cl_event* OpenCLDevice::getCommandWaitList() {
+    if ( !getOutOfOrderExecution() ) {
+      return NULL;
+    }
+    commitCommandEvent();
+    if ( command_wait_list_.empty() ) {
+      return NULL;
+    }
+    return &command_wait_list_[0];
+  }
+
+  cl_event* OpenCLDevice::getCommandEvent(cl_event* event) {
+    if ( event != NULL || !getOutOfOrderExecution() ) {
+      return event;
+    }
+    commitCommandEvent();
+    return &command_event_;
+  }
+
+  void OpenCLDevice::addCommandEvent(cl_event event) {
+    if ( !getOutOfOrderExecution() || event == NULL ) {
+      return;
+    }
+    clRetainEvent(event);
+    releaseCommandEvents();
+    command_wait_list_.assign(1, event);
+  }
+
+  void OpenCLDevice::setCommandWaitList(const std::vector<cl_event>& events) {
+    releaseCommandEvents();
+    for ( size_t i = 0; i < events.size(); i++ ) {
+      clRetainEvent(events[i]);
+    }
+    command_wait_list_ = events;
+  }
+
+  // the marker completes once the commands in the command wait list did.
+  bool OpenCLDevice::enqueueCommandMarker(cl_event* event) {
+    cl_command_queue* queue = getCurrentCommandQueue();
+    if ( !getOutOfOrderExecution() || getCommandWaitListSize() == 0 ) {
+      return enqueueMarker(currentCommandQueueIdx, event);
+    }
+    if ( !CL_CHECK(clEnqueueMarkerWithWaitList(*queue,
+            getCommandWaitListSize(), getCommandWaitList(), event)) ) {
+      return false;
+    }
+    addCommandEvent(*event);
+    return CL_CHECK(clFlush(*queue));
+  }
+
   void OpenCLDevice::SetContext(cl::Context context) {
     context_ = context;
   }
 
   cl_kernel* OpenCLDevice::getKernel(std::string name) {
-    if (kernel_map_.find(name) == kernel_map_.end()) {
+    // the lock guards the lazy build of registered programs, so that a
+    // program is built exactly once even if requested by several threads.
+    boost::mutex::scoped_lock lock(*build_mutex_);
+
+    std::map<std::string, cl_kernel>::iterator it = kernel_map_.find(name);
+    if (it == kernel_map_.end()) {
       LOG(FATAL)<< "kernel '" << name << "' not found in map";
       return NULL;
     }
 
-    return &kernel_map_[name];
+    if (it->second == NULL) {
+      size_t idx = kernel_program_[name];
+      if (!buildRegisteredProgramLocked(idx)) {
+        LOG(FATAL)<< "failed to build program '"
+                  << registered_programs_[idx].name << "' for kernel '"
+                  << name << "'";
+        return NULL;
+      }
+    }
+
+    return &it->second;
   }
 
   bool OpenCLDevice::add(OpenCLMemory& clMem) {  // NOLINT(*)
@@ -652,11 +1420,14 @@ namespace caffe {
       return false;
     }
 
-    std::map<const void*, OpenCLMemory>::iterator it;
-    for ( it = memory.begin(); it != memory.end(); it++ ) {
-      if ( (it->second).overlaps(clMem) ) {
-        LOG(FATAL) << "memory overlap found";
-      }
+    // only the neighbours of the new range can overlap it.
+    std::map<const void*, OpenCLMemory>::iterator it =
+        memory.upper_bound(clMem.getVirtualPointer());
+    if ( it != memory.end() && (it->second).overlaps(clMem) ) {
+      LOG(FATAL) << "memory overlap found";
+    }
+    if ( it != memory.begin() && (--it)->second.overlaps(clMem) ) {
+      LOG(FATAL) << "memory overlap found";
     }
 
     DLOG(INFO) << "add memory " << clMem.getTag().c_str();
@@ -665,6 +1436,21 @@ namespace caffe {
     return true;
   }
 
+  size_t OpenCLDevice::getBufferSizeClass(size_t size) {
+    size_t size_class = kMinBufferSize;
+    while ( size_class < size ) {
+      size_class <<= 1;
+    }
+
+    // use four classes per power of two above the slab size to bound
+    // the memory lost to rounding for large blobs.
+    if ( size_class > kSlabSize ) {
+      size_t step = size_class / 8;
+      size_class = (size + step - 1) / step * step;
+    }
+    return size_class;
+  }
+
   bool OpenCLDevice::getBuffer(
       std::tr1::shared_ptr<OpenCLBuffer>* ptr,
       size_t size) {
@@ -673,62 +1459,324 @@ namespace caffe {
       return false;
     }
 
-    if ( buffer.find(size) == buffer.end() ) {
+    size_t size_class = getBufferSizeClass(size);
+    if ( buffer[size_class].empty() ) {
       DLOG(INFO) << this->name() << " no buffer of size = "
-                 << size << " found, create new buffer.";
+                 << size_class << " available, create new buffer.";
+      memory_cache_stats_.misses++;
+
+      if ( !createBuffers(size_class) ) {
+        // the cached buffers of the other size classes might be in the way.
+        releaseBuffers();
+        if ( !createBuffers(size_class) ) {
+          LOG(ERROR) << this->name() << " failed to create buffer of size = "
+                     << size_class;
+          return false;
+        }
+      }
+    } else {
+      DLOG(INFO) << this->name() << " found available buffer of size = "
+                 << size_class;
+      memory_cache_stats_.hits++;
+    }
 
-      *ptr = std::tr1::shared_ptr<OpenCLBuffer>(new OpenCLBuffer(size));
-      buffer[size].push_back(*ptr);
-      this->add(**ptr);
+    *ptr = buffer[size_class].back();
+    buffer[size_class].pop_back();
+    memory_cache_stats_.bytes_cached -= (*ptr)->getSize();
 
-      return true;
+    if ( (*ptr)->getSlab() != NULL ) {
+      slabs_[(*ptr)->getSlab()].in_use++;
     }
+    (*ptr)->setUnavailable();
+    (*ptr)->setRequestedSize(size);
+    buffers_in_use_[(*ptr)->getVirtualPointer()] = *ptr;
+    memory_cache_stats_.bytes_in_use += (*ptr)->getSize();
+    memory_cache_stats_.bytes_requested += size;
 
-    std::vector< std::tr1::shared_ptr<caffe::OpenCLBuffer>>::iterator it;
-    for ( it = buffer[size].begin(); it != buffer[size].end(); it++ ) {
-      if ( (*it)->isAvailable() == true ) {
-        DLOG(INFO) << this->name() << " found available buffer of size = "
-                   << size;
-        (*it)->setUnavailable();
-        *ptr = (*it);
-        return true;
+    this->add(**ptr);
+    OpenCLMemory::logStatistics();
+    return true;
+  }
+
+  bool OpenCLDevice::createBuffers(size_t size_class) {
+    std::vector< std::tr1::shared_ptr<caffe::OpenCLBuffer> >& available =
+        buffer[size_class];
+
+    // sub-buffers have to start at a multiple of the base address alignment.
+    size_t align = deviceMemBaseAddrAlign / 8;
+    size_t stride = size_class;
+    if ( align > 0 ) {
+      stride = (size_class + align - 1) / align * align;
+    }
+
+    // a slab is only freed with all of its sub-buffers, so it would not be
+    // bounded by the cache limit once the cache is full.
+    size_t count = kSlabSize / stride;
+    if ( count >= kMinBuffersPerSlab
+        && memory_cache_stats_.bytes_cached + count * size_class
+        <= memory_cache_limit_ ) {
+      cl_int err;
+      cl_mem slab = clCreateBuffer(getContext(), bufferFlags(),
+                                   count * stride, NULL, &err);
+      if ( err == CL_SUCCESS ) {
+        size_t created = 0;
+        for ( ; created < count; created++ ) {
+          try {
+            available.push_back(std::tr1::shared_ptr<OpenCLBuffer>(
+                new OpenCLBuffer(slab, created * stride, size_class)));
+          } catch (std::exception& e) {
+            break;
+          }
+        }
+        // the slab stays alive until all of its sub-buffers are released.
+        clReleaseMemObject(slab);
+        memory_cache_stats_.bytes_cached += created * size_class;
+
+        if ( created > 0 ) {
+          Slab entry = { size_class, 0 };
+          slabs_[slab] = entry;
+          DLOG(INFO) << this->name() << " created " << created
+                     << " buffers of size = " << size_class << " in a slab";
+          return true;
+        }
       }
     }
 
-    DLOG(INFO) << this->name() << " found no available buffer of size = "
-               << size << " found, create new buffer.";
-    *ptr = std::tr1::shared_ptr<OpenCLBuffer>(new OpenCLBuffer(size));
-    buffer[size].push_back(*ptr);
-    this->add(**ptr);
+    try {
+      available.push_back(std::tr1::shared_ptr<OpenCLBuffer>(
+          new OpenCLBuffer(size_class, bufferFlags())));
+    } catch (std::exception& e) {
+      return false;
+    }
+    memory_cache_stats_.bytes_cached += size_class;
     return true;
   }
 
+  cl_mem_flags OpenCLDevice::bufferFlags() {
+    // host accessible buffers can be mapped without a copy on devices
+    // that share their memory with the host.
+    if ( getZeroCopy() ) {
+      return CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR;
+    }
+    return CL_MEM_READ_WRITE;
+  }
+
   bool OpenCLDevice::setBufferAvailable(const void* ptr, size_t size) {
     if (size < 1) {
       LOG(ERROR) << "buffer cannot be smaller than 1Byte.";
       return false;
     }
 
-    if ( buffer.find(size) == buffer.end() ) {
-      DLOG(ERROR) << this->name() << " no buffer of size = "
-                  << size << " exists.";
+    std::map<const void*, std::tr1::shared_ptr<OpenCLBuffer> >::iterator it =
+        buffers_in_use_.find(ptr);
+    if ( it == buffers_in_use_.end() ) {
+      DLOG(ERROR) << this->name() << " found no buffer of size = "
+                  << size << " with virtual address = " << ptr;
       return false;
     }
+    std::tr1::shared_ptr<OpenCLBuffer> available = it->second;
+    buffers_in_use_.erase(it);
 
-    std::vector< std::tr1::shared_ptr<caffe::OpenCLBuffer>>::iterator it;
-    for ( it = buffer[size].begin(); it != buffer[size].end(); it++ ) {
-      if ( (*it)->getVirtualPointer() == ptr ) {
-        DLOG(INFO) << this->name() << " set buffer of size = "
-                   << size << " with virtual address = "
-                   << ptr << " to available";
-        (*it)->setAvailable();
-        return true;
+    // the copy in the memory map carries the event of the last operation.
+    std::map<const void*, OpenCLMemory>::iterator mem = memory.find(ptr);
+    if ( mem != memory.end() ) {
+      if ( mem->second.hasEvent() ) {
+        cl_event event = mem->second.getEvent();
+        CL_CHECK(clWaitForEvents(1, &event));
+        mem->second.resetEvent();
       }
+      memory.erase(mem);
     }
 
-    DLOG(ERROR) << this->name() << " found no buffer of size = "
-                << size << " with virtual address = " << ptr;
-    return false;
+    DLOG(INFO) << this->name() << " set buffer of size = "
+               << available->getSize() << " with virtual address = "
+               << ptr << " to available";
+    available->setAvailable();
+    memory_cache_stats_.bytes_in_use -= available->getSize();
+    memory_cache_stats_.bytes_requested -= available->getRequestedSize();
+
+    cl_mem slab = available->getSlab();
+    if ( slab == NULL ) {
+      if ( memory_cache_stats_.bytes_cached + available->getSize()
+          > memory_cache_limit_ ) {
+        releaseBuffer(available);
+      } else {
+        buffer[available->getSize()].push_back(available);
+        memory_cache_stats_.bytes_cached += available->getSize();
+      }
+    } else {
+      // the memory of a sub-buffer is not freed before the whole slab is.
+      buffer[available->getSize()].push_back(available);
+      memory_cache_stats_.bytes_cached += available->getSize();
+      if ( --slabs_[slab].in_use == 0
+          && memory_cache_stats_.bytes_cached > memory_cache_limit_ ) {
+        releaseSlab(slab);
+      }
+    }
+    OpenCLMemory::logStatistics();
+    return true;
+  }
+
+  void OpenCLDevice::releaseBuffer(std::tr1::shared_ptr<OpenCLBuffer> buffer) {
+    try {
+      buffer->free();
+    } catch (std::exception& e) {
+      LOG(ERROR) << this->name() << " failed to release buffer "
+                 << buffer->getTag() << " : " << e.what();
+    }
+  }
+
+  void OpenCLDevice::releaseSlab(cl_mem slab) {
+    std::map<cl_mem, Slab>::iterator entry = slabs_.find(slab);
+    if ( entry == slabs_.end() ) {
+      return;
+    }
+    std::vector<std::tr1::shared_ptr<caffe::OpenCLBuffer> >& available =
+        buffer[entry->second.size_class];
+    // the handle of the slab may be reused once its last sub-buffer is freed.
+    slabs_.erase(entry);
+
+    size_t kept = 0;
+    for ( size_t i = 0; i < available.size(); i++ ) {
+      if ( available[i]->getSlab() == slab ) {
+        memory_cache_stats_.bytes_cached -= available[i]->getSize();
+        releaseBuffer(available[i]);
+      } else {
+        available[kept++] = available[i];
+      }
+    }
+    available.resize(kept);
+  }
+
+  void OpenCLDevice::releaseBuffers() {
+    size_t bytes_cached = memory_cache_stats_.bytes_cached;
+
+    // the slabs with sub-buffers in use cannot be freed.
+    std::vector<cl_mem> idle;
+    std::map<cl_mem, Slab>::iterator slab;
+    for ( slab = slabs_.begin(); slab != slabs_.end(); slab++ ) {
+      if ( slab->second.in_use == 0 ) {
+        idle.push_back(slab->first);
+      }
+    }
+    for ( size_t i = 0; i < idle.size(); i++ ) {
+      releaseSlab(idle[i]);
+    }
+
+    std::map<size_t,
+        std::vector<std::tr1::shared_ptr<caffe::OpenCLBuffer> > >::iterator it;
+    for ( it = buffer.begin(); it != buffer.end(); it++ ) {
+      size_t kept = 0;
+      for ( size_t i = 0; i < it->second.size(); i++ ) {
+        if ( it->second[i]->getSlab() == NULL ) {
+          memory_cache_stats_.bytes_cached -= it->second[i]->getSize();
+          releaseBuffer(it->second[i]);
+        } else {
+          it->second[kept++] = it->second[i];
+        }
+      }
+      it->second.resize(kept);
+    }
+    DLOG(INFO) << this->name() << " released "
+               << bytes_cached - memory_cache_stats_.bytes_cached
+               << " Byte of cached buffers";
+  }
+
+  void OpenCLDevice::setMemoryCacheLimit(size_t bytes) {
+    memory_cache_limit_ = bytes;
+    if ( memory_cache_stats_.bytes_cached > memory_cache_limit_ ) {
+      releaseBuffers();
+    }
+  }
+
+  void OpenCLDevice::setAsyncTransfers(bool async) {
+    async_transfers_ = async;
+  }
+
+  bool OpenCLDevice::getAsyncTransfers() {
+    return async_transfers_;
+  }
+
+  void OpenCLDevice::setPinnedHostMemory(bool pinned) {
+    pinned_host_memory_ = pinned;
+  }
+
+  bool OpenCLDevice::getPinnedHostMemory() {
+    if ( pinned_host_memory_ >= 0 ) {
+      return pinned_host_memory_ != 0;
+    }
+    // the DMA engines of GPUs need page-locked memory, a copy of pageable
+    // memory is staged through a driver buffer first. On CPU devices both
+    // are the same.
+    return deviceType == CL_DEVICE_TYPE_GPU;
+  }
+
+  void OpenCLDevice::setZeroCopy(bool zero_copy) {
+    zero_copy_ = zero_copy;
+  }
+
+  bool OpenCLDevice::getZeroCopy() {
+    if ( zero_copy_ >= 0 ) {
+      return zero_copy_ != 0;
+    }
+    return deviceHostUnifiedMem == CL_TRUE;
+  }
+
+  bool OpenCLDevice::mallocHost(void** ptr, size_t size) {
+    cl_int err;
+    cl_mem mem = clCreateBuffer(getContext(),
+                                CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+                                size, NULL, &err);
+    if ( err != CL_SUCCESS ) {
+      DLOG(INFO) << this->name() << "> failed to create pinned host buffer of "
+                 << size << " Byte : " << caffe::OpenCL::what(err);
+      return false;
+    }
+
+    *ptr = clEnqueueMapBuffer(*getQueue(), mem, CL_TRUE,
+                              CL_MAP_READ | CL_MAP_WRITE, 0, size,
+                              0, NULL, NULL, &err);
+    if ( err != CL_SUCCESS ) {
+      DLOG(INFO) << this->name() << "> failed to map pinned host buffer of "
+                 << size << " Byte : " << caffe::OpenCL::what(err);
+      clReleaseMemObject(mem);
+      *ptr = NULL;
+      return false;
+    }
+
+    host_memory_[*ptr] = mem;
+    DLOG(INFO) << this->name() << "> allocate " << size
+               << " Byte of pinned host memory @" << *ptr;
+    return true;
+  }
+
+  bool OpenCLDevice::freeHost(void* ptr) {
+    std::map<const void*, cl_mem>::iterator it = host_memory_.find(ptr);
+    if ( it == host_memory_.end() ) {
+      LOG(ERROR) << this->name() << "> no pinned host memory @" << ptr;
+      return false;
+    }
+
+    cl_mem mem = it->second;
+    host_memory_.erase(it);
+    if ( !CL_CHECK(clEnqueueUnmapMemObject(*getQueue(), mem, ptr,
+                                           0, NULL, NULL)) ) {
+      return false;
+    }
+    // the buffer is only deleted after the unmap completed.
+    if ( !CL_CHECK(clReleaseMemObject(mem)) ) {
+      return false;
+    }
+    DLOG(INFO) << this->name() << "> free pinned host memory @" << ptr;
+    return true;
+  }
+
+  size_t OpenCLDevice::getMemoryCacheLimit() {
+    return memory_cache_limit_;
+  }
+
+  const OpenCLMemoryCacheStatistics& OpenCLDevice::getMemoryCacheStatistics() {
+    return memory_cache_stats_;
   }
 
   bool OpenCLDevice::rmMemoryPtr(const void* ptr) {
@@ -800,37 +1848,20 @@ namespace caffe {
       return false;
     }
 
-    // direct match of the base address
-    if (memory.find(ptr) != memory.end()) {
-      *clMem = &(memory[ptr]);
-      return true;
-    }
-
-    int found = 0;
-    std::map<const void*, OpenCLMemory>::iterator it;
-    for (it = memory.begin(); it != memory.end(); it++) {
-      if ((it->second).contains(ptr)) {
-        found++;
-      }
-    }
-
-    if (found > 1) {
-      DLOG(INFO) << "found " << found << " matching for " << ptr;
-      for ( it = memory.begin(); it != memory.end(); it++ ) {
-        if ( (it->second).contains(ptr) ) {
-          DLOG(INFO) << it->second.getTag().c_str();
-        }
-      }
+    // the virtual address ranges handed out by OpenCLMemory don't overlap
+    // and the map is ordered by their base address, so the only candidate
+    // is the last allocation that starts at or before ptr.
+    std::map<const void*, OpenCLMemory>::iterator it = memory.upper_bound(ptr);
+    if (it == memory.begin()) {
+      return false;
     }
-
-    for (it = memory.begin(); it != memory.end(); it++) {
-      if ((it->second).contains(ptr)) {
-        *clMem = &(it->second);
-        return true;
-      }
+    --it;
+    if (!(it->second).contains(ptr)) {
+      return false;
     }
 
-    return false;
+    *clMem = &(it->second);
+    return true;
   }
 
   std::string OpenCLDevice::getMemoryTag(const void* ptr) {
@@ -850,6 +1881,10 @@ namespace caffe {
     return clMem->getTag();
   }
 
+  std::string OpenCLDevice::getDriverVersion() {
+    return deviceDriverVersion;
+  }
+
   std::string OpenCLDevice::getDeviceName() {
     return deviceName;
   }
@@ -858,6 +1893,14 @@ namespace caffe {
     return deviceMemBaseAddrAlign;
   }
 
+  size_t OpenCLDevice::getMaxWorkGroupSize() {
+    return deviceMaxWorkGroupSize;
+  }
+
+  cl_ulong OpenCLDevice::getLocalMemSize() {
+    return deviceLocalMemSize;
+  }
+
   size_t OpenCLDevice::getMemoryUsage() {
     size_t bytesUsed = 0;
     std::map<const void*, OpenCLMemory>::iterator it;
@@ -869,40 +1912,31 @@ namespace caffe {
   }
 
   void OpenCLDevice::waitForInputQueues() {
-    for (int i = 0; i < OPENCL_NUM_INPUT_QUEUES; i++) {
+    for ( size_t i = 0; i < inputQueues.size(); i++ ) {
       DLOG(INFO) << "calling clFinish(inputQueues[" << i << "])";
       CL_CHECK(clFinish(inputQueues[i]));
     }
   }
 
   void OpenCLDevice::waitForCommandQueues() {
-    for (int i = 0; i < OPENCL_NUM_COMMAND_QUEUES; i++) {
+    for ( size_t i = 0; i < commandQueues.size(); i++ ) {
       DLOG(INFO) << "calling clFinish(commandQueues[" << i << "])";
       CL_CHECK(clFinish(commandQueues[i]));
     }
   }
 
   void OpenCLDevice::waitForOutputQueues() {
-    for (int i = 0; i < OPENCL_NUM_OUTPUT_QUEUES; i++) {
+    for ( size_t i = 0; i < outputQueues.size(); i++ ) {
       DLOG(INFO) << "calling clFinish(outputQueues[" << i << "])";
       CL_CHECK(clFinish(outputQueues[i]));
     }
   }
 
   void OpenCLDevice::Synchronize() {
-    for (int i = 0; i < OPENCL_NUM_INPUT_QUEUES; i++) {
-      DLOG(INFO) << "calling clFinish(inputQueues[" << i << "])";
-    CL_CHECK(clFinish(inputQueues[i]));
-  }
-  for ( int i = 0; i < OPENCL_NUM_COMMAND_QUEUES; i++ ) {
-    DLOG(INFO) << "calling clFinish(commandQueues[" << i << "])";
-    CL_CHECK(clFinish(commandQueues[i]));
-  }
-  for ( int i = 0; i < OPENCL_NUM_OUTPUT_QUEUES; i++ ) {
-    DLOG(INFO) << "calling clFinish(outputQueues[" << i << "])";
-    CL_CHECK(clFinish(outputQueues[i]));
+    waitForInputQueues();
+    waitForCommandQueues();
+    waitForOutputQueues();
   }
-}
 
 }  // namespace caffe
 
@@ -0,0 +1,391 @@
+#ifdef USE_OPENCL
+
+#include <CL/cl.h>
+#include <glog/logging.h>
+
+#include <caffe/syncedmem.hpp>
+#include <caffe/util/benchmark.hpp>
+#include <caffe/util/OpenCL/definitions.hpp>
+#include <caffe/util/OpenCL/OpenCLGemmTuner.hpp>
+#include <caffe/util/OpenCL/OpenCLManager.hpp>
+#include <caffe/util/OpenCL/OpenCLSupport.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace caffe {
+
+  OpenCLGemmTuner OpenCLGemmTuner::instance_;
+
+  // timed runs of each candidate after a first run that checks its result.
+  static const int kTuneIterations = 5;
+  static const int kTileSizes[] = { 8, 16, 32 };
+  static const int kWorkPerThread[] = { 1, 2, 4, 8 };
+
+  static bool GetDefaultTuning() {
+    const char* tuning = getenv("CAFFE_OPENCL_GEMM_TUNING");
+    return tuning != NULL && atoi(tuning) != 0;
+  }
+
+  static std::string GetDefaultFile() {
+    const char* file = getenv("CAFFE_OPENCL_GEMM_TUNING_FILE");
+    if ( file != NULL ) {
+      return file;
+    }
+    if ( OpenCLManager::GetProgramCacheDir().size() > 0 ) {
+      return OpenCLManager::GetProgramCacheDir() + "/gemm_tuning.txt";
+    }
+    return "";
+  }
+
+  static char TransposeName(const clblasTranspose trans) {
+    return trans == clblasNoTrans ? 'N' : 'T';
+  }
+
+  OpenCLGemmTuner::OpenCLGemmTuner() {
+    loaded_ = false;
+    tuning_ = GetDefaultTuning();
+    benchmarking_ = false;
+  }
+
+  template <typename T>
+  std::string OpenCLGemmTuner::Key(const clblasTranspose TransA,
+                                   const clblasTranspose TransB,
+                                   const int m, const int n, const int k,
+                                   const int batch) {
+    OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+    std::ostringstream os;
+    os << device.getDeviceName() << '\t'
+       << device.getDriverVersion() << '\t'
+       << (sizeof(T) == sizeof(double) ? "double" : "float") << '\t'
+       << TransposeName(TransA) << '\t'
+       << TransposeName(TransB) << '\t'
+       << m << '\t' << n << '\t' << k << '\t' << batch;
+    return os.str();
+  }
+
+  template <typename T>
+  bool OpenCLGemmTuner::Lookup(const clblasTranspose TransA,
+                               const clblasTranspose TransB,
+                               const int m, const int n, const int k,
+                               const int batch,
+                               OpenCLGemmConfig* config) {
+    if ( instance_.benchmarking_ ) {
+      return false;
+    }
+    if ( !instance_.loaded_ ) {
+      Load();
+    }
+
+    std::map<std::string, OpenCLGemmConfig>::iterator it;
+    it = instance_.entries_.find(Key<T>(TransA, TransB, m, n, k, batch));
+    if ( it != instance_.entries_.end() ) {
+      *config = it->second;
+      return true;
+    }
+    if ( !instance_.tuning_ ) {
+      return false;
+    }
+    if ( !Tune<T>(TransA, TransB, m, n, k, batch, config) ) {
+      return false;
+    }
+    if ( GetFile().size() > 0 ) {
+      Save();
+    }
+    return true;
+  }
+
+  template <typename T>
+  std::vector<OpenCLGemmConfig> OpenCLGemmTuner::Candidates() {
+    OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+    std::vector<OpenCLGemmConfig> candidates;
+    for ( size_t i = 0; i < sizeof(kTileSizes) / sizeof(int); i++ ) {
+      int tile = kTileSizes[i];
+      // one [tile x tile] tile of A and B each in local memory.
+      if ( 2 * tile * tile * sizeof(T) > device.getLocalMemSize() ) {
+        continue;
+      }
+      for ( size_t j = 0; j < sizeof(kWorkPerThread) / sizeof(int); j++ ) {
+        int wpt = kWorkPerThread[j];
+        if ( wpt > OPENCL_TUNED_MAX_WPT || wpt > tile ||
+             static_cast<size_t>(tile * tile / wpt) >
+             device.getMaxWorkGroupSize() ) {
+          continue;
+        }
+        OpenCLGemmConfig config;
+        config.kernel = "mmul_tiled";
+        config.tile = tile;
+        config.wpt = wpt;
+        candidates.push_back(config);
+      }
+    }
+    return candidates;
+  }
+
+  template <typename T>
+  bool OpenCLGemmTuner::Run(const OpenCLGemmConfig& config,
+                            const clblasTranspose TransA,
+                            const clblasTranspose TransB,
+                            const int m, const int n, const int k,
+                            const int batch,
+                            const T* A, const T* B, T* C) {
+    if ( config.tiled() ) {
+      return OpenCL::clgemm_tiled<T>(config, TransA, TransB, m, n, k, batch,
+                                     1.0, A, 0, 0, B, 0, k * n, 0.0, C, 0,
+                                     m * n, NULL, NULL, false, 0, NULL);
+    }
+    if ( batch == 1 ) {
+      return OpenCL::clgemm<T>(TransA, TransB, m, n, k, 1.0, A, 0, B, 0, 0.0,
+                               C, 0, NULL);
+    }
+    return OpenCL::clgemm_strided_batched<T>(TransA, TransB, m, n, k, batch,
+                                             1.0, A, 0, 0, B, 0, k * n, 0.0,
+                                             C, 0, m * n, NULL, NULL, false,
+                                             0, NULL);
+  }
+
+  template <typename T>
+  bool OpenCLGemmTuner::Tune(const clblasTranspose TransA,
+                             const clblasTranspose TransB,
+                             const int m, const int n, const int k,
+                             const int batch,
+                             OpenCLGemmConfig* config) {
+    OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+    // scratch matrices, the candidates must not modify the caller's C.
+    SyncedMemory a(m * k * sizeof(T));
+    SyncedMemory b(k * n * batch * sizeof(T));
+    SyncedMemory c(m * n * batch * sizeof(T));
+    T* a_data = static_cast<T*>(a.mutable_cpu_data());
+    T* b_data = static_cast<T*>(b.mutable_cpu_data());
+    T* c_data = static_cast<T*>(c.mutable_cpu_data());
+    for ( int i = 0; i < m * k; i++ ) {
+      a_data[i] = static_cast<T>(i % 7) / 7;
+    }
+    for ( int i = 0; i < k * n * batch; i++ ) {
+      b_data[i] = static_cast<T>(i % 5) / 5 - 0.5;
+    }
+    for ( int i = 0; i < m * n * batch; i++ ) {
+      c_data[i] = 0;
+    }
+    const T* A = static_cast<const T*>(a.gpu_data());
+    const T* B = static_cast<const T*>(b.gpu_data());
+
+    std::vector<OpenCLGemmConfig> candidates = Candidates<T>();
+    candidates.insert(candidates.begin(), OpenCLGemmConfig());
+
+    // the default kernels produce the reference result.
+    std::vector<T> reference;
+    OpenCLGemmConfig best;
+    bool found = false;
+    CPUTimer timer;
+    instance_.benchmarking_ = true;
+    for ( size_t i = 0; i < candidates.size(); i++ ) {
+      OpenCLGemmConfig& candidate = candidates[i];
+      T* C = static_cast<T*>(c.mutable_gpu_data());
+      try {
+        if ( !Run<T>(candidate, TransA, TransB, m, n, k, batch, A, B, C) ) {
+          DLOG(INFO) << "GEMM kernel " << candidate.kernel << " failed";
+          if ( i == 0 ) {
+            break;
+          }
+          continue;
+        }
+        const T* result = static_cast<const T*>(c.cpu_data());
+        if ( i == 0 ) {
+          reference.assign(result, result + m * n * batch);
+        } else {
+          bool valid = true;
+          for ( int j = 0; j < m * n * batch && valid; j++ ) {
+            valid = fabs(result[j] - reference[j]) <=
+                1e-3 * (fabs(reference[j]) + 1);
+          }
+          if ( !valid ) {
+            LOG(WARNING) << "GEMM kernel " << candidate.kernel << " tile = "
+                         << candidate.tile << " wpt = " << candidate.wpt
+                         << " differs from the default kernel";
+            continue;
+          }
+        }
+
+        C = static_cast<T*>(c.mutable_gpu_data());
+        timer.Start();
+        for ( int j = 0; j < kTuneIterations; j++ ) {
+          if ( !Run<T>(candidate, TransA, TransB, m, n, k, batch, A, B,
+                       C) ) {
+            break;
+          }
+        }
+        device.waitForCommandQueues();
+        candidate.time_us = timer.MicroSeconds() / kTuneIterations;
+      } catch ( OpenCLSupportException& e ) {
+        DLOG(INFO) << "GEMM kernel " << candidate.kernel << " failed";
+        if ( i == 0 ) {
+          break;
+        }
+        continue;
+      }
+
+      DLOG(INFO) << "GEMM " << candidate.kernel << " tile = "
+                 << candidate.tile << " wpt = " << candidate.wpt << " : "
+                 << candidate.time_us << " us";
+      if ( !found || candidate.time_us < best.time_us ) {
+        best = candidate;
+        found = true;
+      }
+    }
+    instance_.benchmarking_ = false;
+
+    if ( reference.size() == 0 ) {
+      LOG(ERROR) << "failed to run the default GEMM kernel for M = " << m
+                 << " N = " << n << " K = " << k << " batch = " << batch;
+      return false;
+    }
+
+    LOG(INFO) << "tuned GEMM " << TransposeName(TransA)
+              << TransposeName(TransB) << " M = " << m << " N = " << n
+              << " K = " << k << " batch = " << batch << " : "
+              << best.kernel << " tile = " << best.tile << " wpt = "
+              << best.wpt << " " << best.time_us << " us";
+    instance_.entries_[Key<T>(TransA, TransB, m, n, k, batch)] = best;
+    *config = best;
+    return true;
+  }
+
+  void OpenCLGemmTuner::SetTuning(bool tuning) {
+    instance_.tuning_ = tuning;
+  }
+
+  bool OpenCLGemmTuner::GetTuning() {
+    return instance_.tuning_;
+  }
+
+  void OpenCLGemmTuner::SetFile(const std::string& file) {
+    instance_.file_ = file;
+    instance_.loaded_ = false;
+  }
+
+  std::string OpenCLGemmTuner::GetFile() {
+    if ( instance_.file_.size() > 0 ) {
+      return instance_.file_;
+    }
+    return GetDefaultFile();
+  }
+
+  bool OpenCLGemmTuner::Load() {
+    instance_.loaded_ = true;
+    instance_.entries_.clear();
+    std::string file_name = GetFile();
+    if ( file_name.size() == 0 ) {
+      return false;
+    }
+    std::ifstream file(file_name.c_str());
+    if ( !file.is_open() ) {
+      DLOG(INFO) << "no GEMM tuning file '" << file_name.c_str() << "'";
+      return false;
+    }
+
+    // the first nine fields form the key, see Key().
+    std::string line;
+    while ( std::getline(file, line) ) {
+      if ( line.size() == 0 || line[0] == '#' ) {
+        continue;
+      }
+      std::vector<std::string> fields;
+      std::istringstream is(line);
+      std::string field;
+      while ( std::getline(is, field, '\t') ) {
+        fields.push_back(field);
+      }
+      if ( fields.size() != 13 ) {
+        LOG(WARNING) << "ignoring invalid line in GEMM tuning file '"
+                     << file_name.c_str() << "' : " << line;
+        continue;
+      }
+      std::string key = fields[0];
+      for ( int i = 1; i < 9; i++ ) {
+        key += "\t" + fields[i];
+      }
+      OpenCLGemmConfig config;
+      config.kernel = fields[9];
+      config.tile = atoi(fields[10].c_str());
+      config.wpt = atoi(fields[11].c_str());
+      config.time_us = atof(fields[12].c_str());
+      if ( config.tiled() && (config.tile < config.wpt || config.wpt < 1 ||
+                              config.wpt > OPENCL_TUNED_MAX_WPT) ) {
+        LOG(WARNING) << "ignoring invalid line in GEMM tuning file '"
+                     << file_name.c_str() << "' : " << line;
+        continue;
+      }
+      instance_.entries_[key] = config;
+    }
+    DLOG(INFO) << "loaded " << instance_.entries_.size()
+               << " GEMM shapes from '" << file_name.c_str() << "'";
+    return true;
+  }
+
+  bool OpenCLGemmTuner::Save() {
+    std::string file_name = GetFile();
+    if ( file_name.size() == 0 ) {
+      LOG(ERROR) << "no GEMM tuning file, set CAFFE_OPENCL_GEMM_TUNING_FILE "
+                    "or the program cache directory";
+      return false;
+    }
+    std::ofstream file(file_name.c_str(), std::ios::out | std::ios::trunc);
+    if ( !file.is_open() ) {
+      LOG(ERROR) << "failed to write GEMM tuning file '"
+                 << file_name.c_str() << "'";
+      return false;
+    }
+
+    file << "# device\tdriver\tdtype\ttransA\ttransB\tM\tN\tK\tbatch"
+            "\tkernel\ttile\twpt\tus" << std::endl;
+    std::map<std::string, OpenCLGemmConfig>::iterator it;
+    for ( it = instance_.entries_.begin(); it != instance_.entries_.end();
+          it++ ) {
+      file << it->first << '\t' << it->second.kernel << '\t'
+           << it->second.tile << '\t' << it->second.wpt << '\t'
+           << it->second.time_us << std::endl;
+    }
+    return file.good();
+  }
+
+  void OpenCLGemmTuner::Clear() {
+    instance_.entries_.clear();
+    instance_.loaded_ = true;
+  }
+
+  size_t OpenCLGemmTuner::GetNumEntries() {
+    if ( !instance_.loaded_ ) {
+      Load();
+    }
+    return instance_.entries_.size();
+  }
+
+  template bool OpenCLGemmTuner::Lookup<float>(
+      const clblasTranspose TransA, const clblasTranspose TransB,
+      const int m, const int n, const int k, const int batch,
+      OpenCLGemmConfig* config);
+  template bool OpenCLGemmTuner::Lookup<double>(
+      const clblasTranspose TransA, const clblasTranspose TransB,
+      const int m, const int n, const int k, const int batch,
+      OpenCLGemmConfig* config);
+  template bool OpenCLGemmTuner::Tune<float>(
+      const clblasTranspose TransA, const clblasTranspose TransB,
+      const int m, const int n, const int k, const int batch,
+      OpenCLGemmConfig* config);
+  template bool OpenCLGemmTuner::Tune<double>(
+      const clblasTranspose TransA, const clblasTranspose TransB,
+      const int m, const int n, const int k, const int batch,
+      OpenCLGemmConfig* config);
+  template std::vector<OpenCLGemmConfig> OpenCLGemmTuner::Candidates<float>();
+  template std::vector<OpenCLGemmConfig>
+  OpenCLGemmTuner::Candidates<double>();
+
+}  // namespace caffe
+
+#endif  // USE_OPENCL
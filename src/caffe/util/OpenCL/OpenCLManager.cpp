@@ -2,11 +2,19 @@
 
 #include <CL/cl.h>
 #include <glog/logging.h>
+#include <stdlib.h>
 
+#include <caffe/layer.hpp>
+#include <caffe/net.hpp>
+#include <caffe/util/benchmark.hpp>
 #include <caffe/util/OpenCL/OpenCLManager.hpp>
 #include <caffe/util/OpenCL/OpenCLSupport.hpp>
+#ifdef CAFFE_OPENCL_EMBEDDED_SOURCES
+#include <caffe/util/OpenCL/OpenCLSources.hpp>
+#endif
 
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -14,36 +22,8 @@ namespace caffe {
 
 OpenCLManager OpenCLManager::instance_;
 
-OpenCLManager::OpenCLManager() : initialized_(
-        false) {
-}
-
-OpenCLManager::~OpenCLManager() {
-}
-
-bool OpenCLManager::Init() {
-  if (instance_.initialized_) {
-    return true;
-  }
-  LOG(INFO)<< "Initialize OpenCL";
-  instance_.Query();
-  if (OpenCLManager::GetNumPlatforms() <= 0) {
-    LOG(FATAL)<< "No OpenCL platforms found.";
-    return false;
-  }
-
-  // TODO: mechanism for choosing the correct platform.
-  instance_.current_platform_index_ = 0;
-
-  std::tr1::shared_ptr<OpenCLPlatform> pf = CurrentPlatform();
-  pf->print();
-
-  if (!pf->createContext()) {
-    LOG(FATAL)<< "failed to create OpenCL context for platform "
-    << pf->name();
-    return false;
-  }
-
+#ifndef CAFFE_OPENCL_EMBEDDED_SOURCES
+static std::vector<std::string> GetProgramSources() {
   std::vector<std::string> cl_files;
   cl_files.push_back(
       "src/caffe/util/OpenCL/gemm.cl");
@@ -51,6 +31,14 @@ bool OpenCLManager::Init() {
       "src/caffe/util/OpenCL/math_functions.cl");
   cl_files.push_back(
       "src/caffe/util/OpenCL/im2col.cl");
+  cl_files.push_back(
+      "src/caffe/util/OpenCL/winograd.cl");
+  cl_files.push_back(
+      "src/caffe/util/OpenCL/fft.cl");
+  cl_files.push_back(
+      "src/caffe/util/OpenCL/random.cl");
+  cl_files.push_back(
+      "src/caffe/layers/OpenCL/conv_layer.cl");
   cl_files.push_back(
       "src/caffe/layers/OpenCL/pooling_layer.cl");
   cl_files.push_back(
@@ -79,17 +67,70 @@ bool OpenCLManager::Init() {
       "src/caffe/layers/OpenCL/threshold_layer.cl");
   cl_files.push_back(
       "src/caffe/layers/OpenCL/mvn_layer.cl");
+  return cl_files;
+}
+#endif  // CAFFE_OPENCL_EMBEDDED_SOURCES
 
-  std::vector<std::string>::iterator it;
+OpenCLManager::OpenCLManager() : initialized_(
+        false) {
+  const char* cache_dir = getenv("CAFFE_OPENCL_CACHE_DIR");
+  program_cache_dir_ = cache_dir != NULL ? cache_dir : ".opencl_cache";
+}
+
+OpenCLManager::~OpenCLManager() {
+}
+
+bool OpenCLManager::Init() {
+  if (instance_.initialized_) {
+    return true;
+  }
+  LOG(INFO)<< "Initialize OpenCL";
+  instance_.Query();
+  if (OpenCLManager::GetNumPlatforms() <= 0) {
+    LOG(FATAL)<< "No OpenCL platforms found.";
+    return false;
+  }
 
+  // TODO: mechanism for choosing the correct platform.
+  instance_.current_platform_index_ = 0;
+
+  std::tr1::shared_ptr<OpenCLPlatform> pf = CurrentPlatform();
+  pf->print();
+
+  if (!pf->createContext()) {
+    LOG(FATAL)<< "failed to create OpenCL context for platform "
+    << pf->name();
+    return false;
+  }
+
+  // programs are only registered here and built on the first request of
+  // one of their kernels, see OpenCLDevice::getKernel() and WarmUp().
+#ifdef CAFFE_OPENCL_EMBEDDED_SOURCES
+  const OpenCL::EmbeddedProgram* it;
+  int num_programs = 0;
+  for (it = OpenCL::embedded_programs; it->name != NULL; it++) {
+    if (!pf->registerProgram(
+        it->name, it->source, it->kernels)) {
+      LOG(FATAL)<< "failed to register OpenCL program for platform "
+      << pf->name();
+      return false;
+    }
+    num_programs++;
+  }
+#else
+  std::vector<std::string> cl_files = GetProgramSources();
+  std::vector<std::string>::iterator it;
+  int num_programs = cl_files.size();
   for (it = cl_files.begin(); it != cl_files.end(); it++) {
-    if (!pf->compile(
+    if (!pf->registerProgram(
         *it)) {
-      LOG(FATAL)<< "failed to create to create OpenCL program for platform "
+      LOG(FATAL)<< "failed to register OpenCL program for platform "
       << pf->name();
       return false;
     }
   }
+#endif
+  LOG(INFO)<< "registered " << num_programs << " OpenCL programs";
 
   if (pf->getNumGPUDevices() < 1) {
     LOG(FATAL)<< "No GPU devices available at platform " << pf->name();
@@ -182,6 +223,123 @@ void OpenCLManager::SetDeviceId(int device_id) {
   instance_.device_id_ = device_id;
 }
 
+void OpenCLManager::SetProgramCacheDir(const std::string& dir) {
+  instance_.program_cache_dir_ = dir;
+}
+
+std::string OpenCLManager::GetProgramCacheDir() {
+  return instance_.program_cache_dir_;
+}
+
+bool OpenCLManager::BenchmarkProgramBuild(float* cold_ms, float* warm_ms) {
+  if (!instance_.initialized_) {
+    LOG(ERROR)<< "OpenCL is not initialized.";
+    return false;
+  }
+  if (instance_.program_cache_dir_.size() == 0) {
+    LOG(ERROR)<< "OpenCL program cache is disabled.";
+    return false;
+  }
+
+  OpenCLDevice& device = CurrentPlatform()->CurrentDevice();
+#ifndef CAFFE_OPENCL_EMBEDDED_SOURCES
+  std::vector<std::string> cl_files = GetProgramSources();
+  std::vector<std::string> kernel_names;
+#endif
+  cl_program program;
+  CPUTimer timer;
+
+  // the cold build ignores but refreshes the cache, so the warm build that
+  // follows always finds a valid binary.
+  *cold_ms = 0;
+  *warm_ms = 0;
+  for (int use_cache = 0; use_cache < 2; use_cache++) {
+    timer.Start();
+#ifdef CAFFE_OPENCL_EMBEDDED_SOURCES
+    const OpenCL::EmbeddedProgram* it;
+    for (it = OpenCL::embedded_programs; it->name != NULL; it++) {
+      if (!device.buildProgram(it->name, it->source, use_cache, &program)) {
+        LOG(ERROR)<< "failed to build OpenCL program '" << it->name << "'";
+        return false;
+      }
+      clReleaseProgram(program);
+    }
+#else
+    std::vector<std::string>::iterator it;
+    for (it = cl_files.begin(); it != cl_files.end(); it++) {
+      if (!device.buildProgram(*it, use_cache, &program, &kernel_names)) {
+        LOG(ERROR)<< "failed to build OpenCL program '" << *it << "'";
+        return false;
+      }
+      clReleaseProgram(program);
+    }
+#endif
+    *(use_cache ? warm_ms : cold_ms) = timer.MilliSeconds();
+  }
+  return true;
+}
+
+// builds the programs and math_functions, which almost every layer uses.
+static bool BuildPrograms(std::set<std::string> programs) {
+  programs.insert("math_functions");
+
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  CPUTimer timer;
+  timer.Start();
+  std::set<std::string>::iterator it;
+  for (it = programs.begin(); it != programs.end(); it++) {
+    if (!device.buildRegisteredProgram(*it)) {
+      LOG(ERROR)<< "failed to warm up OpenCL program '" << *it << "'";
+      return false;
+    }
+  }
+  LOG(INFO)<< "warmed up " << programs.size() << " OpenCL programs in "
+  << timer.MilliSeconds() << " ms";
+  return true;
+}
+
+bool OpenCLManager::WarmUp(const std::vector<std::string>& layer_types) {
+  if (!instance_.initialized_) {
+    LOG(ERROR)<< "OpenCL is not initialized.";
+    return false;
+  }
+  // a layer reports the programs of its default parameters before SetUp.
+  std::set<std::string> programs;
+  LayerRegistry<float>::CreatorRegistry& registry =
+      LayerRegistry<float>::Registry();
+  for (size_t i = 0; i < layer_types.size(); i++) {
+    if (registry.count(layer_types[i]) == 0) {
+      continue;
+    }
+    LayerParameter param;
+    param.set_type(layer_types[i]);
+    std::vector<std::string> layer_programs;
+    LayerRegistry<float>::CreateLayer(param)->opencl_programs(
+        &layer_programs);
+    programs.insert(layer_programs.begin(), layer_programs.end());
+  }
+  return BuildPrograms(programs);
+}
+
+template <typename Dtype>
+bool OpenCLManager::WarmUp(const Net<Dtype>& net) {
+  if (!instance_.initialized_) {
+    LOG(ERROR)<< "OpenCL is not initialized.";
+    return false;
+  }
+  // the layers report the engines they chose for their shapes.
+  std::set<std::string> programs;
+  for (size_t i = 0; i < net.layers().size(); i++) {
+    std::vector<std::string> layer_programs;
+    net.layers()[i]->opencl_programs(&layer_programs);
+    programs.insert(layer_programs.begin(), layer_programs.end());
+  }
+  return BuildPrograms(programs);
+}
+
+template bool OpenCLManager::WarmUp<float>(const Net<float>& net);
+template bool OpenCLManager::WarmUp<double>(const Net<double>& net);
+
 }  // namespace caffe
 
 #endif  // USE_OPENCL
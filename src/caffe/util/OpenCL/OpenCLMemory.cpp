@@ -32,7 +32,7 @@ OpenCLMemory::OpenCLMemory() {
   this->memoryEvent = NULL;
 }
 
-OpenCLMemory::OpenCLMemory(size_t size) {
+OpenCLMemory::OpenCLMemory(size_t size, cl_mem_flags flags) {
   OpenCLDevice& current_device =
       OpenCLManager::CurrentPlatform()->CurrentDevice();
   cl_context context = current_device.getContext();
@@ -41,15 +41,15 @@ OpenCLMemory::OpenCLMemory(size_t size) {
   if (!context) {
     std::ostringstream oss;
     oss << current_device.name() << "> failed to get OpenCL context.";
-    LOG(FATAL)<< oss;
+    LOG(FATAL)<< oss.str();
   }
 
   double allocSizeMB = size / (1024.0 * 1024.0);
 
   cl_int err;
-  this->ptr_device_mem_ = clCreateBuffer(
+  cl_mem mem = clCreateBuffer(
       context,
-      CL_MEM_READ_WRITE,
+      flags,
       size,
       NULL,
       &err);
@@ -58,7 +58,8 @@ OpenCLMemory::OpenCLMemory(size_t size) {
     oss << current_device.name()
         << "> failed to create CL_MEM_READ_WRITE buffer of " << allocSizeMB
         << " MByte";
-    LOG(FATAL)<< oss.str();
+    LOG(ERROR)<< oss.str();
+    throw OpenCLMemoryException(oss.str());
   }
 
   /*
@@ -75,6 +76,47 @@ OpenCLMemory::OpenCLMemory(size_t size) {
   deviceMemUsedMB /= 1024.0;
   deviceMemUsedMB /= 1024.0;
 
+  setDeviceMemory(mem, size);
+
+  DLOG(INFO)<< current_device.name()
+  << "> create CL_MEM_READ_WRITE buffer of "
+  << allocSizeMB << " MByte at " << getTag().c_str()
+  << " total mem utilization = " << deviceMemUsedMB << " MByte";
+  logStatistics();
+}
+
+OpenCLMemory::OpenCLMemory(cl_mem slab, size_t origin, size_t size) {
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+  cl_buffer_region region;
+  region.origin = origin;
+  region.size = size;
+
+  cl_int err;
+  cl_mem mem = clCreateSubBuffer(
+      slab,
+      CL_MEM_READ_WRITE,
+      CL_BUFFER_CREATE_TYPE_REGION,
+      &region,
+      &err);
+  if (err != CL_SUCCESS) {
+    std::ostringstream oss;
+    oss << current_device.name() << "> failed to create sub-buffer of "
+        << size << " Byte at offset " << origin << " : "
+        << caffe::OpenCL::what(err);
+    DLOG(INFO)<< oss.str();
+    throw OpenCLMemoryException(oss.str());
+  }
+
+  setDeviceMemory(mem, size);
+
+  DLOG(INFO)<< current_device.name() << "> create sub-buffer of " << size
+  << " Byte at offset " << origin << " at " << getTag().c_str();
+}
+
+void OpenCLMemory::setDeviceMemory(cl_mem mem, size_t size) {
+  this->ptr_device_mem_ = mem;
   this->ptr_device_mem = (const void*) this->ptr_device_mem_;
   this->size = size;
   this->ptr_virtual_bgn = ptr_offset;
@@ -89,14 +131,9 @@ OpenCLMemory::OpenCLMemory(size_t size) {
       << this->count;
   this->tag = oss.str();
 
-  DLOG(INFO)<< current_device.name()
-  << "> create CL_MEM_READ_WRITE buffer of "
-  << allocSizeMB << " MByte at " << getTag().c_str()
-  << " total mem utilization = " << deviceMemUsedMB << " MByte";
   DLOG(INFO)<< "new memory " << this->tag.c_str();
   this->count++;
   numCallsMalloc++;
-  logStatistics();
 }
 
 void OpenCLMemory::free() {
@@ -133,6 +170,27 @@ void OpenCLMemory::free() {
 OpenCLMemory::~OpenCLMemory() {
 }
 
+void OpenCLMemory::logStatistics() {
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+  const OpenCLMemoryCacheStatistics& stats =
+      current_device.getMemoryCacheStatistics();
+
+  uint64_t requests = stats.hits + stats.misses;
+  double hitRate = requests > 0 ? 100.0 * stats.hits / requests : 0.0;
+  double fragmentation = stats.bytes_in_use > 0 ?
+      100.0 * (stats.bytes_in_use - stats.bytes_requested) / stats.bytes_in_use
+      : 0.0;
+
+  DLOG(INFO) << "OpenCL Memory Statistics [clMalloc|clFree] = ["
+             << numCallsMalloc << "|" << numCallsFree << "]"
+             << " cache [hits|misses] = [" << stats.hits << "|"
+             << stats.misses << "] hit rate = " << hitRate << "%"
+             << " in use = " << stats.bytes_in_use << " Byte"
+             << " cached = " << stats.bytes_cached << " Byte"
+             << " fragmentation = " << fragmentation << "%";
+}
+
 bool OpenCLMemory::isHighMem(const void* p) {
   if ((uintptr_t) p & (1UL << CL_PTR_BIT)) {
     return true;
@@ -230,6 +288,11 @@ bool OpenCLMemory::hasEvent() {
 
 bool OpenCLMemory::setEvent(cl_event event) {
   DLOG(INFO)<< "setting event for " << this->getTag() << " event = " << event;
+  // the memory owns its event, commands enqueued later on the same queue
+  // are ordered after the one replaced here anyway.
+  if (this->memoryEvent != NULL && this->memoryEvent != event) {
+    clReleaseEvent(this->memoryEvent);
+  }
   this->memoryEvent = event;
   return true;
 }
@@ -245,6 +308,9 @@ cl_event OpenCLMemory::getEvent() {
 }
 
 void OpenCLMemory::resetEvent() {
+  if (this->memoryEvent != NULL) {
+    clReleaseEvent(this->memoryEvent);
+  }
   this->memoryEvent = NULL;
 }
 
@@ -49,8 +49,9 @@ bool OpenCLParser::getKernelNames(
     return false;
   }
 
+  // works on standard OpenCL as well as on the unconverted sources, where
+  // the names of template kernels come from their instantiation lines.
   boost::regex kernel_line("^__kernel[[:space:]]+void[[:space:]]+[[:word:]]+\\(.*", boost::regex::perl);  // NOLINT(*)
-  boost::regex template_kernel_line("^template\\s+<class \\w+>\\s+__kernel[[:space:]]+void[[:space:]]+[[:word:]]+\\(.*", boost::regex::perl);  // NOLINT(*)
   boost::regex split("[\\s+(]");
 
   boost::smatch what;
@@ -68,18 +69,8 @@ bool OpenCLParser::getKernelNames(
       }
     }
 
-    if ( boost::regex_match(str, what,
-                            template_kernel_line, boost::match_default) ) {
-      for (int m = 0; m < what.size(); m++) {
-        boost::sregex_token_iterator it(str.begin(), str.end(), split, -1);
-        it++;
-        it++;
-        it++;
-        it++;
-        it++;
-        names.push_back(*it+"Float");
-        names.push_back(*it+"Double");
-      }
+    if ( isAttributeLine(str) ) {
+      names.push_back(getTypedKernelName(str));
     }
   }
   return true;
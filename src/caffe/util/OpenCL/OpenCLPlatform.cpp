@@ -284,6 +284,41 @@ bool OpenCLPlatform::compile(std::string cl_source) {
   return true;
 }
 
+bool OpenCLPlatform::compile(std::string name, const char* source,
+                             const char* const* kernel_names) {
+  std::vector<caffe::OpenCLDevice>::iterator it;
+  for (it = devices.begin(); it != devices.end(); it++) {
+    if (!(*it).compile(
+        name, source, kernel_names)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool OpenCLPlatform::registerProgram(std::string cl_source) {
+  std::vector<caffe::OpenCLDevice>::iterator it;
+  for (it = devices.begin(); it != devices.end(); it++) {
+    if (!(*it).registerProgram(
+        cl_source)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool OpenCLPlatform::registerProgram(std::string name, const char* source,
+                                     const char* const* kernel_names) {
+  std::vector<caffe::OpenCLDevice>::iterator it;
+  for (it = devices.begin(); it != devices.end(); it++) {
+    if (!(*it).registerProgram(
+        name, source, kernel_names)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 OpenCLDevice& OpenCLPlatform::CurrentDevice() {
   if (current_device_index_ < 0) {
     LOG(FATAL)<< "Current device not set.";
@@ -0,0 +1,226 @@
+#ifdef USE_OPENCL
+
+#include <CL/cl.h>
+#include <glog/logging.h>
+
+#include <caffe/util/OpenCL/OpenCLManager.hpp>
+#include <caffe/util/OpenCL/OpenCLScheduler.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace caffe {
+
+  OpenCLScheduler::OpenCLScheduler() {
+    num_chains_ = 0;
+    fork_event_ = NULL;
+  }
+
+  OpenCLScheduler::~OpenCLScheduler() {
+    releaseEvents();
+  }
+
+  void OpenCLScheduler::Init(const std::vector<std::vector<int> >& bottom_ids,
+                             const std::vector<std::vector<int> >& top_ids,
+                             int num_blobs) {
+    releaseEvents();
+    int num_layers = bottom_ids.size();
+    layer_deps_.assign(num_layers, std::vector<int>());
+    layer_chain_.assign(num_layers, 0);
+    layer_event_.assign(num_layers, NULL);
+
+    // the layer that wrote each blob last and the layers reading it since.
+    std::vector<int> writer(num_blobs, -1);
+    std::vector<std::vector<int> > readers(num_blobs);
+    for ( int i = 0; i < num_layers; i++ ) {
+      std::vector<int>& deps = layer_deps_[i];
+      for ( size_t j = 0; j < bottom_ids[i].size(); j++ ) {
+        deps.push_back(writer[bottom_ids[i][j]]);
+      }
+      for ( size_t j = 0; j < top_ids[i].size(); j++ ) {
+        int blob_id = top_ids[i][j];
+        deps.push_back(writer[blob_id]);
+        deps.insert(deps.end(), readers[blob_id].begin(),
+                    readers[blob_id].end());
+      }
+      std::sort(deps.begin(), deps.end());
+      deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+      deps.erase(std::remove(deps.begin(), deps.end(), i), deps.end());
+      deps.erase(std::remove(deps.begin(), deps.end(), -1), deps.end());
+
+      for ( size_t j = 0; j < bottom_ids[i].size(); j++ ) {
+        readers[bottom_ids[i][j]].push_back(i);
+      }
+      for ( size_t j = 0; j < top_ids[i].size(); j++ ) {
+        writer[top_ids[i][j]] = i;
+        readers[top_ids[i][j]].clear();
+      }
+    }
+
+    std::vector<int> producer(num_blobs, -1);
+    std::vector<bool> continued(num_layers, false);
+    num_chains_ = 0;
+    for ( int i = 0; i < num_layers; i++ ) {
+      int chain = -1;
+      for ( size_t j = 0; j < bottom_ids[i].size(); j++ ) {
+        int layer = producer[bottom_ids[i][j]];
+        if ( layer >= 0 && !continued[layer] ) {
+          continued[layer] = true;
+          chain = layer_chain_[layer];
+          break;
+        }
+      }
+      if ( chain < 0 ) {
+        chain = num_chains_++;
+      }
+      layer_chain_[i] = chain;
+      for ( size_t j = 0; j < top_ids[i].size(); j++ ) {
+        producer[top_ids[i][j]] = i;
+      }
+    }
+    DLOG(INFO) << "scheduled " << num_layers << " layers on "
+               << num_chains_ << " chains";
+  }
+
+  bool OpenCLScheduler::enabled() {
+    OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+    return device.getNumCommandQueues() > 1 ||
+        device.getOutOfOrderExecution();
+  }
+
+  unsigned int OpenCLScheduler::getQueueIdx(int layer) {
+    OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+    if ( device.getOutOfOrderExecution() ) {
+      return 0;
+    }
+    return layer_chain_[layer] % device.getNumCommandQueues();
+  }
+
+  int OpenCLScheduler::getChain(int layer) {
+    return layer_chain_[layer];
+  }
+
+  int OpenCLScheduler::getSerialIdx(int layer) {
+    OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+    if ( device.getOutOfOrderExecution() ) {
+      return layer_chain_[layer];
+    }
+    return getQueueIdx(layer);
+  }
+
+  int OpenCLScheduler::getNumChains() {
+    return num_chains_;
+  }
+
+  const std::vector<int>& OpenCLScheduler::getDependencies(int layer) {
+    return layer_deps_[layer];
+  }
+
+  // the layers may read what was enqueued on queue 0 before.
+  bool OpenCLScheduler::Fork() {
+    OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+    if ( !device.enqueueMarker(0, &fork_event_) ) {
+      fork_event_ = NULL;
+      return false;
+    }
+    if ( device.getOutOfOrderExecution() ) {
+      return true;
+    }
+    std::vector<cl_event> events(1, fork_event_);
+    for ( unsigned int i = 1; i < device.getNumCommandQueues(); i++ ) {
+      if ( !device.enqueueWaitForEvents(i, events) ) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool OpenCLScheduler::BeginLayer(int layer) {
+    if ( fork_event_ == NULL && !Fork() ) {
+      return false;
+    }
+
+    OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+    unsigned int queue_idx = getQueueIdx(layer);
+    bool out_of_order = device.getOutOfOrderExecution();
+    std::vector<cl_event> events;
+    if ( out_of_order ) {
+      events.push_back(fork_event_);
+    }
+    const std::vector<int>& deps = layer_deps_[layer];
+    for ( size_t i = 0; i < deps.size(); i++ ) {
+      // layers outside of the issued range are covered by the fork event,
+      // commands on the same in-order queue are ordered anyway.
+      if ( layer_event_[deps[i]] == NULL ) {
+        continue;
+      }
+      if ( !out_of_order && getQueueIdx(deps[i]) == queue_idx ) {
+        continue;
+      }
+      events.push_back(layer_event_[deps[i]]);
+    }
+
+    if ( out_of_order ) {
+      device.setCommandWaitList(events);
+    } else if ( !device.enqueueWaitForEvents(queue_idx, events) ) {
+      return false;
+    }
+    return device.setCommandQueueIDX(queue_idx);
+  }
+
+  bool OpenCLScheduler::EndLayer(int layer) {
+    OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+    if ( layer_event_[layer] != NULL ) {
+      clReleaseEvent(layer_event_[layer]);
+      layer_event_[layer] = NULL;
+    }
+    bool success;
+    if ( device.getOutOfOrderExecution() ) {
+      success = device.enqueueCommandMarker(&layer_event_[layer]);
+    } else {
+      success = device.enqueueMarker(getQueueIdx(layer), &layer_event_[layer]);
+    }
+    if ( !success ) {
+      layer_event_[layer] = NULL;
+    }
+    return success;
+  }
+
+  bool OpenCLScheduler::Join() {
+    OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+    bool success = true;
+    if ( device.getOutOfOrderExecution() ) {
+      // the marker waits for all commands enqueued before, the commands
+      // enqueued afterwards wait for the marker.
+      cl_event event;
+      success = device.enqueueMarker(0, &event);
+      if ( success ) {
+        device.addCommandEvent(event);
+        clReleaseEvent(event);
+      }
+    } else {
+      for ( unsigned int i = 1; i < device.getNumCommandQueues(); i++ ) {
+        success = success && device.enqueueCommandQueueWait(0, i);
+      }
+    }
+    releaseEvents();
+    return device.setCommandQueueIDX(0) && success;
+  }
+
+  void OpenCLScheduler::releaseEvents() {
+    // pending events stay valid until their commands have completed.
+    for ( size_t i = 0; i < layer_event_.size(); i++ ) {
+      if ( layer_event_[i] != NULL ) {
+        clReleaseEvent(layer_event_[i]);
+        layer_event_[i] = NULL;
+      }
+    }
+    if ( fork_event_ != NULL ) {
+      clReleaseEvent(fork_event_);
+      fork_event_ = NULL;
+    }
+  }
+
+}  // namespace caffe
+
+#endif  // USE_OPENCL
@@ -12,6 +12,7 @@
 #include <caffe/util/benchmark.hpp>
 #include <caffe/util/OpenCL/definitions.hpp>
 
+#include <algorithm>
 #include <cstdlib>
 #include <exception>
 #include <map>
@@ -245,15 +246,12 @@ bool clMalloc(void** virtualPtr, size_t size) {
   std::tr1::shared_ptr<OpenCLPlatform> pf = OpenCLManager::CurrentPlatform();
   OpenCLDevice& device = pf->CurrentDevice();
 
-  OpenCLMemory clMem;
-  try {
-    clMem = OpenCLMemory(size);
-  } catch (std::exception& e) {
+  std::tr1::shared_ptr<OpenCLBuffer> buffer;
+  if (!device.getBuffer(&buffer, size)) {
     return false;
   }
-  device.add(clMem);
 
-  *virtualPtr = clMem.getVirtualPointer();
+  *virtualPtr = buffer->getVirtualPointer();
   return true;
 }
 
@@ -261,13 +259,10 @@ bool clGetBuffer(void** virtualPtr, size_t size) {
   std::tr1::shared_ptr<OpenCLPlatform> pf = OpenCLManager::CurrentPlatform();
   OpenCLDevice& device = pf->CurrentDevice();
 
-  std::tr1::shared_ptr<OpenCLBuffer> buffer =
-      std::tr1::shared_ptr<OpenCLBuffer>(new OpenCLBuffer(size));
-
+  std::tr1::shared_ptr<OpenCLBuffer> buffer;
   if (!device.getBuffer(&buffer, size)) {
     return false;
   }
-  buffer->setUnavailable();
   *virtualPtr = buffer->getVirtualPointer();
 
   return true;
@@ -298,18 +293,140 @@ bool clFree(void* virtualPtr) {
     return false;
   }
 
-  if (clMem->hasEvent()) {
-    cl_event event = clMem->getEvent();
-    DLOG(INFO) << "waiting for event of " << clMem->getTag();
-    CL_CHECK(clWaitForEvents(1, &event));
+  // the buffer goes back to the device's cache, which waits for its
+  // pending event first.
+  return device.setBufferAvailable(clMem->getVirtualPointer(),
+                                   clMem->getSize());
+}
+
+bool clMallocHost(void** hostPtr, size_t size) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  if (!device.getPinnedHostMemory()) {
+    return false;
+  }
+  return device.mallocHost(hostPtr, size);
+}
+
+bool clFreeHost(void* hostPtr) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  return device.freeHost(hostPtr);
+}
+
+bool clIsZeroCopy() {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  return device.getZeroCopy();
+}
+
+bool clMapHost(const void* virtualPtr, size_t size, void** hostPtr) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  cl_command_queue* queue = device.getQueue();
+
+  OpenCLMemory* clMem;
+  if (!device.get(virtualPtr, &clMem)) {
+    LOG(ERROR) << device.name() << "> failed to get GPU memory @ "
+    << virtualPtr;
+    return false;
+  }
+  if (!clEnqueueWaitForTransfer(virtualPtr)) {
+    return false;
+  }
+
+  // the blocking map waits for the kernels enqueued before on the queue.
+  cl_int err;
+  *hostPtr = clEnqueueMapBuffer(*queue, (cl_mem) clMem->getLogicalPointer(),
+                                CL_TRUE, CL_MAP_READ | CL_MAP_WRITE,
+                                clGetMemoryOffset(virtualPtr), size,
+                                CL_COMMAND_WAIT_LIST(device), &err);
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << device.name() << "> failed to map "
+    << device.getMemoryTag(virtualPtr) << " : " << what(err);
+    return false;
+  }
+  DLOG(INFO) << device.name() << "> map " << device.getMemoryTag(virtualPtr)
+  << " to CPU@" << *hostPtr;
+  return true;
+}
+
+bool clUnmapHost(const void* virtualPtr, void* hostPtr) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  cl_command_queue* queue = device.getQueue();
+
+  OpenCLMemory* clMem;
+  if (!device.get(virtualPtr, &clMem)) {
+    LOG(ERROR) << device.name() << "> failed to get GPU memory @ "
+    << virtualPtr;
+    return false;
+  }
+
+  if (!CL_CHECK(clEnqueueUnmapMemObject(*queue,
+                    (cl_mem) clMem->getLogicalPointer(), hostPtr,
+                    CL_COMMAND_WAIT_LIST(device)))) {
+    return false;
+  }
+  DLOG(INFO) << device.name() << "> unmap CPU@" << hostPtr << " from "
+  << device.getMemoryTag(virtualPtr);
+  return true;
+}
+
+bool clWaitForTransfer(const void* virtualPtr) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  if (!device.getAsyncTransfers()) {
+    return true;
+  }
+
+  OpenCLMemory* clMem;
+  if (!device.get(virtualPtr, &clMem)) {
+    LOG(ERROR) << device.name() << "> failed to get GPU memory @ "
+    << virtualPtr;
+    return false;
+  }
+  if (!clMem->hasEvent()) {
+    return true;
   }
-  device.rmMemoryPtr(clMem->getVirtualPointer());
-  // clMem = NULL;
-  // device.Synchronize();
 
+  cl_event event = clMem->getEvent();
+  DLOG(INFO) << "waiting for event of " << clMem->getTag();
+  if (!CL_CHECK(clWaitForEvents(1, &event))) {
+    return false;
+  }
+  clMem->resetEvent();
   return true;
 }
 
+bool clEnqueueWaitForTransfer(const void* virtualPtr) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  if (!device.getAsyncTransfers()) {
+    return true;
+  }
+
+  OpenCLMemory* clMem;
+  if (!device.get(virtualPtr, &clMem)) {
+    LOG(ERROR) << device.name() << "> failed to get GPU memory @ "
+    << virtualPtr;
+    return false;
+  }
+  if (!clMem->hasEvent()) {
+    return true;
+  }
+
+  cl_event event = clMem->getEvent();
+  cl_int status;
+  if (!CL_CHECK(clGetEventInfo(event, CL_EVENT_COMMAND_EXECUTION_STATUS,
+                               sizeof(status), &status, NULL))) {
+    return false;
+  }
+  if (status == CL_COMPLETE) {
+    clMem->resetEvent();
+    return true;
+  }
+
+  // the event is kept, as the host might still have to wait for it
+  // before it touches the memory the transfer reads from.
+  DLOG(INFO) << "command queue waits for event of " << clMem->getTag();
+  return CL_CHECK(clEnqueueBarrierWithWaitList(
+      *device.getCurrentCommandQueue(), 1, &event, NULL));
+}
+
 template<typename T>
 bool clMemset(void* virtualPtr, const T alpha, const size_t Bytes) {
   std::tr1::shared_ptr<OpenCLPlatform> pf = OpenCLManager::CurrentPlatform();
@@ -339,12 +456,15 @@ bool clMemset(void* virtualPtr, const T alpha, const size_t Bytes) {
   cl_event bufferEvent = NULL;
 
 #ifdef OPENCL_VERSION_1_2  // at least OpenCL Version 1.2 required, this is slow
+  if (!clEnqueueWaitForTransfer(virtualPtr)) {
+    return false;
+  }
 
   size_t mem_offset = clGetMemoryOffset(virtualPtr);
   cl_mem base = (cl_mem) clMem->getLogicalPointer();
 
   cl_int err = clEnqueueFillBuffer(*queue, base, &alpha, sizeof(T), mem_offset,
-      Bytes, 0, NULL, &bufferEvent);
+      Bytes, CL_COMMAND_WAIT_LIST_EVENT(device, &bufferEvent));
   // clWaitForEvents(1, &bufferEvent);
   if (err != CL_SUCCESS) {
     std::ostringstream oss;
@@ -376,7 +496,7 @@ bool clMemset(void* virtualPtr, const T alpha, const size_t Bytes) {
 
   TIMENOSYNC("clMemSet::clEnqueuNDRangeKernel("<<Bytes<<")", {
       err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-          &global, &local, 0, NULL, &bufferEvent);
+          &global, &local, CL_COMMAND_WAIT_LIST_EVENT(device, &bufferEvent));
   });
 
   if ( err != CL_SUCCESS ) {
@@ -397,6 +517,7 @@ bool clMemset(void* virtualPtr, const T alpha, const size_t Bytes) {
   DLOG(INFO) << device.name() << "> set OpenCL memory at " <<
   device.getMemoryTag(virtualPtr) << " to " << alpha;
 
+  device.addCommandEvent(bufferEvent);
   clMem->setEvent(bufferEvent);
 
   return true;
@@ -457,9 +578,30 @@ bool clMemcpy(
       baseDst = clMemDst->getLogicalPointer();
       offsetDst = clGetMemoryOffset(virtualDstPtr);
 
-      if ( !CL_CHECK(clEnqueueWriteBuffer(*queue, (cl_mem) baseDst, CL_TRUE,
-                  offsetDst, size, virtualSrcPtr,
-                  0, NULL, &copyEvent) ) ) {
+      if (device.getAsyncTransfers()) {
+        // upload on the input queue, so that the transfer overlaps with
+        // the kernels on the command queue. It must not overwrite memory
+        // that kernels enqueued before still read from.
+        cl_command_queue* inputQueue = device.getNextInputQueue();
+        cl_event marker;
+        if ( !CL_CHECK(clEnqueueMarkerWithWaitList(*queue, 0, NULL,
+                    &marker)) ) {
+          return false;
+        }
+        bool success = CL_CHECK(clEnqueueWriteBuffer(*inputQueue,
+                    (cl_mem) baseDst, CL_FALSE, offsetDst, size,
+                    virtualSrcPtr, 1, &marker, &copyEvent));
+        clReleaseEvent(marker);
+        if ( !success ) {
+          LOG(ERROR) << device.name() << "> copy CPU@" << virtualSrcPtr
+          << " to " << device.getMemoryTag(virtualDstPtr).c_str()
+          << " " << size << " Byte transferred failed.";
+          return false;
+        }
+        clFlush(*inputQueue);
+      } else if ( !CL_CHECK(clEnqueueWriteBuffer(*queue, (cl_mem) baseDst,
+                  CL_TRUE, offsetDst, size, virtualSrcPtr,
+                  CL_COMMAND_WAIT_LIST_EVENT(device, &copyEvent)) ) ) {
         LOG(ERROR) << device.name() << "> copy CPU@" << virtualSrcPtr
         << " to " << device.getMemoryTag(virtualDstPtr).c_str()
         << " " << size << " Byte transferred failed.";
@@ -471,6 +613,7 @@ bool clMemcpy(
       << " Byte transferred.";
 
       // clWaitForEvents(1, &copyEvent);
+      device.addCommandEvent(copyEvent);
       clMemDst->setEvent(copyEvent);
 
       break;
@@ -489,9 +632,29 @@ bool clMemcpy(
       baseSrc = clMemSrc->getLogicalPointer();
       offsetSrc = clGetMemoryOffset(virtualSrcPtr);
 
-      if (!CL_CHECK(clEnqueueReadBuffer(*queue, (cl_mem) baseSrc, CL_TRUE,
-                  offsetSrc, size, virtualDstPtr, 0,
-                  NULL, &copyEvent) ) ) {
+      if (!clEnqueueWaitForTransfer(virtualSrcPtr)) {
+        return false;
+      }
+      if (device.getAsyncTransfers()) {
+        // download on the output queue once the kernels enqueued before
+        // on the command queue are done, the command queue keeps going.
+        cl_command_queue* outputQueue = device.getNextOutputQueue();
+        cl_event marker;
+        if ( !CL_CHECK(clEnqueueMarkerWithWaitList(*queue, 0, NULL,
+                    &marker)) ) {
+          return false;
+        }
+        clFlush(*queue);
+        bool success = CL_CHECK(clEnqueueReadBuffer(*outputQueue,
+                    (cl_mem) baseSrc, CL_TRUE, offsetSrc, size,
+                    virtualDstPtr, 1, &marker, &copyEvent));
+        clReleaseEvent(marker);
+        if ( !success ) {
+          return false;
+        }
+      } else if (!CL_CHECK(clEnqueueReadBuffer(*queue, (cl_mem) baseSrc,
+                  CL_TRUE, offsetSrc, size, virtualDstPtr,
+                  CL_COMMAND_WAIT_LIST_EVENT(device, &copyEvent)) ) ) {
         return false;
       }
 
@@ -540,6 +703,11 @@ bool clMemcpy(
       DLOG(INFO) << device.getMemoryTag(clMemDst->getVirtualPointer());
       DLOG(INFO) << "VMD@" << baseDst << " offset = " << offsetDst;
 
+      if (!clEnqueueWaitForTransfer(virtualSrcPtr) ||
+          !clEnqueueWaitForTransfer(virtualDstPtr)) {
+        return false;
+      }
+
       if (offsetSrc + size > clMemSrc->getSize()) {
         LOG(ERROR) << device.name() << "> copy range out of source range.";
         return false;
@@ -556,10 +724,12 @@ bool clMemcpy(
 
         if ( !CL_CHECK(clEnqueueCopyBuffer(*queue, (cl_mem) baseSrc,
                     (cl_mem) baseDst, offsetSrc,
-                    offsetDst, size, 0, NULL, &copyEvent) ) ) {
+                    offsetDst, size,
+                    CL_COMMAND_WAIT_LIST_EVENT(device, &copyEvent)) ) ) {
           return false;
         }
         // clWaitForEvents(1, &copyEvent);
+        device.addCommandEvent(copyEvent);
         clMemDst->setEvent(copyEvent);
       } else {
         DLOG(INFO) << "caffe::OpenCL::COPY_GPU_TO_GPU: with overlap";
@@ -589,12 +759,12 @@ bool clMemcpy(
                 offsetSrc,
                 0,
                 size,
-                0,
-                NULL,
-                &copyEvent))) {
+                CL_COMMAND_WAIT_LIST_EVENT(device, &copyEvent)))) {
           return false;
         }
         // CL_CHECK(clWaitForEvents(1, &copyEvent) );
+        device.addCommandEvent(copyEvent);
+        clReleaseEvent(copyEvent);
         DLOG(INFO) << device.name()
                    << "> copy "
                    << device.getMemoryTag(virtualSrcPtr).c_str()
@@ -614,12 +784,11 @@ bool clMemcpy(
                 0,
                 offsetDst,
                 size,
-                0,
-                NULL,
-                &copyEvent) ) ) {
+                CL_COMMAND_WAIT_LIST_EVENT(device, &copyEvent)) ) ) {
           return false;
         }
         // clWaitForEvents(1, &copyEvent);
+        device.addCommandEvent(copyEvent);
         clMemDst->setEvent(copyEvent);
 
         DLOG(INFO) << device.name()
@@ -844,6 +1013,26 @@ bool clSetKernelArrayArg(
   return true;
 }
 
+bool clSetKernelLocalArg(
+    size_t size, unsigned int& idx, cl_kernel* kernel) {  // NOLINT(*)
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+  cl_int err;
+
+  err = clSetKernelArg(*kernel, idx, size, NULL);
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "failed to set local memory kernel argument "
+               << idx
+               << " for kernel on GPU "
+               << device.name()
+               << " : "
+               << what(err);
+    return false;
+  }
+  idx++;
+  return true;
+}
+
 template<typename T>
 bool clSetKernelTypeArg(
     T variable, unsigned int& idx, cl_kernel* kernel) {  // NOLINT(*)
@@ -954,7 +1143,8 @@ bool clBLASasum(const int N, const void* array_virtual, T* y) {
     if (!CL_CHECK(clblasSasum(N,
                               (cl_mem) asum_device, 0,
                               (cl_mem) array_logical, 0, 1,
-                              (cl_mem) buf_device, 1, queue, 0, NULL, NULL))) {
+                              (cl_mem) buf_device, 1, queue,
+                              CL_COMMAND_WAIT_LIST(device)))) {
       caffe::OpenCL::clBufferSetAvailable(asum, sizeof(T));
       caffe::OpenCL::clBufferSetAvailable(buf, N * sizeof(T));
       return false;
@@ -965,7 +1155,8 @@ bool clBLASasum(const int N, const void* array_virtual, T* y) {
     if (!CL_CHECK(clblasDasum(N,
                               (cl_mem) asum_device, 0,
                               (cl_mem) array_logical, 0, 1,
-                              (cl_mem) buf_device, 1, queue, 0, NULL, NULL))) {
+                              (cl_mem) buf_device, 1, queue,
+                              CL_COMMAND_WAIT_LIST(device)))) {
       caffe::OpenCL::clBufferSetAvailable(asum, sizeof(T));
       caffe::OpenCL::clBufferSetAvailable(buf, N * sizeof(T));
       return false;
@@ -1013,8 +1204,8 @@ bool clsign(const int n, const void* array_GPU_x, void* array_GPU_y) {
   size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
 
-  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local, 0,
-  NULL, NULL);
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -1068,8 +1259,8 @@ bool clsgnbit(const int n, const void* array_GPU_x, void* array_GPU_y) {
   size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
 
-  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local, 0,
-  NULL, NULL);
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -1123,8 +1314,8 @@ bool clabs(const int n, const void* array_GPU_x, void* array_GPU_y) {
   size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
 
-  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local, 0,
-  NULL, NULL);
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -1183,8 +1374,8 @@ bool cldiv(
   size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
 
-  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local, 0,
-  NULL, NULL);
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -1245,8 +1436,8 @@ bool clmul(
   size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
 
-  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local, 0,
-  NULL, NULL);
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -1310,14 +1501,14 @@ bool clBLASscal(
     if (!CL_CHECK(clblasScopy(n,
                               (cl_mem) array_x_logical, 0, 1,
                               (cl_mem) array_y_logical, 0, 1, 1,
-                              queue, 0, NULL, NULL))) {
+                              queue, CL_COMMAND_WAIT_LIST(device)))) {
       LOG(ERROR) << "clblasScopy() failed on GPU " << device.name();
       return false;
     }
     DLOG(INFO) << device.name() << " clblasScopy() succeeded";
     if ( !CL_CHECK(clblasSscal(n,
                                alpha, (cl_mem) array_y_logical, 0, 1, 1,
-                               queue, 0, NULL, NULL) ) ) {
+                               queue, CL_COMMAND_WAIT_LIST(device)) ) ) {
       LOG(ERROR) << "clblasSscal() failed on GPU " << device.name();
       return false;
     }
@@ -1328,14 +1519,14 @@ bool clBLASscal(
     if (!CL_CHECK(clblasDcopy(n,
                               (cl_mem) array_x_logical, 0, 1,
                               (cl_mem) array_y_logical, 0, 1, 1,
-                              queue, 0, NULL, NULL))) {
+                              queue, CL_COMMAND_WAIT_LIST(device)))) {
       LOG(ERROR) << "clblasDcopy() failed on GPU " << device.name();
       return false;
     }
     DLOG(INFO) << device.name() << " clblasDcopy() succeeded";
     if ( !CL_CHECK(clblasDscal(n,
                                alpha, (cl_mem) array_y_logical, 0, 1, 1,
-                               queue, 0, NULL, NULL) ) ) {
+                               queue, CL_COMMAND_WAIT_LIST(device)) ) ) {
       LOG(ERROR) << "clblasDscal() failed on GPU " << device.name();
       return false;
     }
@@ -1453,7 +1644,8 @@ bool clBLASdot(
                             (cl_mem) dot_device, 0,
                             (cl_mem) x_device, x_offset, 1,
                             (cl_mem) y_device, y_offset, 1,
-                            (cl_mem) buf_device, 1, queue, 0, NULL, NULL))) {
+                            (cl_mem) buf_device, 1, queue,
+                            CL_COMMAND_WAIT_LIST(device)))) {
       LOG(ERROR) << "clblasSdot() failed on GPU " << device.name();
       caffe::OpenCL::clBufferSetAvailable(dot, sizeof(T));
       caffe::OpenCL::clBufferSetAvailable(buf, n*sizeof(T));
@@ -1467,7 +1659,8 @@ bool clBLASdot(
                             (cl_mem) dot_device, 0,
                             (cl_mem) x_device, x_offset, 1,
                             (cl_mem) y_device, y_offset, 1,
-                            (cl_mem) buf_device, 1, queue, 0, NULL, NULL))) {
+                            (cl_mem) buf_device, 1, queue,
+                            CL_COMMAND_WAIT_LIST(device)))) {
       LOG(ERROR) << "clblasDdot() failed on GPU " << device.name();
       caffe::OpenCL::clBufferSetAvailable(dot, sizeof(T));
       caffe::OpenCL::clBufferSetAvailable(buf, n*sizeof(T));
@@ -1617,7 +1810,7 @@ bool clBLASgemv(
                                 (cl_mem) A_logical, step_A, n,
                                 (cl_mem) x_logical, step_x, 1, beta,
                                 (cl_mem) y_logical, step_y, 1, 1,
-                                queue, 0, NULL, NULL))) {
+                                queue, CL_COMMAND_WAIT_LIST(device)))) {
       LOG(ERROR) << "clblasSgemv() failed on GPU " << device.name();
       return false;
     }
@@ -1629,7 +1822,7 @@ bool clBLASgemv(
                                 (cl_mem) A_logical, step_A, n,
                                 (cl_mem) x_logical, step_x, 1, beta,
                                 (cl_mem) y_logical, step_y, 1, 1,
-                                queue, 0, NULL, NULL))) {
+                                queue, CL_COMMAND_WAIT_LIST(device)))) {
       LOG(ERROR) << "clblasDgemv() failed on GPU " << device.name();
       return false;
     }
@@ -1982,6 +2175,15 @@ bool clgemm(
     T* C,
     const size_t idx_offset_C,
     cl_event* event) {
+  OpenCLGemmConfig config;
+  if ( OpenCLGemmTuner::Lookup<T>(TransA, TransB, m, n, k, 1, &config) &&
+       config.tiled() ) {
+    return clgemm_tiled<T>(config, TransA, TransB, m, n, k, 1, alpha,
+                           A, idx_offset_A, 0, B, idx_offset_B, 0, beta,
+                           C, idx_offset_C, 0, NULL, NULL, false, 0,
+                           event);
+  }
+
   std::tr1::shared_ptr<OpenCLPlatform> pf = OpenCLManager::CurrentPlatform();
   OpenCLDevice& device = pf->CurrentDevice();
   cl_command_queue* queue = device.getCurrentCommandQueue();
@@ -2113,7 +2315,7 @@ bool clgemm(
   DLOG(INFO) << "LSIZE = ( " << local[0] << " | " << local[1] << " )";
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, numKernelDims, NULL, global,
-      local, 0, NULL, event);
+      local, CL_COMMAND_WAIT_LIST_EVENT(device, event));
   if (err != CL_SUCCESS) {
     std::ostringstream oss;
     oss << "Failed to enqueue kernel '"
@@ -2127,6 +2329,9 @@ bool clgemm(
     throw OpenCLSupportException(oss.str());
     return false;
   }
+  if ( event != NULL ) {
+    device.addCommandEvent(*event);
+  }
   DLOG(INFO) << "kernel '"
              << kernel_name.c_str()
              << "' executed on GPU "
@@ -2167,57 +2372,30 @@ template bool clgemm<double>(
     cl_event* event);
 
 template<typename T>
-bool cl_group_gemm(
+bool clgemm_tiled(
+    const OpenCLGemmConfig& config,
     const clblasTranspose TransA,
     const clblasTranspose TransB,
     const int m,
     const int n,
     const int k,
-    const int gm,
-    const int gn,
-    const int gk,
+    const int batch,
     const T alpha,
     const T* A,
     const size_t idx_offset_A,
+    const size_t stride_A,
     const T* B,
     const size_t idx_offset_B,
+    const size_t stride_B,
     const T beta,
     T* C,
     const size_t idx_offset_C,
+    const size_t stride_C,
+    const T* bias_row,
+    const T* bias_col,
+    const bool relu,
+    const T negative_slope,
     cl_event* event) {
-  if (gm != 1) {
-    LOG(ERROR) << "partition of M = "
-               << m
-               << " into GM = "
-               << gm
-               << " currently not supported";
-
-    return false;
-  }
-  if ( gk != 1 ) {
-    LOG(ERROR) << "partition of K = "
-               << m
-               << " into GK = "
-               << gk
-               << " currently not supported";
-
-    return false;
-  }
-  if ( n % gn != 0 ) {
-    LOG(ERROR) << "partition of N = "
-               << n
-               << " into GN = "
-               << gn
-               << " must be even such that N % GN = 0 ";
-
-    return false;
-  }
-
-  if (TransA != clblasNoTrans && TransB != clblasNoTrans) {
-    LOG(WARNING) << "TransA != clblasNoTrans and "
-                    "TransB != clblasNoTrans not fully tested";
-  }
-
   std::tr1::shared_ptr<OpenCLPlatform> pf = OpenCLManager::CurrentPlatform();
   OpenCLDevice& device = pf->CurrentDevice();
   cl_command_queue* queue = device.getCurrentCommandQueue();
@@ -2227,82 +2405,62 @@ bool cl_group_gemm(
     return false;
   }
 
-  int block_size_x;
-  int block_size_y;
-  std::string kernel_name;
-  int numKernelDims = 0;
-
-  if (TransA == clblasNoTrans && TransB == clblasNoTrans) {
-    kernel_name = clGetKernelName<T>("group_mmul_NA_NB");
-  }
-  if (TransA == clblasTrans && TransB == clblasTrans) {
-    kernel_name = clGetKernelName<T>("group_mmul_TA_TB");
-  }
-  if (TransA == clblasTrans && TransB == clblasNoTrans) {
-    kernel_name = clGetKernelName<T>("group_mmul_TA_NB");
-  }
-  if (TransA == clblasNoTrans && TransB == clblasTrans) {
-    kernel_name = clGetKernelName<T>("group_mmul_NA_TB");
-  }
-
-  DLOG(INFO) << "kernel = " << kernel_name;
-
-  block_size_x = OPENCL_BLOCK_SIZE;
-  block_size_y = OPENCL_BLOCK_SIZE;
-  numKernelDims = 2;
-
+  std::string kernel_name = clGetKernelName<T>(config.kernel);
   cl_kernel* kernel = device.getKernel(kernel_name);
-  if (kernel == NULL) {
+  if ( kernel == NULL ) {
     return false;
   }
 
+  int transA = TransA != clblasNoTrans;
+  int transB = TransB != clblasNoTrans;
+  int wpt = config.wpt;
+  const int relu_flag = relu ? 1 : 0;
+  size_t local_size = config.tile * config.tile * sizeof(T);
+
   CL_SET_KERNEL_ARG
   CL_SET_TYPE_KERNEL_ARG(int, m, kernel)
   CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
   CL_SET_TYPE_KERNEL_ARG(int, k, kernel)
-  CL_SET_TYPE_KERNEL_ARG(int, gm, kernel)
-  CL_SET_TYPE_KERNEL_ARG(int, gn, kernel)
-  CL_SET_TYPE_KERNEL_ARG(int, gk, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, transA, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, transB, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, wpt, kernel)
   CL_SET_TYPE_KERNEL_ARG(T, alpha, kernel)
   CL_SET_ARRAY_KERNEL_ARG(&A, kernel)
   CL_SET_TYPE_KERNEL_ARG(size_t, idx_offset_A, kernel)
+  CL_SET_TYPE_KERNEL_ARG(size_t, stride_A, kernel)
   CL_SET_ARRAY_KERNEL_ARG(&B, kernel)
   CL_SET_TYPE_KERNEL_ARG(size_t, idx_offset_B, kernel)
+  CL_SET_TYPE_KERNEL_ARG(size_t, stride_B, kernel)
   CL_SET_TYPE_KERNEL_ARG(T, beta, kernel)
   CL_SET_ARRAY_KERNEL_ARG(&C, kernel)
   CL_SET_TYPE_KERNEL_ARG(size_t, idx_offset_C, kernel)
-
-  size_t* global  = reinterpret_cast<size_t*>(
-                      malloc(numKernelDims*sizeof(size_t)));
-  size_t* local   = reinterpret_cast<size_t*>(
-                      malloc(numKernelDims*sizeof(size_t)));
-
-  int global_x = 0;
-  int global_y = 0;
-
-  if ( n % block_size_x == 0 ) {
-    global_x = n;
-  } else {
-    global_x = (n/block_size_x + 1)*block_size_x;
-  }
-
-  if ( m % block_size_y == 0 ) {
-    global_y = m;
-  } else {
-    global_y = (m/block_size_y + 1)*block_size_y;
-  }
-
-  global[0] = global_x;
-  global[1] = global_y;
-  local[0] = block_size_x;
-  local[1] = block_size_y;
-
-  DLOG(INFO) << "MNK   = ( " << m << " | " << n << " | " << k << " )";
-  DLOG(INFO) << "GSIZE = ( " << global[0] << " | " << global[1] << " )";
-  DLOG(INFO) << "LSIZE = ( " << local[0] << " | " << local[1] << " )";
-
-  err = clEnqueueNDRangeKernel(*queue, *kernel, numKernelDims, NULL,
-                                global, local, 0, NULL, event);
+  CL_SET_TYPE_KERNEL_ARG(size_t, stride_C, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bias_row, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bias_col, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, relu_flag, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, negative_slope, kernel)
+  CL_SET_LOCAL_KERNEL_ARG(local_size, kernel)
+  CL_SET_LOCAL_KERNEL_ARG(local_size, kernel)
+
+  // each work group computes a [tile x tile] tile of C.
+  size_t global[3];
+  size_t local[3];
+  local[0] = config.tile;
+  local[1] = config.tile / config.wpt;
+  local[2] = 1;
+  global[0] = getAlignedSize<T>(n, config.tile);
+  global[1] = getAlignedSize<T>(m, config.tile) / config.wpt;
+  global[2] = batch;
+
+  DLOG(INFO) << "MNK   = ( " << m << " | " << n << " | " << k << " ) x "
+             << batch;
+  DLOG(INFO) << "GSIZE = ( " << global[0] << " | " << global[1] << " | "
+             << global[2] << " )";
+  DLOG(INFO) << "LSIZE = ( " << local[0] << " | " << local[1] << " | "
+             << local[2] << " )";
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 3, NULL, global, local,
+                               CL_COMMAND_WAIT_LIST_EVENT(device, event));
   if ( err != CL_SUCCESS ) {
     std::ostringstream oss;
     oss << "Failed to enqueue kernel '"
@@ -2316,6 +2474,9 @@ bool cl_group_gemm(
     throw OpenCLSupportException(oss.str());
     return false;
   }
+  if ( event != NULL ) {
+    device.addCommandEvent(*event);
+  }
   DLOG(INFO) << "kernel '"
              << kernel_name.c_str()
              << "' executed on GPU "
@@ -2324,92 +2485,291 @@ bool cl_group_gemm(
   CL_SET_KERNEL_ARG_END
   return true;
 }
-template bool cl_group_gemm<float>(
+template bool clgemm_tiled<float>(
+    const OpenCLGemmConfig& config,
     const clblasTranspose TransA,
     const clblasTranspose TransB,
     const int m,
     const int n,
     const int k,
-    const int gm,
-    const int gn,
-    const int gk,
+    const int batch,
     const float alpha,
     const float* A,
     const size_t idx_offset_A,
+    const size_t stride_A,
     const float* B,
     const size_t idx_offset_B,
+    const size_t stride_B,
     const float beta,
     float* C,
     const size_t idx_offset_C,
+    const size_t stride_C,
+    const float* bias_row,
+    const float* bias_col,
+    const bool relu,
+    const float negative_slope,
     cl_event* event);
-template bool cl_group_gemm<double>(
+template bool clgemm_tiled<double>(
+    const OpenCLGemmConfig& config,
     const clblasTranspose TransA,
     const clblasTranspose TransB,
     const int m,
     const int n,
     const int k,
-    const int gm,
-    const int gn,
-    const int gk,
+    const int batch,
     const double alpha,
     const double* A,
     const size_t idx_offset_A,
+    const size_t stride_A,
     const double* B,
     const size_t idx_offset_B,
+    const size_t stride_B,
     const double beta,
     double* C,
     const size_t idx_offset_C,
+    const size_t stride_C,
+    const double* bias_row,
+    const double* bias_col,
+    const bool relu,
+    const double negative_slope,
     cl_event* event);
 
 template<typename T>
-bool cl_group_gemm_3D(
+bool clgemm_strided_batched(
     const clblasTranspose TransA,
     const clblasTranspose TransB,
     const int m,
     const int n,
     const int k,
-    const int g,
-    const int gm,
-    const int gn,
-    const int gk,
+    const int batch,
     const T alpha,
     const T* A,
     const size_t idx_offset_A,
+    const size_t stride_A,
     const T* B,
     const size_t idx_offset_B,
+    const size_t stride_B,
     const T beta,
     T* C,
     const size_t idx_offset_C,
+    const size_t stride_C,
+    const T* bias_row,
+    const T* bias_col,
+    const bool relu,
+    const T negative_slope,
     cl_event* event) {
-  if (gm != 1) {
-    LOG(ERROR) << "partition of M = "
-               << m
-               << " into GM = "
-               << gm
-               << " currently not supported";
-
-    return false;
+  OpenCLGemmConfig config;
+  if ( OpenCLGemmTuner::Lookup<T>(TransA, TransB, m, n, k, batch, &config) &&
+       config.tiled() ) {
+    return clgemm_tiled<T>(config, TransA, TransB, m, n, k, batch, alpha,
+                           A, idx_offset_A, stride_A, B, idx_offset_B,
+                           stride_B, beta, C, idx_offset_C, stride_C,
+                           bias_row, bias_col, relu, negative_slope,
+                           event);
   }
-  if ( gk != 1 ) {
-    LOG(ERROR) << "partition of K = "
-               << m
-               << " into GK = "
-               << gk
-               << " currently not supported";
 
-    return false;
-  }
-  if ( n % gn != 0 ) {
-    LOG(ERROR) << "partition of N = "
-               << n
-               << " into GN = "
-               << gn
-               << " must be even such that N % GN = 0 ";
+  std::tr1::shared_ptr<OpenCLPlatform> pf = OpenCLManager::CurrentPlatform();
+  OpenCLDevice& device = pf->CurrentDevice();
+  cl_command_queue* queue = device.getCurrentCommandQueue();
 
+  if ( !queue ) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
     return false;
   }
 
-  if (TransA != clblasNoTrans && TransB != clblasNoTrans) {
+  std::string kernel_name;
+  if (TransA == clblasNoTrans && TransB == clblasNoTrans) {
+    kernel_name = clGetKernelName<T>("mmul_batched_NA_NB");
+  }
+  if (TransA == clblasTrans && TransB == clblasTrans) {
+    kernel_name = clGetKernelName<T>("mmul_batched_TA_TB");
+  }
+  if (TransA == clblasTrans && TransB == clblasNoTrans) {
+    kernel_name = clGetKernelName<T>("mmul_batched_TA_NB");
+  }
+  if (TransA == clblasNoTrans && TransB == clblasTrans) {
+    kernel_name = clGetKernelName<T>("mmul_batched_NA_TB");
+  }
+  if ( kernel_name.size() == 0 ) {
+    LOG(ERROR) << "unsupported transpose mode for batched GEMM";
+    return false;
+  }
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if ( kernel == NULL ) {
+    return false;
+  }
+  const int relu_flag = relu ? 1 : 0;
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, m, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, k, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, alpha, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&A, kernel)
+  CL_SET_TYPE_KERNEL_ARG(size_t, idx_offset_A, kernel)
+  CL_SET_TYPE_KERNEL_ARG(size_t, stride_A, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&B, kernel)
+  CL_SET_TYPE_KERNEL_ARG(size_t, idx_offset_B, kernel)
+  CL_SET_TYPE_KERNEL_ARG(size_t, stride_B, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, beta, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&C, kernel)
+  CL_SET_TYPE_KERNEL_ARG(size_t, idx_offset_C, kernel)
+  CL_SET_TYPE_KERNEL_ARG(size_t, stride_C, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bias_row, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bias_col, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, relu_flag, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, negative_slope, kernel)
+
+  size_t global[3];
+  size_t local[3];
+  global[0] = getAlignedSize<T>(n, OPENCL_BLOCK_SIZE);
+  global[1] = getAlignedSize<T>(m, OPENCL_BLOCK_SIZE);
+  global[2] = batch;
+  local[0] = OPENCL_BLOCK_SIZE;
+  local[1] = OPENCL_BLOCK_SIZE;
+  local[2] = 1;
+
+  DLOG(INFO) << "MNK   = ( " << m << " | " << n << " | " << k << " ) x "
+             << batch;
+  DLOG(INFO) << "GSIZE = ( " << global[0] << " | " << global[1] << " | "
+             << global[2] << " )";
+  DLOG(INFO) << "LSIZE = ( " << local[0] << " | " << local[1] << " | "
+             << local[2] << " )";
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 3, NULL, global, local,
+                               CL_COMMAND_WAIT_LIST_EVENT(device, event));
+  if ( err != CL_SUCCESS ) {
+    std::ostringstream oss;
+    oss << "Failed to enqueue kernel '"
+        << kernel_name.c_str()
+        << "' on GPU "
+        << device.name()
+        << " : "
+        << what(err);
+
+    LOG(ERROR) << oss.str();
+    throw OpenCLSupportException(oss.str());
+    return false;
+  }
+  if ( event != NULL ) {
+    device.addCommandEvent(*event);
+  }
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
+  return true;
+}
+template bool clgemm_strided_batched<float>(
+    const clblasTranspose TransA,
+    const clblasTranspose TransB,
+    const int m,
+    const int n,
+    const int k,
+    const int batch,
+    const float alpha,
+    const float* A,
+    const size_t idx_offset_A,
+    const size_t stride_A,
+    const float* B,
+    const size_t idx_offset_B,
+    const size_t stride_B,
+    const float beta,
+    float* C,
+    const size_t idx_offset_C,
+    const size_t stride_C,
+    const float* bias_row,
+    const float* bias_col,
+    const bool relu,
+    const float negative_slope,
+    cl_event* event);
+template bool clgemm_strided_batched<double>(
+    const clblasTranspose TransA,
+    const clblasTranspose TransB,
+    const int m,
+    const int n,
+    const int k,
+    const int batch,
+    const double alpha,
+    const double* A,
+    const size_t idx_offset_A,
+    const size_t stride_A,
+    const double* B,
+    const size_t idx_offset_B,
+    const size_t stride_B,
+    const double beta,
+    double* C,
+    const size_t idx_offset_C,
+    const size_t stride_C,
+    const double* bias_row,
+    const double* bias_col,
+    const bool relu,
+    const double negative_slope,
+    cl_event* event);
+
+template<typename T>
+bool cl_group_gemm(
+    const clblasTranspose TransA,
+    const clblasTranspose TransB,
+    const int m,
+    const int n,
+    const int k,
+    const int gm,
+    const int gn,
+    const int gk,
+    const T alpha,
+    const T* A,
+    const size_t idx_offset_A,
+    const T* B,
+    const size_t idx_offset_B,
+    const T beta,
+    T* C,
+    const size_t idx_offset_C,
+    cl_event* event) {
+  if (gm != 1) {
+    LOG(ERROR) << "partition of M = "
+               << m
+               << " into GM = "
+               << gm
+               << " currently not supported";
+
+    return false;
+  }
+  if ( gk != 1 ) {
+    LOG(ERROR) << "partition of K = "
+               << m
+               << " into GK = "
+               << gk
+               << " currently not supported";
+
+    return false;
+  }
+  if ( n % gn != 0 ) {
+    LOG(ERROR) << "partition of N = "
+               << n
+               << " into GN = "
+               << gn
+               << " must be even such that N % GN = 0 ";
+
+    return false;
+  }
+
+  // the groups of N are a batch of GEMMs that share A, tuned shapes run
+  // the kernel chosen by the tuner.
+  OpenCLGemmConfig config;
+  if ( OpenCLGemmTuner::Lookup<T>(TransA, TransB, m, n / gn, k, gn,
+                                  &config) ) {
+    return clgemm_strided_batched<T>(TransA, TransB, m, n / gn, k, gn, alpha,
+                                     A, idx_offset_A, 0,
+                                     B, idx_offset_B, k * (n / gn), beta,
+                                     C, idx_offset_C, m * (n / gn),
+                                     NULL, NULL, false, 0, event);
+  }
+
+  if (TransA != clblasNoTrans && TransB != clblasNoTrans) {
     LOG(WARNING) << "TransA != clblasNoTrans and "
                     "TransB != clblasNoTrans not fully tested";
   }
@@ -2425,28 +2785,27 @@ bool cl_group_gemm_3D(
 
   int block_size_x;
   int block_size_y;
-  int block_size_z;
-
   std::string kernel_name;
-  int numKernelDims = 3;
+  int numKernelDims = 0;
 
   if (TransA == clblasNoTrans && TransB == clblasNoTrans) {
-    kernel_name = clGetKernelName<T>("group_3D_mmul_NA_NB");
+    kernel_name = clGetKernelName<T>("group_mmul_NA_NB");
   }
   if (TransA == clblasTrans && TransB == clblasTrans) {
-    kernel_name = clGetKernelName<T>("group_3D_mmul_TA_TB");
+    kernel_name = clGetKernelName<T>("group_mmul_TA_TB");
   }
   if (TransA == clblasTrans && TransB == clblasNoTrans) {
-    kernel_name = clGetKernelName<T>("group_3D_mmul_TA_NB");
+    kernel_name = clGetKernelName<T>("group_mmul_TA_NB");
   }
   if (TransA == clblasNoTrans && TransB == clblasTrans) {
-    kernel_name = clGetKernelName<T>("group_3D_mmul_NA_TB");
+    kernel_name = clGetKernelName<T>("group_mmul_NA_TB");
   }
 
   DLOG(INFO) << "kernel = " << kernel_name;
 
   block_size_x = OPENCL_BLOCK_SIZE;
   block_size_y = OPENCL_BLOCK_SIZE;
+  numKernelDims = 2;
 
   cl_kernel* kernel = device.getKernel(kernel_name);
   if (kernel == NULL) {
@@ -2457,7 +2816,6 @@ bool cl_group_gemm_3D(
   CL_SET_TYPE_KERNEL_ARG(int, m, kernel)
   CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
   CL_SET_TYPE_KERNEL_ARG(int, k, kernel)
-  CL_SET_TYPE_KERNEL_ARG(int, g, kernel)
   CL_SET_TYPE_KERNEL_ARG(int, gm, kernel)
   CL_SET_TYPE_KERNEL_ARG(int, gn, kernel)
   CL_SET_TYPE_KERNEL_ARG(int, gk, kernel)
@@ -2477,7 +2835,6 @@ bool cl_group_gemm_3D(
 
   int global_x = 0;
   int global_y = 0;
-  int global_z = g;
 
   if ( n % block_size_x == 0 ) {
     global_x = n;
@@ -2493,18 +2850,16 @@ bool cl_group_gemm_3D(
 
   global[0] = global_x;
   global[1] = global_y;
-  global[2] = g;
-
   local[0] = block_size_x;
   local[1] = block_size_y;
-  local[2] = 1;
 
-  DLOG(INFO) << "MNKG  = ( " << m << " | " << n << " | " << k << " | " << g << " )";
-  DLOG(INFO) << "GSIZE = ( " << global[0] << " | " << global[1] << " | " << global[2] << " )";
-  DLOG(INFO) << "LSIZE = ( " << local[0] << " | " << local[1] << " | " << local[2] << " )";
+  DLOG(INFO) << "MNK   = ( " << m << " | " << n << " | " << k << " )";
+  DLOG(INFO) << "GSIZE = ( " << global[0] << " | " << global[1] << " )";
+  DLOG(INFO) << "LSIZE = ( " << local[0] << " | " << local[1] << " )";
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, numKernelDims, NULL,
-                                global, local, 0, NULL, event);
+                                global, local,
+                                CL_COMMAND_WAIT_LIST_EVENT(device, event));
   if ( err != CL_SUCCESS ) {
     std::ostringstream oss;
     oss << "Failed to enqueue kernel '"
@@ -2518,6 +2873,9 @@ bool cl_group_gemm_3D(
     throw OpenCLSupportException(oss.str());
     return false;
   }
+  if ( event != NULL ) {
+    device.addCommandEvent(*event);
+  }
   DLOG(INFO) << "kernel '"
              << kernel_name.c_str()
              << "' executed on GPU "
@@ -2526,13 +2884,12 @@ bool cl_group_gemm_3D(
   CL_SET_KERNEL_ARG_END
   return true;
 }
-template bool cl_group_gemm_3D<float>(
+template bool cl_group_gemm<float>(
     const clblasTranspose TransA,
     const clblasTranspose TransB,
     const int m,
     const int n,
     const int k,
-    const int g,
     const int gm,
     const int gn,
     const int gk,
@@ -2545,13 +2902,12 @@ template bool cl_group_gemm_3D<float>(
     float* C,
     const size_t idx_offset_C,
     cl_event* event);
-template bool cl_group_gemm_3D<double>(
+template bool cl_group_gemm<double>(
     const clblasTranspose TransA,
     const clblasTranspose TransB,
     const int m,
     const int n,
     const int k,
-    const int g,
     const int gm,
     const int gn,
     const int gk,
@@ -2565,74 +2921,282 @@ template bool cl_group_gemm_3D<double>(
     const size_t idx_offset_C,
     cl_event* event);
 
-
 template<typename T>
-bool clBLASgemm(
+bool cl_group_gemm_3D(
     const clblasTranspose TransA,
     const clblasTranspose TransB,
     const int m,
     const int n,
     const int k,
+    const int g,
+    const int gm,
+    const int gn,
+    const int gk,
     const T alpha,
     const T* A,
-    const T* x,
+    const size_t idx_offset_A,
+    const T* B,
+    const size_t idx_offset_B,
     const T beta,
-    T* y,
+    T* C,
+    const size_t idx_offset_C,
     cl_event* event) {
-  std::tr1::shared_ptr<OpenCLPlatform> pf = OpenCLManager::CurrentPlatform();
-  OpenCLDevice& device = pf->CurrentDevice();
+  if (gm != 1) {
+    LOG(ERROR) << "partition of M = "
+               << m
+               << " into GM = "
+               << gm
+               << " currently not supported";
 
-  cl_command_queue* queue = device.getCurrentCommandQueue();
-  if (!queue) {
-    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
     return false;
   }
+  if ( gk != 1 ) {
+    LOG(ERROR) << "partition of K = "
+               << m
+               << " into GK = "
+               << gk
+               << " currently not supported";
 
-  void* A_base = clGetMemoryBase(A);
-  if (!A_base) {
-    LOG(ERROR) << "failed to get OpenCL device memory address"
-                  " for virtual address @ " << A;
     return false;
   }
-  const void* A_device = NULL;
-  if (!clMakeLogical(A_base, &A_device)) {
+  if ( n % gn != 0 ) {
+    LOG(ERROR) << "partition of N = "
+               << n
+               << " into GN = "
+               << gn
+               << " must be even such that N % GN = 0 ";
+
     return false;
   }
-  size_t A_offset = clGetMemoryOffset(A);
-  if (A_offset < 0) {
-    LOG(ERROR) << "failed to get OpenCL device memory offset"
-                  " for virtual address @ " << A;
-    return false;
+
+  if (TransA != clblasNoTrans && TransB != clblasNoTrans) {
+    LOG(WARNING) << "TransA != clblasNoTrans and "
+                    "TransB != clblasNoTrans not fully tested";
   }
-  A_offset /= sizeof(T);
-  DLOG(INFO) << A
-             << " -> "
-             << A_base
-             << " with offset = "
-             << A_offset
-             << " on "
-             << A_device;
 
-  void* x_base = clGetMemoryBase(x);
-  if (!x_base) {
-    LOG(ERROR) << "failed to get OpenCL device memory address"
-                  " for virtual address @ " << x;
+  std::tr1::shared_ptr<OpenCLPlatform> pf = OpenCLManager::CurrentPlatform();
+  OpenCLDevice& device = pf->CurrentDevice();
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+
+  if ( !queue ) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
     return false;
   }
 
-  const void* x_device = NULL;
-  if (!clMakeLogical(x_base, &x_device)) {
-    return false;
+  int block_size_x;
+  int block_size_y;
+  int block_size_z;
+
+  std::string kernel_name;
+  int numKernelDims = 3;
+
+  if (TransA == clblasNoTrans && TransB == clblasNoTrans) {
+    kernel_name = clGetKernelName<T>("group_3D_mmul_NA_NB");
   }
-  size_t x_offset = clGetMemoryOffset(x);
-  if (x_offset < 0) {
-    LOG(ERROR) << "failed to get OpenCL device memory offset"
-                  " for virtual address @ " << x;
-    return false;
+  if (TransA == clblasTrans && TransB == clblasTrans) {
+    kernel_name = clGetKernelName<T>("group_3D_mmul_TA_TB");
   }
-  x_offset /= sizeof(T);
-  DLOG(INFO) << x
-             << " -> "
+  if (TransA == clblasTrans && TransB == clblasNoTrans) {
+    kernel_name = clGetKernelName<T>("group_3D_mmul_TA_NB");
+  }
+  if (TransA == clblasNoTrans && TransB == clblasTrans) {
+    kernel_name = clGetKernelName<T>("group_3D_mmul_NA_TB");
+  }
+
+  DLOG(INFO) << "kernel = " << kernel_name;
+
+  block_size_x = OPENCL_BLOCK_SIZE;
+  block_size_y = OPENCL_BLOCK_SIZE;
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, m, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, k, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, g, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, gm, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, gn, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, gk, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, alpha, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&A, kernel)
+  CL_SET_TYPE_KERNEL_ARG(size_t, idx_offset_A, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&B, kernel)
+  CL_SET_TYPE_KERNEL_ARG(size_t, idx_offset_B, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, beta, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&C, kernel)
+  CL_SET_TYPE_KERNEL_ARG(size_t, idx_offset_C, kernel)
+
+  size_t* global  = reinterpret_cast<size_t*>(
+                      malloc(numKernelDims*sizeof(size_t)));
+  size_t* local   = reinterpret_cast<size_t*>(
+                      malloc(numKernelDims*sizeof(size_t)));
+
+  int global_x = 0;
+  int global_y = 0;
+  int global_z = g;
+
+  if ( n % block_size_x == 0 ) {
+    global_x = n;
+  } else {
+    global_x = (n/block_size_x + 1)*block_size_x;
+  }
+
+  if ( m % block_size_y == 0 ) {
+    global_y = m;
+  } else {
+    global_y = (m/block_size_y + 1)*block_size_y;
+  }
+
+  global[0] = global_x;
+  global[1] = global_y;
+  global[2] = g;
+
+  local[0] = block_size_x;
+  local[1] = block_size_y;
+  local[2] = 1;
+
+  DLOG(INFO) << "MNKG  = ( " << m << " | " << n << " | " << k << " | " << g << " )";
+  DLOG(INFO) << "GSIZE = ( " << global[0] << " | " << global[1] << " | " << global[2] << " )";
+  DLOG(INFO) << "LSIZE = ( " << local[0] << " | " << local[1] << " | " << local[2] << " )";
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, numKernelDims, NULL,
+                                global, local,
+                                CL_COMMAND_WAIT_LIST_EVENT(device, event));
+  if ( err != CL_SUCCESS ) {
+    std::ostringstream oss;
+    oss << "Failed to enqueue kernel '"
+        << kernel_name.c_str()
+        << "' on GPU "
+        << device.name()
+        << " : "
+        << what(err);
+
+    LOG(ERROR) << oss.str();
+    throw OpenCLSupportException(oss.str());
+    return false;
+  }
+  if ( event != NULL ) {
+    device.addCommandEvent(*event);
+  }
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
+  return true;
+}
+template bool cl_group_gemm_3D<float>(
+    const clblasTranspose TransA,
+    const clblasTranspose TransB,
+    const int m,
+    const int n,
+    const int k,
+    const int g,
+    const int gm,
+    const int gn,
+    const int gk,
+    const float alpha,
+    const float* A,
+    const size_t idx_offset_A,
+    const float* B,
+    const size_t idx_offset_B,
+    const float beta,
+    float* C,
+    const size_t idx_offset_C,
+    cl_event* event);
+template bool cl_group_gemm_3D<double>(
+    const clblasTranspose TransA,
+    const clblasTranspose TransB,
+    const int m,
+    const int n,
+    const int k,
+    const int g,
+    const int gm,
+    const int gn,
+    const int gk,
+    const double alpha,
+    const double* A,
+    const size_t idx_offset_A,
+    const double* B,
+    const size_t idx_offset_B,
+    const double beta,
+    double* C,
+    const size_t idx_offset_C,
+    cl_event* event);
+
+
+template<typename T>
+bool clBLASgemm(
+    const clblasTranspose TransA,
+    const clblasTranspose TransB,
+    const int m,
+    const int n,
+    const int k,
+    const T alpha,
+    const T* A,
+    const T* x,
+    const T beta,
+    T* y,
+    cl_event* event) {
+  std::tr1::shared_ptr<OpenCLPlatform> pf = OpenCLManager::CurrentPlatform();
+  OpenCLDevice& device = pf->CurrentDevice();
+
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  void* A_base = clGetMemoryBase(A);
+  if (!A_base) {
+    LOG(ERROR) << "failed to get OpenCL device memory address"
+                  " for virtual address @ " << A;
+    return false;
+  }
+  const void* A_device = NULL;
+  if (!clMakeLogical(A_base, &A_device)) {
+    return false;
+  }
+  size_t A_offset = clGetMemoryOffset(A);
+  if (A_offset < 0) {
+    LOG(ERROR) << "failed to get OpenCL device memory offset"
+                  " for virtual address @ " << A;
+    return false;
+  }
+  A_offset /= sizeof(T);
+  DLOG(INFO) << A
+             << " -> "
+             << A_base
+             << " with offset = "
+             << A_offset
+             << " on "
+             << A_device;
+
+  void* x_base = clGetMemoryBase(x);
+  if (!x_base) {
+    LOG(ERROR) << "failed to get OpenCL device memory address"
+                  " for virtual address @ " << x;
+    return false;
+  }
+
+  const void* x_device = NULL;
+  if (!clMakeLogical(x_base, &x_device)) {
+    return false;
+  }
+  size_t x_offset = clGetMemoryOffset(x);
+  if (x_offset < 0) {
+    LOG(ERROR) << "failed to get OpenCL device memory offset"
+                  " for virtual address @ " << x;
+    return false;
+  }
+  x_offset /= sizeof(T);
+  DLOG(INFO) << x
+             << " -> "
              << x_base
              << " with offset = "
              << x_offset
@@ -2680,10 +3244,14 @@ bool clBLASgemm(
                               (cl_mem) x_device, x_offset, ldb,
                               beta,
                               (cl_mem) y_device, y_offset, ldc,
-                              1, queue, 0, NULL, event))) {
+                              1, queue,
+                              CL_COMMAND_WAIT_LIST_EVENT(device, event)))) {
       LOG(ERROR) << "clblasSgemm() failed on GPU " << device.name();
       return false;
     }
+    if ( event != NULL ) {
+      device.addCommandEvent(*event);
+    }
     DLOG(INFO) << "clblasSgemm() succeeded on GPU " << device.name();
   }
 
@@ -2693,10 +3261,14 @@ bool clBLASgemm(
                               (cl_mem) x_device, x_offset, ldb,
                               beta,
                               (cl_mem) y_device, y_offset, ldc,
-                              1, queue, 0, NULL, event))) {
+                              1, queue,
+                              CL_COMMAND_WAIT_LIST_EVENT(device, event)))) {
       LOG(ERROR) << "clblasDgemm() failed on GPU " << device.name();
       return false;
     }
+    if ( event != NULL ) {
+      device.addCommandEvent(*event);
+    }
     DLOG(INFO) << "clblasDgemm() succeeded on GPU " << device.name();
   }
   return true;
@@ -2832,10 +3404,14 @@ bool clBLASgemm(
                               (cl_mem) x_logical, idx_offset_x, ldb,
                               beta,
                               (cl_mem) y_logical, idx_offset_y, ldc,
-                              1, queue, 0, NULL, event))) {
+                              1, queue,
+                              CL_COMMAND_WAIT_LIST_EVENT(device, event)))) {
       LOG(ERROR) << "clblasSgemm() failed on GPU " << device.name();
       return false;
     }
+    if ( event != NULL ) {
+      device.addCommandEvent(*event);
+    }
     DLOG(INFO) << "clblasSgemm() succeeded on GPU " << device.name();
   }
 
@@ -2845,10 +3421,14 @@ bool clBLASgemm(
                               (cl_mem) x_logical, idx_offset_x, ldb,
                               beta,
                               (cl_mem) y_logical, idx_offset_y, ldc,
-                              1, queue, 0, NULL, event))) {
+                              1, queue,
+                              CL_COMMAND_WAIT_LIST_EVENT(device, event)))) {
       LOG(ERROR) << "clblasDgemm() failed on GPU " << device.name();
       return false;
     }
+    if ( event != NULL ) {
+      device.addCommandEvent(*event);
+    }
     DLOG(INFO) << "clblasDgemm() succeeded on GPU " << device.name();
   }
 
@@ -2954,10 +3534,14 @@ bool clBLASgemm(
                               beta,
                               (cl_mem) y_logical, idx_offset_y, ldy,
                               1,
-                              queue, 0, NULL, event))) {
+                              queue,
+                              CL_COMMAND_WAIT_LIST_EVENT(device, event)))) {
       LOG(ERROR) << "clblasSgemm() failed on GPU " << device.name();
       return false;
     }
+    if ( event != NULL ) {
+      device.addCommandEvent(*event);
+    }
     DLOG(INFO) << "clblasSgemm() succeeded on GPU " << device.name();
   }
 
@@ -2968,10 +3552,14 @@ bool clBLASgemm(
                               beta,
                               (cl_mem) y_logical, idx_offset_y, ldy,
                               1,
-                              queue, 0, NULL, event))) {
+                              queue,
+                              CL_COMMAND_WAIT_LIST_EVENT(device, event)))) {
       LOG(ERROR) << "clblasDgemm() failed on GPU " << device.name();
       return false;
     }
+    if ( event != NULL ) {
+      device.addCommandEvent(*event);
+    }
     DLOG(INFO) << "clblasDgemm() succeeded on GPU " << device.name();
   }
 
@@ -3093,7 +3681,7 @@ bool clBLASaxpy(
                               (cl_mem) X_device, X_offset, incr_x,
                               (cl_mem) Y_device, Y_offset, incr_y,
                               1,
-                              queue, 0, NULL, NULL))) {
+                              queue, CL_COMMAND_WAIT_LIST(device)))) {
       LOG(ERROR) << "clblasSaxpy() failed on GPU " << device.name();
       return false;
     }
@@ -3105,7 +3693,7 @@ bool clBLASaxpy(
                               (cl_mem) X_device, X_offset, incr_x,
                               (cl_mem) Y_device, Y_offset, incr_y,
                               1,
-                              queue, 0, NULL, NULL))) {
+                              queue, CL_COMMAND_WAIT_LIST(device)))) {
       LOG(ERROR) << "clblasDaxpy() failed on GPU " << device.name();
       return false;
     }
@@ -3134,6 +3722,12 @@ bool clIsVirtualMemory(const void* p) {
 }
 
 bool clMakeLogical(const void* ptr_virtual, const void** ptr_logical) {
+  // the memory is about to be used on the command queue.
+  if (clIsVirtualMemory(ptr_virtual)
+      && !clEnqueueWaitForTransfer(ptr_virtual)) {
+    return false;
+  }
+
   if (mapMemoryToDevice.find(ptr_virtual) != mapMemoryToDevice.end()) {
     *ptr_logical = mapMemoryToDevice[ptr_virtual];
     return true;
@@ -3188,6 +3782,10 @@ bool clMakeLogical2(
   }
   *ptr_logical = clMem->getLogicalPointer();
 
+  if (!clEnqueueWaitForTransfer(ptr_virtual)) {
+    return false;
+  }
+
   if (clIsVirtualMemory(*ptr_logical)) {
     LOG(ERROR) << "failed to convert VM@"
                << ptr_virtual
@@ -3356,14 +3954,440 @@ bool clGetMemoryObject(const void* ptr_virtual, OpenCLMemory** clMem) {
 }
 
 template<typename T>
-bool clsub(
+bool clsub(
+    const int n,
+    const T* array_GPU_x,
+    const T* array_GPU_y,
+    T* array_GPU_z) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+  std::string kernel_name = clGetKernelName<T>("clsub");
+
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_x, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_y, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_z, kernel)
+
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clsub<float>(
+    const int n,
+    const float* array_GPU_x,
+    const float* array_GPU_y,
+    float* array_GPU_z);
+template bool clsub<double>(
+    const int n,
+    const double* array_GPU_x,
+    const double* array_GPU_y,
+    double* array_GPU_z);
+
+template<typename T>
+bool cladd(
+    const int n,
+    const T* array_GPU_x,
+    const T* array_GPU_y,
+    T* array_GPU_z) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+  std::string kernel_name = clGetKernelName<T>("cladd");
+
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_x, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_y, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_z, kernel)
+
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool cladd<float>(
+    const int n,
+    const float* array_GPU_x,
+    const float* array_GPU_y,
+    float* array_GPU_z);
+template bool cladd<double>(
+    const int n,
+    const double* array_GPU_x,
+    const double* array_GPU_y,
+    double* array_GPU_z);
+
+template<typename T>
+bool cladd_scalar(const int N, const T alpha, T* Y) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+  std::string kernel_name = clGetKernelName<T>("cladd_scalar");
+
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, N, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, alpha, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&Y, kernel)
+
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(N, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(N, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool cladd_scalar<float>(const int N, const float alpha, float* Y);
+template bool cladd_scalar<double>(const int N, const double alpha, double* Y);
+
+template<typename T>
+bool clpowx(const int n, const T* array_GPU_x, const T alpha, T* array_GPU_z) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+  std::string kernel_name = clGetKernelName<T>("clpowx");
+
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_x, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, alpha, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_z, kernel)
+
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clpowx<float>(
+    const int n,
+    const float* array_GPU_x,
+    const float alpha,
+    float* array_GPU_z);
+template bool clpowx<double>(
+    const int n,
+    const double* array_GPU_x,
+    const double alpha,
+    double* array_GPU_z);
+
+template<typename T>
+bool clexp(const int n, const T* array_GPU_x, T* array_GPU_y) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+  std::string kernel_name = clGetKernelName<T>("clexp");
+
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_x, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_y, kernel)
+
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clexp<float>(
+    const int n,
+    const float* array_GPU_x,
+    float* array_GPU_z);
+template bool clexp<double>(
+    const int n,
+    const double* array_GPU_x,
+    double* array_GPU_z);
+
+template<typename T>
+bool cladd_bias(
+    const int count,
+    const int channels,
+    const int spatial_dim,
+    const T* bias,
+    T* y) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+  std::string kernel_name = clGetKernelName<T>("cladd_bias");
+
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, count, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, channels, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, spatial_dim, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bias, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&y, kernel)
+
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(count, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool cladd_bias<float>(
+    const int count,
+    const int channels,
+    const int spatial_dim,
+    const float* bias,
+    float* y);
+template bool cladd_bias<double>(
+    const int count,
+    const int channels,
+    const int spatial_dim,
+    const double* bias,
+    double* y);
+
+template<typename T>
+bool clchannel_sum(
+    const int num,
+    const int channels,
+    const int spatial_dim,
+    const T* x,
+    T* y) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+  std::string kernel_name = clGetKernelName<T>("clchannel_sum");
+
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, num, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, channels, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, spatial_dim, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&x, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&y, kernel)
+
+  // a work group per channel reduces its num * spatial_dim elements.
+  size_t global = channels * OPENCL_LOCAL_SIZE;
+  size_t local = OPENCL_LOCAL_SIZE;
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
+    return false;
+  }
+
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clchannel_sum<float>(
+    const int num,
+    const int channels,
+    const int spatial_dim,
+    const float* x,
+    float* y);
+template bool clchannel_sum<double>(
+    const int num,
+    const int channels,
+    const int spatial_dim,
+    const double* x,
+    double* y);
+
+// launches clreduce_dot with groups work groups, see math_functions.cl. The
+// kernel's event goes to event unless NULL.
+template<typename T>
+static bool clreduce_dot_groups(
     const int n,
-    const T* array_GPU_x,
-    const T* array_GPU_y,
-    T* array_GPU_z) {
+    const T* x,
+    const T* y,
+    const bool absolute,
+    const T scale,
+    T* out,
+    const int out_idx,
+    const int groups,
+    cl_event* event) {
   OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
 
-  std::string kernel_name = clGetKernelName<T>("clsub");
+  std::string kernel_name = clGetKernelName<T>("clreduce_dot");
 
   cl_command_queue* queue = device.getCurrentCommandQueue();
   if (!queue) {
@@ -3376,17 +4400,22 @@ bool clsub(
     return false;
   }
 
+  const int abs_flag = absolute ? 1 : 0;
+
   CL_SET_KERNEL_ARG
   CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_x, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_y, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_z, kernel)
-
-  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
-  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
-
-  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local, 0,
-  NULL, NULL);
+  CL_SET_ARRAY_KERNEL_ARG(&x, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&y, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, abs_flag, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, scale, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&out, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, out_idx, kernel)
+
+  size_t global = groups * OPENCL_LOCAL_SIZE;
+  size_t local = OPENCL_LOCAL_SIZE;
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST_EVENT(device, event));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -3396,6 +4425,9 @@ bool clsub(
                << caffe::OpenCL::what(err);
     return false;
   }
+  if ( event != NULL ) {
+    device.addCommandEvent(*event);
+  }
 
   DLOG(INFO) << "kernel '"
              << kernel_name.c_str()
@@ -3406,26 +4438,133 @@ bool clsub(
 
   return true;
 }
-template bool clsub<float>(
+
+template<typename T>
+bool clreduce_dot(
     const int n,
-    const float* array_GPU_x,
-    const float* array_GPU_y,
-    float* array_GPU_z);
-template bool clsub<double>(
+    const T* x,
+    const T* y,
+    const bool absolute,
+    const T scale,
+    T* out,
+    const int out_idx) {
+  const int items = OPENCL_LOCAL_SIZE * OPENCL_REDUCE_ITEMS;
+  const int groups = std::max(1, std::min(OPENCL_REDUCE_GROUPS,
+                                          (n + items - 1) / items));
+  if (groups == 1) {
+    return clreduce_dot_groups<T>(n, x, y, absolute, scale, out, out_idx, 1,
+                                  NULL);
+  }
+
+  // the partial results of the first pass go to a buffer of the device's
+  // cache, so repeated reductions do not allocate.
+  void* partial;
+  if (!clGetBuffer(&partial, groups * sizeof(T))) {
+    LOG(ERROR) << "failed to get reduction buffer";
+    return false;
+  }
+  T* partial_data = static_cast<T*>(partial);
+  cl_event event = NULL;
+  bool ok = clreduce_dot_groups<T>(n, x, y, absolute, T(1), partial_data, 0,
+                                   groups, NULL)
+      && clreduce_dot_groups<T>(groups, partial_data, static_cast<T*>(NULL),
+                                false, scale, out, out_idx, 1, &event);
+  // the buffer goes back to the cache only once the second pass read it,
+  // other queues may get it from there right away.
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+  OpenCLMemory* clMem;
+  if ( event != NULL && device.get(partial, &clMem) ) {
+    clMem->setEvent(event);
+  } else if ( event != NULL ) {
+    CL_CHECK(clWaitForEvents(1, &event));
+    clReleaseEvent(event);
+  }
+  clBufferSetAvailable(partial, groups * sizeof(T));
+  return ok;
+}
+template bool clreduce_dot<float>(
     const int n,
-    const double* array_GPU_x,
-    const double* array_GPU_y,
-    double* array_GPU_z);
+    const float* x,
+    const float* y,
+    const bool absolute,
+    const float scale,
+    float* out,
+    const int out_idx);
+template bool clreduce_dot<double>(
+    const int n,
+    const double* x,
+    const double* y,
+    const bool absolute,
+    const double scale,
+    double* out,
+    const int out_idx);
 
+// reduces into a device scalar of the cache and reads it back.
 template<typename T>
-bool cladd(
+static bool clreduce_dot_host(
     const int n,
-    const T* array_GPU_x,
-    const T* array_GPU_y,
-    T* array_GPU_z) {
+    const T* x,
+    const T* y,
+    const bool absolute,
+    T* out) {
+  void* result;
+  if (!clGetBuffer(&result, sizeof(T))) {
+    LOG(ERROR) << "failed to get reduction buffer";
+    return false;
+  }
+  bool ok = clreduce_dot<T>(n, x, y, absolute, T(1),
+                            static_cast<T*>(result), 0)
+      && clMemcpy(out, result, sizeof(T), COPY_GPU_TO_CPU);
+  clBufferSetAvailable(result, sizeof(T));
+  return ok;
+}
+
+template<typename T>
+bool clasum(const int n, const T* x, T* out) {
+  return clreduce_dot_host<T>(n, x, static_cast<T*>(NULL), true, out);
+}
+template bool clasum<float>(const int n, const float* x, float* out);
+template bool clasum<double>(const int n, const double* x, double* out);
+
+template<typename T>
+bool cldot(const int n, const T* x, const T* y, T* out) {
+  return clreduce_dot_host<T>(n, x, y, false, out);
+}
+template bool cldot<float>(
+    const int n,
+    const float* x,
+    const float* y,
+    float* out);
+template bool cldot<double>(
+    const int n,
+    const double* x,
+    const double* y,
+    double* out);
+
+void clrows_work_items(const int rows, const int len, int* group_per_row,
+                       size_t* global, size_t* local) {
+  *group_per_row = len >= OPENCL_LOCAL_SIZE ? 1 : 0;
+  if (*group_per_row) {
+    *global = rows * OPENCL_LOCAL_SIZE;
+    *local = OPENCL_LOCAL_SIZE;
+  } else {
+    *global = CAFFE_GET_GLOBAL_WORKITEMS(rows, OPENCL_LOCAL_SIZE);
+    *local = CAFFE_GET_LOCAL_WORKITEMS(rows, OPENCL_LOCAL_SIZE);
+  }
+}
+
+template<typename T>
+bool clrows_sum(
+    const int rows,
+    const int len,
+    const int inner,
+    const T* x,
+    const T* y,
+    const T scale,
+    T* out) {
   OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
 
-  std::string kernel_name = clGetKernelName<T>("cladd");
+  std::string kernel_name = clGetKernelName<T>("clrows_sum");
 
   cl_command_queue* queue = device.getCurrentCommandQueue();
   if (!queue) {
@@ -3438,17 +4577,23 @@ bool cladd(
     return false;
   }
 
-  CL_SET_KERNEL_ARG
-  CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_x, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_y, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_z, kernel)
-
-  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
-  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+  int group_per_row;
+  size_t global;
+  size_t local;
+  clrows_work_items(rows, len, &group_per_row, &global, &local);
 
-  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local, 0,
-  NULL, NULL);
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, rows, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, len, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, inner, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, group_per_row, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&x, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&y, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, scale, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&out, kernel)
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -3468,22 +4613,33 @@ bool cladd(
 
   return true;
 }
-template bool cladd<float>(
-    const int n,
-    const float* array_GPU_x,
-    const float* array_GPU_y,
-    float* array_GPU_z);
-template bool cladd<double>(
-    const int n,
-    const double* array_GPU_x,
-    const double* array_GPU_y,
-    double* array_GPU_z);
+template bool clrows_sum<float>(
+    const int rows,
+    const int len,
+    const int inner,
+    const float* x,
+    const float* y,
+    const float scale,
+    float* out);
+template bool clrows_sum<double>(
+    const int rows,
+    const int len,
+    const int inner,
+    const double* x,
+    const double* y,
+    const double scale,
+    double* out);
 
 template<typename T>
-bool cladd_scalar(const int N, const T alpha, T* Y) {
+bool clrows_max(
+    const int rows,
+    const int len,
+    const int inner,
+    const T* x,
+    T* out) {
   OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
 
-  std::string kernel_name = clGetKernelName<T>("cladd_scalar");
+  std::string kernel_name = clGetKernelName<T>("clrows_max");
 
   cl_command_queue* queue = device.getCurrentCommandQueue();
   if (!queue) {
@@ -3496,16 +4652,21 @@ bool cladd_scalar(const int N, const T alpha, T* Y) {
     return false;
   }
 
-  CL_SET_KERNEL_ARG
-  CL_SET_TYPE_KERNEL_ARG(int, N, kernel)
-  CL_SET_TYPE_KERNEL_ARG(T, alpha, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&Y, kernel)
+  int group_per_row;
+  size_t global;
+  size_t local;
+  clrows_work_items(rows, len, &group_per_row, &global, &local);
 
-  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(N, OPENCL_LOCAL_SIZE);
-  size_t local = CAFFE_GET_LOCAL_WORKITEMS(N, OPENCL_LOCAL_SIZE);
-
-  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local, 0,
-  NULL, NULL);
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, rows, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, len, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, inner, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, group_per_row, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&x, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&out, kernel)
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -3525,14 +4686,31 @@ bool cladd_scalar(const int N, const T alpha, T* Y) {
 
   return true;
 }
-template bool cladd_scalar<float>(const int N, const float alpha, float* Y);
-template bool cladd_scalar<double>(const int N, const double alpha, double* Y);
+template bool clrows_max<float>(
+    const int rows,
+    const int len,
+    const int inner,
+    const float* x,
+    float* out);
+template bool clrows_max<double>(
+    const int rows,
+    const int len,
+    const int inner,
+    const double* x,
+    double* out);
 
 template<typename T>
-bool clpowx(const int n, const T* array_GPU_x, const T alpha, T* array_GPU_z) {
+bool cldot_device(
+    const int n,
+    const T* x,
+    const T* y,
+    const T* d,
+    const T scale,
+    T* out,
+    const int out_idx) {
   OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
 
-  std::string kernel_name = clGetKernelName<T>("clpowx");
+  std::string kernel_name = clGetKernelName<T>("cldot_device");
 
   cl_command_queue* queue = device.getCurrentCommandQueue();
   if (!queue) {
@@ -3547,15 +4725,19 @@ bool clpowx(const int n, const T* array_GPU_x, const T alpha, T* array_GPU_z) {
 
   CL_SET_KERNEL_ARG
   CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_x, kernel)
-  CL_SET_TYPE_KERNEL_ARG(T, alpha, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_z, kernel)
-
-  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
-  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
-
-  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local, 0,
-  NULL, NULL);
+  CL_SET_ARRAY_KERNEL_ARG(&x, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&y, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&d, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, scale, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&out, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, out_idx, kernel)
+
+  // a single work group, the result stays on the device.
+  size_t global = OPENCL_LOCAL_SIZE;
+  size_t local = OPENCL_LOCAL_SIZE;
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -3575,22 +4757,38 @@ bool clpowx(const int n, const T* array_GPU_x, const T alpha, T* array_GPU_z) {
 
   return true;
 }
-template bool clpowx<float>(
+template bool cldot_device<float>(
     const int n,
-    const float* array_GPU_x,
-    const float alpha,
-    float* array_GPU_z);
-template bool clpowx<double>(
+    const float* x,
+    const float* y,
+    const float* d,
+    const float scale,
+    float* out,
+    const int out_idx);
+template bool cldot_device<double>(
     const int n,
-    const double* array_GPU_x,
-    const double alpha,
-    double* array_GPU_z);
+    const double* x,
+    const double* y,
+    const double* d,
+    const double scale,
+    double* out,
+    const int out_idx);
+
+// the Philox key and the first of calls reserved counters, see random.cl.
+static void clrng_key_counter(const size_t calls, cl_uint* key0,
+                              cl_uint* key1, cl_uint* ctr0, cl_uint* ctr1) {
+  uint64_t key = Caffe::philox_key();
+  uint64_t counter = Caffe::philox_counter(calls);
+  *key0 = static_cast<cl_uint>(key);
+  *key1 = static_cast<cl_uint>(key >> 32);
+  *ctr0 = static_cast<cl_uint>(counter);
+  *ctr1 = static_cast<cl_uint>(counter >> 32);
+}
 
-template<typename T>
-bool clexp(const int n, const T* array_GPU_x, T* array_GPU_y) {
+bool cl_caffe_gpu_rng_uniform(const int n, unsigned int* r) {
   OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
 
-  std::string kernel_name = clGetKernelName<T>("clexp");
+  std::string kernel_name = "clrng_uint";
 
   cl_command_queue* queue = device.getCurrentCommandQueue();
   if (!queue) {
@@ -3603,16 +4801,24 @@ bool clexp(const int n, const T* array_GPU_x, T* array_GPU_y) {
     return false;
   }
 
+  // 4 numbers per Philox call.
+  const int calls = (n + 3) / 4;
+  cl_uint key0, key1, ctr0, ctr1;
+  clrng_key_counter(calls, &key0, &key1, &ctr0, &ctr1);
+
   CL_SET_KERNEL_ARG
   CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_x, kernel)
-  CL_SET_ARRAY_KERNEL_ARG(&array_GPU_y, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, key0, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, key1, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, ctr0, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, ctr1, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&r, kernel)
 
-  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
-  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(calls, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(calls, OPENCL_LOCAL_SIZE);
 
-  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local, 0,
-  NULL, NULL);
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -3632,65 +4838,63 @@ bool clexp(const int n, const T* array_GPU_x, T* array_GPU_y) {
 
   return true;
 }
-template bool clexp<float>(
-    const int n,
-    const float* array_GPU_x,
-    float* array_GPU_z);
-template bool clexp<double>(
-    const int n,
-    const double* array_GPU_x,
-    double* array_GPU_z);
 
-bool cl_caffe_gpu_rng_uniform(const int n, unsigned int* r) {
-  size_t bytes;
+template<typename T>
+bool cl_caffe_gpu_rng_uniform(const int n, const T a, const T b, T* r) {
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
 
-  bytes = n * sizeof(double);
-  double* fBuffer = reinterpret_cast<double*>(malloc(bytes));
-  if (fBuffer == NULL) {
-    LOG(ERROR) << "failed to allocate cpu memory for buffer of "
-               << bytes << " Bytes.";
-    return false;
-  }
+  std::string kernel_name = clGetKernelName<T>("clrng_uniform");
 
-  bytes = n * sizeof(unsigned int);
-  unsigned int* buffer = (unsigned int*) malloc(bytes);
-  if (buffer == NULL) {
-    LOG(ERROR) << "failed to allocate cpu memory for buffer of "
-               << bytes
-               << " Bytes.";
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
     return false;
   }
 
-  caffe_rng_uniform(n, 0.0, static_cast<double>(UINT_MAX), fBuffer);
-  for (int i = 0; i < n; i++) {
-    buffer[i] = (unsigned int) fBuffer[i];
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
   }
 
-  BOOL_CHECK(caffe::OpenCL::clMemcpy(r, buffer, bytes, COPY_CPU_TO_GPU));
-  free(buffer);
-  free(fBuffer);
-  LOG(WARNING) << "caffe_gpu_rng_gaussian() was executed on the CPU"
-                  " and random array copied back to GPU.";
-
-  return true;
-}
+  // 32 bit words per number, 4 words per Philox call.
+  const int words = sizeof(T) / sizeof(cl_uint);
+  const int per_call = 4 / words;
+  const int calls = (n + per_call - 1) / per_call;
+  cl_uint key0, key1, ctr0, ctr1;
+  clrng_key_counter(calls, &key0, &key1, &ctr0, &ctr1);
 
-template<typename T>
-bool cl_caffe_gpu_rng_uniform(const int n, const T a, const T b, T* r) {
-  size_t bytes = n * sizeof(T);
-  T* buffer = reinterpret_cast<T*>(malloc(bytes));
-  if (buffer == NULL) {
-    LOG(ERROR) << "failed to allocate cpu memory for buffer of "
-               << bytes
-               << " Bytes.";
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, key0, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, key1, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, ctr0, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, ctr1, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, words, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, a, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, b, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&r, kernel)
+
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(calls, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(calls, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
     return false;
   }
 
-  caffe_rng_uniform(n, a, b, buffer);
-  BOOL_CHECK(caffe::OpenCL::clMemcpy(r, buffer, bytes, COPY_CPU_TO_GPU));
-  free(buffer);
-  LOG(WARNING) << "caffe_gpu_rng_uniform() was executed on the CPU"
-                  " and random array copied back to GPU.";
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
 
   return true;
 }
@@ -3707,20 +4911,60 @@ template bool cl_caffe_gpu_rng_uniform<double>(
 
 template<typename T>
 bool cl_caffe_gpu_rng_gaussian(const int n, const T mu, const T sigma, T* r) {
-  size_t bytes = n * sizeof(T);
-  T* buffer = reinterpret_cast<T*>(malloc(bytes));
-  if (buffer == NULL) {
-    LOG(ERROR) << "failed to allocate cpu memory for buffer of "
-               << bytes
-               << " Bytes.";
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+  std::string kernel_name = clGetKernelName<T>("clrng_gaussian");
+
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  // 32 bit words per number, 4 words per Philox call.
+  const int words = sizeof(T) / sizeof(cl_uint);
+  const int per_call = 4 / words;
+  const int calls = (n + per_call - 1) / per_call;
+  cl_uint key0, key1, ctr0, ctr1;
+  clrng_key_counter(calls, &key0, &key1, &ctr0, &ctr1);
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, key0, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, key1, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, ctr0, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, ctr1, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, words, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, mu, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, sigma, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&r, kernel)
+
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(calls, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(calls, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
     return false;
   }
 
-  caffe_rng_gaussian(n, mu, sigma, buffer);
-  BOOL_CHECK(caffe::OpenCL::clMemcpy(r, buffer, bytes, COPY_CPU_TO_GPU));
-  free(buffer);
-  LOG(WARNING) << "caffe_gpu_rng_gaussian() was executed on the CPU"
-                  " and random array copied back to GPU.";
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
 
   return true;
 }
@@ -3735,22 +4979,59 @@ template bool cl_caffe_gpu_rng_gaussian<double>(
     const double sigma,
     double* r);
 
+// T2 is int or unsigned int, the kernel writes 0 and 1 as int.
 template<typename T1, typename T2>
 bool cl_caffe_gpu_rng_bernoulli(const int n, const T1 p, T2* r) {
-  size_t bytes = n * sizeof(T2);
-  T2* buffer = reinterpret_cast<T2*>(malloc(bytes));
-  if (buffer == NULL) {
-    LOG(ERROR) << "failed to allocate cpu memory for buffer of "
-               << bytes
-               << " Bytes.";
+  OpenCLDevice& device = OpenCLManager::CurrentPlatform()->CurrentDevice();
+
+  std::string kernel_name = clGetKernelName<T1>("clrng_bernoulli");
+
+  cl_command_queue* queue = device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << device.name() << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  // 4 numbers per Philox call.
+  const int calls = (n + 3) / 4;
+  cl_uint key0, key1, ctr0, ctr1;
+  clrng_key_counter(calls, &key0, &key1, &ctr0, &ctr1);
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, key0, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, key1, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, ctr0, kernel)
+  CL_SET_TYPE_KERNEL_ARG(cl_uint, ctr1, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T1, p, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&r, kernel)
+
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(calls, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(calls, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL, &global, &local,
+  CL_COMMAND_WAIT_LIST(device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << device.name()
+               << " : "
+               << caffe::OpenCL::what(err);
     return false;
   }
 
-  caffe_rng_bernoulli(n, p, buffer);
-  BOOL_CHECK(caffe::OpenCL::clMemcpy(r, buffer, bytes, COPY_CPU_TO_GPU));
-  free(buffer);
-  LOG(WARNING)<< "caffe_gpu_rng_bernoulli() was executed on the CPU"
-                 " and random array copied back to GPU.";
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << device.name();
+
+  CL_SET_KERNEL_ARG_END
 
   return true;
 }
@@ -3927,7 +5208,8 @@ void clLogProfile(
 
   ofs << device.c_str() << ", ";
   ofs << sdk.c_str() << ", ";
-  ofs << OPENCL_NUM_COMMAND_QUEUES << ", ";
+  ofs << OpenCLManager::CurrentPlatform()->CurrentDevice().getNumCommandQueues()
+      << ", ";
   ofs << src.c_str() << ", ";
   ofs << function.c_str() << ", ";
   ofs << type.c_str() << ", ";
@@ -0,0 +1,163 @@
+#if defined(cl_khr_fp64)
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#endif
+
+#if defined(cl_amd_printf)
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+#endif
+
+#if defined(cl_amd_fp64)
+#pragma OPENCL EXTENSION cl_amd_fp64 : enable
+#endif
+
+#include "definitions.hpp"
+
+/*
+ * FFT convolution, see fft.hpp
+ *
+ * The complex planes are [fft_h x fft_w] interleaved (real, imag) values.
+ */
+
+/*
+ * Global Index Space
+ *   global_size[0] := planes * fft_h * fft_w, a work item per complex value
+ */
+template <class T> __kernel void clfft_pad(global T* data, const int planes, const int height, const int width, const int stride_h, const int stride_w, const int offset_h, const int offset_w, const int fft_h, const int fft_w, global T* spectrum) {
+  const int idx = get_global_id(0);
+  if ( idx >= planes * fft_h * fft_w ) {
+    return;
+  }
+  const int p = idx / (fft_h * fft_w);
+  const int h = (idx / fft_w) % fft_h - offset_h;
+  const int w = idx % fft_w - offset_w;
+  const int y = h / stride_h;
+  const int x = w / stride_w;
+  T value = 0;
+  if ( h >= 0 && w >= 0 && h % stride_h == 0 && w % stride_w == 0 && y < height && x < width ) {
+    value = data[(p * height + y) * width + x];
+  }
+  spectrum[2 * idx] = value;
+  spectrum[2 * idx + 1] = 0;
+}
+template __attribute__((mangled_name(clfft_padFloat))) kernel void clfft_pad(global float* data, const int planes, const int height, const int width, const int stride_h, const int stride_w, const int offset_h, const int offset_w, const int fft_h, const int fft_w, global float* spectrum);
+template __attribute__((mangled_name(clfft_padDouble))) kernel void clfft_pad(global double* data, const int planes, const int height, const int width, const int stride_h, const int stride_w, const int offset_h, const int offset_w, const int fft_h, const int fft_w, global double* spectrum);
+
+/*
+ * Iterative radix-2 FFT of n complex values in place, unscaled
+ *
+ * Global Index Space
+ *   global_size[0] := sequences, a work item per sequence
+ *
+ * Sequence s starts at complex element (s / inner) * outer_stride +
+ * (s % inner) * inner_stride, its elements are elem_stride apart.
+ */
+template <class T> __kernel void clfft(global T* spectrum, const int sequences, const int n, const int elem_stride, const int inner, const int inner_stride, const int outer_stride, const int inverse) {
+  const int s = get_global_id(0);
+  if ( s >= sequences ) {
+    return;
+  }
+  global T* data = spectrum + 2 * ((s / inner) * outer_stride + (s % inner) * inner_stride);
+
+  // bit reversed order
+  for ( int i = 1, j = 0; i < n; i++ ) {
+    int bit = n >> 1;
+    for ( ; j & bit; bit >>= 1 ) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if ( i < j ) {
+      const T re = data[2 * i * elem_stride];
+      const T im = data[2 * i * elem_stride + 1];
+      data[2 * i * elem_stride] = data[2 * j * elem_stride];
+      data[2 * i * elem_stride + 1] = data[2 * j * elem_stride + 1];
+      data[2 * j * elem_stride] = re;
+      data[2 * j * elem_stride + 1] = im;
+    }
+  }
+
+  // butterflies
+  const T sign = inverse ? 1 : -1;
+  for ( int len = 2; len <= n; len <<= 1 ) {
+    const int half = len / 2;
+    const T angle = sign * (T) (2.0 * M_PI) / len;
+    for ( int k = 0; k < half; k++ ) {
+      const T wr = cos(angle * k);
+      const T wi = sin(angle * k);
+      for ( int i = k; i < n; i += len ) {
+        global T* u = data + 2 * i * elem_stride;
+        global T* v = data + 2 * (i + half) * elem_stride;
+        const T vr = v[0] * wr - v[1] * wi;
+        const T vi = v[0] * wi + v[1] * wr;
+        v[0] = u[0] - vr;
+        v[1] = u[1] - vi;
+        u[0] += vr;
+        u[1] += vi;
+      }
+    }
+  }
+}
+template __attribute__((mangled_name(clfftFloat))) kernel void clfft(global float* spectrum, const int sequences, const int n, const int elem_stride, const int inner, const int inner_stride, const int outer_stride, const int inverse);
+template __attribute__((mangled_name(clfftDouble))) kernel void clfft(global double* spectrum, const int sequences, const int n, const int elem_stride, const int inner, const int inner_stride, const int outer_stride, const int inverse);
+
+/*
+ * Global Index Space
+ *   global_size[0] := num * num_output * size, a work item per output frequency
+ *
+ * Sums input[n][c] * conj(filter[o][c]) over the channels c of the group of
+ * o, or input[n][c] * filter[c][o] with transposed filters.
+ */
+template <class T> __kernel void clfft_multiply(global T* input, global T* filter, const int num, const int channels, const int num_output, const int group, const int size, const int transposed, global T* output) {
+  const int idx = get_global_id(0);
+  if ( idx >= num * num_output * size ) {
+    return;
+  }
+  const int n = idx / (num_output * size);
+  const int o = (idx / size) % num_output;
+  const int i = idx % size;
+  const int channels_g = channels / group;
+  const int outputs_g = num_output / group;
+  const int g = o / outputs_g;
+  const T conj = transposed ? 1 : -1;
+
+  T re = 0;
+  T im = 0;
+  for ( int c = g * channels_g; c < (g + 1) * channels_g; c++ ) {
+    const int plane = transposed ? c * outputs_g + o % outputs_g : o * channels_g + c % channels_g;
+    const T ir = input[2 * ((n * channels + c) * size + i)];
+    const T ii = input[2 * ((n * channels + c) * size + i) + 1];
+    const T fr = filter[2 * (plane * size + i)];
+    const T fi = conj * filter[2 * (plane * size + i) + 1];
+    re += ir * fr - ii * fi;
+    im += ir * fi + ii * fr;
+  }
+  output[2 * idx] = re;
+  output[2 * idx + 1] = im;
+}
+template __attribute__((mangled_name(clfft_multiplyFloat))) kernel void clfft_multiply(global float* input, global float* filter, const int num, const int channels, const int num_output, const int group, const int size, const int transposed, global float* output);
+template __attribute__((mangled_name(clfft_multiplyDouble))) kernel void clfft_multiply(global double* input, global double* filter, const int num, const int channels, const int num_output, const int group, const int size, const int transposed, global double* output);
+
+/*
+ * Global Index Space
+ *   global_size[0] := planes * height * width, a work item per output pixel
+ *
+ * The bias is optional, relu applies the leaky ReLU of negative_slope.
+ */
+template <class T> __kernel void clfft_crop(global T* spectrum, global T* bias, const int relu, const T negative_slope, const int planes, const int num_output, const int fft_h, const int fft_w, const int stride_h, const int stride_w, const int offset_h, const int offset_w, const int height, const int width, global T* data) {
+  const int idx = get_global_id(0);
+  if ( idx >= planes * height * width ) {
+    return;
+  }
+  const int p = idx / (height * width);
+  const int h = (idx / width) % height * stride_h + offset_h;
+  const int w = idx % width * stride_w + offset_w;
+  T value = spectrum[2 * ((p * fft_h + h) * fft_w + w)] / (fft_h * fft_w);
+  if ( bias ) {
+    value += bias[p % num_output];
+  }
+  if ( relu ) {
+    value = value > 0 ? value : value * negative_slope;
+  }
+  data[idx] = value;
+}
+template __attribute__((mangled_name(clfft_cropFloat))) kernel void clfft_crop(global float* spectrum, global float* bias, const int relu, const float negative_slope, const int planes, const int num_output, const int fft_h, const int fft_w, const int stride_h, const int stride_w, const int offset_h, const int offset_w, const int height, const int width, global float* data);
+template __attribute__((mangled_name(clfft_cropDouble))) kernel void clfft_crop(global double* spectrum, global double* bias, const int relu, const double negative_slope, const int planes, const int num_output, const int fft_h, const int fft_w, const int stride_h, const int stride_w, const int offset_h, const int offset_w, const int height, const int width, global double* data);
@@ -1594,3 +1594,510 @@ template <class T> __kernel void group_3D_mmul_NA_NB(const int M, const int N, c
 template __attribute__((mangled_name(group_3D_mmul_NA_NBFloat))) kernel void group_3D_mmul_NA_NB(const int M, const int N, const int K, const int G, const int GM, const int GN, const int GK, const float alpha, global float* A, const unsigned long idx_offset_A, global float* B, const unsigned long idx_offset_B, const float beta, global float* C, const unsigned long idx_offset_C);
 template __attribute__((mangled_name(group_3D_mmul_NA_NBDouble))) kernel void group_3D_mmul_NA_NB(const int M, const int N, const int K, const int G, const int GM, const int GN, const int GK, const double alpha, global double* A, const unsigned long idx_offset_A, global double* B, const unsigned long idx_offset_B, const double beta, global double* C, const unsigned long idx_offset_C);
 
+
+/*
+ * Batched Matrix-Matrix-Multiplication C = alpha*op(A)*op(B) + beta*C with
+ * tile size and work per thread chosen at runtime, see OpenCLGemmTuner
+ *
+ * Dimensions:
+ *   Matrix op(A) is [MxK], A is [KxM] if TA != 0
+ *   Matrix op(B) is [KxN], B is [NxK] if TB != 0
+ *   Matrix C is [MxN]
+ *   matrix i of a batch starts at idx_offset_X + i*stride_X
+ *   bias_row[m] and bias_col[n] are added to C(m, n) unless NULL, then
+ *   C(m, n) goes through a ReLU with negative_slope if relu
+ *
+ * Global Index Space
+ *   global_size[0] := global_size[0] % TS == 0 && global_size[0] >= N
+ *   global_size[1] := global_size[1] % (TS/WPT) == 0 && global_size[1]*WPT >= M
+ *   global_size[2] := batch count
+ *
+ * Local Index Space
+ *   local_size[0] := TS
+ *   local_size[1] := TS/WPT
+ *   local_size[2] := 1
+ *
+ * Local Memory
+ *   localMemA, localMemB := TS*TS elements each
+ *
+ * Each thread computes WPT <= OPENCL_TUNED_MAX_WPT elements of a column of
+ * the [TS x TS] tile of C, which are TS/WPT rows apart.
+ */
+template <class T> __kernel void mmul_tiled(const int M, const int N, const int K, const int TA, const int TB, const int WPT, const T alpha, global T* A, const unsigned long idx_offset_A, const unsigned long stride_A, global T* B, const unsigned long idx_offset_B, const unsigned long stride_B, const T beta, global T* C, const unsigned long idx_offset_C, const unsigned long stride_C, global T* bias_row, global T* bias_col, const int relu, const T negative_slope, local T* localMemA, local T* localMemB) {
+  const int TS  = get_local_size(0);
+  const int RTS = get_local_size(1);
+
+  // local index of each thread
+  const int thread_x = get_local_id(0);
+  const int thread_y = get_local_id(1);
+
+  // first row and column of the tile in C
+  const int tile_m = get_group_id(1) * TS;
+  const int tile_n = get_group_id(0) * TS;
+
+  // offset pointers in global memory
+  const int batch = get_global_id(2);
+  global T* A_ptr = A + idx_offset_A + batch * stride_A;
+  global T* B_ptr = B + idx_offset_B + batch * stride_B;
+  global T* C_ptr = C + idx_offset_C + batch * stride_C;
+
+  // accumulates the results
+  T sum[OPENCL_TUNED_MAX_WPT];
+  for ( int w = 0; w < WPT; w++ ) {
+    sum[w] = 0.0;
+  }
+
+  for ( int tile_k = 0; tile_k < K; tile_k += TS ) {
+    // each thread reads WPT elements of op(A) and op(B) into local memory
+    for ( int w = 0; w < WPT; w++ ) {
+      int row = thread_y + w * RTS;
+
+      int m = tile_m + row;
+      int k = tile_k + thread_x;
+      T value = 0.0;
+      if ( m < M && k < K ) {
+        value = TA ? A_ptr[k * M + m] : A_ptr[m * K + k];
+      }
+      localMemA[row * TS + thread_x] = value;
+
+      k = tile_k + row;
+      int n = tile_n + thread_x;
+      value = 0.0;
+      if ( k < K && n < N ) {
+        value = TB ? B_ptr[n * K + k] : B_ptr[k * N + n];
+      }
+      localMemB[row * TS + thread_x] = value;
+    }
+
+    // Synchronize the reads of A and B
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // multiply the tiles of A and B using local memory
+    for ( int k = 0; k < TS; k++ ) {
+      T value = localMemB[k * TS + thread_x];
+      for ( int w = 0; w < WPT; w++ ) {
+        sum[w] += localMemA[(thread_y + w * RTS) * TS + k] * value;
+      }
+    }
+
+    // Synchronize all sub-results
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+
+  // write all results back to global memory with the bias and the ReLU, C
+  // is not read if beta is zero
+  const int n = tile_n + thread_x;
+  for ( int w = 0; w < WPT; w++ ) {
+    int m = tile_m + thread_y + w * RTS;
+    if ( m < M && n < N ) {
+      T value = alpha * sum[w];
+      if ( bias_row ) {
+        value += bias_row[m];
+      }
+      if ( bias_col ) {
+        value += bias_col[n];
+      }
+      if ( beta != 0.0 ) {
+        value += beta * C_ptr[m * N + n];
+      }
+      if ( relu ) {
+        value = value > 0 ? value : value * negative_slope;
+      }
+      C_ptr[m * N + n] = value;
+    }
+  }
+}
+template __attribute__((mangled_name(mmul_tiledFloat))) kernel void mmul_tiled(const int M, const int N, const int K, const int TA, const int TB, const int WPT, const float alpha, global float* A, const unsigned long idx_offset_A, const unsigned long stride_A, global float* B, const unsigned long idx_offset_B, const unsigned long stride_B, const float beta, global float* C, const unsigned long idx_offset_C, const unsigned long stride_C, global float* bias_row, global float* bias_col, const int relu, const float negative_slope, local float* localMemA, local float* localMemB);
+template __attribute__((mangled_name(mmul_tiledDouble))) kernel void mmul_tiled(const int M, const int N, const int K, const int TA, const int TB, const int WPT, const double alpha, global double* A, const unsigned long idx_offset_A, const unsigned long stride_A, global double* B, const unsigned long idx_offset_B, const unsigned long stride_B, const double beta, global double* C, const unsigned long idx_offset_C, const unsigned long stride_C, global double* bias_row, global double* bias_col, const int relu, const double negative_slope, local double* localMemA, local double* localMemB);
+
+/*
+ * Batched Matrix-Matrix-Multiplication using local memory as a buffer
+ * that has [OPENCL_BLOCK_SIZE x OPENCL_BLOCK_SIZE] elements
+ *
+ * Dimensions:
+ *   Matrix A is [MxK] and A is not transposed
+ *   Matrix B is [KxN] and B is not transposed
+ *   Matrix C is [MxN]
+ *   matrix i of a batch starts at idx_offset_X + i*stride_X
+ *   bias_row[m] and bias_col[n] are added to C(m, n) unless NULL, then
+ *   C(m, n) goes through a ReLU with negative_slope if relu
+ *
+ * Global Index Space
+ *   global_size[0] := global_size[0] % OPENCL_BLOCK_SIZE == 0 && global_size[0] >= N
+ *   global_size[1] := global_size[1] % OPENCL_BLOCK_SIZE == 0 && global_size[1] >= M
+ *   global_size[2] := batch count
+ *
+ * Local Index Space
+ *   local_size[0] := OPENCL_BLOCK_SIZE
+ *   local_size[1] := OPENCL_BLOCK_SIZE
+ *   local_size[2] := 1
+ *
+ * Number of Threads in each local workgroup
+ *   localThreadCount := OPENCL_BLOCK_SIZE*OPENCL_BLOCK_SIZE
+ */
+template <class T> __kernel void mmul_batched_NA_NB(const int M, const int N, const int K, const T alpha, global T* A, const unsigned long idx_offset_A, const unsigned long stride_A, global T* B, const unsigned long idx_offset_B, const unsigned long stride_B, const T beta, global T* C, const unsigned long idx_offset_C, const unsigned long stride_C, global T* bias_row, global T* bias_col, const int relu, const T negative_slope) {
+  // local index of each thread
+  int thread_x = get_local_id(0);
+  int thread_y = get_local_id(1);
+
+  // global coordinates of each element in C
+  int n = get_global_id(0);
+  int m = get_global_id(1);
+
+  // offset pointers in global memory
+  int batch = get_global_id(2);
+  global T* A_ptr = A + idx_offset_A + batch * stride_A;
+  global T* B_ptr = B + idx_offset_B + batch * stride_B;
+  global T* C_ptr = C + idx_offset_C + batch * stride_C;
+
+  // accumulates the result
+  T sum = 0.0;
+
+  // local memory for matrix A
+  __local T localMemA[OPENCL_BLOCK_SIZE][OPENCL_BLOCK_SIZE];
+
+  // local memory for matrix B
+  __local T localMemB[OPENCL_BLOCK_SIZE][OPENCL_BLOCK_SIZE];
+
+  for ( int tile_k = 0; tile_k < K; tile_k += OPENCL_BLOCK_SIZE ) {
+    // each thread in workgroup reads one element of matrix A and B from global to local memory
+    int k = tile_k + thread_x;
+    if ( m < M && k < K ) {
+      localMemA[thread_y][thread_x] = A_ptr[m * K + k];
+    } else {
+      localMemA[thread_y][thread_x] = 0.0;
+    }
+    k = tile_k + thread_y;
+    if ( k < K && n < N ) {
+      localMemB[thread_y][thread_x] = B_ptr[k * N + n];
+    } else {
+      localMemB[thread_y][thread_x] = 0.0;
+    }
+
+    // Synchronize the reads of A and B
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // multiply matrix A and B using local memory
+    for ( int i = 0; i < OPENCL_BLOCK_SIZE; i++ ) {
+      sum += localMemA[thread_y][i] * localMemB[i][thread_x];
+    }
+
+    // Synchronize all sub-results
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+
+  // write all results back to global memory with the bias and the ReLU, C
+  // is not read if beta is zero
+  if ( m < M && n < N ) {
+    T value = alpha * sum;
+    if ( bias_row ) {
+      value += bias_row[m];
+    }
+    if ( bias_col ) {
+      value += bias_col[n];
+    }
+    if ( beta != 0.0 ) {
+      value += beta * C_ptr[m * N + n];
+    }
+    if ( relu ) {
+      value = value > 0 ? value : value * negative_slope;
+    }
+    C_ptr[m * N + n] = value;
+  }
+}
+template __attribute__((mangled_name(mmul_batched_NA_NBFloat))) kernel void mmul_batched_NA_NB(const int M, const int N, const int K, const float alpha, global float* A, const unsigned long idx_offset_A, const unsigned long stride_A, global float* B, const unsigned long idx_offset_B, const unsigned long stride_B, const float beta, global float* C, const unsigned long idx_offset_C, const unsigned long stride_C, global float* bias_row, global float* bias_col, const int relu, const float negative_slope);
+template __attribute__((mangled_name(mmul_batched_NA_NBDouble))) kernel void mmul_batched_NA_NB(const int M, const int N, const int K, const double alpha, global double* A, const unsigned long idx_offset_A, const unsigned long stride_A, global double* B, const unsigned long idx_offset_B, const unsigned long stride_B, const double beta, global double* C, const unsigned long idx_offset_C, const unsigned long stride_C, global double* bias_row, global double* bias_col, const int relu, const double negative_slope);
+
+/*
+ * Batched Matrix-Matrix-Multiplication using local memory as a buffer
+ * that has [OPENCL_BLOCK_SIZE x OPENCL_BLOCK_SIZE] elements
+ *
+ * Dimensions:
+ *   Matrix A is [MxK] and A is not transposed
+ *   Matrix B is [KxN] and B is transposed, B is [NxK]
+ *   Matrix C is [MxN]
+ *   matrix i of a batch starts at idx_offset_X + i*stride_X
+ *   bias_row[m] and bias_col[n] are added to C(m, n) unless NULL, then
+ *   C(m, n) goes through a ReLU with negative_slope if relu
+ *
+ * Global Index Space
+ *   global_size[0] := global_size[0] % OPENCL_BLOCK_SIZE == 0 && global_size[0] >= N
+ *   global_size[1] := global_size[1] % OPENCL_BLOCK_SIZE == 0 && global_size[1] >= M
+ *   global_size[2] := batch count
+ *
+ * Local Index Space
+ *   local_size[0] := OPENCL_BLOCK_SIZE
+ *   local_size[1] := OPENCL_BLOCK_SIZE
+ *   local_size[2] := 1
+ *
+ * Number of Threads in each local workgroup
+ *   localThreadCount := OPENCL_BLOCK_SIZE*OPENCL_BLOCK_SIZE
+ */
+template <class T> __kernel void mmul_batched_NA_TB(const int M, const int N, const int K, const T alpha, global T* A, const unsigned long idx_offset_A, const unsigned long stride_A, global T* B, const unsigned long idx_offset_B, const unsigned long stride_B, const T beta, global T* C, const unsigned long idx_offset_C, const unsigned long stride_C, global T* bias_row, global T* bias_col, const int relu, const T negative_slope) {
+  // local index of each thread
+  int thread_x = get_local_id(0);
+  int thread_y = get_local_id(1);
+
+  // global coordinates of each element in C
+  int n = get_global_id(0);
+  int m = get_global_id(1);
+
+  // offset pointers in global memory
+  int batch = get_global_id(2);
+  global T* A_ptr = A + idx_offset_A + batch * stride_A;
+  global T* B_ptr = B + idx_offset_B + batch * stride_B;
+  global T* C_ptr = C + idx_offset_C + batch * stride_C;
+
+  // accumulates the result
+  T sum = 0.0;
+
+  // local memory for matrix A
+  __local T localMemA[OPENCL_BLOCK_SIZE][OPENCL_BLOCK_SIZE];
+
+  // local memory for matrix B
+  __local T localMemB[OPENCL_BLOCK_SIZE][OPENCL_BLOCK_SIZE];
+
+  for ( int tile_k = 0; tile_k < K; tile_k += OPENCL_BLOCK_SIZE ) {
+    // each thread in workgroup reads one element of matrix A and B from global to local memory
+    int k = tile_k + thread_x;
+    if ( m < M && k < K ) {
+      localMemA[thread_y][thread_x] = A_ptr[m * K + k];
+    } else {
+      localMemA[thread_y][thread_x] = 0.0;
+    }
+    k = tile_k + thread_y;
+    if ( k < K && n < N ) {
+      localMemB[thread_y][thread_x] = B_ptr[n * K + k];
+    } else {
+      localMemB[thread_y][thread_x] = 0.0;
+    }
+
+    // Synchronize the reads of A and B
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // multiply matrix A and B using local memory
+    for ( int i = 0; i < OPENCL_BLOCK_SIZE; i++ ) {
+      sum += localMemA[thread_y][i] * localMemB[i][thread_x];
+    }
+
+    // Synchronize all sub-results
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+
+  // write all results back to global memory with the bias and the ReLU, C
+  // is not read if beta is zero
+  if ( m < M && n < N ) {
+    T value = alpha * sum;
+    if ( bias_row ) {
+      value += bias_row[m];
+    }
+    if ( bias_col ) {
+      value += bias_col[n];
+    }
+    if ( beta != 0.0 ) {
+      value += beta * C_ptr[m * N + n];
+    }
+    if ( relu ) {
+      value = value > 0 ? value : value * negative_slope;
+    }
+    C_ptr[m * N + n] = value;
+  }
+}
+template __attribute__((mangled_name(mmul_batched_NA_TBFloat))) kernel void mmul_batched_NA_TB(const int M, const int N, const int K, const float alpha, global float* A, const unsigned long idx_offset_A, const unsigned long stride_A, global float* B, const unsigned long idx_offset_B, const unsigned long stride_B, const float beta, global float* C, const unsigned long idx_offset_C, const unsigned long stride_C, global float* bias_row, global float* bias_col, const int relu, const float negative_slope);
+template __attribute__((mangled_name(mmul_batched_NA_TBDouble))) kernel void mmul_batched_NA_TB(const int M, const int N, const int K, const double alpha, global double* A, const unsigned long idx_offset_A, const unsigned long stride_A, global double* B, const unsigned long idx_offset_B, const unsigned long stride_B, const double beta, global double* C, const unsigned long idx_offset_C, const unsigned long stride_C, global double* bias_row, global double* bias_col, const int relu, const double negative_slope);
+
+/*
+ * Batched Matrix-Matrix-Multiplication using local memory as a buffer
+ * that has [OPENCL_BLOCK_SIZE x OPENCL_BLOCK_SIZE] elements
+ *
+ * Dimensions:
+ *   Matrix A is [MxK] and A is transposed, A is [KxM]
+ *   Matrix B is [KxN] and B is not transposed
+ *   Matrix C is [MxN]
+ *   matrix i of a batch starts at idx_offset_X + i*stride_X
+ *   bias_row[m] and bias_col[n] are added to C(m, n) unless NULL, then
+ *   C(m, n) goes through a ReLU with negative_slope if relu
+ *
+ * Global Index Space
+ *   global_size[0] := global_size[0] % OPENCL_BLOCK_SIZE == 0 && global_size[0] >= N
+ *   global_size[1] := global_size[1] % OPENCL_BLOCK_SIZE == 0 && global_size[1] >= M
+ *   global_size[2] := batch count
+ *
+ * Local Index Space
+ *   local_size[0] := OPENCL_BLOCK_SIZE
+ *   local_size[1] := OPENCL_BLOCK_SIZE
+ *   local_size[2] := 1
+ *
+ * Number of Threads in each local workgroup
+ *   localThreadCount := OPENCL_BLOCK_SIZE*OPENCL_BLOCK_SIZE
+ */
+template <class T> __kernel void mmul_batched_TA_NB(const int M, const int N, const int K, const T alpha, global T* A, const unsigned long idx_offset_A, const unsigned long stride_A, global T* B, const unsigned long idx_offset_B, const unsigned long stride_B, const T beta, global T* C, const unsigned long idx_offset_C, const unsigned long stride_C, global T* bias_row, global T* bias_col, const int relu, const T negative_slope) {
+  // local index of each thread
+  int thread_x = get_local_id(0);
+  int thread_y = get_local_id(1);
+
+  // global coordinates of each element in C
+  int n = get_global_id(0);
+  int m = get_global_id(1);
+
+  // offset pointers in global memory
+  int batch = get_global_id(2);
+  global T* A_ptr = A + idx_offset_A + batch * stride_A;
+  global T* B_ptr = B + idx_offset_B + batch * stride_B;
+  global T* C_ptr = C + idx_offset_C + batch * stride_C;
+
+  // accumulates the result
+  T sum = 0.0;
+
+  // local memory for matrix A
+  __local T localMemA[OPENCL_BLOCK_SIZE][OPENCL_BLOCK_SIZE];
+
+  // local memory for matrix B
+  __local T localMemB[OPENCL_BLOCK_SIZE][OPENCL_BLOCK_SIZE];
+
+  for ( int tile_k = 0; tile_k < K; tile_k += OPENCL_BLOCK_SIZE ) {
+    // each thread in workgroup reads one element of matrix A and B from global to local memory
+    int k = tile_k + thread_x;
+    if ( m < M && k < K ) {
+      localMemA[thread_y][thread_x] = A_ptr[k * M + m];
+    } else {
+      localMemA[thread_y][thread_x] = 0.0;
+    }
+    k = tile_k + thread_y;
+    if ( k < K && n < N ) {
+      localMemB[thread_y][thread_x] = B_ptr[k * N + n];
+    } else {
+      localMemB[thread_y][thread_x] = 0.0;
+    }
+
+    // Synchronize the reads of A and B
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // multiply matrix A and B using local memory
+    for ( int i = 0; i < OPENCL_BLOCK_SIZE; i++ ) {
+      sum += localMemA[thread_y][i] * localMemB[i][thread_x];
+    }
+
+    // Synchronize all sub-results
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+
+  // write all results back to global memory with the bias and the ReLU, C
+  // is not read if beta is zero
+  if ( m < M && n < N ) {
+    T value = alpha * sum;
+    if ( bias_row ) {
+      value += bias_row[m];
+    }
+    if ( bias_col ) {
+      value += bias_col[n];
+    }
+    if ( beta != 0.0 ) {
+      value += beta * C_ptr[m * N + n];
+    }
+    if ( relu ) {
+      value = value > 0 ? value : value * negative_slope;
+    }
+    C_ptr[m * N + n] = value;
+  }
+}
+template __attribute__((mangled_name(mmul_batched_TA_NBFloat))) kernel void mmul_batched_TA_NB(const int M, const int N, const int K, const float alpha, global float* A, const unsigned long idx_offset_A, const unsigned long stride_A, global float* B, const unsigned long idx_offset_B, const unsigned long stride_B, const float beta, global float* C, const unsigned long idx_offset_C, const unsigned long stride_C, global float* bias_row, global float* bias_col, const int relu, const float negative_slope);
+template __attribute__((mangled_name(mmul_batched_TA_NBDouble))) kernel void mmul_batched_TA_NB(const int M, const int N, const int K, const double alpha, global double* A, const unsigned long idx_offset_A, const unsigned long stride_A, global double* B, const unsigned long idx_offset_B, const unsigned long stride_B, const double beta, global double* C, const unsigned long idx_offset_C, const unsigned long stride_C, global double* bias_row, global double* bias_col, const int relu, const double negative_slope);
+
+/*
+ * Batched Matrix-Matrix-Multiplication using local memory as a buffer
+ * that has [OPENCL_BLOCK_SIZE x OPENCL_BLOCK_SIZE] elements
+ *
+ * Dimensions:
+ *   Matrix A is [MxK] and A is transposed, A is [KxM]
+ *   Matrix B is [KxN] and B is transposed, B is [NxK]
+ *   Matrix C is [MxN]
+ *   matrix i of a batch starts at idx_offset_X + i*stride_X
+ *   bias_row[m] and bias_col[n] are added to C(m, n) unless NULL, then
+ *   C(m, n) goes through a ReLU with negative_slope if relu
+ *
+ * Global Index Space
+ *   global_size[0] := global_size[0] % OPENCL_BLOCK_SIZE == 0 && global_size[0] >= N
+ *   global_size[1] := global_size[1] % OPENCL_BLOCK_SIZE == 0 && global_size[1] >= M
+ *   global_size[2] := batch count
+ *
+ * Local Index Space
+ *   local_size[0] := OPENCL_BLOCK_SIZE
+ *   local_size[1] := OPENCL_BLOCK_SIZE
+ *   local_size[2] := 1
+ *
+ * Number of Threads in each local workgroup
+ *   localThreadCount := OPENCL_BLOCK_SIZE*OPENCL_BLOCK_SIZE
+ */
+template <class T> __kernel void mmul_batched_TA_TB(const int M, const int N, const int K, const T alpha, global T* A, const unsigned long idx_offset_A, const unsigned long stride_A, global T* B, const unsigned long idx_offset_B, const unsigned long stride_B, const T beta, global T* C, const unsigned long idx_offset_C, const unsigned long stride_C, global T* bias_row, global T* bias_col, const int relu, const T negative_slope) {
+  // local index of each thread
+  int thread_x = get_local_id(0);
+  int thread_y = get_local_id(1);
+
+  // global coordinates of each element in C
+  int n = get_global_id(0);
+  int m = get_global_id(1);
+
+  // offset pointers in global memory
+  int batch = get_global_id(2);
+  global T* A_ptr = A + idx_offset_A + batch * stride_A;
+  global T* B_ptr = B + idx_offset_B + batch * stride_B;
+  global T* C_ptr = C + idx_offset_C + batch * stride_C;
+
+  // accumulates the result
+  T sum = 0.0;
+
+  // local memory for matrix A
+  __local T localMemA[OPENCL_BLOCK_SIZE][OPENCL_BLOCK_SIZE];
+
+  // local memory for matrix B
+  __local T localMemB[OPENCL_BLOCK_SIZE][OPENCL_BLOCK_SIZE];
+
+  for ( int tile_k = 0; tile_k < K; tile_k += OPENCL_BLOCK_SIZE ) {
+    // each thread in workgroup reads one element of matrix A and B from global to local memory
+    int k = tile_k + thread_x;
+    if ( m < M && k < K ) {
+      localMemA[thread_y][thread_x] = A_ptr[k * M + m];
+    } else {
+      localMemA[thread_y][thread_x] = 0.0;
+    }
+    k = tile_k + thread_y;
+    if ( k < K && n < N ) {
+      localMemB[thread_y][thread_x] = B_ptr[n * K + k];
+    } else {
+      localMemB[thread_y][thread_x] = 0.0;
+    }
+
+    // Synchronize the reads of A and B
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // multiply matrix A and B using local memory
+    for ( int i = 0; i < OPENCL_BLOCK_SIZE; i++ ) {
+      sum += localMemA[thread_y][i] * localMemB[i][thread_x];
+    }
+
+    // Synchronize all sub-results
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+
+  // write all results back to global memory with the bias and the ReLU, C
+  // is not read if beta is zero
+  if ( m < M && n < N ) {
+    T value = alpha * sum;
+    if ( bias_row ) {
+      value += bias_row[m];
+    }
+    if ( bias_col ) {
+      value += bias_col[n];
+    }
+    if ( beta != 0.0 ) {
+      value += beta * C_ptr[m * N + n];
+    }
+    if ( relu ) {
+      value = value > 0 ? value : value * negative_slope;
+    }
+    C_ptr[m * N + n] = value;
+  }
+}
+template __attribute__((mangled_name(mmul_batched_TA_TBFloat))) kernel void mmul_batched_TA_TB(const int M, const int N, const int K, const float alpha, global float* A, const unsigned long idx_offset_A, const unsigned long stride_A, global float* B, const unsigned long idx_offset_B, const unsigned long stride_B, const float beta, global float* C, const unsigned long idx_offset_C, const unsigned long stride_C, global float* bias_row, global float* bias_col, const int relu, const float negative_slope);
+template __attribute__((mangled_name(mmul_batched_TA_TBDouble))) kernel void mmul_batched_TA_TB(const int M, const int N, const int K, const double alpha, global double* A, const unsigned long idx_offset_A, const unsigned long stride_A, global double* B, const unsigned long idx_offset_B, const unsigned long stride_B, const double beta, global double* C, const unsigned long idx_offset_C, const unsigned long stride_C, global double* bias_row, global double* bias_col, const int relu, const double negative_slope);
@@ -16,6 +16,7 @@
 #endif
 
 #include "definitions.hpp"
+#include "reduction.hpp"
 
 template <class T> __kernel void clsign(const int n, global T* x, global T* y) {
   int idx = get_global_id(0);
@@ -126,3 +127,176 @@ template <class T> __kernel void clexp(const int n, global T* x, global T* y) {
 template __attribute__((mangled_name(clexpFloat))) kernel void clexp(const int n, global float* x, global float* y);
 template __attribute__((mangled_name(clexpDouble))) kernel void clexp(const int n, global double* x, global double* y);
 
+/*
+ * y[(n * channels + c) * spatial_dim + s] += bias[c]
+ */
+template <class T> __kernel void cladd_bias(const int count, const int channels, const int spatial_dim, global T* bias, global T* y) {
+  int idx = get_global_id(0);
+  if ( idx < count ) {
+    y[idx] += bias[(idx / spatial_dim) % channels];
+  }
+}
+template __attribute__((mangled_name(cladd_biasFloat))) kernel void cladd_bias(const int count, const int channels, const int spatial_dim, global float* bias, global float* y);
+template __attribute__((mangled_name(cladd_biasDouble))) kernel void cladd_bias(const int count, const int channels, const int spatial_dim, global double* bias, global double* y);
+
+/*
+ * Reductions, see reduction.hpp
+ *
+ * The work groups have OPENCL_LOCAL_SIZE work items. A reduction over more
+ * elements than one work group handles well takes two passes, the work groups
+ * of the first write their partial results to a scratch buffer, which a
+ * single work group reduces in the second pass.
+ */
+
+/*
+ * y[c] += sum of x[(n * channels + c) * spatial_dim + s] over n and s
+ *
+ * Global Index Space
+ *   global_size[0] := channels * OPENCL_LOCAL_SIZE, a work group per channel
+ */
+template <class T> __kernel void clchannel_sum(const int num, const int channels, const int spatial_dim, global T* x, global T* y) {
+  __local T partial[OPENCL_LOCAL_SIZE];
+  const int c = get_group_id(0);
+
+  T sum = 0;
+  for ( int i = get_local_id(0); i < num * spatial_dim; i += OPENCL_LOCAL_SIZE ) {
+    const int n = i / spatial_dim;
+    sum += x[(n * channels + c) * spatial_dim + i - n * spatial_dim];
+  }
+  REDUCE_GROUP(sum, partial, REDUCE_ADD, sub_group_reduce_add);
+  if ( get_local_id(0) == 0 ) {
+    y[c] += partial[0];
+  }
+}
+template __attribute__((mangled_name(clchannel_sumFloat))) kernel void clchannel_sum(const int num, const int channels, const int spatial_dim, global float* x, global float* y);
+template __attribute__((mangled_name(clchannel_sumDouble))) kernel void clchannel_sum(const int num, const int channels, const int spatial_dim, global double* x, global double* y);
+
+/*
+ * out[out_idx + g] = scale * the sum of x[i] * y[i] over the elements of work
+ * group g, |x[i]| if absolute, a NULL y sums x
+ *
+ * Global Index Space
+ *   global_size[0] := groups * OPENCL_LOCAL_SIZE, the work groups stride over n
+ */
+template <class T> __kernel void clreduce_dot(const int n, global T* x, global T* y, const int absolute, const T scale, global T* out, const int out_idx) {
+  __local T partial[OPENCL_LOCAL_SIZE];
+
+  T sum = 0;
+  for ( int i = get_global_id(0); i < n; i += get_global_size(0) ) {
+    T value = y ? x[i] * y[i] : x[i];
+    sum += absolute ? fabs(value) : value;
+  }
+  REDUCE_GROUP(sum, partial, REDUCE_ADD, sub_group_reduce_add);
+  if ( get_local_id(0) == 0 ) {
+    out[out_idx + get_group_id(0)] = scale * partial[0];
+  }
+}
+template __attribute__((mangled_name(clreduce_dotFloat))) kernel void clreduce_dot(const int n, global float* x, global float* y, const int absolute, const float scale, global float* out, const int out_idx);
+template __attribute__((mangled_name(clreduce_dotDouble))) kernel void clreduce_dot(const int n, global double* x, global double* y, const int absolute, const double scale, global double* out, const int out_idx);
+
+/*
+ * out[out_idx] = scale * sum(x[i] * y[i]) / sum(d[i]) without a host readback,
+ * a NULL y sums x and a NULL d divides by 1
+ *
+ * Global Index Space
+ *   global_size[0] := OPENCL_LOCAL_SIZE, a single work group
+ */
+template <class T> __kernel void cldot_device(const int n, global T* x, global T* y, global T* d, const T scale, global T* out, const int out_idx) {
+  __local T partial[OPENCL_LOCAL_SIZE];
+  __local T divisor[OPENCL_LOCAL_SIZE];
+
+  T sum = 0;
+  T div = 0;
+  for ( int i = get_local_id(0); i < n; i += OPENCL_LOCAL_SIZE ) {
+    sum += y ? x[i] * y[i] : x[i];
+    if ( d ) {
+      div += d[i];
+    }
+  }
+  REDUCE_GROUP(sum, partial, REDUCE_ADD, sub_group_reduce_add);
+  REDUCE_GROUP(div, divisor, REDUCE_ADD, sub_group_reduce_add);
+  if ( get_local_id(0) == 0 ) {
+    out[out_idx] = d ? scale * partial[0] / divisor[0] : scale * partial[0];
+  }
+}
+template __attribute__((mangled_name(cldot_deviceFloat))) kernel void cldot_device(const int n, global float* x, global float* y, global float* d, const float scale, global float* out, const int out_idx);
+template __attribute__((mangled_name(cldot_deviceDouble))) kernel void cldot_device(const int n, global double* x, global double* y, global double* d, const double scale, global double* out, const int out_idx);
+
+/*
+ * Row reductions of x viewed as [outer x len x inner], row r = o * inner + i
+ * reduces the len elements x[(o * len + k) * inner + i] into out[r]
+ *
+ * With group_per_row a work group reduces each row, for long rows, else a
+ * work item, whose neighbours read neighbouring elements if inner > 1.
+ *
+ * Global Index Space
+ *   global_size[0] := rows * OPENCL_LOCAL_SIZE with group_per_row, else rows
+ *                     rounded up to OPENCL_LOCAL_SIZE
+ */
+
+/*
+ * out[r] = scale * the sum of x * y over row r, a NULL y sums x
+ */
+template <class T> __kernel void clrows_sum(const int rows, const int len, const int inner, const int group_per_row, global T* x, global T* y, const T scale, global T* out) {
+  __local T partial[OPENCL_LOCAL_SIZE];
+
+  if ( group_per_row ) {
+    const int r = get_group_id(0);
+    const int base = (r / inner) * len * inner + r % inner;
+    T sum = 0;
+    for ( int k = get_local_id(0); k < len; k += OPENCL_LOCAL_SIZE ) {
+      const int idx = base + k * inner;
+      sum += y ? x[idx] * y[idx] : x[idx];
+    }
+    REDUCE_GROUP(sum, partial, REDUCE_ADD, sub_group_reduce_add);
+    if ( get_local_id(0) == 0 ) {
+      out[r] = scale * partial[0];
+    }
+  } else {
+    const int r = get_global_id(0);
+    if ( r < rows ) {
+      const int base = (r / inner) * len * inner + r % inner;
+      T sum = 0;
+      for ( int k = 0; k < len; k++ ) {
+        const int idx = base + k * inner;
+        sum += y ? x[idx] * y[idx] : x[idx];
+      }
+      out[r] = scale * sum;
+    }
+  }
+}
+template __attribute__((mangled_name(clrows_sumFloat))) kernel void clrows_sum(const int rows, const int len, const int inner, const int group_per_row, global float* x, global float* y, const float scale, global float* out);
+template __attribute__((mangled_name(clrows_sumDouble))) kernel void clrows_sum(const int rows, const int len, const int inner, const int group_per_row, global double* x, global double* y, const double scale, global double* out);
+
+/*
+ * out[r] = the maximum of row r
+ */
+template <class T> __kernel void clrows_max(const int rows, const int len, const int inner, const int group_per_row, global T* x, global T* out) {
+  __local T partial[OPENCL_LOCAL_SIZE];
+
+  if ( group_per_row ) {
+    const int r = get_group_id(0);
+    const int base = (r / inner) * len * inner + r % inner;
+    T maxval = -FLT_MAX;
+    for ( int k = get_local_id(0); k < len; k += OPENCL_LOCAL_SIZE ) {
+      maxval = fmax(maxval, x[base + k * inner]);
+    }
+    REDUCE_GROUP(maxval, partial, REDUCE_MAX, sub_group_reduce_max);
+    if ( get_local_id(0) == 0 ) {
+      out[r] = partial[0];
+    }
+  } else {
+    const int r = get_global_id(0);
+    if ( r < rows ) {
+      const int base = (r / inner) * len * inner + r % inner;
+      T maxval = -FLT_MAX;
+      for ( int k = 0; k < len; k++ ) {
+        maxval = fmax(maxval, x[base + k * inner]);
+      }
+      out[r] = maxval;
+    }
+  }
+}
+template __attribute__((mangled_name(clrows_maxFloat))) kernel void clrows_max(const int rows, const int len, const int inner, const int group_per_row, global float* x, global float* out);
+template __attribute__((mangled_name(clrows_maxDouble))) kernel void clrows_max(const int rows, const int len, const int inner, const int group_per_row, global double* x, global double* out);
+
@@ -40,7 +40,7 @@ namespace caffe {
 
   template<typename T>
   void caffe_gpu_asum(const int n, const T* x, T* y) {
-    BOOL_CHECK(caffe::OpenCL::clBLASasum<T>(n, x, y));
+    BOOL_CHECK(caffe::OpenCL::clasum<T>(n, x, y));
   }
   template void caffe_gpu_asum<float>(const int n, const float* x, float* y);
   template void caffe_gpu_asum<double>(const int n, const double* x, double* y);
@@ -101,11 +101,25 @@ namespace caffe {
 
   template<typename T>
   void caffe_gpu_dot(const int n, const T* x, const T* y, T* out) {
-    BOOL_CHECK(caffe::OpenCL::clBLASdot<T>(n, x, 1, y, 1, out));
+    BOOL_CHECK(caffe::OpenCL::cldot<T>(n, x, y, out));
   }
   template void caffe_gpu_dot<float>(const int n, const float* x, const float* y, float* out);        // NOLINT(*)
   template void caffe_gpu_dot<double>(const int n, const double* x, const double* y, double* out);    // NOLINT(*)
 
+  template<typename T>
+  void caffe_gpu_dot_device(const int n, const T* x, const T* y, const T* d,
+      const T scale, T* out, const int out_idx) {
+    if (d) {
+      BOOL_CHECK(caffe::OpenCL::cldot_device<T>(n, x, y, d, scale, out,
+          out_idx));
+    } else {
+      BOOL_CHECK(caffe::OpenCL::clreduce_dot<T>(n, x, y, false, scale, out,
+          out_idx));
+    }
+  }
+  template void caffe_gpu_dot_device<float>(const int n, const float* x, const float* y, const float* d, const float scale, float* out, const int out_idx);        // NOLINT(*)
+  template void caffe_gpu_dot_device<double>(const int n, const double* x, const double* y, const double* d, const double scale, double* out, const int out_idx);  // NOLINT(*)
+
   template<typename T>
   void caffe_gpu_sub(const int n, const T* a, const T* b, T* y) {
     BOOL_CHECK(caffe::OpenCL::clsub<T>(n, a, b, y));
@@ -127,6 +141,24 @@ namespace caffe {
   template void caffe_gpu_add_scalar<float>(const int N, const float alpha, float* Y);                // NOLINT(*)
   template void caffe_gpu_add_scalar<double>(const int N, const double alpha, double* Y);             // NOLINT(*)
 
+  template<typename T>
+  void caffe_gpu_add_bias(const int num, const int channels,
+      const int spatial_dim, const T* bias, T* y) {
+    BOOL_CHECK(caffe::OpenCL::cladd_bias<T>(num * channels * spatial_dim,
+        channels, spatial_dim, bias, y));
+  }
+  template void caffe_gpu_add_bias<float>(const int num, const int channels, const int spatial_dim, const float* bias, float* y);      // NOLINT(*)
+  template void caffe_gpu_add_bias<double>(const int num, const int channels, const int spatial_dim, const double* bias, double* y);  // NOLINT(*)
+
+  template<typename T>
+  void caffe_gpu_channel_sum(const int num, const int channels,
+      const int spatial_dim, const T* x, T* y) {
+    BOOL_CHECK(caffe::OpenCL::clchannel_sum<T>(num, channels, spatial_dim,
+        x, y));
+  }
+  template void caffe_gpu_channel_sum<float>(const int num, const int channels, const int spatial_dim, const float* x, float* y);      // NOLINT(*)
+  template void caffe_gpu_channel_sum<double>(const int num, const int channels, const int spatial_dim, const double* x, double* y);  // NOLINT(*)
+
   template<typename T>
   void caffe_gpu_powx(const int n, const T* a, const T alpha, T* y) {
     BOOL_CHECK(caffe::OpenCL::clpowx<T>(n, a, alpha, y));
@@ -844,6 +876,148 @@ namespace caffe {
       double* C);
 
 
+  template<typename T>
+  void caffe_gpu_gemm_strided_batched(
+      const CBLAS_TRANSPOSE TransA,
+      const CBLAS_TRANSPOSE TransB,
+      const int M,
+      const int N,
+      const int K,
+      const int batch,
+      const T alpha,
+      const T* A,
+      const size_t idx_offset_A,
+      const size_t stride_A,
+      const T* B,
+      const size_t idx_offset_B,
+      const size_t stride_B,
+      const T beta,
+      T* C,
+      const size_t idx_offset_C,
+      const size_t stride_C) {
+    clblasTranspose clTransA = TransA == CblasNoTrans ? clblasNoTrans :
+        clblasTrans;
+    clblasTranspose clTransB = TransB == CblasNoTrans ? clblasNoTrans :
+        clblasTrans;
+    BOOL_CHECK(caffe::OpenCL::clgemm_strided_batched<T>(clTransA, clTransB,
+        M, N, K, batch, alpha, A, idx_offset_A, stride_A, B, idx_offset_B,
+        stride_B, beta, C, idx_offset_C, stride_C, NULL, NULL, false, 0,
+        NULL));
+  }
+  template void caffe_gpu_gemm_strided_batched<float>(
+      const CBLAS_TRANSPOSE TransA,
+      const CBLAS_TRANSPOSE TransB,
+      const int M,
+      const int N,
+      const int K,
+      const int batch,
+      const float alpha,
+      const float* A,
+      const size_t idx_offset_A,
+      const size_t stride_A,
+      const float* B,
+      const size_t idx_offset_B,
+      const size_t stride_B,
+      const float beta,
+      float* C,
+      const size_t idx_offset_C,
+      const size_t stride_C);
+  template void caffe_gpu_gemm_strided_batched<double>(
+      const CBLAS_TRANSPOSE TransA,
+      const CBLAS_TRANSPOSE TransB,
+      const int M,
+      const int N,
+      const int K,
+      const int batch,
+      const double alpha,
+      const double* A,
+      const size_t idx_offset_A,
+      const size_t stride_A,
+      const double* B,
+      const size_t idx_offset_B,
+      const size_t stride_B,
+      const double beta,
+      double* C,
+      const size_t idx_offset_C,
+      const size_t stride_C);
+
+  template<typename T>
+  void caffe_gpu_gemm_strided_batched(
+      const CBLAS_TRANSPOSE TransA,
+      const CBLAS_TRANSPOSE TransB,
+      const int M,
+      const int N,
+      const int K,
+      const int batch,
+      const T alpha,
+      const T* A,
+      const size_t idx_offset_A,
+      const size_t stride_A,
+      const T* B,
+      const size_t idx_offset_B,
+      const size_t stride_B,
+      const T beta,
+      T* C,
+      const size_t idx_offset_C,
+      const size_t stride_C,
+      const T* bias_row,
+      const T* bias_col,
+      const bool relu,
+      const T negative_slope) {
+    clblasTranspose clTransA = TransA == CblasNoTrans ? clblasNoTrans :
+        clblasTrans;
+    clblasTranspose clTransB = TransB == CblasNoTrans ? clblasNoTrans :
+        clblasTrans;
+    BOOL_CHECK(caffe::OpenCL::clgemm_strided_batched<T>(clTransA, clTransB,
+        M, N, K, batch, alpha, A, idx_offset_A, stride_A, B, idx_offset_B,
+        stride_B, beta, C, idx_offset_C, stride_C, bias_row, bias_col, relu,
+        negative_slope, NULL));
+  }
+  template void caffe_gpu_gemm_strided_batched<float>(
+      const CBLAS_TRANSPOSE TransA,
+      const CBLAS_TRANSPOSE TransB,
+      const int M,
+      const int N,
+      const int K,
+      const int batch,
+      const float alpha,
+      const float* A,
+      const size_t idx_offset_A,
+      const size_t stride_A,
+      const float* B,
+      const size_t idx_offset_B,
+      const size_t stride_B,
+      const float beta,
+      float* C,
+      const size_t idx_offset_C,
+      const size_t stride_C,
+      const float* bias_row,
+      const float* bias_col,
+      const bool relu,
+      const float negative_slope);
+  template void caffe_gpu_gemm_strided_batched<double>(
+      const CBLAS_TRANSPOSE TransA,
+      const CBLAS_TRANSPOSE TransB,
+      const int M,
+      const int N,
+      const int K,
+      const int batch,
+      const double alpha,
+      const double* A,
+      const size_t idx_offset_A,
+      const size_t stride_A,
+      const double* B,
+      const size_t idx_offset_B,
+      const size_t stride_B,
+      const double beta,
+      double* C,
+      const size_t idx_offset_C,
+      const size_t stride_C,
+      const double* bias_row,
+      const double* bias_col,
+      const bool relu,
+      const double negative_slope);
+
   template<typename T>
   void caffe_gpu_axpy(const int N, const T alpha, const T* X, T* Y) {
     TIME("clBLASaxpy()", {
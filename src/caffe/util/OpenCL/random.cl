@@ -0,0 +1,111 @@
+#if defined(cl_khr_fp64)
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#endif
+
+#if defined(cl_amd_printf)
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+#endif
+
+#if defined(cl_amd_fp64)
+#pragma OPENCL EXTENSION cl_amd_fp64 : enable
+#endif
+
+#include "definitions.hpp"
+#include "philox.hpp"
+
+/*
+ * Random numbers from Philox4x32-10, see philox.hpp
+ *
+ * Work item i uses the counter ctr + i, where ctr is the 64 bit counter
+ * (ctr0, ctr1) the host reserved for the call, and the key (key0, key1)
+ * derived from the seed, see Caffe::philox_key().
+ *
+ * Global Index Space
+ *   global_size[0] := number of Philox calls, each one yields 4 x 32 bits
+ *
+ * The floating point kernels get words := sizeof(T) / sizeof(uint) so a
+ * call yields 4 float or 2 double uniforms in (0, 1].
+ */
+
+__kernel void clrng_uint(const int n, const uint key0, const uint key1, const uint ctr0, const uint ctr1, global uint* r) {
+  uint x[4];
+  philox4x32_10(ctr0, ctr1, get_global_id(0), key0, key1, x);
+  for ( int j = 0; j < 4; j++ ) {
+    const int idx = get_global_id(0) * 4 + j;
+    if ( idx < n ) {
+      r[idx] = x[j];
+    }
+  }
+}
+
+template <class T> __kernel void clrng_uniform(const int n, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const int words, const T a, const T b, global T* r) {
+  uint x[4];
+  philox4x32_10(ctr0, ctr1, get_global_id(0), key0, key1, x);
+  const int per_call = 4 / words;
+  for ( int j = 0; j < per_call; j++ ) {
+    const int idx = get_global_id(0) * per_call + j;
+    if ( idx < n ) {
+      T u = x[j * words];
+      if ( words == 1 ) {
+        u = (u + 1) * PHILOX_2POW32_INV;
+      } else {
+        T lo = x[j * words + 1];
+        u = (u + (lo + 1) * PHILOX_2POW32_INV) * PHILOX_2POW32_INV;
+      }
+      r[idx] = a + (b - a) * u;
+    }
+  }
+}
+template __attribute__((mangled_name(clrng_uniformFloat))) kernel void clrng_uniform(const int n, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const int words, const float a, const float b, global float* r);
+template __attribute__((mangled_name(clrng_uniformDouble))) kernel void clrng_uniform(const int n, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const int words, const double a, const double b, global double* r);
+
+/*
+ * Box-Muller on pairs of uniforms
+ */
+template <class T> __kernel void clrng_gaussian(const int n, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const int words, const T mu, const T sigma, global T* r) {
+  uint x[4];
+  philox4x32_10(ctr0, ctr1, get_global_id(0), key0, key1, x);
+  const int per_call = 4 / words;
+  for ( int j = 0; j < per_call; j += 2 ) {
+    T u1 = x[j * words];
+    T u2 = x[(j + 1) * words];
+    if ( words == 1 ) {
+      u1 = (u1 + 1) * PHILOX_2POW32_INV;
+      u2 = (u2 + 1) * PHILOX_2POW32_INV;
+    } else {
+      T lo1 = x[j * words + 1];
+      T lo2 = x[(j + 1) * words + 1];
+      u1 = (u1 + (lo1 + 1) * PHILOX_2POW32_INV) * PHILOX_2POW32_INV;
+      u2 = (u2 + (lo2 + 1) * PHILOX_2POW32_INV) * PHILOX_2POW32_INV;
+    }
+    T radius = sigma * sqrt(-2 * log(u1));
+    T theta = PHILOX_2PI * u2;
+    const int idx = get_global_id(0) * per_call + j;
+    if ( idx < n ) {
+      r[idx] = mu + radius * cos(theta);
+    }
+    if ( idx + 1 < n ) {
+      r[idx + 1] = mu + radius * sin(theta);
+    }
+  }
+}
+template __attribute__((mangled_name(clrng_gaussianFloat))) kernel void clrng_gaussian(const int n, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const int words, const float mu, const float sigma, global float* r);
+template __attribute__((mangled_name(clrng_gaussianDouble))) kernel void clrng_gaussian(const int n, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const int words, const double mu, const double sigma, global double* r);
+
+/*
+ * r[i] = 1 with probability p, 32 bits per number
+ */
+template <class T> __kernel void clrng_bernoulli(const int n, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const T p, global int* r) {
+  uint x[4];
+  philox4x32_10(ctr0, ctr1, get_global_id(0), key0, key1, x);
+  for ( int j = 0; j < 4; j++ ) {
+    const int idx = get_global_id(0) * 4 + j;
+    if ( idx < n ) {
+      T u = x[j];
+      u = (u + 1) * PHILOX_2POW32_INV;
+      r[idx] = u <= p ? 1 : 0;
+    }
+  }
+}
+template __attribute__((mangled_name(clrng_bernoulliFloat))) kernel void clrng_bernoulli(const int n, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const float p, global int* r);
+template __attribute__((mangled_name(clrng_bernoulliDouble))) kernel void clrng_bernoulli(const int n, const uint key0, const uint key1, const uint ctr0, const uint ctr1, const double p, global int* r);
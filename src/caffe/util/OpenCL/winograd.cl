@@ -0,0 +1,197 @@
+#if defined(cl_khr_fp64)
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#endif
+
+#if defined(cl_amd_printf)
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+#endif
+
+#if defined(cl_amd_fp64)
+#pragma OPENCL EXTENSION cl_amd_fp64 : enable
+#endif
+
+#include "definitions.hpp"
+
+/*
+ * Winograd F(2x2, 3x3) and F(4x4, 3x3) transforms, see winograd.hpp
+ *
+ * The filter transform G g G^T of the 3x3 filters g, the input transform B^T d B of a tile d of [(tile + 2) x (tile + 2)] input
+ * pixels and the output transform A^T m A of the elementwise products m.
+ * Element t of a transformed tile is stored at [t][channel][p] of the
+ * [T x channels x P] matrices the GEMMs multiply, with p the tile index
+ * over the images, so that consecutive work items write consecutive p.
+ */
+__constant float winograd_G_2[4 * 3] = {
+  1.0f, 0.0f, 0.0f,
+  0.5f, 0.5f, 0.5f,
+  0.5f, -0.5f, 0.5f,
+  0.0f, 0.0f, 1.0f };
+__constant float winograd_BT_2[4 * 4] = {
+  1.0f, 0.0f, -1.0f, 0.0f,
+  0.0f, 1.0f, 1.0f, 0.0f,
+  0.0f, -1.0f, 1.0f, 0.0f,
+  0.0f, 1.0f, 0.0f, -1.0f };
+__constant float winograd_AT_2[2 * 4] = {
+  1.0f, 1.0f, 1.0f, 0.0f,
+  0.0f, 1.0f, -1.0f, -1.0f };
+__constant float winograd_G_4[6 * 3] = {
+  1.0f / 4, 0.0f, 0.0f,
+  -1.0f / 6, -1.0f / 6, -1.0f / 6,
+  -1.0f / 6, 1.0f / 6, -1.0f / 6,
+  1.0f / 24, 1.0f / 12, 1.0f / 6,
+  1.0f / 24, -1.0f / 12, 1.0f / 6,
+  0.0f, 0.0f, 1.0f };
+__constant float winograd_BT_4[6 * 6] = {
+  4.0f, 0.0f, -5.0f, 0.0f, 1.0f, 0.0f,
+  0.0f, -4.0f, -4.0f, 1.0f, 1.0f, 0.0f,
+  0.0f, 4.0f, -4.0f, -1.0f, 1.0f, 0.0f,
+  0.0f, -2.0f, -1.0f, 2.0f, 1.0f, 0.0f,
+  0.0f, 2.0f, -1.0f, -2.0f, 1.0f, 0.0f,
+  0.0f, 4.0f, 0.0f, -5.0f, 0.0f, 1.0f };
+__constant float winograd_AT_4[4 * 6] = {
+  1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f,
+  0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.0f,
+  0.0f, 1.0f, 1.0f, 4.0f, 4.0f, 0.0f,
+  0.0f, 1.0f, -1.0f, 8.0f, -8.0f, 1.0f };
+
+/*
+ * Global Index Space
+ *   global_size[0] := num_output * channels, a work item per 3x3 filter
+ *
+ * The filter of output o and channel c is stored at [t][o][c] of the
+ * [T x num_output x channels] matrix.
+ */
+template <class T> __kernel void clwinograd_filter_transform(const int num_output, global T* weight, const int channels, const int tile, global T* filter) {
+  const int idx = get_global_id(0);
+  if ( idx >= num_output * channels ) {
+    return;
+  }
+  __constant float* G = tile == 2 ? winograd_G_2 : winograd_G_4;
+  const int size = tile + 2;
+  global T* g = weight + idx * 9;
+
+  T tmp[6][3];
+  for ( int i = 0; i < size; i++ ) {
+    for ( int j = 0; j < 3; j++ ) {
+      T value = 0;
+      for ( int k = 0; k < 3; k++ ) {
+        value += G[i * 3 + k] * g[k * 3 + j];
+      }
+      tmp[i][j] = value;
+    }
+  }
+  for ( int i = 0; i < size; i++ ) {
+    for ( int j = 0; j < size; j++ ) {
+      T value = 0;
+      for ( int k = 0; k < 3; k++ ) {
+        value += tmp[i][k] * G[j * 3 + k];
+      }
+      filter[(i * size + j) * num_output * channels + idx] = value;
+    }
+  }
+}
+template __attribute__((mangled_name(clwinograd_filter_transformFloat))) kernel void clwinograd_filter_transform(const int num_output, global float* weight, const int channels, const int tile, global float* filter);
+template __attribute__((mangled_name(clwinograd_filter_transformDouble))) kernel void clwinograd_filter_transform(const int num_output, global double* weight, const int channels, const int tile, global double* filter);
+
+/*
+ * Global Index Space
+ *   global_size[0] := channels * num_tiles, a work item per input tile
+ */
+template <class T> __kernel void clwinograd_input_transform(const int num_tiles, global T* data_im, const int channels, const int height, const int width, const int pad_h, const int pad_w, const int tiles_h, const int tiles_w, const int tile, global T* input) {
+  const int idx = get_global_id(0);
+  if ( idx >= channels * num_tiles ) {
+    return;
+  }
+  __constant float* BT = tile == 2 ? winograd_BT_2 : winograd_BT_4;
+  const int size = tile + 2;
+  const int c = idx / num_tiles;
+  const int p = idx % num_tiles;
+  const int n = p / (tiles_h * tiles_w);
+  const int h_bgn = (p / tiles_w) % tiles_h * tile - pad_h;
+  const int w_bgn = p % tiles_w * tile - pad_w;
+  global T* image = data_im + (n * channels + c) * height * width;
+
+  T d[6][6];
+  T tmp[6][6];
+  for ( int i = 0; i < size; i++ ) {
+    for ( int j = 0; j < size; j++ ) {
+      const int h = h_bgn + i;
+      const int w = w_bgn + j;
+      d[i][j] = (h >= 0 && h < height && w >= 0 && w < width) ? image[h * width + w] : 0;
+    }
+  }
+  for ( int i = 0; i < size; i++ ) {
+    for ( int j = 0; j < size; j++ ) {
+      T value = 0;
+      for ( int k = 0; k < size; k++ ) {
+        value += BT[i * size + k] * d[k][j];
+      }
+      tmp[i][j] = value;
+    }
+  }
+  for ( int i = 0; i < size; i++ ) {
+    for ( int j = 0; j < size; j++ ) {
+      T value = 0;
+      for ( int k = 0; k < size; k++ ) {
+        value += tmp[i][k] * BT[j * size + k];
+      }
+      input[((i * size + j) * channels + c) * num_tiles + p] = value;
+    }
+  }
+}
+template __attribute__((mangled_name(clwinograd_input_transformFloat))) kernel void clwinograd_input_transform(const int num_tiles, global float* data_im, const int channels, const int height, const int width, const int pad_h, const int pad_w, const int tiles_h, const int tiles_w, const int tile, global float* input);
+template __attribute__((mangled_name(clwinograd_input_transformDouble))) kernel void clwinograd_input_transform(const int num_tiles, global double* data_im, const int channels, const int height, const int width, const int pad_h, const int pad_w, const int tiles_h, const int tiles_w, const int tile, global double* input);
+
+/*
+ * Global Index Space
+ *   global_size[0] := num_output * num_tiles, a work item per output tile
+ *
+ * The bias is optional, relu applies the leaky ReLU of negative_slope. The
+ * tiles at the border are cut off.
+ */
+template <class T> __kernel void clwinograd_output_transform(const int num_tiles, global T* output, global T* bias, const int relu, const T negative_slope, const int num_output, const int height_out, const int width_out, const int tiles_h, const int tiles_w, const int tile, global T* data_im) {
+  const int idx = get_global_id(0);
+  if ( idx >= num_output * num_tiles ) {
+    return;
+  }
+  __constant float* AT = tile == 2 ? winograd_AT_2 : winograd_AT_4;
+  const int size = tile + 2;
+  const int o = idx / num_tiles;
+  const int p = idx % num_tiles;
+  const int n = p / (tiles_h * tiles_w);
+  const int h_bgn = (p / tiles_w) % tiles_h * tile;
+  const int w_bgn = p % tiles_w * tile;
+
+  T m[6][6];
+  T tmp[4][6];
+  for ( int i = 0; i < size; i++ ) {
+    for ( int j = 0; j < size; j++ ) {
+      m[i][j] = output[((i * size + j) * num_output + o) * num_tiles + p];
+    }
+  }
+  for ( int i = 0; i < tile; i++ ) {
+    for ( int j = 0; j < size; j++ ) {
+      T value = 0;
+      for ( int k = 0; k < size; k++ ) {
+        value += AT[i * size + k] * m[k][j];
+      }
+      tmp[i][j] = value;
+    }
+  }
+  global T* image = data_im + (n * num_output + o) * height_out * width_out;
+  const T b = bias ? bias[o] : 0;
+  for ( int i = 0; i < tile && h_bgn + i < height_out; i++ ) {
+    for ( int j = 0; j < tile && w_bgn + j < width_out; j++ ) {
+      T value = b;
+      for ( int k = 0; k < size; k++ ) {
+        value += tmp[i][k] * AT[j * size + k];
+      }
+      if ( relu ) {
+        value = value > 0 ? value : value * negative_slope;
+      }
+      image[(h_bgn + i) * width_out + w_bgn + j] = value;
+    }
+  }
+}
+template __attribute__((mangled_name(clwinograd_output_transformFloat))) kernel void clwinograd_output_transform(const int num_tiles, global float* output, global float* bias, const int relu, const float negative_slope, const int num_output, const int height_out, const int width_out, const int tiles_h, const int tiles_w, const int tile, global float* data_im);
+template __attribute__((mangled_name(clwinograd_output_transformDouble))) kernel void clwinograd_output_transform(const int num_tiles, global double* output, global double* bias, const int relu, const double negative_slope, const int num_output, const int height_out, const int width_out, const int tiles_h, const int tiles_w, const int tile, global double* data_im);
@@ -0,0 +1,798 @@
+#if defined(USE_OPENCL)
+#include <caffe/util/OpenCL/definitions.hpp>
+#include <caffe/util/OpenCL/fft.hpp>
+#endif
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "caffe/util/fft.hpp"
+#include "caffe/util/math_functions.hpp"
+
+namespace caffe {
+
+template<typename Dtype>
+void fft_pad_cpu(
+    const Dtype* data,
+    const int planes,
+    const int height,
+    const int width,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int fft_h,
+    const int fft_w,
+    Dtype* spectrum) {
+  caffe_set(planes * fft_h * fft_w * 2, Dtype(0), spectrum);
+  for (int p = 0; p < planes; ++p) {
+    const Dtype* image = data + p * height * width;
+    Dtype* plane = spectrum + p * fft_h * fft_w * 2;
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        const int h = y * stride_h + offset_h;
+        const int w = x * stride_w + offset_w;
+        plane[(h * fft_w + w) * 2] = image[y * width + x];
+      }
+    }
+  }
+}
+template void fft_pad_cpu<float>(
+    const float* data,
+    const int planes,
+    const int height,
+    const int width,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int fft_h,
+    const int fft_w,
+    float* spectrum);
+template void fft_pad_cpu<double>(
+    const double* data,
+    const int planes,
+    const int height,
+    const int width,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int fft_h,
+    const int fft_w,
+    double* spectrum);
+
+// the iterative radix-2 FFT of n complex values elem_stride apart.
+template<typename Dtype>
+static void fft1d_cpu(
+    Dtype* data,
+    const int n,
+    const int elem_stride,
+    const bool inverse) {
+  // bit reversed order
+  for (int i = 1, j = 0; i < n; ++i) {
+    int bit = n >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      std::swap(data[2 * i * elem_stride], data[2 * j * elem_stride]);
+      std::swap(data[2 * i * elem_stride + 1], data[2 * j * elem_stride + 1]);
+    }
+  }
+  // butterflies
+  const double sign = inverse ? 1.0 : -1.0;
+  for (int len = 2; len <= n; len <<= 1) {
+    const int half = len / 2;
+    const double angle = sign * 2.0 * M_PI / len;
+    for (int k = 0; k < half; ++k) {
+      const Dtype wr = cos(angle * k);
+      const Dtype wi = sin(angle * k);
+      for (int i = k; i < n; i += len) {
+        Dtype* u = data + 2 * i * elem_stride;
+        Dtype* v = data + 2 * (i + half) * elem_stride;
+        const Dtype vr = v[0] * wr - v[1] * wi;
+        const Dtype vi = v[0] * wi + v[1] * wr;
+        v[0] = u[0] - vr;
+        v[1] = u[1] - vi;
+        u[0] += vr;
+        u[1] += vi;
+      }
+    }
+  }
+}
+
+template<typename Dtype>
+void fft2d_cpu(
+    Dtype* spectrum,
+    const int planes,
+    const int fft_h,
+    const int fft_w,
+    const bool inverse) {
+  for (int p = 0; p < planes; ++p) {
+    Dtype* plane = spectrum + p * fft_h * fft_w * 2;
+    for (int y = 0; y < fft_h; ++y) {
+      fft1d_cpu(plane + y * fft_w * 2, fft_w, 1, inverse);
+    }
+    for (int x = 0; x < fft_w; ++x) {
+      fft1d_cpu(plane + x * 2, fft_h, fft_w, inverse);
+    }
+  }
+}
+template void fft2d_cpu<float>(
+    float* spectrum,
+    const int planes,
+    const int fft_h,
+    const int fft_w,
+    const bool inverse);
+template void fft2d_cpu<double>(
+    double* spectrum,
+    const int planes,
+    const int fft_h,
+    const int fft_w,
+    const bool inverse);
+
+template<typename Dtype>
+void fft_multiply_cpu(
+    const Dtype* input,
+    const Dtype* filter,
+    const int num,
+    const int channels,
+    const int num_output,
+    const int group,
+    const int size,
+    const bool transposed,
+    Dtype* output) {
+  const int channels_g = channels / group;
+  const int outputs_g = num_output / group;
+  const Dtype conj = transposed ? 1 : -1;
+  caffe_set(num * num_output * size * 2, Dtype(0), output);
+  for (int n = 0; n < num; ++n) {
+    for (int o = 0; o < num_output; ++o) {
+      const int g = o / outputs_g;
+      Dtype* out = output + (n * num_output + o) * size * 2;
+      for (int c = g * channels_g; c < (g + 1) * channels_g; ++c) {
+        const Dtype* in = input + (n * channels + c) * size * 2;
+        const int plane = transposed ? c * outputs_g + o % outputs_g :
+            o * channels_g + c % channels_g;
+        const Dtype* f = filter + plane * size * 2;
+        for (int i = 0; i < size; ++i) {
+          const Dtype fr = f[2 * i];
+          const Dtype fi = conj * f[2 * i + 1];
+          out[2 * i] += in[2 * i] * fr - in[2 * i + 1] * fi;
+          out[2 * i + 1] += in[2 * i] * fi + in[2 * i + 1] * fr;
+        }
+      }
+    }
+  }
+}
+template void fft_multiply_cpu<float>(
+    const float* input,
+    const float* filter,
+    const int num,
+    const int channels,
+    const int num_output,
+    const int group,
+    const int size,
+    const bool transposed,
+    float* output);
+template void fft_multiply_cpu<double>(
+    const double* input,
+    const double* filter,
+    const int num,
+    const int channels,
+    const int num_output,
+    const int group,
+    const int size,
+    const bool transposed,
+    double* output);
+
+template<typename Dtype>
+void fft_crop_cpu(
+    const Dtype* spectrum,
+    const Dtype* bias,
+    const bool relu,
+    const Dtype negative_slope,
+    const int planes,
+    const int num_output,
+    const int fft_h,
+    const int fft_w,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int height,
+    const int width,
+    Dtype* data) {
+  const Dtype scale = Dtype(1) / (fft_h * fft_w);
+  for (int p = 0; p < planes; ++p) {
+    const Dtype* plane = spectrum + p * fft_h * fft_w * 2;
+    const Dtype b = bias ? bias[p % num_output] : 0;
+    Dtype* image = data + p * height * width;
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        const int h = y * stride_h + offset_h;
+        const int w = x * stride_w + offset_w;
+        Dtype value = plane[(h * fft_w + w) * 2] * scale + b;
+        if (relu && value < 0) {
+          value *= negative_slope;
+        }
+        image[y * width + x] = value;
+      }
+    }
+  }
+}
+template void fft_crop_cpu<float>(
+    const float* spectrum,
+    const float* bias,
+    const bool relu,
+    const float negative_slope,
+    const int planes,
+    const int num_output,
+    const int fft_h,
+    const int fft_w,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int height,
+    const int width,
+    float* data);
+template void fft_crop_cpu<double>(
+    const double* spectrum,
+    const double* bias,
+    const bool relu,
+    const double negative_slope,
+    const int planes,
+    const int num_output,
+    const int fft_h,
+    const int fft_w,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int height,
+    const int width,
+    double* data);
+
+#if defined(USE_OPENCL)
+
+namespace OpenCL {
+
+template<typename T> bool clfft_pad(
+    const T* data,
+    const int planes,
+    const int height,
+    const int width,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int fft_h,
+    const int fft_w,
+    T* spectrum) {
+  std::string kernel_name = clGetKernelName<T>("clfft_pad");
+
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+  cl_command_queue* queue = current_device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << current_device.name()
+               << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = current_device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_ARRAY_KERNEL_ARG(&data, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, planes, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, height, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, width, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, stride_h, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, stride_w, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, offset_h, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, offset_w, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, fft_h, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, fft_w, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&spectrum, kernel)
+
+  // a work item per complex value.
+  const int n = planes * fft_h * fft_w;
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << current_device.name()
+               << " : " << caffe::OpenCL::what(err);
+    return false;
+  }
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << current_device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clfft_pad<float>(
+    const float* data,
+    const int planes,
+    const int height,
+    const int width,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int fft_h,
+    const int fft_w,
+    float* spectrum);
+template bool clfft_pad<double>(
+    const double* data,
+    const int planes,
+    const int height,
+    const int width,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int fft_h,
+    const int fft_w,
+    double* spectrum);
+
+template<typename T> bool clfft(
+    T* spectrum,
+    const int sequences,
+    const int n,
+    const int elem_stride,
+    const int inner,
+    const int inner_stride,
+    const int outer_stride,
+    const bool inverse) {
+  std::string kernel_name = clGetKernelName<T>("clfft");
+
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+  cl_command_queue* queue = current_device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << current_device.name()
+               << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = current_device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  const int inverse_flag = inverse ? 1 : 0;
+
+  CL_SET_KERNEL_ARG
+  CL_SET_ARRAY_KERNEL_ARG(&spectrum, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, sequences, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, n, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, elem_stride, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, inner, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, inner_stride, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, outer_stride, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, inverse_flag, kernel)
+
+  // a work item per sequence.
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(sequences, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(sequences, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << current_device.name()
+               << " : " << caffe::OpenCL::what(err);
+    return false;
+  }
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << current_device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clfft<float>(
+    float* spectrum,
+    const int sequences,
+    const int n,
+    const int elem_stride,
+    const int inner,
+    const int inner_stride,
+    const int outer_stride,
+    const bool inverse);
+template bool clfft<double>(
+    double* spectrum,
+    const int sequences,
+    const int n,
+    const int elem_stride,
+    const int inner,
+    const int inner_stride,
+    const int outer_stride,
+    const bool inverse);
+
+template<typename T> bool clfft_multiply(
+    const T* input,
+    const T* filter,
+    const int num,
+    const int channels,
+    const int num_output,
+    const int group,
+    const int size,
+    const bool transposed,
+    T* output) {
+  std::string kernel_name = clGetKernelName<T>("clfft_multiply");
+
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+  cl_command_queue* queue = current_device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << current_device.name()
+               << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = current_device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  const int transposed_flag = transposed ? 1 : 0;
+
+  CL_SET_KERNEL_ARG
+  CL_SET_ARRAY_KERNEL_ARG(&input, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&filter, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, num, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, channels, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, num_output, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, group, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, size, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, transposed_flag, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&output, kernel)
+
+  // a work item per output frequency.
+  const int n = num * num_output * size;
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << current_device.name()
+               << " : " << caffe::OpenCL::what(err);
+    return false;
+  }
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << current_device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clfft_multiply<float>(
+    const float* input,
+    const float* filter,
+    const int num,
+    const int channels,
+    const int num_output,
+    const int group,
+    const int size,
+    const bool transposed,
+    float* output);
+template bool clfft_multiply<double>(
+    const double* input,
+    const double* filter,
+    const int num,
+    const int channels,
+    const int num_output,
+    const int group,
+    const int size,
+    const bool transposed,
+    double* output);
+
+template<typename T> bool clfft_crop(
+    const T* spectrum,
+    const T* bias,
+    const bool relu,
+    const T negative_slope,
+    const int planes,
+    const int num_output,
+    const int fft_h,
+    const int fft_w,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int height,
+    const int width,
+    T* data) {
+  std::string kernel_name = clGetKernelName<T>("clfft_crop");
+
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+  cl_command_queue* queue = current_device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << current_device.name()
+               << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = current_device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  const int relu_flag = relu ? 1 : 0;
+  CL_SET_KERNEL_ARG
+  CL_SET_ARRAY_KERNEL_ARG(&spectrum, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bias, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, relu_flag, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, negative_slope, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, planes, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, num_output, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, fft_h, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, fft_w, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, stride_h, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, stride_w, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, offset_h, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, offset_w, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, height, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, width, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&data, kernel)
+
+  // a work item per output pixel.
+  const int n = planes * height * width;
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << current_device.name()
+               << " : " << caffe::OpenCL::what(err);
+    return false;
+  }
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << current_device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clfft_crop<float>(
+    const float* spectrum,
+    const float* bias,
+    const bool relu,
+    const float negative_slope,
+    const int planes,
+    const int num_output,
+    const int fft_h,
+    const int fft_w,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int height,
+    const int width,
+    float* data);
+template bool clfft_crop<double>(
+    const double* spectrum,
+    const double* bias,
+    const bool relu,
+    const double negative_slope,
+    const int planes,
+    const int num_output,
+    const int fft_h,
+    const int fft_w,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int height,
+    const int width,
+    double* data);
+
+}  // namespace OpenCL
+
+template<typename Dtype>
+void fft_pad_gpu(
+    const Dtype* data,
+    const int planes,
+    const int height,
+    const int width,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int fft_h,
+    const int fft_w,
+    Dtype* spectrum) {
+  BOOL_CHECK(
+      caffe::OpenCL::clfft_pad(
+          data, planes, height, width, stride_h, stride_w, offset_h,
+          offset_w, fft_h, fft_w, spectrum));
+}
+template void fft_pad_gpu<float>(
+    const float* data,
+    const int planes,
+    const int height,
+    const int width,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int fft_h,
+    const int fft_w,
+    float* spectrum);
+template void fft_pad_gpu<double>(
+    const double* data,
+    const int planes,
+    const int height,
+    const int width,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int fft_h,
+    const int fft_w,
+    double* spectrum);
+
+// the rows and then the columns of the planes.
+template<typename Dtype>
+void fft2d_gpu(
+    Dtype* spectrum,
+    const int planes,
+    const int fft_h,
+    const int fft_w,
+    const bool inverse) {
+  BOOL_CHECK(
+      caffe::OpenCL::clfft(
+          spectrum, planes * fft_h, fft_w, 1, 1, 0, fft_w, inverse));
+  BOOL_CHECK(
+      caffe::OpenCL::clfft(
+          spectrum, planes * fft_w, fft_h, fft_w, fft_w, 1, fft_h * fft_w,
+          inverse));
+}
+template void fft2d_gpu<float>(
+    float* spectrum,
+    const int planes,
+    const int fft_h,
+    const int fft_w,
+    const bool inverse);
+template void fft2d_gpu<double>(
+    double* spectrum,
+    const int planes,
+    const int fft_h,
+    const int fft_w,
+    const bool inverse);
+
+template<typename Dtype>
+void fft_multiply_gpu(
+    const Dtype* input,
+    const Dtype* filter,
+    const int num,
+    const int channels,
+    const int num_output,
+    const int group,
+    const int size,
+    const bool transposed,
+    Dtype* output) {
+  BOOL_CHECK(
+      caffe::OpenCL::clfft_multiply(
+          input, filter, num, channels, num_output, group, size, transposed,
+          output));
+}
+template void fft_multiply_gpu<float>(
+    const float* input,
+    const float* filter,
+    const int num,
+    const int channels,
+    const int num_output,
+    const int group,
+    const int size,
+    const bool transposed,
+    float* output);
+template void fft_multiply_gpu<double>(
+    const double* input,
+    const double* filter,
+    const int num,
+    const int channels,
+    const int num_output,
+    const int group,
+    const int size,
+    const bool transposed,
+    double* output);
+
+template<typename Dtype>
+void fft_crop_gpu(
+    const Dtype* spectrum,
+    const Dtype* bias,
+    const bool relu,
+    const Dtype negative_slope,
+    const int planes,
+    const int num_output,
+    const int fft_h,
+    const int fft_w,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int height,
+    const int width,
+    Dtype* data) {
+  BOOL_CHECK(
+      caffe::OpenCL::clfft_crop(
+          spectrum, bias, relu, negative_slope, planes, num_output, fft_h,
+          fft_w, stride_h, stride_w, offset_h, offset_w, height, width, data));
+}
+template void fft_crop_gpu<float>(
+    const float* spectrum,
+    const float* bias,
+    const bool relu,
+    const float negative_slope,
+    const int planes,
+    const int num_output,
+    const int fft_h,
+    const int fft_w,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int height,
+    const int width,
+    float* data);
+template void fft_crop_gpu<double>(
+    const double* spectrum,
+    const double* bias,
+    const bool relu,
+    const double negative_slope,
+    const int planes,
+    const int num_output,
+    const int fft_h,
+    const int fft_w,
+    const int stride_h,
+    const int stride_w,
+    const int offset_h,
+    const int offset_w,
+    const int height,
+    const int width,
+    double* data);
+
+#endif  // USE_OPENCL
+
+}  // namespace caffe
@@ -194,7 +194,8 @@ template<typename T> bool clim2col_gpu(
   DLOG(INFO) << "kernels = " << n;
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -301,7 +302,8 @@ template<typename T> bool clim2col_gpu(
   DLOG(INFO)<< "local  = { " << local << " }";
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, dim, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -465,7 +467,8 @@ template<typename T> bool clim2col_group_gpu(
    */
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, dim, NULL,
-                               global, local, 0, NULL, NULL);
+                               global, local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -581,7 +584,8 @@ template<typename T> bool clim2col_group_gpu(
   DLOG(INFO)<< "local  = { " << local[0] << " }";
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, dim, NULL,
-                               global, local, 0, NULL, NULL);
+                               global, local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -674,7 +678,8 @@ template<typename T> bool clcol2im_gpu(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -779,7 +784,8 @@ template<typename T> bool clcol2im_gpu(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
@@ -889,7 +895,8 @@ template<typename T> bool clcol2im_gpu(
   size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
 
   err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
-                               &global, &local, 0, NULL, NULL);
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
   if (err != CL_SUCCESS) {
     LOG(ERROR) << "Failed to enqueue kernel '"
                << kernel_name.c_str()
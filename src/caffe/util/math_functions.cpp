@@ -1,6 +1,7 @@
 #include <boost/math/special_functions/next.hpp>
 #include <boost/random.hpp>
 
+#include <algorithm>
 #include <limits>
 
 #include "caffe/common.hpp"
@@ -49,6 +50,68 @@ void caffe_cpu_gemm<double>(
               alpha, A, lda, B, ldb, beta, C, N);
 }
 
+template<typename Dtype>
+void caffe_cpu_gemm(
+    const CBLAS_TRANSPOSE TransA,
+    const CBLAS_TRANSPOSE TransB,
+    const int M,
+    const int N,
+    const int K,
+    const Dtype alpha,
+    const Dtype* A,
+    const Dtype* B,
+    const Dtype beta,
+    Dtype* C,
+    const Dtype* bias_row,
+    const Dtype* bias_col) {
+  if (beta == 0 && (bias_row || bias_col)) {
+    // C starts out as the broadcast bias, which the GEMM accumulates onto.
+    for (int m = 0; m < M; ++m) {
+      Dtype* C_row = C + m * N;
+      caffe_set(N, bias_row ? bias_row[m] : Dtype(0), C_row);
+      if (bias_col) {
+        caffe_axpy<Dtype>(N, Dtype(1), bias_col, C_row);
+      }
+    }
+    caffe_cpu_gemm<Dtype>(TransA, TransB, M, N, K, alpha, A, B, Dtype(1), C);
+    return;
+  }
+  caffe_cpu_gemm<Dtype>(TransA, TransB, M, N, K, alpha, A, B, beta, C);
+  if (bias_row) {
+    caffe_cpu_add_bias<Dtype>(1, M, N, bias_row, C);
+  }
+  if (bias_col) {
+    caffe_cpu_add_bias<Dtype>(M, N, 1, bias_col, C);
+  }
+}
+
+template void caffe_cpu_gemm<float>(
+    const CBLAS_TRANSPOSE TransA,
+    const CBLAS_TRANSPOSE TransB,
+    const int M,
+    const int N,
+    const int K,
+    const float alpha,
+    const float* A,
+    const float* B,
+    const float beta,
+    float* C,
+    const float* bias_row,
+    const float* bias_col);
+template void caffe_cpu_gemm<double>(
+    const CBLAS_TRANSPOSE TransA,
+    const CBLAS_TRANSPOSE TransB,
+    const int M,
+    const int N,
+    const int K,
+    const double alpha,
+    const double* A,
+    const double* B,
+    const double beta,
+    double* C,
+    const double* bias_row,
+    const double* bias_col);
+
 template<>
 void caffe_cpu_gemv<float>(
     const CBLAS_TRANSPOSE TransA,
@@ -477,4 +540,59 @@ void caffe_cpu_scale<double>(
   cblas_dscal(n, alpha, y, 1);
 }
 
+template<typename Dtype>
+void caffe_cpu_relu(const int n, const Dtype negative_slope, Dtype* x) {
+  for (int i = 0; i < n; ++i) {
+    x[i] = std::max(x[i], Dtype(0)) + negative_slope * std::min(x[i], Dtype(0));
+  }
+}
+
+template void caffe_cpu_relu<float>(
+    const int n,
+    const float negative_slope,
+    float* x);
+template void caffe_cpu_relu<double>(
+    const int n,
+    const double negative_slope,
+    double* x);
+
+template<typename Dtype>
+void caffe_cpu_add_bias(const int num, const int channels,
+    const int spatial_dim, const Dtype* bias, Dtype* y) {
+  for (int n = 0; n < num; ++n) {
+    for (int c = 0; c < channels; ++c) {
+      const Dtype b = bias[c];
+      for (int s = 0; s < spatial_dim; ++s) {
+        y[s] += b;
+      }
+      y += spatial_dim;
+    }
+  }
+}
+
+template void caffe_cpu_add_bias<float>(const int num, const int channels,
+    const int spatial_dim, const float* bias, float* y);
+template void caffe_cpu_add_bias<double>(const int num, const int channels,
+    const int spatial_dim, const double* bias, double* y);
+
+template<typename Dtype>
+void caffe_cpu_channel_sum(const int num, const int channels,
+    const int spatial_dim, const Dtype* x, Dtype* y) {
+  for (int n = 0; n < num; ++n) {
+    for (int c = 0; c < channels; ++c) {
+      Dtype sum = 0;
+      for (int s = 0; s < spatial_dim; ++s) {
+        sum += x[s];
+      }
+      y[c] += sum;
+      x += spatial_dim;
+    }
+  }
+}
+
+template void caffe_cpu_channel_sum<float>(const int num, const int channels,
+    const int spatial_dim, const float* x, float* y);
+template void caffe_cpu_channel_sum<double>(const int num, const int channels,
+    const int spatial_dim, const double* x, double* y);
+
 }  // namespace caffe
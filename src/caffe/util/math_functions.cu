@@ -185,6 +185,65 @@ void caffe_gpu_add_scalar(const int N, const double alpha, double* Y) {
       N, alpha, Y);
 }
 
+template <typename Dtype>
+__global__ void add_bias_kernel(const int n, const int channels,
+    const int spatial_dim, const Dtype* bias, Dtype* y) {
+  CUDA_KERNEL_LOOP(index, n) {
+    y[index] += bias[(index / spatial_dim) % channels];
+  }
+}
+
+template <typename Dtype>
+void caffe_gpu_add_bias(const int num, const int channels,
+    const int spatial_dim, const Dtype* bias, Dtype* y) {
+  const int n = num * channels * spatial_dim;
+  // NOLINT_NEXT_LINE(whitespace/operators)
+  add_bias_kernel<Dtype><<<CAFFE_GET_BLOCKS(n), CAFFE_CUDA_NUM_THREADS>>>(
+      n, channels, spatial_dim, bias, y);
+}
+
+template void caffe_gpu_add_bias<float>(const int num, const int channels,
+    const int spatial_dim, const float* bias, float* y);
+template void caffe_gpu_add_bias<double>(const int num, const int channels,
+    const int spatial_dim, const double* bias, double* y);
+
+// a block per channel reduces its num * spatial_dim elements.
+template <typename Dtype>
+__global__ void channel_sum_kernel(const int num, const int channels,
+    const int spatial_dim, const Dtype* x, Dtype* y) {
+  __shared__ Dtype partial[CAFFE_CUDA_NUM_THREADS];
+  const int c = blockIdx.x;
+  Dtype sum = 0;
+  for (int i = threadIdx.x; i < num * spatial_dim; i += blockDim.x) {
+    const int n = i / spatial_dim;
+    sum += x[(n * channels + c) * spatial_dim + i - n * spatial_dim];
+  }
+  partial[threadIdx.x] = sum;
+  __syncthreads();
+  for (int stride = blockDim.x / 2; stride > 0; stride /= 2) {
+    if (threadIdx.x < stride) {
+      partial[threadIdx.x] += partial[threadIdx.x + stride];
+    }
+    __syncthreads();
+  }
+  if (threadIdx.x == 0) {
+    y[c] += partial[0];
+  }
+}
+
+template <typename Dtype>
+void caffe_gpu_channel_sum(const int num, const int channels,
+    const int spatial_dim, const Dtype* x, Dtype* y) {
+  // NOLINT_NEXT_LINE(whitespace/operators)
+  channel_sum_kernel<Dtype><<<channels, CAFFE_CUDA_NUM_THREADS>>>(
+      num, channels, spatial_dim, x, y);
+}
+
+template void caffe_gpu_channel_sum<float>(const int num, const int channels,
+    const int spatial_dim, const float* x, float* y);
+template void caffe_gpu_channel_sum<double>(const int num,
+    const int channels, const int spatial_dim, const double* x, double* y);
+
 template <typename Dtype>
 __global__ void add_kernel(const int n, const Dtype* a,
     const Dtype* b, Dtype* y) {
@@ -0,0 +1,663 @@
+#if defined(USE_OPENCL)
+#include <caffe/util/OpenCL/definitions.hpp>
+#include <caffe/util/OpenCL/winograd.hpp>
+#endif
+
+#include <glog/logging.h>
+
+#include <string>
+
+#include "caffe/util/math_functions.hpp"
+#include "caffe/util/winograd.hpp"
+
+namespace caffe {
+
+// the transforms of F(2x2, 3x3) and F(4x4, 3x3) from Lavin and Gray, "Fast
+// Algorithms for Convolutional Neural Networks": filter G g G^T, input
+// B^T d B and output A^T m A.
+static const double winograd_G_2[4 * 3] = {
+    1.0, 0.0, 0.0,
+    0.5, 0.5, 0.5,
+    0.5, -0.5, 0.5,
+    0.0, 0.0, 1.0 };
+static const double winograd_BT_2[4 * 4] = {
+    1.0, 0.0, -1.0, 0.0,
+    0.0, 1.0, 1.0, 0.0,
+    0.0, -1.0, 1.0, 0.0,
+    0.0, 1.0, 0.0, -1.0 };
+static const double winograd_AT_2[2 * 4] = {
+    1.0, 1.0, 1.0, 0.0,
+    0.0, 1.0, -1.0, -1.0 };
+static const double winograd_G_4[6 * 3] = {
+    1.0 / 4, 0.0, 0.0,
+    -1.0 / 6, -1.0 / 6, -1.0 / 6,
+    -1.0 / 6, 1.0 / 6, -1.0 / 6,
+    1.0 / 24, 1.0 / 12, 1.0 / 6,
+    1.0 / 24, -1.0 / 12, 1.0 / 6,
+    0.0, 0.0, 1.0 };
+static const double winograd_BT_4[6 * 6] = {
+    4.0, 0.0, -5.0, 0.0, 1.0, 0.0,
+    0.0, -4.0, -4.0, 1.0, 1.0, 0.0,
+    0.0, 4.0, -4.0, -1.0, 1.0, 0.0,
+    0.0, -2.0, -1.0, 2.0, 1.0, 0.0,
+    0.0, 2.0, -1.0, -2.0, 1.0, 0.0,
+    0.0, 4.0, 0.0, -5.0, 0.0, 1.0 };
+static const double winograd_AT_4[4 * 6] = {
+    1.0, 1.0, 1.0, 1.0, 1.0, 0.0,
+    0.0, 1.0, -1.0, 2.0, -2.0, 0.0,
+    0.0, 1.0, 1.0, 4.0, 4.0, 0.0,
+    0.0, 1.0, -1.0, 8.0, -8.0, 1.0 };
+
+// the largest transformed tile.
+static const int kMaxWinogradSize = 6;
+
+static void winograd_matrices(const int tile, const double** G,
+                              const double** BT, const double** AT) {
+  CHECK(tile == 2 || tile == 4) << "Winograd tiles are 2x2 or 4x4, not "
+                                << tile << "x" << tile;
+  *G = tile == 2 ? winograd_G_2 : winograd_G_4;
+  *BT = tile == 2 ? winograd_BT_2 : winograd_BT_4;
+  *AT = tile == 2 ? winograd_AT_2 : winograd_AT_4;
+}
+
+template<typename Dtype>
+void winograd_filter_transform_cpu(
+    const Dtype* weight,
+    const int num_output,
+    const int channels,
+    const int tile,
+    Dtype* filter) {
+  const double* G;
+  const double* BT;
+  const double* AT;
+  winograd_matrices(tile, &G, &BT, &AT);
+  const int size = tile + 2;
+  double tmp[kMaxWinogradSize][3];
+  for (int o = 0; o < num_output; ++o) {
+    for (int c = 0; c < channels; ++c) {
+      const Dtype* g = weight + (o * channels + c) * 9;
+      // G g
+      for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < 3; ++j) {
+          tmp[i][j] = 0;
+          for (int k = 0; k < 3; ++k) {
+            tmp[i][j] += G[i * 3 + k] * g[k * 3 + j];
+          }
+        }
+      }
+      // (G g) G^T
+      for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+          double value = 0;
+          for (int k = 0; k < 3; ++k) {
+            value += tmp[i][k] * G[j * 3 + k];
+          }
+          filter[((i * size + j) * num_output + o) * channels + c] = value;
+        }
+      }
+    }
+  }
+}
+template void winograd_filter_transform_cpu<float>(
+    const float* weight,
+    const int num_output,
+    const int channels,
+    const int tile,
+    float* filter);
+template void winograd_filter_transform_cpu<double>(
+    const double* weight,
+    const int num_output,
+    const int channels,
+    const int tile,
+    double* filter);
+
+template<typename Dtype>
+void winograd_input_transform_cpu(
+    const Dtype* data_im,
+    const int num,
+    const int channels,
+    const int height,
+    const int width,
+    const int pad_h,
+    const int pad_w,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    Dtype* input) {
+  const double* G;
+  const double* BT;
+  const double* AT;
+  winograd_matrices(tile, &G, &BT, &AT);
+  const int size = tile + 2;
+  const int num_tiles = num * tiles_h * tiles_w;
+  Dtype d[kMaxWinogradSize][kMaxWinogradSize];
+  Dtype tmp[kMaxWinogradSize][kMaxWinogradSize];
+  for (int c = 0; c < channels; ++c) {
+    for (int p = 0; p < num_tiles; ++p) {
+      const int n = p / (tiles_h * tiles_w);
+      const int h_bgn = (p / tiles_w) % tiles_h * tile - pad_h;
+      const int w_bgn = p % tiles_w * tile - pad_w;
+      const Dtype* image = data_im + (n * channels + c) * height * width;
+      for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+          const int h = h_bgn + i;
+          const int w = w_bgn + j;
+          d[i][j] = (h >= 0 && h < height && w >= 0 && w < width) ?
+              image[h * width + w] : 0;
+        }
+      }
+      // B^T d
+      for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+          tmp[i][j] = 0;
+          for (int k = 0; k < size; ++k) {
+            tmp[i][j] += BT[i * size + k] * d[k][j];
+          }
+        }
+      }
+      // (B^T d) B
+      for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+          Dtype value = 0;
+          for (int k = 0; k < size; ++k) {
+            value += tmp[i][k] * BT[j * size + k];
+          }
+          input[((i * size + j) * channels + c) * num_tiles + p] = value;
+        }
+      }
+    }
+  }
+}
+template void winograd_input_transform_cpu<float>(
+    const float* data_im,
+    const int num,
+    const int channels,
+    const int height,
+    const int width,
+    const int pad_h,
+    const int pad_w,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    float* input);
+template void winograd_input_transform_cpu<double>(
+    const double* data_im,
+    const int num,
+    const int channels,
+    const int height,
+    const int width,
+    const int pad_h,
+    const int pad_w,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    double* input);
+
+template<typename Dtype>
+void winograd_output_transform_cpu(
+    const Dtype* output,
+    const Dtype* bias,
+    const bool relu,
+    const Dtype negative_slope,
+    const int num,
+    const int num_output,
+    const int height_out,
+    const int width_out,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    Dtype* data_im) {
+  const double* G;
+  const double* BT;
+  const double* AT;
+  winograd_matrices(tile, &G, &BT, &AT);
+  const int size = tile + 2;
+  const int num_tiles = num * tiles_h * tiles_w;
+  Dtype m[kMaxWinogradSize][kMaxWinogradSize];
+  Dtype tmp[kMaxWinogradSize][kMaxWinogradSize];
+  for (int o = 0; o < num_output; ++o) {
+    for (int p = 0; p < num_tiles; ++p) {
+      const int n = p / (tiles_h * tiles_w);
+      const int h_bgn = (p / tiles_w) % tiles_h * tile;
+      const int w_bgn = p % tiles_w * tile;
+      for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+          m[i][j] = output[((i * size + j) * num_output + o) * num_tiles + p];
+        }
+      }
+      // A^T m
+      for (int i = 0; i < tile; ++i) {
+        for (int j = 0; j < size; ++j) {
+          tmp[i][j] = 0;
+          for (int k = 0; k < size; ++k) {
+            tmp[i][j] += AT[i * size + k] * m[k][j];
+          }
+        }
+      }
+      // (A^T m) A, the tiles at the border are cut off.
+      Dtype* image = data_im + (n * num_output + o) * height_out * width_out;
+      for (int i = 0; i < tile && h_bgn + i < height_out; ++i) {
+        for (int j = 0; j < tile && w_bgn + j < width_out; ++j) {
+          Dtype value = bias ? bias[o] : 0;
+          for (int k = 0; k < size; ++k) {
+            value += tmp[i][k] * AT[j * size + k];
+          }
+          if (relu && value < 0) {
+            value *= negative_slope;
+          }
+          image[(h_bgn + i) * width_out + w_bgn + j] = value;
+        }
+      }
+    }
+  }
+}
+template void winograd_output_transform_cpu<float>(
+    const float* output,
+    const float* bias,
+    const bool relu,
+    const float negative_slope,
+    const int num,
+    const int num_output,
+    const int height_out,
+    const int width_out,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    float* data_im);
+template void winograd_output_transform_cpu<double>(
+    const double* output,
+    const double* bias,
+    const bool relu,
+    const double negative_slope,
+    const int num,
+    const int num_output,
+    const int height_out,
+    const int width_out,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    double* data_im);
+
+#if defined(USE_OPENCL)
+
+namespace OpenCL {
+
+template<typename T> bool clwinograd_filter_transform(
+    const int num_output,
+    const T* weight,
+    const int channels,
+    const int tile,
+    T* filter) {
+  std::string kernel_name = clGetKernelName<T>("clwinograd_filter_transform");
+
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+  cl_command_queue* queue = current_device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << current_device.name()
+               << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = current_device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, num_output, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&weight, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, channels, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, tile, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&filter, kernel)
+
+  // a work item per output and input channel.
+  const int n = num_output * channels;
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << current_device.name()
+               << " : " << caffe::OpenCL::what(err);
+    return false;
+  }
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << current_device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clwinograd_filter_transform<float>(
+    const int num_output,
+    const float* weight,
+    const int channels,
+    const int tile,
+    float* filter);
+template bool clwinograd_filter_transform<double>(
+    const int num_output,
+    const double* weight,
+    const int channels,
+    const int tile,
+    double* filter);
+
+template<typename T> bool clwinograd_input_transform(
+    const int num_tiles,
+    const T* data_im,
+    const int channels,
+    const int height,
+    const int width,
+    const int pad_h,
+    const int pad_w,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    T* input) {
+  std::string kernel_name = clGetKernelName<T>("clwinograd_input_transform");
+
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+  cl_command_queue* queue = current_device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << current_device.name()
+               << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = current_device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, num_tiles, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&data_im, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, channels, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, height, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, width, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, pad_h, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, pad_w, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, tiles_h, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, tiles_w, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, tile, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&input, kernel)
+
+  // a work item per tile and channel.
+  const int n = num_tiles * channels;
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << current_device.name()
+               << " : " << caffe::OpenCL::what(err);
+    return false;
+  }
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << current_device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clwinograd_input_transform<float>(
+    const int num_tiles,
+    const float* data_im,
+    const int channels,
+    const int height,
+    const int width,
+    const int pad_h,
+    const int pad_w,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    float* input);
+template bool clwinograd_input_transform<double>(
+    const int num_tiles,
+    const double* data_im,
+    const int channels,
+    const int height,
+    const int width,
+    const int pad_h,
+    const int pad_w,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    double* input);
+
+template<typename T> bool clwinograd_output_transform(
+    const int num_tiles,
+    const T* output,
+    const T* bias,
+    const bool relu,
+    const T negative_slope,
+    const int num_output,
+    const int height_out,
+    const int width_out,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    T* data_im) {
+  std::string kernel_name = clGetKernelName<T>("clwinograd_output_transform");
+
+  OpenCLDevice& current_device =
+      OpenCLManager::CurrentPlatform()->CurrentDevice();
+  cl_command_queue* queue = current_device.getCurrentCommandQueue();
+  if (!queue) {
+    LOG(ERROR) << current_device.name()
+               << "> failed to get OpenCL command queue";
+    return false;
+  }
+
+  cl_kernel* kernel = current_device.getKernel(kernel_name);
+  if (kernel == NULL) {
+    return false;
+  }
+
+  const int relu_flag = relu ? 1 : 0;
+  CL_SET_KERNEL_ARG
+  CL_SET_TYPE_KERNEL_ARG(int, num_tiles, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&output, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&bias, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, relu_flag, kernel)
+  CL_SET_TYPE_KERNEL_ARG(T, negative_slope, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, num_output, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, height_out, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, width_out, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, tiles_h, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, tiles_w, kernel)
+  CL_SET_TYPE_KERNEL_ARG(int, tile, kernel)
+  CL_SET_ARRAY_KERNEL_ARG(&data_im, kernel)
+
+  // a work item per tile and output channel.
+  const int n = num_tiles * num_output;
+  size_t global = CAFFE_GET_GLOBAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+  size_t local = CAFFE_GET_LOCAL_WORKITEMS(n, OPENCL_LOCAL_SIZE);
+
+  err = clEnqueueNDRangeKernel(*queue, *kernel, 1, NULL,
+                               &global, &local,
+                               CL_COMMAND_WAIT_LIST(current_device));
+  if (err != CL_SUCCESS) {
+    LOG(ERROR) << "Failed to enqueue kernel '"
+               << kernel_name.c_str()
+               << "' on GPU "
+               << current_device.name()
+               << " : " << caffe::OpenCL::what(err);
+    return false;
+  }
+  DLOG(INFO) << "kernel '"
+             << kernel_name.c_str()
+             << "' executed on GPU "
+             << current_device.name();
+
+  CL_SET_KERNEL_ARG_END
+
+  return true;
+}
+template bool clwinograd_output_transform<float>(
+    const int num_tiles,
+    const float* output,
+    const float* bias,
+    const bool relu,
+    const float negative_slope,
+    const int num_output,
+    const int height_out,
+    const int width_out,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    float* data_im);
+template bool clwinograd_output_transform<double>(
+    const int num_tiles,
+    const double* output,
+    const double* bias,
+    const bool relu,
+    const double negative_slope,
+    const int num_output,
+    const int height_out,
+    const int width_out,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    double* data_im);
+
+}  // namespace OpenCL
+
+template<typename Dtype>
+void winograd_filter_transform_gpu(
+    const Dtype* weight,
+    const int num_output,
+    const int channels,
+    const int tile,
+    Dtype* filter) {
+  CHECK(tile == 2 || tile == 4) << "Winograd tiles are 2x2 or 4x4, not "
+                                << tile << "x" << tile;
+  BOOL_CHECK(
+      caffe::OpenCL::clwinograd_filter_transform(
+          num_output, weight, channels, tile, filter));
+}
+template void winograd_filter_transform_gpu<float>(
+    const float* weight,
+    const int num_output,
+    const int channels,
+    const int tile,
+    float* filter);
+template void winograd_filter_transform_gpu<double>(
+    const double* weight,
+    const int num_output,
+    const int channels,
+    const int tile,
+    double* filter);
+
+template<typename Dtype>
+void winograd_input_transform_gpu(
+    const Dtype* data_im,
+    const int num,
+    const int channels,
+    const int height,
+    const int width,
+    const int pad_h,
+    const int pad_w,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    Dtype* input) {
+  CHECK(tile == 2 || tile == 4) << "Winograd tiles are 2x2 or 4x4, not "
+                                << tile << "x" << tile;
+  BOOL_CHECK(
+      caffe::OpenCL::clwinograd_input_transform(
+          num * tiles_h * tiles_w, data_im, channels, height, width,
+          pad_h, pad_w, tiles_h, tiles_w, tile, input));
+}
+template void winograd_input_transform_gpu<float>(
+    const float* data_im,
+    const int num,
+    const int channels,
+    const int height,
+    const int width,
+    const int pad_h,
+    const int pad_w,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    float* input);
+template void winograd_input_transform_gpu<double>(
+    const double* data_im,
+    const int num,
+    const int channels,
+    const int height,
+    const int width,
+    const int pad_h,
+    const int pad_w,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    double* input);
+
+template<typename Dtype>
+void winograd_output_transform_gpu(
+    const Dtype* output,
+    const Dtype* bias,
+    const bool relu,
+    const Dtype negative_slope,
+    const int num,
+    const int num_output,
+    const int height_out,
+    const int width_out,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    Dtype* data_im) {
+  CHECK(tile == 2 || tile == 4) << "Winograd tiles are 2x2 or 4x4, not "
+                                << tile << "x" << tile;
+  BOOL_CHECK(
+      caffe::OpenCL::clwinograd_output_transform(
+          num * tiles_h * tiles_w, output, bias, relu, negative_slope,
+          num_output, height_out,
+          width_out, tiles_h, tiles_w, tile, data_im));
+}
+template void winograd_output_transform_gpu<float>(
+    const float* output,
+    const float* bias,
+    const bool relu,
+    const float negative_slope,
+    const int num,
+    const int num_output,
+    const int height_out,
+    const int width_out,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    float* data_im);
+template void winograd_output_transform_gpu<double>(
+    const double* output,
+    const double* bias,
+    const bool relu,
+    const double negative_slope,
+    const int num,
+    const int num_output,
+    const int height_out,
+    const int width_out,
+    const int tiles_h,
+    const int tiles_w,
+    const int tile,
+    double* data_im);
+
+#endif  // USE_OPENCL
+
+}  // namespace caffe
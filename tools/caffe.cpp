@@ -39,6 +39,14 @@ DEFINE_string(weights, "",
     "Cannot be set simultaneously with snapshot.");
 DEFINE_int32(iterations, 50,
     "The number of iterations to run.");
+#ifdef USE_OPENCL
+DEFINE_string(opencl_cache_dir, "",
+    "Optional; the directory used to cache compiled OpenCL programs. "
+    "Pass 'none' to disable the cache.");
+DEFINE_string(opencl_gemm_tuning_file, "",
+    "Optional; the GEMM tuning database, defaults to gemm_tuning.txt "
+    "in the OpenCL program cache directory.");
+#endif
 
 // A simple registry for caffe commands.
 typedef int (*BrewFunction)();
@@ -253,6 +261,13 @@ int time() {
 
   // Instantiate the caffe net.
   Net<float> caffe_net(FLAGS_model, caffe::TRAIN);
+#ifdef USE_OPENCL
+  // Build the OpenCL programs of the net up front, so that the first
+  // iterations don't pay for their compilation.
+  if ( FLAGS_gpu >= 0 ) {
+    caffe::OpenCLManager::WarmUp(caffe_net);
+  }
+#endif
 
   // Do a clean forward and backward pass, so that memory allocation are done
   // and future iterations will be more stable.
@@ -328,6 +343,43 @@ int time() {
 }
 RegisterBrewFunction(time);
 
+#ifdef USE_OPENCL
+// Tune: benchmark the GEMM kernels for the GEMM shapes of a model and store
+// the fastest ones in the GEMM tuning database.
+int tune() {
+  CHECK_GT(FLAGS_model.size(), 0) << "Need a model definition to tune.";
+  CHECK_GT(FLAGS_gpu, -1) << "Need a device ID to tune.";
+  CHECK_GT(caffe::OpenCLGemmTuner::GetFile().size(), 0)
+      << "Need a GEMM tuning file, see -opencl_gemm_tuning_file.";
+
+  LOG(INFO) << "Use GPU with device ID " << FLAGS_gpu;
+  Caffe::SetDevice(FLAGS_gpu);
+  Caffe::set_mode(Caffe::GPU);
+
+  // A forward and backward pass of the nets of both phases runs every GEMM
+  // shape once, the shapes missing in the database are tuned on their way.
+  caffe::OpenCLGemmTuner::SetTuning(true);
+  caffe::Phase phases[] = { caffe::TRAIN, caffe::TEST };
+  for (int i = 0; i < 2; ++i) {
+    Net<float> caffe_net(FLAGS_model, phases[i]);
+    caffe::OpenCLManager::WarmUp(caffe_net);
+    LOG(INFO) << "Tuning " << (phases[i] == caffe::TRAIN ? "TRAIN" : "TEST")
+              << " net";
+    float loss;
+    caffe_net.Forward(vector<Blob<float>*>(), &loss);
+    caffe_net.Backward();
+  }
+  caffe::OpenCLGemmTuner::SetTuning(false);
+
+  CHECK(caffe::OpenCLGemmTuner::Save())
+      << "Failed to save " << caffe::OpenCLGemmTuner::GetFile();
+  LOG(INFO) << caffe::OpenCLGemmTuner::GetNumEntries() << " GEMM shapes in "
+            << caffe::OpenCLGemmTuner::GetFile();
+  return 0;
+}
+RegisterBrewFunction(tune);
+#endif
+
 int main(int argc, char** argv) {
   // Print output to stderr (while still logging).
   FLAGS_alsologtostderr = 1;
@@ -338,9 +390,20 @@ int main(int argc, char** argv) {
       "  train           train or finetune a model\n"
       "  test            score a model\n"
       "  device_query    show GPU diagnostic information\n"
-      "  time            benchmark model execution time");
+      "  time            benchmark model execution time\n"
+      "  tune            tune the OpenCL GEMM kernels of a model");
   // Run tool or show usage.
   caffe::GlobalInit(&argc, &argv);
+#ifdef USE_OPENCL
+  if (FLAGS_opencl_cache_dir == "none") {
+    caffe::OpenCLManager::SetProgramCacheDir("");
+  } else if (FLAGS_opencl_cache_dir.size()) {
+    caffe::OpenCLManager::SetProgramCacheDir(FLAGS_opencl_cache_dir);
+  }
+  if (FLAGS_opencl_gemm_tuning_file.size()) {
+    caffe::OpenCLGemmTuner::SetFile(FLAGS_opencl_gemm_tuning_file);
+  }
+#endif
   if (argc == 2) {
     return GetBrewFunction(caffe::string(argv[1]))();
   } else {
@@ -0,0 +1,224 @@
+// Converts the AMD-style OpenCL kernel sources to standard OpenCL at build
+// time and embeds them into a C++ header, so that the Caffe library does not
+// need to read or rewrite any files in the source tree at runtime.
+//
+// Usage:
+//    cl_embed OUTPUT_HEADER WORK_DIR INCLUDE_DIR [NAME CL_FILE]...
+//
+// NAME is the name the program is reported under at runtime (usually the
+// path of CL_FILE relative to the source tree), WORK_DIR receives the
+// intermediate standard OpenCL files and INCLUDE_DIR is used to resolve the
+// local #include directives of the kernel sources.
+
+#ifdef USE_OPENCL
+
+#include <glog/logging.h>
+#include <stdio.h>
+
+#include <caffe/util/OpenCL/OpenCLParser.hpp>
+
+#include <fstream>  // NOLINT(*)
+#include <sstream>  // NOLINT(*)
+#include <string>
+#include <vector>
+
+// Resolves '#include "file"' lines against include_dir, as done by the
+// OpenCL compiler through the -I option when building from files.
+bool resolveIncludes(const std::string& source,
+                     const std::string& include_dir,
+                     std::string* result) {
+  std::istringstream in(source);
+  std::string line;
+  while (std::getline(in, line)) {
+    size_t pos = line.find_first_not_of(" \t");
+    if (pos != std::string::npos && line.compare(pos, 8, "#include") == 0) {
+      size_t bgn = line.find('"', pos);
+      size_t end = line.find('"', bgn + 1);
+      if (bgn == std::string::npos || end == std::string::npos) {
+        LOG(ERROR) << "unsupported include directive '" << line << "'";
+        return false;
+      }
+      std::string file_name = include_dir + "/"
+          + line.substr(bgn + 1, end - bgn - 1);
+      std::ifstream file(file_name.c_str());
+      if (!file.is_open()) {
+        LOG(ERROR) << "failed to open include file '" << file_name << "'";
+        return false;
+      }
+      std::string included(
+          (std::istreambuf_iterator<char>(file)),
+          std::istreambuf_iterator<char>());
+      *result += included;
+      if (included.size() > 0 && included[included.size() - 1] != '\n') {
+        *result += "\n";
+      }
+      continue;
+    }
+    *result += line + "\n";
+  }
+  return true;
+}
+
+// Writes str as a sequence of C string literals, one per source line.
+void writeStringLiteral(std::ostream& out, const std::string& str) {
+  out << "    \"";
+  for (size_t i = 0; i < str.size(); i++) {
+    unsigned char c = str[i];
+    switch (c) {
+      case '\n':
+        out << "\\n\"";
+        if (i + 1 < str.size()) {
+          out << "\n    \"";
+        } else {
+          return;
+        }
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '"':
+        out << "\\\"";
+        break;
+      case '?':
+        // avoid trigraphs
+        out << "\\?";
+        break;
+      case '\t':
+        out << "\\t";
+        break;
+      case '\r':
+        break;
+      default:
+        if (c < 0x20 || c >= 0x7f) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\%03o", c);
+          out << buf;
+        } else {
+          out << c;
+        }
+    }
+  }
+  out << "\"";
+}
+
+// Turns a file name into a valid C identifier.
+std::string identifier(const std::string& name) {
+  std::string id;
+  size_t pos = name.find_last_of('/');
+  std::string base = pos == std::string::npos ? name : name.substr(pos + 1);
+  for (size_t i = 0; i < base.size(); i++) {
+    char c = base[i];
+    bool alnum = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+        || (c >= '0' && c <= '9');
+    id += alnum ? c : '_';
+  }
+  return id;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4 || (argc - 4) % 2 != 0) {
+    LOG(ERROR) << "usage: cl_embed OUTPUT_HEADER WORK_DIR INCLUDE_DIR "
+               << "[NAME CL_FILE]...";
+    return 1;
+  }
+  std::string output = argv[1];
+  std::string work_dir = argv[2];
+  std::string include_dir = argv[3];
+
+  std::ostringstream programs;
+  std::ostringstream table;
+
+  for (int i = 4; i < argc; i += 2) {
+    std::string name = argv[i];
+    std::string cl_source = argv[i + 1];
+    std::string id = identifier(cl_source);
+    std::string cl_standard = work_dir + "/" + id + "-STD.cl";
+
+    caffe::OpenCLParser parser;
+    if (!parser.convert(cl_source, cl_standard)) {
+      LOG(ERROR) << "failed to convert kernel source file = '"
+                 << cl_source << "' to standard OpenCL";
+      return 1;
+    }
+
+    std::vector<std::string> kernel_names;
+    if (!parser.getKernelNames(cl_standard, kernel_names)) {
+      LOG(ERROR) << "failed to parse kernel names from file '"
+                 << cl_standard << "'";
+      return 1;
+    }
+
+    std::ifstream file(cl_standard.c_str());
+    std::string str(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>());
+    std::string source;
+    if (!resolveIncludes(str, include_dir, &source)) {
+      LOG(ERROR) << "failed to resolve includes of file '"
+                 << cl_source << "'";
+      return 1;
+    }
+
+    programs << "static const char* " << id << "_kernels[] = {\n";
+    for (size_t k = 0; k < kernel_names.size(); k++) {
+      programs << "    \"" << kernel_names[k] << "\",\n";
+    }
+    programs << "    NULL\n};\n\n";
+    programs << "static const char " << id << "_source[] =\n";
+    writeStringLiteral(programs, source);
+    programs << ";\n\n";
+
+    table << "    { \"" << name << "\", " << id << "_source, "
+          << id << "_kernels },\n";
+  }
+
+  std::ostringstream header;
+  header << "// This file was auto-generated by cl_embed. Do not edit.\n"
+         << "#ifndef CAFFE_UTIL_OPENCL_SOURCES_HPP_\n"
+         << "#define CAFFE_UTIL_OPENCL_SOURCES_HPP_\n\n"
+         << "#include <cstddef>\n\n"
+         << "namespace caffe {\n\n"
+         << "namespace OpenCL {\n\n"
+         << "struct EmbeddedProgram {\n"
+         << "  const char* name;\n"
+         << "  const char* source;\n"
+         << "  const char* const* kernels;\n"
+         << "};\n\n"
+         << programs.str()
+         << "static const EmbeddedProgram embedded_programs[] = {\n"
+         << table.str()
+         << "    { NULL, NULL, NULL }\n"
+         << "};\n\n"
+         << "}  // namespace OpenCL\n\n"
+         << "}  // namespace caffe\n\n"
+         << "#endif  // CAFFE_UTIL_OPENCL_SOURCES_HPP_\n";
+
+  // only replace the header if its content changed, so that touching a
+  // kernel file doesn't trigger a rebuild of everything including it.
+  std::ifstream current(output.c_str());
+  std::string previous(
+      (std::istreambuf_iterator<char>(current)),
+      std::istreambuf_iterator<char>());
+  if (previous == header.str()) {
+    return 0;
+  }
+
+  std::ofstream out(output.c_str());
+  if (!out.is_open()) {
+    LOG(ERROR) << "failed to open file '" << output << "' for writing";
+    return 1;
+  }
+  out << header.str();
+  return out.good() ? 0 : 1;
+}
+
+#else
+
+#include <glog/logging.h>
+
+int main(int argc, char** argv) {
+  LOG(FATAL) << "cl_embed requires Caffe to be built with USE_OPENCL.";
+  return 1;
+}
+
+#endif  // USE_OPENCL